@@ -4,7 +4,26 @@
 #include "GL/gl.h"
 #include "GLFW/glfw3.h"
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
 #include <utility>
+#include <vector>
+
+// Compile the call capture into the wrappers, see gl::call_capture.
+#ifndef M_GL_CAPTURE
+#define M_GL_CAPTURE 0
+#endif
 
 namespace gl {
 
@@ -21,58 +40,1063 @@ using f64 = GLdouble;
 using i32 = GLint;
 using s32 = GLsizei;
 using u32 = GLuint;
+using u64 = GLuint64;
 
 
 // OpenGL Constants
 
 
 
+// OpenGL State Cache
+
+/**
+ * @brief Shadow copy of the bindings of one context, so that the wrappers below can skip calls
+ * that would not change anything. k_unknown forces the next call through. The wrappers also
+ * count the work of the frame into it: draws, binds, uploads, and objects made and deleted.
+ */
+struct state_cache {
+    static constexpr u32 k_unknown = ~0u;
+
+    struct stats {
+        std::uint64_t issued = 0;               // Binding calls let through by the cache.
+        std::uint64_t skipped = 0;              // Binding calls skipped as redundant.
+        std::uint64_t draw_calls = 0;           // A multi-draw counts its draws.
+        std::uint64_t triangles = 0;            // Of all instances; indirect draws are not known.
+        std::uint64_t instances = 0;
+        std::uint64_t program_binds = 0;        // Programs and pipelines, those issued.
+        std::uint64_t vao_binds = 0;
+        std::uint64_t texture_binds = 0;
+        std::uint64_t bytes_uploaded = 0;       // Buffer and texture data from client memory; not what is written through mappings.
+        std::uint64_t buffer_allocations = 0;   // Buffer stores (re)created with *buffer_data or *buffer_storage.
+        std::uint64_t objects_created = 0;
+        std::uint64_t objects_destroyed = 0;
+
+        stats& operator+=(stats const& other) noexcept {
+            issued += other.issued;
+            skipped += other.skipped;
+            draw_calls += other.draw_calls;
+            triangles += other.triangles;
+            instances += other.instances;
+            program_binds += other.program_binds;
+            vao_binds += other.vao_binds;
+            texture_binds += other.texture_binds;
+            bytes_uploaded += other.bytes_uploaded;
+            buffer_allocations += other.buffer_allocations;
+            objects_created += other.objects_created;
+            objects_destroyed += other.objects_destroyed;
+            return *this;
+        }
+    };
+
+    /**
+     * @brief Record a new value of a binding. Returns whether the call has to be issued.
+     */
+    bool change(u32& slot, u32 value) noexcept {
+        if (slot == value) {
+            ++frame.skipped;
+            return false;
+        }
+        slot = value;
+        ++frame.issued;
+        return true;
+    }
+
+    /**
+     * @brief Index of a buffer target in `buffers`, or -1 for untracked targets.
+     */
+    static constexpr int slot_of(e32 target) noexcept {
+        switch (target) {
+        case GL_ARRAY_BUFFER:               return 0;
+        case GL_ELEMENT_ARRAY_BUFFER:       return 1;
+        case GL_COPY_READ_BUFFER:           return 2;
+        case GL_COPY_WRITE_BUFFER:          return 3;
+        case GL_UNIFORM_BUFFER:             return 4;
+        case GL_SHADER_STORAGE_BUFFER:      return 5;
+        case GL_DISPATCH_INDIRECT_BUFFER:   return 6;
+        case GL_DRAW_INDIRECT_BUFFER:       return 7;
+        case GL_PIXEL_PACK_BUFFER:          return 8;
+        case GL_PIXEL_UNPACK_BUFFER:        return 9;
+        case GL_PARAMETER_BUFFER:           return 10;
+        default:                            return -1;
+        }
+    }
+
+    /**
+     * @brief The cached binding of a buffer target, or a scratch slot for untracked targets.
+     */
+    u32& buffer_slot(e32 target) noexcept {
+        auto const slot = slot_of(target);
+        return slot < 0 ? (scratch = k_unknown) : buffers[slot];
+    }
+
+    /**
+     * @brief The cached state of a capability (0: unknown, 1: disabled, 2: enabled).
+     */
+    std::uint8_t* capability_slot(e32 cap) noexcept {
+        switch (cap) {
+        case GL_BLEND:                      return &capabilities[0];
+        case GL_CULL_FACE:                  return &capabilities[1];
+        case GL_DEPTH_TEST:                 return &capabilities[2];
+        case GL_SCISSOR_TEST:               return &capabilities[3];
+        case GL_STENCIL_TEST:               return &capabilities[4];
+        case GL_MULTISAMPLE:                return &capabilities[5];
+        case GL_FRAMEBUFFER_SRGB:           return &capabilities[6];
+        case GL_POLYGON_OFFSET_FILL:        return &capabilities[7];
+        default:                            return nullptr;
+        }
+    }
+
+    bool change_capability(e32 cap, bool enabled) noexcept {
+        auto* const slot = capability_slot(cap);
+        auto const value = static_cast<std::uint8_t>(enabled ? 2 : 1);
+        if (slot != nullptr && *slot == value) {
+            ++frame.skipped;
+            return false;
+        }
+        if (slot != nullptr) {
+            *slot = value;
+        }
+        ++frame.issued;
+        render_state = k_unknown;
+        return true;
+    }
+
+    /**
+     * @brief Where the fixed function state lives in `fixed`; a state of several values takes
+     * consecutive slots.
+     */
+    struct fixed_state {
+        enum type : std::uint8_t {
+            BLEND_FUNC     = 0,         // Source and destination of RGB, then of alpha.
+            BLEND_EQUATION = 4,         // RGB, alpha.
+            COLOR_MASK     = 6,         // Bits 0 to 3: red, green, blue, alpha.
+            DEPTH_FUNC     = 7,
+            DEPTH_MASK     = 8,
+            CULL_FACE      = 9,
+            FRONT_FACE     = 10,
+            POLYGON_MODE   = 11,        // Of GL_FRONT_AND_BACK.
+            POLYGON_OFFSET = 12,        // Factor, units (the bits of the floats).
+            STENCIL_FUNC   = 14,        // Function, reference, mask.
+            STENCIL_OP     = 17,        // Stencil fail, depth fail, pass.
+            STENCIL_MASK   = 20,
+            COUNT          = 21
+        };
+    };
+
+    /**
+     * @brief Record new values of a fixed function state. Returns whether the call has to be issued.
+     */
+    bool change_fixed(fixed_state::type first, std::initializer_list<u32> values) noexcept {
+        auto const at = fixed.begin() + first;
+        if (std::equal(values.begin(), values.end(), at)) {
+            ++frame.skipped;
+            return false;
+        }
+        std::ranges::copy(values, at);
+        ++frame.issued;
+        render_state = k_unknown;
+        return true;
+    }
+
+    /**
+     * @brief Only the blending of all draw buffers is cached; setting that of one forgets it.
+     */
+    void forget_blend_func() noexcept {
+        fixed[fixed_state::BLEND_FUNC] = render_state = k_unknown;
+        ++frame.issued;
+    }
+
+    /**
+     * @brief Only the mode of both faces is cached; setting one face forgets it.
+     */
+    bool change_polygon_mode(e32 face, e32 mode) noexcept {
+        if (face == GL_FRONT_AND_BACK) {
+            return change_fixed(fixed_state::POLYGON_MODE, { mode });
+        }
+        fixed[fixed_state::POLYGON_MODE] = render_state = k_unknown;
+        ++frame.issued;
+        return true;
+    }
+
+    /**
+     * @brief Triangles rasterized by one instance of a draw of `count` vertices; 0 for points,
+     * lines and patches.
+     */
+    static constexpr std::uint64_t triangles_of(e32 mode, s32 count) noexcept {
+        auto const n = static_cast<std::uint64_t>(count < 0 ? 0 : count);
+        switch (mode) {
+        case GL_TRIANGLES:                  return n / 3;
+        case GL_TRIANGLE_STRIP:
+        case GL_TRIANGLE_FAN:               return n > 2 ? n - 2 : 0;
+        case GL_TRIANGLES_ADJACENCY:        return n / 6;
+        case GL_TRIANGLE_STRIP_ADJACENCY:   return n > 5 ? (n - 4) / 2 : 0;
+        default:                            return 0;
+        }
+    }
+
+    /**
+     * @brief Bytes of a pixel in client memory, 0 for formats not known here.
+     */
+    static constexpr std::uint64_t pixel_size(e32 format, e32 type) noexcept {
+        switch (type) {
+        case GL_UNSIGNED_SHORT_5_6_5:
+        case GL_UNSIGNED_SHORT_4_4_4_4:
+        case GL_UNSIGNED_SHORT_5_5_5_1:     return 2;
+        case GL_UNSIGNED_INT_2_10_10_10_REV:
+        case GL_UNSIGNED_INT_10F_11F_11F_REV:
+        case GL_UNSIGNED_INT_5_9_9_9_REV:
+        case GL_UNSIGNED_INT_24_8:          return 4;
+        case GL_FLOAT_32_UNSIGNED_INT_24_8_REV: return 8;
+        default:                            break;
+        }
+        auto components = std::uint64_t(0);
+        switch (format) {
+        case GL_RED: case GL_RED_INTEGER: case GL_DEPTH_COMPONENT: case GL_STENCIL_INDEX:   components = 1; break;
+        case GL_RG: case GL_RG_INTEGER:                                                     components = 2; break;
+        case GL_RGB: case GL_BGR: case GL_RGB_INTEGER: case GL_BGR_INTEGER:                 components = 3; break;
+        case GL_RGBA: case GL_BGRA: case GL_RGBA_INTEGER: case GL_BGRA_INTEGER:             components = 4; break;
+        default:                                                                            return 0;
+        }
+        switch (type) {
+        case GL_UNSIGNED_BYTE: case GL_BYTE:                                return components;
+        case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT:          return components * 2;
+        case GL_UNSIGNED_INT: case GL_INT: case GL_FLOAT:                   return components * 4;
+        default:                                                            return 0;
+        }
+    }
+
+    void count_draw(e32 mode, s32 count, s32 instance_ct) noexcept {
+        auto const instances = static_cast<std::uint64_t>(instance_ct < 0 ? 0 : instance_ct);
+        ++frame.draw_calls;
+        frame.instances += instances;
+        frame.triangles += triangles_of(mode, count) * instances;
+    }
+
+    void count_upload(std::intptr_t size, void const* data) noexcept {
+        if (data != nullptr && size > 0) {
+            frame.bytes_uploaded += static_cast<std::uint64_t>(size);
+        }
+    }
+
+    /**
+     * @brief Count a texture upload, unless it reads from a pixel unpack buffer (`pixels` is an
+     * offset then, and the bytes were counted when they went into the buffer).
+     */
+    void count_pixels(std::uint64_t size, void const* pixels) noexcept {
+        if (pixels != nullptr && (buffers[9] == 0 || buffers[9] == k_unknown)) {
+            frame.bytes_uploaded += size;
+        }
+    }
+
+    void count_pixels(e32 format, e32 type, s32 width, s32 height, s32 depth, void const* pixels) noexcept {
+        count_pixels(pixel_size(format, type) * static_cast<std::uint64_t>(width) * static_cast<std::uint64_t>(height) *
+                     static_cast<std::uint64_t>(depth), pixels);
+    }
+
+    /**
+     * @brief An indexed binding of a block target; a size of 0 is the whole buffer (glBindBufferBase).
+     */
+    struct buffer_range {
+        u32 buffer = k_unknown;
+        std::intptr_t offset = 0;
+        std::intptr_t size = 0;
+
+        friend bool operator ==(buffer_range const&, buffer_range const&) = default;
+    };
+
+    /**
+     * @brief The cached indexed bindings of a target, null for untracked targets.
+     */
+    std::array<buffer_range, 32>* indexed_slots(e32 target) noexcept {
+        switch (target) {
+        case GL_UNIFORM_BUFFER:             return &indexed[0];
+        case GL_SHADER_STORAGE_BUFFER:      return &indexed[1];
+        default:                            return nullptr;
+        }
+    }
+
+    /**
+     * @brief Record new values of the consecutive slots [first, first + count), e.g. texture
+     * units. Returns the part [begin, end) of the values to issue, from the first changed one
+     * to the last; slots past the cached ones always count as changed.
+     */
+    template<typename T, std::size_t N, typename F>
+    std::pair<u32, u32> change_slots(std::array<T, N>* slots, u32 first, s32 count, F&& value_of) noexcept {
+        auto begin = static_cast<u32>(count);
+        auto end = u32(0);
+        for (auto i = u32(0); i < static_cast<u32>(count); ++i) {
+            auto const value = value_of(i);
+            if (slots != nullptr && first + i < N) {
+                if ((*slots)[first + i] == value) {
+                    continue;
+                }
+                (*slots)[first + i] = value;
+            }
+            begin = std::min(begin, i);
+            end = i + 1;
+        }
+        if (begin >= end) {
+            ++frame.skipped;
+            return { 0, 0 };
+        }
+        ++frame.issued;
+        return { begin, end };
+    }
+
+    template<typename T, std::size_t N>
+    bool change_slot(std::array<T, N>* slots, u32 slot, T const& value) noexcept {
+        return change_slots(slots, slot, 1, [&value](u32) { return value; }).second != 0;
+    }
+
+    /**
+     * @brief Forget the unit a glBindTexture changes: the active one.
+     */
+    void forget_active_unit() noexcept {
+        if (active_unit < textures.size()) {
+            textures[active_unit] = k_unknown;
+        }
+        else if (active_unit == k_unknown) {
+            textures.fill(k_unknown);
+        }
+    }
+
+    template<typename T, std::size_t N>
+    static constexpr std::array<T, N> filled(T value) noexcept {
+        auto result = std::array<T, N>();
+        result.fill(value);
+        return result;
+    }
+
+    /**
+     * @brief Forget every binding equal to a deleted object, since GL unbinds it (or may reuse the name).
+     */
+    void forget(u32& slot, u32 object) noexcept {
+        if (slot == object) {
+            slot = k_unknown;
+        }
+    }
+
+    void forget_buffer(u32 object) noexcept {
+        for (auto& slot : buffers) {
+            forget(slot, object);
+        }
+        for (auto& target : indexed) {
+            for (auto& slot : target) {
+                forget(slot.buffer, object);
+            }
+        }
+    }
+
+    void forget_texture(u32 object) noexcept {
+        for (auto& slot : textures) {
+            forget(slot, object);
+        }
+    }
+
+    void forget_sampler(u32 object) noexcept {
+        for (auto& slot : samplers) {
+            forget(slot, object);
+        }
+    }
+
+    /**
+     * @brief Forget everything, e.g. after third-party code made GL calls behind our back.
+     */
+    void invalidate() noexcept {
+        vao = program = pipeline = k_unknown;
+        buffers.fill(k_unknown);
+        capabilities.fill(0);
+        fixed.fill(k_unknown);
+        render_state = k_unknown;
+        textures.fill(k_unknown);
+        samplers.fill(k_unknown);
+        indexed.fill({});
+        active_unit = k_unknown;
+    }
+
+    u32 vao = k_unknown;
+    u32 program = k_unknown;
+    u32 pipeline = k_unknown;
+    u32 scratch = k_unknown;
+    u32 default_framebuffer = 0;        // What "the window" draws into: 0, or the target of a headless window.
+    std::array<u32, 11> buffers = { k_unknown, k_unknown, k_unknown, k_unknown, k_unknown, k_unknown, k_unknown, k_unknown, k_unknown, k_unknown, k_unknown };
+    std::array<std::uint8_t, 8> capabilities = {};
+    std::array<u32, fixed_state::COUNT> fixed = filled<u32, fixed_state::COUNT>(k_unknown);
+    std::array<u32, 32> textures = filled<u32, 32>(k_unknown);       // Per texture unit, as bound by unit (not by target).
+    std::array<u32, 32> samplers = filled<u32, 32>(k_unknown);
+    std::array<std::array<buffer_range, 32>, 2> indexed = {};       // Uniform and storage block bindings.
+    u32 active_unit = 0;
+    u32 render_state = k_unknown;       // Id of the gl::pipeline_state applied last, unknown once any of its state changes.
+    stats frame;
+};
+
+/**
+ * @brief Caches are kept per context (the key is the context's window handle) and the one of the
+ * context current on this thread is selected by glfw::make_context_current().
+ */
+inline std::unordered_map<void const*, state_cache> g_state_caches;
+
+inline std::mutex g_state_caches_mutex;
+
+inline thread_local state_cache* g_state = [] {
+    auto const lock = std::lock_guard(g_state_caches_mutex);
+    return &g_state_caches[nullptr];
+}();
+
+inline void select_state(void const* context) {
+    auto const lock = std::lock_guard(g_state_caches_mutex);
+    g_state = &g_state_caches[context];
+}
+
+inline void forget_state(void const* context) {
+    auto const lock = std::lock_guard(g_state_caches_mutex);
+    if (g_state == &g_state_caches[context]) {
+        g_state = &g_state_caches[nullptr];
+    }
+    g_state_caches.erase(context);
+}
+
+/**
+ * @brief The cache of a context, null if it was never current. Identifies the context, e.g. to
+ * tell which one a container object (VAO, FBO) belongs to.
+ */
+inline state_cache const* state_of(void const* context) {
+    auto const lock = std::lock_guard(g_state_caches_mutex);
+    auto const found = g_state_caches.find(context);
+    return found == g_state_caches.end() ? nullptr : &found->second;
+}
+
+inline void invalidate_state() noexcept {
+    g_state->invalidate();
+}
+
+/**
+ * @brief The binding calls (issued and skipped) and the counted work of the current context
+ * since the last call.
+ */
+inline state_cache::stats take_state_stats() noexcept {
+    return std::exchange(g_state->frame, state_cache::stats());
+}
+
+
+// OpenGL Memory Tracking
+
+/**
+ * @brief The bytes of the data stores of the live buffers, textures and renderbuffers, by
+ * object. The buffer wrappers below report the stores they (re)create, the texture classes
+ * the storage they allocate, and the delete_* wrappers forget the objects; one never deleted
+ * stays in the tally, so a leak shows as bytes that no owner accounts for. These names are
+ * shared by the contexts of a group, hence one table for all of them.
+ */
+struct gpu_memory {
+    struct kind {
+        enum type : u32 {
+            BUFFER,
+            TEXTURE,
+            RENDERBUFFER,
+            COUNT
+        };
+    };
+
+    struct allocation {
+        kind::type    type;
+        u32           object;
+        std::uint64_t bytes;
+    };
+
+    /**
+     * @brief Set the bytes of an object's store, replacing what it had (a buffer respecified).
+     */
+    static void track(kind::type type, u32 object, std::uint64_t bytes) {
+        if (object == 0 || object == state_cache::k_unknown) {
+            return;
+        }
+        auto const lock = std::lock_guard(g_mutex);
+        auto& entry = g_objects[key_of(type, object)];
+        g_totals[type] += bytes - entry;
+        entry = bytes;
+    }
+
+    static void release(kind::type type, u32 object) {
+        auto const lock = std::lock_guard(g_mutex);
+        if (auto const found = g_objects.find(key_of(type, object)); found != g_objects.end()) {
+            g_totals[type] -= found->second;
+            g_objects.erase(found);
+        }
+    }
+
+    static std::uint64_t bytes_of(kind::type type, u32 object) {
+        auto const lock = std::lock_guard(g_mutex);
+        auto const found = g_objects.find(key_of(type, object));
+        return found == g_objects.end() ? 0 : found->second;
+    }
+
+    static std::uint64_t total(kind::type type) {
+        auto const lock = std::lock_guard(g_mutex);
+        return g_totals[type];
+    }
+
+    static std::uint64_t total() {
+        auto const lock = std::lock_guard(g_mutex);
+        return g_totals[kind::BUFFER] + g_totals[kind::TEXTURE] + g_totals[kind::RENDERBUFFER];
+    }
+
+    /**
+     * @brief Every live allocation, by kind and then object.
+     */
+    static std::vector<allocation> allocations() {
+        auto result = std::vector<allocation>();
+        {
+            auto const lock = std::lock_guard(g_mutex);
+            result.reserve(g_objects.size());
+            for (auto const& [key, bytes] : g_objects) {
+                result.push_back({ static_cast<kind::type>(key >> 32), static_cast<u32>(key), bytes });
+            }
+        }
+        std::sort(result.begin(), result.end(), [](allocation const& lhs, allocation const& rhs) {
+            return lhs.type != rhs.type ? lhs.type < rhs.type : lhs.object < rhs.object;
+        });
+        return result;
+    }
+
+    static constexpr u64 key_of(kind::type type, u32 object) noexcept {
+        return (u64(type) << 32) | object;
+    }
+
+private:
+    static inline std::mutex g_mutex;
+    static inline std::unordered_map<u64, std::uint64_t> g_objects;
+    static inline std::array<std::uint64_t, kind::COUNT> g_totals = {};
+};
+
+
+// OpenGL Call Capture
+
+/**
+ * @brief The calls call_capture records, in the order of their ids: the enum call::type and
+ * the names of call_capture::name_of() are both expanded from it, so they cannot drift apart.
+ */
+#define CAPTURE_CALL_LIST(X) \
+    X(ACTIVE_SHADER_PROGRAM) X(ACTIVE_TEXTURE) X(ATTACH_SHADER)                                                                                                                       \
+    X(BIND_BUFFER) X(BIND_BUFFER_BASE) X(BIND_BUFFER_RANGE) X(BIND_BUFFERS_BASE) X(BIND_BUFFERS_RANGE) X(BIND_FRAMEBUFFER) X(BIND_IMAGE_TEXTURE) X(BIND_PROGRAM_PIPELINE)             \
+    X(BIND_RENDERBUFFER) X(BIND_SAMPLER) X(BIND_SAMPLERS) X(BIND_TEXTURE) X(BIND_TEXTURE_UNIT) X(BIND_TEXTURES) X(BIND_VERTEX_ARRAY)                                                  \
+    X(BIND_VERTEX_BUFFERS)                                                                                                                                                            \
+    X(BLEND_EQUATION_SEPARATE) X(BLEND_FUNC) X(BLEND_FUNC_I) X(BLEND_FUNC_SEPARATE) X(BLIT_FRAMEBUFFER) X(BLIT_NAMED_FRAMEBUFFER) X(BUFFER_DATA) X(BUFFER_STORAGE) X(BUFFER_SUB_DATA) \
+    X(CLEAR) X(CLEAR_BUFFER_FI) X(CLEAR_BUFFER_FV) X(CLEAR_BUFFER_SUB_DATA) X(CLEAR_BUFFER_UIV) X(CLEAR_COLOR) X(CLEAR_DEPTH)                                                         \
+    X(CLEAR_NAMED_BUFFER_SUB_DATA) X(CLEAR_NAMED_FRAMEBUFFER_FI) X(CLEAR_NAMED_FRAMEBUFFER_FV) X(CLEAR_NAMED_FRAMEBUFFER_UIV)                                                         \
+    X(CLIP_CONTROL) X(COLOR_MASK) X(COMPILE_SHADER) X(COMPRESSED_TEX_SUB_IMAGE_2D) X(COMPRESSED_TEXTURE_SUB_IMAGE_2D)                                                                 \
+    X(COPY_BUFFER_SUB_DATA) X(COPY_IMAGE_SUB_DATA) X(COPY_NAMED_BUFFER_SUB_DATA)                                                                                                      \
+    X(CREATE_BUFFERS) X(CREATE_FRAMEBUFFERS) X(CREATE_PROGRAM) X(CREATE_RENDERBUFFERS) X(CREATE_SAMPLERS) X(CREATE_SHADER)                                                            \
+    X(CREATE_TEXTURES) X(CREATE_VERTEX_ARRAYS) X(CULL_FACE)                                                                                                                           \
+    X(DELETE_BUFFERS) X(DELETE_FRAMEBUFFERS) X(DELETE_PROGRAM) X(DELETE_PROGRAM_PIPELINES) X(DELETE_RENDERBUFFERS) X(DELETE_SAMPLERS)                                                 \
+    X(DELETE_SHADER) X(DELETE_TEXTURES) X(DELETE_VERTEX_ARRAYS)                                                                                                                       \
+    X(DEPTH_FUNC) X(DEPTH_MASK) X(DETACH_SHADER) X(DISABLE) X(DISPATCH_COMPUTE) X(DISPATCH_COMPUTE_INDIRECT)                                                                          \
+    X(DRAW_ARRAYS) X(DRAW_ARRAYS_INDIRECT) X(DRAW_ARRAYS_INSTANCED) X(DRAW_BUFFER) X(DRAW_BUFFERS)                                                                                    \
+    X(DRAW_ELEMENTS) X(DRAW_ELEMENTS_BASE_VERTEX) X(DRAW_ELEMENTS_INSTANCED) X(DRAW_ELEMENTS_INSTANCED_BASE_VERTEX)                                                                   \
+    X(DRAW_ELEMENTS_INSTANCED_BASE_VERTEX_BASE_INSTANCE)                                                                                                                              \
+    X(ENABLE) X(ENABLE_VERTEX_ARRAY_ATTRIB) X(ENABLE_VERTEX_ATTRIB_ARRAY)                                                                                                             \
+    X(FRAMEBUFFER_RENDERBUFFER) X(FRAMEBUFFER_TEXTURE) X(FRAMEBUFFER_TEXTURE_2D) X(FRAMEBUFFER_TEXTURE_LAYER) X(FRAMEBUFFER_TEXTURE_MULTIVIEW) X(FRONT_FACE)                          \
+    X(GEN_BUFFERS) X(GEN_FRAMEBUFFERS) X(GEN_PROGRAM_PIPELINES) X(GEN_RENDERBUFFERS) X(GEN_SAMPLERS) X(GEN_TEXTURES) X(GEN_VERTEX_ARRAYS)                                             \
+    X(GENERATE_MIPMAP) X(GENERATE_TEXTURE_MIPMAP) X(INVALIDATE_FRAMEBUFFER) X(INVALIDATE_NAMED_FRAMEBUFFER_DATA)                                                                      \
+    X(LINK_PROGRAM) X(MEMORY_BARRIER) X(MULTI_DRAW_ARRAYS_INDIRECT) X(MULTI_DRAW_ELEMENTS_INDIRECT) X(MULTI_DRAW_ELEMENTS_INDIRECT_COUNT)                                             \
+    X(NAMED_BUFFER_DATA) X(NAMED_BUFFER_STORAGE) X(NAMED_BUFFER_SUB_DATA)                                                                                                             \
+    X(NAMED_FRAMEBUFFER_DRAW_BUFFERS) X(NAMED_FRAMEBUFFER_READ_BUFFER) X(NAMED_FRAMEBUFFER_RENDERBUFFER)                                                                              \
+    X(NAMED_FRAMEBUFFER_TEXTURE) X(NAMED_FRAMEBUFFER_TEXTURE_LAYER) X(NAMED_RENDERBUFFER_STORAGE_MULTISAMPLE)                                                                         \
+    X(PATCH_PARAMETER) X(PIXEL_STORE_I) X(POLYGON_MODE) X(POLYGON_OFFSET) X(PROGRAM_BINARY) X(PROGRAM_PARAMETER)                                                                      \
+    X(PROGRAM_UNIFORM_1F) X(PROGRAM_UNIFORM_1I) X(PROGRAM_UNIFORM_1U) X(PROGRAM_UNIFORM_2F) X(PROGRAM_UNIFORM_2I) X(PROGRAM_UNIFORM_3F)                                               \
+    X(PROGRAM_UNIFORM_3I) X(PROGRAM_UNIFORM_4F) X(PROGRAM_UNIFORM_4I) X(PROGRAM_UNIFORM_MAT3F) X(PROGRAM_UNIFORM_MAT4F)                                                               \
+    X(READ_BUFFER) X(RENDERBUFFER_STORAGE_MULTISAMPLE) X(SAMPLER_PARAMETER_F) X(SAMPLER_PARAMETER_I) X(SCISSOR_ARRAY)                                                                 \
+    X(SHADER_BINARY) X(SHADER_STORAGE_BLOCK_BINDING) X(SHADER_SOURCE) X(SPECIALIZE_SHADER)                                                                                            \
+    X(STENCIL_FUNC) X(STENCIL_MASK) X(STENCIL_OP)                                                                                                                                     \
+    X(TEX_PARAMETER_I) X(TEX_STORAGE_2D) X(TEX_STORAGE_3D) X(TEX_SUB_IMAGE_2D) X(TEX_SUB_IMAGE_3D)                                                                                    \
+    X(TEXTURE_STORAGE_2D) X(TEXTURE_STORAGE_3D) X(TEXTURE_SUB_IMAGE_2D) X(TEXTURE_SUB_IMAGE_3D)                                                                                       \
+    X(UNIFORM_1F) X(UNIFORM_1I) X(UNIFORM_1U) X(UNIFORM_2F) X(UNIFORM_2I) X(UNIFORM_3F) X(UNIFORM_3I) X(UNIFORM_4F) X(UNIFORM_4I)                                                     \
+    X(UNIFORM_BLOCK_BINDING) X(UNIFORM_MAT3F) X(UNIFORM_MAT4F) X(USE_PROGRAM) X(USE_PROGRAM_STAGES)                                                                                   \
+    X(VERTEX_ARRAY_ATTRIB_BINDING) X(VERTEX_ARRAY_ATTRIB_FORMAT) X(VERTEX_ARRAY_ATTRIB_I_FORMAT) X(VERTEX_ARRAY_BINDING_DIVISOR)                                                      \
+    X(VERTEX_ARRAY_ELEMENT_BUFFER) X(VERTEX_ARRAY_VERTEX_BUFFER) X(VERTEX_ARRAY_VERTEX_BUFFERS)                                                                                       \
+    X(VERTEX_ATTRIB) X(VERTEX_ATTRIB_DIVISOR) X(VERTEX_ATTRIB_I_POINTER) X(VERTEX_ATTRIB_POINTER)                                                                                     \
+    X(VIEWPORT) X(VIEWPORT_ARRAY)                                                                                                                                                     \
+    X(MAPPED_WRITE)  /* (buffer, offset, bytes): what the CPU wrote to mapped memory in the frame. */                                                                                 \
+    X(FRAME)  /* The end of a frame. */
+
+/**
+ * @brief A recording of the calls made through the wrappers below, with the data they upload,
+ * for tools/replay_capture to issue again without the application: the same frame looped on
+ * another driver, or before and after a change. Only built in with M_GL_CAPTURE, which costs a
+ * branch per wrapper then. Recording starts with start(), on the calling thread, and keeps
+ * everything from there (the stream grows with every upload), so it has to start before the
+ * objects of the frames of interest are made; window::end_frame() marks the frames.
+ * Left out: queries, syncs, getters, debug output, bindless handles and sparse commitment.
+ * Writes through mapped memory are not seen; the ring buffers record each frame's writes as
+ * a MAPPED_WRITE of their region.
+ * @code
+ *      gl::call_capture::start();          // Before the window and its resources.
+ *      ...
+ *      win.capture_calls("frame.glcap");   // Written after the next frame.
+ * @endcode
+ */
+struct call_capture {
+    struct call {
+        enum type : std::uint16_t {
+#define CAPTURE_CALL_ENUM(id) id,
+            CAPTURE_CALL_LIST(CAPTURE_CALL_ENUM)
+#undef CAPTURE_CALL_ENUM
+            COUNT
+        };
+    };
+
+    /**
+     * @brief The name of a call, that of its wrapper: "bind_buffer" for call::BIND_BUFFER.
+     */
+    static std::string_view name_of(call::type id) {
+        static auto const names = [] {
+#define CAPTURE_CALL_NAME(id) #id,
+            auto const upper = std::array<std::string_view, call::COUNT>{ CAPTURE_CALL_LIST(CAPTURE_CALL_NAME) };
+#undef CAPTURE_CALL_NAME
+            auto result = std::array<std::string, call::COUNT>();
+            for (auto i = std::size_t(0); i < upper.size(); ++i) {
+                std::ranges::transform(upper[i], std::back_inserter(result[i]), [](char c) {
+                    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+                });
+            }
+            return result;
+        }();
+        return id < call::COUNT ? std::string_view(names[id]) : std::string_view("unknown");
+    }
+
+    /**
+     * @brief Bytes copied into the stream, as a u32 size and the bytes.
+     */
+    struct bytes {
+        void const* data;
+        std::size_t size;
+    };
+
+    /**
+     * @brief A pointer argument that is either client memory (a u8 0, then as bytes) or an
+     * offset into a bound buffer (a u8 1, then an i64).
+     */
+    struct pointer {
+        void const* data;
+        std::size_t size;
+        bool        offset;
+    };
+
+    /**
+     * @brief The file: this header, then the records, each a u16 call::type, the u32 size of its
+     * arguments, and the arguments in the order of the wrapper.
+     */
+    struct header {
+        std::array<char, 8> magic   = k_magic;
+        std::uint32_t       version = k_version;
+        std::uint32_t       frames  = 0;
+    };
+
+    static constexpr std::array<char, 8> k_magic      = { 'G', 'L', 'C', 'A', 'P', 'T', 'U', 'R' };
+    static constexpr std::uint32_t       k_version    = 13;
+    static constexpr std::size_t         k_record_size = sizeof(std::uint16_t) + sizeof(std::uint32_t);
+
+    /**
+     * @brief Start recording the calls of this thread, dropping what was recorded before.
+     */
+    static void start() {
+        g_stream.clear();
+        g_frames = 0;
+        g_recording = true;
+    }
+
+    /**
+     * @brief Stop recording and return the file.
+     */
+    static std::vector<std::byte> stop() {
+        g_recording = false;
+        auto const head = header{ .frames = g_frames };
+        auto result = std::vector<std::byte>(sizeof(head));
+        std::memcpy(result.data(), &head, sizeof(head));
+        result.insert(result.end(), g_stream.begin(), g_stream.end());
+        g_stream = std::vector<std::byte>();
+        return result;
+    }
+
+    static bool recording() noexcept {
+        return g_recording;
+    }
+
+    static std::uint32_t frames() noexcept {
+        return g_frames;
+    }
+
+    static std::size_t size() noexcept {
+        return g_stream.size();
+    }
+
+    static void end_frame() {
+        if (g_recording) {
+            record(call::FRAME);
+            ++g_frames;
+        }
+    }
+
+    template<typename... Args>
+    static void record(call::type id, Args const&... args) {
+        auto const start = g_stream.size();
+        put(static_cast<std::uint16_t>(id));
+        put(std::uint32_t(0));
+        (put(args), ...);
+        auto const size = static_cast<std::uint32_t>(g_stream.size() - start - k_record_size);
+        std::memcpy(g_stream.data() + start + sizeof(std::uint16_t), &size, sizeof(size));
+    }
+
+    static pointer client(void const* data, std::size_t size) noexcept {
+        return { data, data != nullptr ? size : 0, false };
+    }
+
+    static pointer offset(void const* data) noexcept {
+        return { data, 0, true };
+    }
+
+    /**
+     * @brief The elements of an array argument of a multi-bind, none for a null array.
+     */
+    template<typename T>
+    static bytes array(T const* data, std::size_t count) noexcept {
+        return { data, data != nullptr ? count * sizeof(T) : 0 };
+    }
+
+    /**
+     * @brief The pixels of a texture upload: an offset while a pixel unpack buffer is bound,
+     * else the rows in client memory, at the unpack alignment (row lengths and skips are not
+     * taken into account).
+     */
+    static pointer pixels(std::uint64_t size, void const* data);
+
+    static pointer pixels(e32 format, e32 type, s32 width, s32 height, s32 depth, void const* data);
+
+    /**
+     * @brief The strings of a shader source as one, recorded as bytes.
+     */
+    static std::string source(s32 count, char const* const* strings, s32 const* lengths) {
+        auto result = std::string();
+        for (auto i = 0; i < count; ++i) {
+            result.append(strings[i], lengths != nullptr && lengths[i] >= 0 ? static_cast<std::size_t>(lengths[i]) : std::strlen(strings[i]));
+        }
+        return result;
+    }
+
+private:
+    template<typename T>
+        requires std::is_arithmetic_v<T> || std::is_enum_v<T>
+    static void put(T value) {
+        auto const at = g_stream.size();
+        g_stream.resize(at + sizeof(T));
+        std::memcpy(g_stream.data() + at, &value, sizeof(T));
+    }
+
+    static void put(bytes const& value) {
+        put(static_cast<std::uint32_t>(value.size));
+        if (value.size > 0) {
+            auto const* const data = static_cast<std::byte const*>(value.data);
+            g_stream.insert(g_stream.end(), data, data + value.size);
+        }
+    }
+
+    static void put(std::string const& value) {
+        put(bytes{ value.data(), value.size() });
+    }
+
+    static void put(pointer const& value) {
+        put(static_cast<std::uint8_t>(value.offset));
+        if (value.offset) {
+            put(static_cast<std::int64_t>(reinterpret_cast<std::intptr_t>(value.data)));
+        }
+        else {
+            put(bytes{ value.data, value.size });
+        }
+    }
+
+    static inline std::vector<std::byte>  g_stream;
+    static inline std::uint32_t           g_frames    = 0;
+    static inline thread_local bool       g_recording = false;
+};
+
+/**
+ * @brief Record a wrapper's call when capturing; nothing without M_GL_CAPTURE.
+ */
+#if M_GL_CAPTURE
+#define CAPTURE_CALL(id, ...) \
+    (gl::call_capture::recording() ? gl::call_capture::record(gl::call_capture::call::id __VA_OPT__(,) __VA_ARGS__) : void())
+#else
+#define CAPTURE_CALL(id, ...) ((void)0)
+#endif
+
+inline call_capture::pointer call_capture::pixels(std::uint64_t size, void const* data) {
+    auto unpack = static_cast<i32>(g_state->buffers[9]);
+    if (g_state->buffers[9] == state_cache::k_unknown) {
+        glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &unpack);
+    }
+    return unpack != 0 ? offset(data) : client(data, size);
+}
+
+inline call_capture::pointer call_capture::pixels(e32 format, e32 type, s32 width, s32 height, s32 depth, void const* data) {
+    auto alignment = i32(4);
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    auto const pixel = state_cache::pixel_size(format, type) * static_cast<std::uint64_t>(width);
+    auto const row = (pixel + static_cast<std::uint64_t>(alignment) - 1) / static_cast<std::uint64_t>(alignment) * static_cast<std::uint64_t>(alignment);
+    auto const rows = static_cast<std::uint64_t>(height) * static_cast<std::uint64_t>(depth);
+    return pixels(rows > 0 ? row * (rows - 1) + pixel : 0, data);
+}
+
+
 // OpenGL Functions
 
-inline void attach_shader               (u32 program, u32 shader)           { glAttachShader(program, shader); }
-inline void bind_buffer                 (e32 target, u32 buffer)            { glBindBuffer(target, buffer); }
-inline void bind_vao                    (u32 vao)                           { glBindVertexArray(vao); }
-inline void bind_vertex_array           (u32 vao)                           { glBindVertexArray(vao); }
-inline void buffer_data                 (e32 target, s32 size, void const* data, e32 usage) { glBufferData(target, size, data, usage); }
-inline void clear                       (b32 mask)                          { glClear(mask); }
-inline void clear_color                 (cf32 r, cf32 g, cf32 b, cf32 a)    { glClearColor(r, g, b, a); }
-inline void compile_shader              (u32 shader)                        { glCompileShader(shader); }
-inline u32  create_program              ()                                  { return glCreateProgram(); }
-inline u32  create_shader               (e32 type)                          { return glCreateShader(type); }
-inline void delete_buffer               (u32& buffer)                       { glDeleteBuffers(1, &buffer); }
-inline void delete_buffers              (s32 n, u32* buffers)               { glDeleteBuffers(n, buffers); }
-inline void delete_program              (u32 program)                       { glDeleteProgram(program); }
-inline void delete_shader               (u32 shader)                        { glDeleteShader(shader); }
-inline void delete_vertex_array         (u32 vao)                           { glDeleteVertexArrays(1, &vao); }
-inline void delete_vertex_arrays        (s32 n, u32* vaos)                  { glDeleteVertexArrays(n, vaos); }
-inline void draw_arrays                 (e32 mode, i32 first, s32 count)    { glDrawArrays(mode, first, count); }
-inline void draw_elements               (e32 mode, s32 count, e32 type, void const* indices) { glDrawElements(mode, count, type, indices); }
-inline void enable                      (e32 cap)                           { glEnable(cap); }
-inline void enable_vertex_attrib_array  (u32 index)                         { glEnableVertexAttribArray(index); }
-inline u32  generate_buffer             ()                                  { u32 buffer; glGenBuffers(1, &buffer); return buffer; }
-inline void generate_buffer             (u32& buffer)                       { glGenBuffers(1, &buffer); }
-inline void generate_buffers            (u32 count, u32* buffers)           { glGenBuffers(count, buffers); }
-inline void gen_buffers                 (u32 count, u32* buffers)           { glGenBuffers(count, buffers); }
-inline u32  generate_vertex_array       ()                                  { u32 vao; glGenVertexArrays(1, &vao); return vao; }
-inline void generate_vertex_array       (u32& vao)                          { glGenVertexArrays(1, &vao); }
-inline void generate_vertex_arrays      (s32 n, u32* vaos)                  { glGenVertexArrays(n, vaos); }
-inline void gen_vertex_arrays           (s32 n, u32* vaos)                  { glGenVertexArrays(n, vaos); }
+inline void active_shader_program       (u32 pipeline, u32 program)         { CAPTURE_CALL(ACTIVE_SHADER_PROGRAM, pipeline, program); glActiveShaderProgram(pipeline, program); }
+inline void active_texture              (e32 unit)                          { g_state->active_unit = unit - GL_TEXTURE0; CAPTURE_CALL(ACTIVE_TEXTURE, unit); glActiveTexture(unit); }
+inline void attach_shader               (u32 program, u32 shader)           { CAPTURE_CALL(ATTACH_SHADER, program, shader); glAttachShader(program, shader); }
+inline void begin_conditional_render    (u32 query, e32 mode)               { glBeginConditionalRender(query, mode); }
+inline void begin_query                 (e32 target, u32 query)             { glBeginQuery(target, query); }
+inline void bind_buffer                 (e32 target, u32 buffer)            { if (g_state->change(g_state->buffer_slot(target), buffer)) { CAPTURE_CALL(BIND_BUFFER, target, buffer); glBindBuffer(target, buffer); } }
+template<e32 Target>
+inline void bind_buffer                 (u32 buffer)                        { static_assert(state_cache::slot_of(Target) >= 0); if (g_state->change(g_state->buffers[state_cache::slot_of(Target)], buffer)) { CAPTURE_CALL(BIND_BUFFER, Target, buffer); glBindBuffer(Target, buffer); } }
+inline void bind_buffer_base            (e32 target, u32 index, u32 buffer) { if (g_state->change_slot(g_state->indexed_slots(target), index, state_cache::buffer_range{ buffer, 0, 0 })) { g_state->buffer_slot(target) = buffer; CAPTURE_CALL(BIND_BUFFER_BASE, target, index, buffer); glBindBufferBase(target, index, buffer); } }
+inline void bind_buffer_range           (e32 target, u32 index, u32 buffer, std::intptr_t offset, std::intptr_t size) { if (g_state->change_slot(g_state->indexed_slots(target), index, state_cache::buffer_range{ buffer, offset, size })) { g_state->buffer_slot(target) = buffer; CAPTURE_CALL(BIND_BUFFER_RANGE, target, index, buffer, static_cast<std::int64_t>(offset), static_cast<std::int64_t>(size)); glBindBufferRange(target, index, buffer, offset, size); } }
+inline void bind_buffers_base           (e32 target, u32 first, s32 count, u32 const* buffers) { auto const [begin, end] = g_state->change_slots(g_state->indexed_slots(target), first, count, [buffers](u32 i) { return state_cache::buffer_range{ buffers != nullptr ? buffers[i] : 0, 0, 0 }; }); if (begin < end) { auto const* const part = buffers != nullptr ? buffers + begin : nullptr; CAPTURE_CALL(BIND_BUFFERS_BASE, target, first + begin, s32(end - begin), call_capture::array(part, end - begin)); glBindBuffersBase(target, first + begin, static_cast<s32>(end - begin), part); } }
+inline void bind_buffers_range          (e32 target, u32 first, s32 count, u32 const* buffers, std::intptr_t const* offsets, std::intptr_t const* sizes) { auto const [begin, end] = g_state->change_slots(g_state->indexed_slots(target), first, count, [=](u32 i) { return buffers != nullptr ? state_cache::buffer_range{ buffers[i], offsets[i], sizes[i] } : state_cache::buffer_range{ 0, 0, 0 }; }); if (begin < end) { auto const n = static_cast<s32>(end - begin); auto const* const part = buffers != nullptr ? buffers + begin : nullptr; auto const* const part_offsets = buffers != nullptr ? offsets + begin : nullptr; auto const* const part_sizes = buffers != nullptr ? sizes + begin : nullptr; CAPTURE_CALL(BIND_BUFFERS_RANGE, target, first + begin, n, call_capture::array(part, end - begin), call_capture::array(part_offsets, end - begin), call_capture::array(part_sizes, end - begin)); glBindBuffersRange(target, first + begin, n, part, part_offsets, part_sizes); } }
+inline void bind_framebuffer            (e32 target, u32 framebuffer)       { CAPTURE_CALL(BIND_FRAMEBUFFER, target, framebuffer); glBindFramebuffer(target, framebuffer); }
+inline void bind_image_texture          (u32 unit, u32 texture, i32 level, b8 layered, i32 layer, e32 access, e32 format) { CAPTURE_CALL(BIND_IMAGE_TEXTURE, unit, texture, level, layered, layer, access, format); glBindImageTexture(unit, texture, level, layered, layer, access, format); }
+inline void bind_program_pipeline       (u32 pipeline)                      { if (g_state->change(g_state->pipeline, pipeline)) { ++g_state->frame.program_binds; CAPTURE_CALL(BIND_PROGRAM_PIPELINE, pipeline); glBindProgramPipeline(pipeline); } }
+inline void bind_renderbuffer           (e32 target, u32 renderbuffer)      { CAPTURE_CALL(BIND_RENDERBUFFER, target, renderbuffer); glBindRenderbuffer(target, renderbuffer); }
+inline void bind_sampler                (u32 unit, u32 sampler)             { if (g_state->change_slot(&g_state->samplers, unit, sampler)) { CAPTURE_CALL(BIND_SAMPLER, unit, sampler); glBindSampler(unit, sampler); } }
+inline void bind_samplers               (u32 first, s32 count, u32 const* samplers) { auto const [begin, end] = g_state->change_slots(&g_state->samplers, first, count, [samplers](u32 i) { return samplers != nullptr ? samplers[i] : 0u; }); if (begin < end) { auto const* const part = samplers != nullptr ? samplers + begin : nullptr; CAPTURE_CALL(BIND_SAMPLERS, first + begin, s32(end - begin), call_capture::array(part, end - begin)); glBindSamplers(first + begin, static_cast<s32>(end - begin), part); } }
+inline void bind_texture                (e32 target, u32 texture)           { ++g_state->frame.texture_binds; g_state->forget_active_unit(); CAPTURE_CALL(BIND_TEXTURE, target, texture); glBindTexture(target, texture); }
+inline void bind_texture_unit           (u32 unit, u32 texture)             { if (g_state->change_slot(&g_state->textures, unit, texture)) { ++g_state->frame.texture_binds; CAPTURE_CALL(BIND_TEXTURE_UNIT, unit, texture); glBindTextureUnit(unit, texture); } }
+inline void bind_textures               (u32 first, s32 count, u32 const* textures) { auto const [begin, end] = g_state->change_slots(&g_state->textures, first, count, [textures](u32 i) { return textures != nullptr ? textures[i] : 0u; }); if (begin < end) { g_state->frame.texture_binds += end - begin; auto const* const part = textures != nullptr ? textures + begin : nullptr; CAPTURE_CALL(BIND_TEXTURES, first + begin, s32(end - begin), call_capture::array(part, end - begin)); glBindTextures(first + begin, static_cast<s32>(end - begin), part); } }
+inline void bind_vao                    (u32 vao)                           { if (g_state->change(g_state->vao, vao)) { ++g_state->frame.vao_binds; g_state->buffers[1] = state_cache::k_unknown; CAPTURE_CALL(BIND_VERTEX_ARRAY, vao); glBindVertexArray(vao); } }
+inline void bind_vertex_array           (u32 vao)                           { bind_vao(vao); }
+inline void bind_vertex_buffers         (u32 first, s32 count, u32 const* buffers, std::intptr_t const* offsets, s32 const* strides) { CAPTURE_CALL(BIND_VERTEX_BUFFERS, first, count, call_capture::array(buffers, static_cast<std::size_t>(count)), call_capture::array(buffers != nullptr ? offsets : nullptr, static_cast<std::size_t>(count)), call_capture::array(buffers != nullptr ? strides : nullptr, static_cast<std::size_t>(count))); glBindVertexBuffers(first, count, buffers, offsets, strides); }
+inline void blend_equation_separate     (e32 rgb, e32 alpha)                { if (g_state->change_fixed(state_cache::fixed_state::BLEND_EQUATION, { rgb, alpha })) { CAPTURE_CALL(BLEND_EQUATION_SEPARATE, rgb, alpha); glBlendEquationSeparate(rgb, alpha); } }
+inline void blend_func                  (e32 source, e32 destination)       { if (g_state->change_fixed(state_cache::fixed_state::BLEND_FUNC, { source, destination, source, destination })) { CAPTURE_CALL(BLEND_FUNC, source, destination); glBlendFunc(source, destination); } }
+inline void blend_func_i                (u32 buffer, e32 source, e32 destination) { g_state->forget_blend_func(); CAPTURE_CALL(BLEND_FUNC_I, buffer, source, destination); glBlendFunci(buffer, source, destination); }
+inline void blend_func_separate         (e32 source_rgb, e32 destination_rgb, e32 source_alpha, e32 destination_alpha) { if (g_state->change_fixed(state_cache::fixed_state::BLEND_FUNC, { source_rgb, destination_rgb, source_alpha, destination_alpha })) { CAPTURE_CALL(BLEND_FUNC_SEPARATE, source_rgb, destination_rgb, source_alpha, destination_alpha); glBlendFuncSeparate(source_rgb, destination_rgb, source_alpha, destination_alpha); } }
+inline void blit_framebuffer            (i32 src_x0, i32 src_y0, i32 src_x1, i32 src_y1, i32 dst_x0, i32 dst_y0, i32 dst_x1, i32 dst_y1, b32 mask, e32 filter) { CAPTURE_CALL(BLIT_FRAMEBUFFER, src_x0, src_y0, src_x1, src_y1, dst_x0, dst_y0, dst_x1, dst_y1, mask, filter); glBlitFramebuffer(src_x0, src_y0, src_x1, src_y1, dst_x0, dst_y0, dst_x1, dst_y1, mask, filter); }
+inline void blit_named_framebuffer      (u32 read_framebuffer, u32 draw_framebuffer, i32 src_x0, i32 src_y0, i32 src_x1, i32 src_y1, i32 dst_x0, i32 dst_y0, i32 dst_x1, i32 dst_y1, b32 mask, e32 filter) { CAPTURE_CALL(BLIT_NAMED_FRAMEBUFFER, read_framebuffer, draw_framebuffer, src_x0, src_y0, src_x1, src_y1, dst_x0, dst_y0, dst_x1, dst_y1, mask, filter); glBlitNamedFramebuffer(read_framebuffer, draw_framebuffer, src_x0, src_y0, src_x1, src_y1, dst_x0, dst_y0, dst_x1, dst_y1, mask, filter); }
+inline void buffer_data                 (e32 target, s32 size, void const* data, e32 usage) { ++g_state->frame.buffer_allocations; g_state->count_upload(size, data); gpu_memory::track(gpu_memory::kind::BUFFER, g_state->buffer_slot(target), static_cast<std::uint64_t>(size)); CAPTURE_CALL(BUFFER_DATA, target, static_cast<std::int64_t>(size), call_capture::client(data, static_cast<std::size_t>(size)), usage); glBufferData(target, size, data, usage); }
+inline void buffer_storage              (e32 target, std::intptr_t size, void const* data, b32 flags) { ++g_state->frame.buffer_allocations; g_state->count_upload(size, data); gpu_memory::track(gpu_memory::kind::BUFFER, g_state->buffer_slot(target), static_cast<std::uint64_t>(size)); CAPTURE_CALL(BUFFER_STORAGE, target, static_cast<std::int64_t>(size), call_capture::client(data, static_cast<std::size_t>(size)), flags); glBufferStorage(target, size, data, flags); }
+inline void buffer_sub_data             (e32 target, std::intptr_t offset, s32 size, void const* data) { g_state->count_upload(size, data); CAPTURE_CALL(BUFFER_SUB_DATA, target, static_cast<std::int64_t>(offset), static_cast<std::int64_t>(size), call_capture::client(data, static_cast<std::size_t>(size))); glBufferSubData(target, offset, size, data); }
+inline e32  check_framebuffer_status    (e32 target)                        { return glCheckFramebufferStatus(target); }
+inline e32  check_named_framebuffer_status (u32 framebuffer, e32 target)       { return glCheckNamedFramebufferStatus(framebuffer, target); }
+inline void clear                       (b32 mask)                          { CAPTURE_CALL(CLEAR, mask); glClear(mask); }
+inline void clear_buffer_fi             (e32 buffer, i32 draw_buffer, f32 depth, i32 stencil) { CAPTURE_CALL(CLEAR_BUFFER_FI, buffer, draw_buffer, depth, stencil); glClearBufferfi(buffer, draw_buffer, depth, stencil); }
+inline void clear_buffer_fv             (e32 buffer, i32 draw_buffer, f32 const* value) { CAPTURE_CALL(CLEAR_BUFFER_FV, buffer, draw_buffer, call_capture::bytes{ value, (buffer == GL_COLOR ? 4 : 1) * sizeof(f32) }); glClearBufferfv(buffer, draw_buffer, value); }
+inline void clear_buffer_sub_data       (e32 target, e32 internal_format, std::intptr_t offset, std::intptr_t size, e32 format, e32 type, void const* data) { CAPTURE_CALL(CLEAR_BUFFER_SUB_DATA, target, internal_format, static_cast<std::int64_t>(offset), static_cast<std::int64_t>(size), format, type, call_capture::client(data, state_cache::pixel_size(format, type))); glClearBufferSubData(target, internal_format, offset, size, format, type, data); }
+inline void clear_buffer_uiv            (e32 buffer, i32 draw_buffer, u32 const* value) { CAPTURE_CALL(CLEAR_BUFFER_UIV, buffer, draw_buffer, call_capture::bytes{ value, 4 * sizeof(u32) }); glClearBufferuiv(buffer, draw_buffer, value); }
+inline void clear_color                 (cf32 r, cf32 g, cf32 b, cf32 a)    { CAPTURE_CALL(CLEAR_COLOR, r, g, b, a); glClearColor(r, g, b, a); }
+inline void clear_depth                 (f64 depth)                         { CAPTURE_CALL(CLEAR_DEPTH, depth); glClearDepth(depth); }
+inline void clear_named_framebuffer_fi  (u32 framebuffer, e32 buffer, i32 draw_buffer, f32 depth, i32 stencil) { CAPTURE_CALL(CLEAR_NAMED_FRAMEBUFFER_FI, framebuffer, buffer, draw_buffer, depth, stencil); glClearNamedFramebufferfi(framebuffer, buffer, draw_buffer, depth, stencil); }
+inline void clear_named_framebuffer_fv  (u32 framebuffer, e32 buffer, i32 draw_buffer, f32 const* value) { CAPTURE_CALL(CLEAR_NAMED_FRAMEBUFFER_FV, framebuffer, buffer, draw_buffer, call_capture::bytes{ value, (buffer == GL_COLOR ? 4 : 1) * sizeof(f32) }); glClearNamedFramebufferfv(framebuffer, buffer, draw_buffer, value); }
+inline void clear_named_buffer_sub_data (u32 buffer, e32 internal_format, std::intptr_t offset, std::intptr_t size, e32 format, e32 type, void const* data) { CAPTURE_CALL(CLEAR_NAMED_BUFFER_SUB_DATA, buffer, internal_format, static_cast<std::int64_t>(offset), static_cast<std::int64_t>(size), format, type, call_capture::client(data, state_cache::pixel_size(format, type))); glClearNamedBufferSubData(buffer, internal_format, offset, size, format, type, data); }
+inline void clear_named_framebuffer_uiv (u32 framebuffer, e32 buffer, i32 draw_buffer, u32 const* value) { CAPTURE_CALL(CLEAR_NAMED_FRAMEBUFFER_UIV, framebuffer, buffer, draw_buffer, call_capture::bytes{ value, 4 * sizeof(u32) }); glClearNamedFramebufferuiv(framebuffer, buffer, draw_buffer, value); }
+inline void clip_control                (e32 origin, e32 depth)             { CAPTURE_CALL(CLIP_CONTROL, origin, depth); glClipControl(origin, depth); }
+inline e32  client_wait_sync            (GLsync sync, b32 flags, std::uint64_t timeout) { return glClientWaitSync(sync, flags, timeout); }
+inline void color_mask                  (b8 red, b8 green, b8 blue, b8 alpha) { if (g_state->change_fixed(state_cache::fixed_state::COLOR_MASK, { u32(red != 0) | u32(green != 0) << 1 | u32(blue != 0) << 2 | u32(alpha != 0) << 3 })) { CAPTURE_CALL(COLOR_MASK, red, green, blue, alpha); glColorMask(red, green, blue, alpha); } }
+inline void compile_shader              (u32 shader)                        { CAPTURE_CALL(COMPILE_SHADER, shader); glCompileShader(shader); }
+inline void compressed_tex_sub_image_2d  (e32 target, i32 level, i32 x, i32 y, s32 width, s32 height, e32 format, s32 size, void const* data) { g_state->count_pixels(static_cast<std::uint64_t>(size), data); CAPTURE_CALL(COMPRESSED_TEX_SUB_IMAGE_2D, target, level, x, y, width, height, format, size, call_capture::pixels(static_cast<std::uint64_t>(size), data)); glCompressedTexSubImage2D(target, level, x, y, width, height, format, size, data); }
+inline void compressed_texture_sub_image_2d (u32 texture, i32 level, i32 x, i32 y, s32 width, s32 height, e32 format, s32 size, void const* data) { g_state->count_pixels(static_cast<std::uint64_t>(size), data); CAPTURE_CALL(COMPRESSED_TEXTURE_SUB_IMAGE_2D, texture, level, x, y, width, height, format, size, call_capture::pixels(static_cast<std::uint64_t>(size), data)); glCompressedTextureSubImage2D(texture, level, x, y, width, height, format, size, data); }
+inline void copy_buffer_sub_data        (e32 read_target, e32 write_target, std::intptr_t read_offset, std::intptr_t write_offset, s32 size) { CAPTURE_CALL(COPY_BUFFER_SUB_DATA, read_target, write_target, static_cast<std::int64_t>(read_offset), static_cast<std::int64_t>(write_offset), static_cast<std::int64_t>(size)); glCopyBufferSubData(read_target, write_target, read_offset, write_offset, size); }
+inline void copy_image_sub_data         (u32 src, e32 src_target, i32 src_level, i32 src_x, i32 src_y, i32 src_z, u32 dst, e32 dst_target, i32 dst_level, i32 dst_x, i32 dst_y, i32 dst_z, s32 width, s32 height, s32 depth) { CAPTURE_CALL(COPY_IMAGE_SUB_DATA, src, src_target, src_level, src_x, src_y, src_z, dst, dst_target, dst_level, dst_x, dst_y, dst_z, width, height, depth); glCopyImageSubData(src, src_target, src_level, src_x, src_y, src_z, dst, dst_target, dst_level, dst_x, dst_y, dst_z, width, height, depth); }
+inline void copy_named_buffer_sub_data  (u32 read_buffer, u32 write_buffer, std::intptr_t read_offset, std::intptr_t write_offset, s32 size) { CAPTURE_CALL(COPY_NAMED_BUFFER_SUB_DATA, read_buffer, write_buffer, static_cast<std::int64_t>(read_offset), static_cast<std::int64_t>(write_offset), static_cast<std::int64_t>(size)); glCopyNamedBufferSubData(read_buffer, write_buffer, read_offset, write_offset, size); }
+inline u32  create_buffer               ()                                  { ++g_state->frame.objects_created; u32 buffer; glCreateBuffers(1, &buffer); CAPTURE_CALL(CREATE_BUFFERS, s32(1), call_capture::bytes{ &buffer, static_cast<std::size_t>(1) * sizeof(u32) }); return buffer; }
+inline void create_buffers              (s32 n, u32* buffers)               { g_state->frame.objects_created += static_cast<std::uint64_t>(n); glCreateBuffers(n, buffers); CAPTURE_CALL(CREATE_BUFFERS, n, call_capture::bytes{ buffers, static_cast<std::size_t>(n) * sizeof(u32) }); }
+inline u32  create_framebuffer          ()                                  { ++g_state->frame.objects_created; u32 framebuffer; glCreateFramebuffers(1, &framebuffer); CAPTURE_CALL(CREATE_FRAMEBUFFERS, s32(1), call_capture::bytes{ &framebuffer, static_cast<std::size_t>(1) * sizeof(u32) }); return framebuffer; }
+inline u32  create_program              ()                                  { ++g_state->frame.objects_created; auto const program = glCreateProgram(); CAPTURE_CALL(CREATE_PROGRAM, program); return program; }
+inline u32  create_renderbuffer         ()                                  { ++g_state->frame.objects_created; u32 renderbuffer; glCreateRenderbuffers(1, &renderbuffer); CAPTURE_CALL(CREATE_RENDERBUFFERS, s32(1), call_capture::bytes{ &renderbuffer, static_cast<std::size_t>(1) * sizeof(u32) }); return renderbuffer; }
+inline u32  create_sampler              ()                                  { ++g_state->frame.objects_created; u32 sampler; glCreateSamplers(1, &sampler); CAPTURE_CALL(CREATE_SAMPLERS, s32(1), call_capture::bytes{ &sampler, static_cast<std::size_t>(1) * sizeof(u32) }); return sampler; }
+inline u32  create_shader               (e32 type)                          { ++g_state->frame.objects_created; auto const shader = glCreateShader(type); CAPTURE_CALL(CREATE_SHADER, type, shader); return shader; }
+inline u32  create_texture              (e32 target)                        { ++g_state->frame.objects_created; u32 texture; glCreateTextures(target, 1, &texture); CAPTURE_CALL(CREATE_TEXTURES, target, s32(1), call_capture::bytes{ &texture, static_cast<std::size_t>(1) * sizeof(u32) }); return texture; }
+inline u32  create_vertex_array         ()                                  { ++g_state->frame.objects_created; u32 vao; glCreateVertexArrays(1, &vao); CAPTURE_CALL(CREATE_VERTEX_ARRAYS, s32(1), call_capture::bytes{ &vao, static_cast<std::size_t>(1) * sizeof(u32) }); return vao; }
+inline void create_vertex_arrays        (s32 n, u32* vaos)                  { g_state->frame.objects_created += static_cast<std::uint64_t>(n); glCreateVertexArrays(n, vaos); CAPTURE_CALL(CREATE_VERTEX_ARRAYS, n, call_capture::bytes{ vaos, static_cast<std::size_t>(n) * sizeof(u32) }); }
+inline void cull_face                   (e32 mode)                          { if (g_state->change_fixed(state_cache::fixed_state::CULL_FACE, { mode })) { CAPTURE_CALL(CULL_FACE, mode); glCullFace(mode); } }
+inline void debug_message_callback      (GLDEBUGPROC callback, void const* user) { glDebugMessageCallback(callback, user); }
+inline void debug_message_control       (e32 source, e32 type, e32 severity, s32 count, u32 const* ids, b8 enabled) { glDebugMessageControl(source, type, severity, count, ids, enabled); }
+inline void delete_buffer               (u32& buffer)                       { ++g_state->frame.objects_destroyed; g_state->forget_buffer(buffer); gpu_memory::release(gpu_memory::kind::BUFFER, buffer); CAPTURE_CALL(DELETE_BUFFERS, s32(1), call_capture::bytes{ &buffer, static_cast<std::size_t>(1) * sizeof(u32) }); glDeleteBuffers(1, &buffer); }
+inline void delete_buffers              (s32 n, u32* buffers)               { g_state->frame.objects_destroyed += static_cast<std::uint64_t>(n); for (auto i = 0; i < n; ++i) { g_state->forget_buffer(buffers[i]); gpu_memory::release(gpu_memory::kind::BUFFER, buffers[i]); } CAPTURE_CALL(DELETE_BUFFERS, n, call_capture::bytes{ buffers, static_cast<std::size_t>(n) * sizeof(u32) }); glDeleteBuffers(n, buffers); }
+inline void delete_framebuffer          (u32 framebuffer)                   { ++g_state->frame.objects_destroyed; CAPTURE_CALL(DELETE_FRAMEBUFFERS, s32(1), call_capture::bytes{ &framebuffer, static_cast<std::size_t>(1) * sizeof(u32) }); glDeleteFramebuffers(1, &framebuffer); }
+inline void delete_program              (u32 program)                       { ++g_state->frame.objects_destroyed; g_state->forget(g_state->program, program); CAPTURE_CALL(DELETE_PROGRAM, program); glDeleteProgram(program); }
+inline void delete_program_pipeline     (u32 pipeline)                      { ++g_state->frame.objects_destroyed; g_state->forget(g_state->pipeline, pipeline); CAPTURE_CALL(DELETE_PROGRAM_PIPELINES, s32(1), call_capture::bytes{ &pipeline, static_cast<std::size_t>(1) * sizeof(u32) }); glDeleteProgramPipelines(1, &pipeline); }
+inline void delete_queries              (s32 n, u32 const* queries)         { g_state->frame.objects_destroyed += static_cast<std::uint64_t>(n); glDeleteQueries(n, queries); }
+inline void delete_renderbuffer         (u32 renderbuffer)                  { ++g_state->frame.objects_destroyed; gpu_memory::release(gpu_memory::kind::RENDERBUFFER, renderbuffer); CAPTURE_CALL(DELETE_RENDERBUFFERS, s32(1), call_capture::bytes{ &renderbuffer, static_cast<std::size_t>(1) * sizeof(u32) }); glDeleteRenderbuffers(1, &renderbuffer); }
+inline void delete_sampler              (u32 sampler)                       { ++g_state->frame.objects_destroyed; g_state->forget_sampler(sampler); CAPTURE_CALL(DELETE_SAMPLERS, s32(1), call_capture::bytes{ &sampler, static_cast<std::size_t>(1) * sizeof(u32) }); glDeleteSamplers(1, &sampler); }
+inline void delete_shader               (u32 shader)                        { ++g_state->frame.objects_destroyed; CAPTURE_CALL(DELETE_SHADER, shader); glDeleteShader(shader); }
+inline void delete_sync                 (GLsync sync)                       { glDeleteSync(sync); }
+inline void delete_texture              (u32 texture)                       { ++g_state->frame.objects_destroyed; g_state->forget_texture(texture); gpu_memory::release(gpu_memory::kind::TEXTURE, texture); CAPTURE_CALL(DELETE_TEXTURES, s32(1), call_capture::bytes{ &texture, static_cast<std::size_t>(1) * sizeof(u32) }); glDeleteTextures(1, &texture); }
+inline void delete_textures             (s32 n, u32* textures)              { g_state->frame.objects_destroyed += static_cast<std::uint64_t>(n); for (auto i = 0; i < n; ++i) { g_state->forget_texture(textures[i]); gpu_memory::release(gpu_memory::kind::TEXTURE, textures[i]); } CAPTURE_CALL(DELETE_TEXTURES, n, call_capture::bytes{ textures, static_cast<std::size_t>(n) * sizeof(u32) }); glDeleteTextures(n, textures); }
+inline void delete_vertex_array         (u32 vao)                           { ++g_state->frame.objects_destroyed; g_state->forget(g_state->vao, vao); CAPTURE_CALL(DELETE_VERTEX_ARRAYS, s32(1), call_capture::bytes{ &vao, static_cast<std::size_t>(1) * sizeof(u32) }); glDeleteVertexArrays(1, &vao); }
+inline void delete_vertex_arrays        (s32 n, u32* vaos)                  { g_state->frame.objects_destroyed += static_cast<std::uint64_t>(n); for (auto i = 0; i < n; ++i) g_state->forget(g_state->vao, vaos[i]); CAPTURE_CALL(DELETE_VERTEX_ARRAYS, n, call_capture::bytes{ vaos, static_cast<std::size_t>(n) * sizeof(u32) }); glDeleteVertexArrays(n, vaos); }
+inline void depth_func                  (e32 func)                          { if (g_state->change_fixed(state_cache::fixed_state::DEPTH_FUNC, { func })) { CAPTURE_CALL(DEPTH_FUNC, func); glDepthFunc(func); } }
+inline void depth_mask                  (b8 enabled)                        { if (g_state->change_fixed(state_cache::fixed_state::DEPTH_MASK, { enabled })) { CAPTURE_CALL(DEPTH_MASK, enabled); glDepthMask(enabled); } }
+inline void detach_shader               (u32 program, u32 shader)           { CAPTURE_CALL(DETACH_SHADER, program, shader); glDetachShader(program, shader); }
+inline void disable                     (e32 cap)                           { if (g_state->change_capability(cap, false)) { CAPTURE_CALL(DISABLE, cap); glDisable(cap); } }
+inline void dispatch_compute            (u32 x, u32 y, u32 z)               { CAPTURE_CALL(DISPATCH_COMPUTE, x, y, z); glDispatchCompute(x, y, z); }
+inline void dispatch_compute_indirect   (std::intptr_t offset)              { CAPTURE_CALL(DISPATCH_COMPUTE_INDIRECT, static_cast<std::int64_t>(offset)); glDispatchComputeIndirect(offset); }
+inline void draw_arrays                 (e32 mode, i32 first, s32 count)    { g_state->count_draw(mode, count, 1); CAPTURE_CALL(DRAW_ARRAYS, mode, first, count); glDrawArrays(mode, first, count); }
+inline void draw_arrays_indirect        (e32 mode, void const* indirect)    { g_state->count_draw(mode, 0, 1); CAPTURE_CALL(DRAW_ARRAYS_INDIRECT, mode, call_capture::offset(indirect)); glDrawArraysIndirect(mode, indirect); }
+inline void draw_arrays_instanced       (e32 mode, i32 first, s32 count, s32 instance_ct) { g_state->count_draw(mode, count, instance_ct); CAPTURE_CALL(DRAW_ARRAYS_INSTANCED, mode, first, count, instance_ct); glDrawArraysInstanced(mode, first, count, instance_ct); }
+inline void draw_buffer                 (e32 buffer)                        { CAPTURE_CALL(DRAW_BUFFER, buffer); glDrawBuffer(buffer); }
+inline void draw_buffers                (s32 count, e32 const* buffers)     { CAPTURE_CALL(DRAW_BUFFERS, count, call_capture::bytes{ buffers, static_cast<std::size_t>(count) * sizeof(e32) }); glDrawBuffers(count, buffers); }
+inline void draw_elements               (e32 mode, s32 count, e32 type, void const* indices) { g_state->count_draw(mode, count, 1); CAPTURE_CALL(DRAW_ELEMENTS, mode, count, type, call_capture::offset(indices)); glDrawElements(mode, count, type, indices); }
+inline void draw_elements_base_vertex   (e32 mode, s32 count, e32 type, void const* indices, i32 base_vertex) { g_state->count_draw(mode, count, 1); CAPTURE_CALL(DRAW_ELEMENTS_BASE_VERTEX, mode, count, type, call_capture::offset(indices), base_vertex); glDrawElementsBaseVertex(mode, count, type, indices, base_vertex); }
+inline void draw_elements_instanced     (e32 mode, s32 count, e32 type, void const* indices, s32 instance_ct) { g_state->count_draw(mode, count, instance_ct); CAPTURE_CALL(DRAW_ELEMENTS_INSTANCED, mode, count, type, call_capture::offset(indices), instance_ct); glDrawElementsInstanced(mode, count, type, indices, instance_ct); }
+inline void draw_elements_instanced_base_vertex (e32 mode, s32 count, e32 type, void const* indices, s32 instance_ct, i32 base_vertex) { g_state->count_draw(mode, count, instance_ct); CAPTURE_CALL(DRAW_ELEMENTS_INSTANCED_BASE_VERTEX, mode, count, type, call_capture::offset(indices), instance_ct, base_vertex); glDrawElementsInstancedBaseVertex(mode, count, type, indices, instance_ct, base_vertex); }
+inline void draw_elements_instanced_base_vertex_base_instance (e32 mode, s32 count, e32 type, void const* indices, s32 instance_ct, i32 base_vertex, u32 base_instance) { g_state->count_draw(mode, count, instance_ct); CAPTURE_CALL(DRAW_ELEMENTS_INSTANCED_BASE_VERTEX_BASE_INSTANCE, mode, count, type, call_capture::offset(indices), instance_ct, base_vertex, base_instance); glDrawElementsInstancedBaseVertexBaseInstance(mode, count, type, indices, instance_ct, base_vertex, base_instance); }
+inline void end_conditional_render      ()                                  { glEndConditionalRender(); }
+inline void end_query                   (e32 target)                        { glEndQuery(target); }
+inline void enable                      (e32 cap)                           { if (g_state->change_capability(cap, true)) { CAPTURE_CALL(ENABLE, cap); glEnable(cap); } }
+inline void enable_vertex_array_attrib   (u32 vao, u32 index)                { CAPTURE_CALL(ENABLE_VERTEX_ARRAY_ATTRIB, vao, index); glEnableVertexArrayAttrib(vao, index); }
+inline void enable_vertex_attrib_array  (u32 index)                         { CAPTURE_CALL(ENABLE_VERTEX_ATTRIB_ARRAY, index); glEnableVertexAttribArray(index); }
+inline GLsync fence_sync                (e32 condition, b32 flags)          { return glFenceSync(condition, flags); }
+inline void finish                      ()                                  { glFinish(); }
+inline void flush_mapped_buffer_range   (e32 target, std::intptr_t offset, std::intptr_t length) { glFlushMappedBufferRange(target, offset, length); }
+inline void flush_mapped_named_buffer_range(u32 buffer, std::intptr_t offset, std::intptr_t length) { glFlushMappedNamedBufferRange(buffer, offset, length); }
+inline void framebuffer_renderbuffer    (e32 target, e32 attachment, e32 renderbuffer_target, u32 renderbuffer) { CAPTURE_CALL(FRAMEBUFFER_RENDERBUFFER, target, attachment, renderbuffer_target, renderbuffer); glFramebufferRenderbuffer(target, attachment, renderbuffer_target, renderbuffer); }
+inline void framebuffer_texture         (e32 target, e32 attachment, u32 texture, i32 level) { CAPTURE_CALL(FRAMEBUFFER_TEXTURE, target, attachment, texture, level); glFramebufferTexture(target, attachment, texture, level); }
+inline void framebuffer_texture_2d      (e32 target, e32 attachment, e32 textarget, u32 texture, i32 level) { CAPTURE_CALL(FRAMEBUFFER_TEXTURE_2D, target, attachment, textarget, texture, level); glFramebufferTexture2D(target, attachment, textarget, texture, level); }
+inline void framebuffer_texture_layer   (e32 target, e32 attachment, u32 texture, i32 level, i32 layer) { CAPTURE_CALL(FRAMEBUFFER_TEXTURE_LAYER, target, attachment, texture, level, layer); glFramebufferTextureLayer(target, attachment, texture, level, layer); }
+inline void framebuffer_texture_multiview (e32 target, e32 attachment, u32 texture, i32 level, i32 base_view, s32 views) { CAPTURE_CALL(FRAMEBUFFER_TEXTURE_MULTIVIEW, target, attachment, texture, level, base_view, views); glFramebufferTextureMultiviewOVR(target, attachment, texture, level, base_view, views); }
+inline void front_face                  (e32 mode)                          { if (g_state->change_fixed(state_cache::fixed_state::FRONT_FACE, { mode })) { CAPTURE_CALL(FRONT_FACE, mode); glFrontFace(mode); } }
+inline u32  generate_buffer             ()                                  { ++g_state->frame.objects_created; u32 buffer; glGenBuffers(1, &buffer); CAPTURE_CALL(GEN_BUFFERS, s32(1), call_capture::bytes{ &buffer, static_cast<std::size_t>(1) * sizeof(u32) }); return buffer; }
+inline void generate_buffer             (u32& buffer)                       { ++g_state->frame.objects_created; glGenBuffers(1, &buffer); CAPTURE_CALL(GEN_BUFFERS, s32(1), call_capture::bytes{ &buffer, static_cast<std::size_t>(1) * sizeof(u32) }); }
+inline void generate_buffers            (u32 count, u32* buffers)           { g_state->frame.objects_created += count; glGenBuffers(count, buffers); CAPTURE_CALL(GEN_BUFFERS, static_cast<s32>(count), call_capture::bytes{ buffers, static_cast<std::size_t>(count) * sizeof(u32) }); }
+inline void gen_buffers                 (u32 count, u32* buffers)           { g_state->frame.objects_created += count; glGenBuffers(count, buffers); CAPTURE_CALL(GEN_BUFFERS, static_cast<s32>(count), call_capture::bytes{ buffers, static_cast<std::size_t>(count) * sizeof(u32) }); }
+inline u32  generate_framebuffer        ()                                  { ++g_state->frame.objects_created; u32 framebuffer; glGenFramebuffers(1, &framebuffer); CAPTURE_CALL(GEN_FRAMEBUFFERS, s32(1), call_capture::bytes{ &framebuffer, static_cast<std::size_t>(1) * sizeof(u32) }); return framebuffer; }
+inline void generate_mipmap             (e32 target)                        { CAPTURE_CALL(GENERATE_MIPMAP, target); glGenerateMipmap(target); }
+inline u32  generate_program_pipeline   ()                                  { ++g_state->frame.objects_created; u32 pipeline; glGenProgramPipelines(1, &pipeline); CAPTURE_CALL(GEN_PROGRAM_PIPELINES, s32(1), call_capture::bytes{ &pipeline, static_cast<std::size_t>(1) * sizeof(u32) }); return pipeline; }
+inline void generate_queries            (s32 n, u32* queries)               { g_state->frame.objects_created += static_cast<std::uint64_t>(n); glGenQueries(n, queries); }
+inline u32  generate_renderbuffer       ()                                  { ++g_state->frame.objects_created; u32 renderbuffer; glGenRenderbuffers(1, &renderbuffer); CAPTURE_CALL(GEN_RENDERBUFFERS, s32(1), call_capture::bytes{ &renderbuffer, static_cast<std::size_t>(1) * sizeof(u32) }); return renderbuffer; }
+inline u32  generate_sampler            ()                                  { ++g_state->frame.objects_created; u32 sampler; glGenSamplers(1, &sampler); CAPTURE_CALL(GEN_SAMPLERS, s32(1), call_capture::bytes{ &sampler, static_cast<std::size_t>(1) * sizeof(u32) }); return sampler; }
+inline u32  generate_texture            ()                                  { ++g_state->frame.objects_created; u32 texture; glGenTextures(1, &texture); CAPTURE_CALL(GEN_TEXTURES, s32(1), call_capture::bytes{ &texture, static_cast<std::size_t>(1) * sizeof(u32) }); return texture; }
+inline void generate_texture_mipmap     (u32 texture)                       { CAPTURE_CALL(GENERATE_TEXTURE_MIPMAP, texture); glGenerateTextureMipmap(texture); }
+inline u32  generate_vertex_array       ()                                  { ++g_state->frame.objects_created; u32 vao; glGenVertexArrays(1, &vao); CAPTURE_CALL(GEN_VERTEX_ARRAYS, s32(1), call_capture::bytes{ &vao, static_cast<std::size_t>(1) * sizeof(u32) }); return vao; }
+inline void generate_vertex_array       (u32& vao)                          { ++g_state->frame.objects_created; glGenVertexArrays(1, &vao); CAPTURE_CALL(GEN_VERTEX_ARRAYS, s32(1), call_capture::bytes{ &vao, static_cast<std::size_t>(1) * sizeof(u32) }); }
+inline void generate_vertex_arrays      (s32 n, u32* vaos)                  { g_state->frame.objects_created += static_cast<std::uint64_t>(n); glGenVertexArrays(n, vaos); CAPTURE_CALL(GEN_VERTEX_ARRAYS, n, call_capture::bytes{ vaos, static_cast<std::size_t>(n) * sizeof(u32) }); }
+inline void gen_vertex_arrays           (s32 n, u32* vaos)                  { g_state->frame.objects_created += static_cast<std::uint64_t>(n); glGenVertexArrays(n, vaos); CAPTURE_CALL(GEN_VERTEX_ARRAYS, n, call_capture::bytes{ vaos, static_cast<std::size_t>(n) * sizeof(u32) }); }
+inline void get_active_uniform          (u32 program, u32 index, s32 bufsize, s32* length, i32* size, e32* type, c8* name) { glGetActiveUniform(program, index, bufsize, length, size, type, name); }
+inline void get_active_uniform_block_name (u32 program, u32 index, s32 bufsize, s32* length, c8* name) { glGetActiveUniformBlockName(program, index, bufsize, length, name); }
+inline void get_buffer_sub_data         (e32 target, std::intptr_t offset, std::intptr_t size, void* data) { glGetBufferSubData(target, offset, size, data); }
+inline void get_float_v                 (e32 pname, f32* data)              { glGetFloatv(pname, data); }
+inline void get_integer_v               (e32 pname, i32* data)              { glGetIntegerv(pname, data); }
+inline void get_internalformat_iv       (e32 target, e32 format, e32 pname, s32 count, i32* params) { glGetInternalformativ(target, format, pname, count, params); }
+inline void get_named_buffer_sub_data   (u32 buffer, std::intptr_t offset, std::intptr_t size, void* data) { glGetNamedBufferSubData(buffer, offset, size, data); }
+inline void get_program_binary          (u32 program, s32 bufsize, s32* length, e32* format, void* binary) { glGetProgramBinary(program, bufsize, length, format, binary); }
 inline void get_program_info_log        (u32 program, s32 bufsize, s32* length, char* infolog) { glGetProgramInfoLog(program, bufsize, length, infolog); }
 inline void get_program_iv              (u32 program, e32 pname, i32* params) { glGetProgramiv(program, pname, params); }
+inline void get_program_interface_iv    (u32 program, e32 interface, e32 pname, i32* params) { glGetProgramInterfaceiv(program, interface, pname, params); }
+inline void get_program_pipeline_info_log (u32 pipeline, s32 bufsize, s32* length, c8* infolog) { glGetProgramPipelineInfoLog(pipeline, bufsize, length, infolog); }
+inline void get_program_pipeline_iv     (u32 pipeline, e32 pname, i32* params) { glGetProgramPipelineiv(pipeline, pname, params); }
+inline void get_program_resource_name   (u32 program, e32 interface, u32 index, s32 bufsize, s32* length, c8* name) { glGetProgramResourceName(program, interface, index, bufsize, length, name); }
+inline void get_query_object_i          (u32 query, e32 pname, i32* params) { glGetQueryObjectiv(query, pname, params); }
+inline void get_query_object_ui64       (u32 query, e32 pname, u64* params) { glGetQueryObjectui64v(query, pname, params); }
 inline void get_shader_info_log         (u32 shader, s32 max_length, s32* length, char* info_log) { glGetShaderInfoLog(shader, max_length, length, info_log); }
 inline void get_shader_iv               (u32 shader, e32 pname, i32* params) { glGetShaderiv(shader, pname, params); }
+inline auto get_string                  (e32 name) -> char const*           { return reinterpret_cast<char const*>(glGetString(name)); }
+inline void get_tex_parameter_iv        (e32 target, e32 pname, i32* params) { glGetTexParameteriv(target, pname, params); }
+inline u64  get_texture_handle          (u32 texture)                       { return glGetTextureHandleARB(texture); }
+inline u64  get_texture_sampler_handle  (u32 texture, u32 sampler)          { return glGetTextureSamplerHandleARB(texture, sampler); }
 inline i32  get_uniform_location        (u32 program, c8 const* name)       { return glGetUniformLocation(program, name); }
+inline void invalidate_framebuffer      (e32 target, s32 count, e32 const* attachments) { CAPTURE_CALL(INVALIDATE_FRAMEBUFFER, target, count, call_capture::bytes{ attachments, static_cast<std::size_t>(count) * sizeof(e32) }); glInvalidateFramebuffer(target, count, attachments); }
+inline void invalidate_named_framebuffer_data (u32 framebuffer, s32 count, e32 const* attachments) { CAPTURE_CALL(INVALIDATE_NAMED_FRAMEBUFFER_DATA, framebuffer, count, call_capture::bytes{ attachments, static_cast<std::size_t>(count) * sizeof(e32) }); glInvalidateNamedFramebufferData(framebuffer, count, attachments); }
 inline b8   is_program                  (u32 program)                       { return glIsProgram(program); }
 inline b8   is_shader                   (u32 shader)                        { return glIsShader(shader); }
-inline void link_program                (u32 program)                       { glLinkProgram(program); }
-inline void patch_parameter             (e32 pname, i32 value)              { glPatchParameteri(pname, value); }
-inline void polygon_mode                (e32 face, e32 mode)                { glPolygonMode(face, mode); }
-inline void shader_source               (u32 shader, s32 count, char const* const* string, s32 const* length) { glShaderSource(shader, count, string, length); }
-inline void uniform_mat4f               (i32 location, s32 count, b8 transpose, f32 const* value) { glUniformMatrix4fv(location, count, transpose, value); }
-inline void use_program                 (u32 program)                       { glUseProgram(program); }
+inline void link_program                (u32 program)                       { CAPTURE_CALL(LINK_PROGRAM, program); glLinkProgram(program); }
+inline void make_texture_handle_non_resident (u64 handle)                   { glMakeTextureHandleNonResidentARB(handle); }
+inline void make_texture_handle_resident (u64 handle)                       { glMakeTextureHandleResidentARB(handle); }
+inline void* map_buffer_range            (e32 target, std::intptr_t offset, std::intptr_t length, b32 access) { return glMapBufferRange(target, offset, length, access); }
+inline void* map_named_buffer_range      (u32 buffer, std::intptr_t offset, std::intptr_t length, b32 access) { return glMapNamedBufferRange(buffer, offset, length, access); }
+inline void max_shader_compiler_threads_arb (u32 count)                  { glMaxShaderCompilerThreadsARB(count); }
+inline void max_shader_compiler_threads_khr (u32 count)                  { glMaxShaderCompilerThreadsKHR(count); }
+inline void memory_barrier              (b32 barriers)                      { CAPTURE_CALL(MEMORY_BARRIER, barriers); glMemoryBarrier(barriers); }
+inline void multi_draw_arrays_indirect   (e32 mode, void const* indirect, s32 draw_ct, s32 stride) { g_state->frame.draw_calls += static_cast<std::uint64_t>(draw_ct); CAPTURE_CALL(MULTI_DRAW_ARRAYS_INDIRECT, mode, call_capture::offset(indirect), draw_ct, stride); glMultiDrawArraysIndirect(mode, indirect, draw_ct, stride); }
+inline void multi_draw_elements_indirect (e32 mode, e32 type, void const* indirect, s32 draw_ct, s32 stride) { g_state->frame.draw_calls += static_cast<std::uint64_t>(draw_ct); CAPTURE_CALL(MULTI_DRAW_ELEMENTS_INDIRECT, mode, type, call_capture::offset(indirect), draw_ct, stride); glMultiDrawElementsIndirect(mode, type, indirect, draw_ct, stride); }
+inline void multi_draw_elements_indirect_count (e32 mode, e32 type, void const* indirect, std::intptr_t draw_count, s32 max_draw_ct, s32 stride) { g_state->frame.draw_calls += static_cast<std::uint64_t>(max_draw_ct); CAPTURE_CALL(MULTI_DRAW_ELEMENTS_INDIRECT_COUNT, mode, type, call_capture::offset(indirect), static_cast<std::int64_t>(draw_count), max_draw_ct, stride); glMultiDrawElementsIndirectCount(mode, type, indirect, draw_count, max_draw_ct, stride); }
+inline void named_buffer_data           (u32 buffer, std::intptr_t size, void const* data, e32 usage) { ++g_state->frame.buffer_allocations; g_state->count_upload(size, data); gpu_memory::track(gpu_memory::kind::BUFFER, buffer, static_cast<std::uint64_t>(size)); CAPTURE_CALL(NAMED_BUFFER_DATA, buffer, static_cast<std::int64_t>(size), call_capture::client(data, static_cast<std::size_t>(size)), usage); glNamedBufferData(buffer, size, data, usage); }
+inline void named_buffer_storage        (u32 buffer, std::intptr_t size, void const* data, b32 flags) { ++g_state->frame.buffer_allocations; g_state->count_upload(size, data); gpu_memory::track(gpu_memory::kind::BUFFER, buffer, static_cast<std::uint64_t>(size)); CAPTURE_CALL(NAMED_BUFFER_STORAGE, buffer, static_cast<std::int64_t>(size), call_capture::client(data, static_cast<std::size_t>(size)), flags); glNamedBufferStorage(buffer, size, data, flags); }
+inline void named_buffer_sub_data       (u32 buffer, std::intptr_t offset, std::intptr_t size, void const* data) { g_state->count_upload(size, data); CAPTURE_CALL(NAMED_BUFFER_SUB_DATA, buffer, static_cast<std::int64_t>(offset), static_cast<std::int64_t>(size), call_capture::client(data, static_cast<std::size_t>(size))); glNamedBufferSubData(buffer, offset, size, data); }
+inline void named_framebuffer_draw_buffers (u32 framebuffer, s32 count, e32 const* buffers) { CAPTURE_CALL(NAMED_FRAMEBUFFER_DRAW_BUFFERS, framebuffer, count, call_capture::bytes{ buffers, static_cast<std::size_t>(count) * sizeof(e32) }); glNamedFramebufferDrawBuffers(framebuffer, count, buffers); }
+inline void named_framebuffer_read_buffer (u32 framebuffer, e32 buffer)       { CAPTURE_CALL(NAMED_FRAMEBUFFER_READ_BUFFER, framebuffer, buffer); glNamedFramebufferReadBuffer(framebuffer, buffer); }
+inline void named_framebuffer_renderbuffer (u32 framebuffer, e32 attachment, e32 renderbuffer_target, u32 renderbuffer) { CAPTURE_CALL(NAMED_FRAMEBUFFER_RENDERBUFFER, framebuffer, attachment, renderbuffer_target, renderbuffer); glNamedFramebufferRenderbuffer(framebuffer, attachment, renderbuffer_target, renderbuffer); }
+inline void named_framebuffer_texture   (u32 framebuffer, e32 attachment, u32 texture, i32 level) { CAPTURE_CALL(NAMED_FRAMEBUFFER_TEXTURE, framebuffer, attachment, texture, level); glNamedFramebufferTexture(framebuffer, attachment, texture, level); }
+inline void named_framebuffer_texture_layer (u32 framebuffer, e32 attachment, u32 texture, i32 level, i32 layer) { CAPTURE_CALL(NAMED_FRAMEBUFFER_TEXTURE_LAYER, framebuffer, attachment, texture, level, layer); glNamedFramebufferTextureLayer(framebuffer, attachment, texture, level, layer); }
+inline void named_renderbuffer_storage_multisample (u32 renderbuffer, s32 samples, e32 format, s32 width, s32 height) { CAPTURE_CALL(NAMED_RENDERBUFFER_STORAGE_MULTISAMPLE, renderbuffer, samples, format, width, height); glNamedRenderbufferStorageMultisample(renderbuffer, samples, format, width, height); }
+inline void object_label                (e32 identifier, u32 name, s32 length, c8 const* label) { glObjectLabel(identifier, name, length, label); }
+inline void patch_parameter             (e32 pname, i32 value)              { CAPTURE_CALL(PATCH_PARAMETER, pname, value); glPatchParameteri(pname, value); }
+inline void pixel_store_i               (e32 pname, i32 value)              { CAPTURE_CALL(PIXEL_STORE_I, pname, value); glPixelStorei(pname, value); }
+inline void polygon_mode                (e32 face, e32 mode)                { if (g_state->change_polygon_mode(face, mode)) { CAPTURE_CALL(POLYGON_MODE, face, mode); glPolygonMode(face, mode); } }
+inline void polygon_offset              (f32 factor, f32 units)             { if (g_state->change_fixed(state_cache::fixed_state::POLYGON_OFFSET, { std::bit_cast<u32>(factor), std::bit_cast<u32>(units) })) { CAPTURE_CALL(POLYGON_OFFSET, factor, units); glPolygonOffset(factor, units); } }
+inline void program_binary              (u32 program, e32 format, void const* binary, s32 length) { CAPTURE_CALL(PROGRAM_BINARY, program, format, call_capture::bytes{ binary, static_cast<std::size_t>(length) }); glProgramBinary(program, format, binary, length); }
+inline void program_parameter           (u32 program, e32 pname, i32 value) { CAPTURE_CALL(PROGRAM_PARAMETER, program, pname, value); glProgramParameteri(program, pname, value); }
+inline void program_uniform_1f          (u32 program, i32 location, f32 value) { CAPTURE_CALL(PROGRAM_UNIFORM_1F, program, location, value); glProgramUniform1f(program, location, value); }
+inline void program_uniform_1i          (u32 program, i32 location, i32 value) { CAPTURE_CALL(PROGRAM_UNIFORM_1I, program, location, value); glProgramUniform1i(program, location, value); }
+inline void program_uniform_1u          (u32 program, i32 location, u32 value) { CAPTURE_CALL(PROGRAM_UNIFORM_1U, program, location, value); glProgramUniform1ui(program, location, value); }
+inline void program_uniform_2f          (u32 program, i32 location, s32 count, f32 const* value) { CAPTURE_CALL(PROGRAM_UNIFORM_2F, program, location, count, call_capture::bytes{ value, static_cast<std::size_t>(count) * 2 * sizeof(f32) }); glProgramUniform2fv(program, location, count, value); }
+inline void program_uniform_2i          (u32 program, i32 location, s32 count, i32 const* value) { CAPTURE_CALL(PROGRAM_UNIFORM_2I, program, location, count, call_capture::bytes{ value, static_cast<std::size_t>(count) * 2 * sizeof(i32) }); glProgramUniform2iv(program, location, count, value); }
+inline void program_uniform_3f          (u32 program, i32 location, s32 count, f32 const* value) { CAPTURE_CALL(PROGRAM_UNIFORM_3F, program, location, count, call_capture::bytes{ value, static_cast<std::size_t>(count) * 3 * sizeof(f32) }); glProgramUniform3fv(program, location, count, value); }
+inline void program_uniform_3i          (u32 program, i32 location, s32 count, i32 const* value) { CAPTURE_CALL(PROGRAM_UNIFORM_3I, program, location, count, call_capture::bytes{ value, static_cast<std::size_t>(count) * 3 * sizeof(i32) }); glProgramUniform3iv(program, location, count, value); }
+inline void program_uniform_4f          (u32 program, i32 location, s32 count, f32 const* value) { CAPTURE_CALL(PROGRAM_UNIFORM_4F, program, location, count, call_capture::bytes{ value, static_cast<std::size_t>(count) * 4 * sizeof(f32) }); glProgramUniform4fv(program, location, count, value); }
+inline void program_uniform_4i          (u32 program, i32 location, s32 count, i32 const* value) { CAPTURE_CALL(PROGRAM_UNIFORM_4I, program, location, count, call_capture::bytes{ value, static_cast<std::size_t>(count) * 4 * sizeof(i32) }); glProgramUniform4iv(program, location, count, value); }
+inline void program_uniform_mat3f       (u32 program, i32 location, s32 count, b8 transpose, f32 const* value) { CAPTURE_CALL(PROGRAM_UNIFORM_MAT3F, program, location, count, transpose, call_capture::bytes{ value, static_cast<std::size_t>(count) * 9 * sizeof(f32) }); glProgramUniformMatrix3fv(program, location, count, transpose, value); }
+inline void program_uniform_mat4f       (u32 program, i32 location, s32 count, b8 transpose, f32 const* value) { CAPTURE_CALL(PROGRAM_UNIFORM_MAT4F, program, location, count, transpose, call_capture::bytes{ value, static_cast<std::size_t>(count) * 16 * sizeof(f32) }); glProgramUniformMatrix4fv(program, location, count, transpose, value); }
+inline void query_counter               (u32 query, e32 target)             { glQueryCounter(query, target); }
+inline void read_buffer                 (e32 buffer)                        { CAPTURE_CALL(READ_BUFFER, buffer); glReadBuffer(buffer); }
+inline void read_pixels                 (i32 x, i32 y, s32 width, s32 height, e32 format, e32 type, void* data) { glReadPixels(x, y, width, height, format, type, data); }
+inline void renderbuffer_storage_multisample (e32 target, s32 samples, e32 format, s32 width, s32 height) { CAPTURE_CALL(RENDERBUFFER_STORAGE_MULTISAMPLE, target, samples, format, width, height); glRenderbufferStorageMultisample(target, samples, format, width, height); }
+inline void sampler_parameter_f         (u32 sampler, e32 pname, f32 value) { CAPTURE_CALL(SAMPLER_PARAMETER_F, sampler, pname, value); glSamplerParameterf(sampler, pname, value); }
+inline void sampler_parameter_i         (u32 sampler, e32 pname, i32 value) { CAPTURE_CALL(SAMPLER_PARAMETER_I, sampler, pname, value); glSamplerParameteri(sampler, pname, value); }
+inline void scissor_array               (u32 first, s32 count, i32 const* boxes) { CAPTURE_CALL(SCISSOR_ARRAY, first, count, call_capture::bytes{ boxes, static_cast<std::size_t>(count) * 4 * sizeof(i32) }); glScissorArrayv(first, count, boxes); }
+inline void shader_binary               (s32 count, u32 const* shaders, e32 format, void const* binary, s32 length) { CAPTURE_CALL(SHADER_BINARY, count, call_capture::bytes{ shaders, static_cast<std::size_t>(count) * sizeof(u32) }, format, call_capture::bytes{ binary, static_cast<std::size_t>(length) }); glShaderBinary(count, shaders, format, binary, length); }
+inline void shader_storage_block_binding (u32 program, u32 index, u32 binding) { CAPTURE_CALL(SHADER_STORAGE_BLOCK_BINDING, program, index, binding); glShaderStorageBlockBinding(program, index, binding); }
+inline void shader_source               (u32 shader, s32 count, char const* const* string, s32 const* length) { CAPTURE_CALL(SHADER_SOURCE, shader, call_capture::source(count, string, length)); glShaderSource(shader, count, string, length); }
+inline void specialize_shader           (u32 shader, c8 const* entry_point, u32 count, u32 const* indices, u32 const* values) { CAPTURE_CALL(SPECIALIZE_SHADER, shader, call_capture::bytes{ entry_point, std::strlen(entry_point) }, count, call_capture::bytes{ indices, count * sizeof(u32) }, call_capture::bytes{ values, count * sizeof(u32) }); glSpecializeShader(shader, entry_point, count, indices, values); }
+inline void stencil_func                (e32 func, i32 reference, u32 mask) { if (g_state->change_fixed(state_cache::fixed_state::STENCIL_FUNC, { func, static_cast<u32>(reference), mask })) { CAPTURE_CALL(STENCIL_FUNC, func, reference, mask); glStencilFunc(func, reference, mask); } }
+inline void stencil_mask                (u32 mask)                          { if (g_state->change_fixed(state_cache::fixed_state::STENCIL_MASK, { mask })) { CAPTURE_CALL(STENCIL_MASK, mask); glStencilMask(mask); } }
+inline void stencil_op                  (e32 stencil_fail, e32 depth_fail, e32 depth_pass) { if (g_state->change_fixed(state_cache::fixed_state::STENCIL_OP, { stencil_fail, depth_fail, depth_pass })) { CAPTURE_CALL(STENCIL_OP, stencil_fail, depth_fail, depth_pass); glStencilOp(stencil_fail, depth_fail, depth_pass); } }
+inline void tex_page_commitment         (e32 target, i32 level, i32 x, i32 y, i32 z, s32 width, s32 height, s32 depth, b8 commit) { glTexPageCommitmentARB(target, level, x, y, z, width, height, depth, commit); }
+inline void tex_parameter_i             (e32 target, e32 pname, i32 value)  { CAPTURE_CALL(TEX_PARAMETER_I, target, pname, value); glTexParameteri(target, pname, value); }
+inline void tex_storage_2d              (e32 target, s32 levels, e32 format, s32 width, s32 height) { CAPTURE_CALL(TEX_STORAGE_2D, target, levels, format, width, height); glTexStorage2D(target, levels, format, width, height); }
+inline void tex_storage_3d              (e32 target, s32 levels, e32 format, s32 width, s32 height, s32 depth) { CAPTURE_CALL(TEX_STORAGE_3D, target, levels, format, width, height, depth); glTexStorage3D(target, levels, format, width, height, depth); }
+inline void tex_sub_image_2d            (e32 target, i32 level, i32 x, i32 y, s32 width, s32 height, e32 format, e32 type, void const* pixels) { g_state->count_pixels(format, type, width, height, 1, pixels); CAPTURE_CALL(TEX_SUB_IMAGE_2D, target, level, x, y, width, height, format, type, call_capture::pixels(format, type, width, height, 1, pixels)); glTexSubImage2D(target, level, x, y, width, height, format, type, pixels); }
+inline void tex_sub_image_3d            (e32 target, i32 level, i32 x, i32 y, i32 z, s32 width, s32 height, s32 depth, e32 format, e32 type, void const* pixels) { g_state->count_pixels(format, type, width, height, depth, pixels); CAPTURE_CALL(TEX_SUB_IMAGE_3D, target, level, x, y, z, width, height, depth, format, type, call_capture::pixels(format, type, width, height, depth, pixels)); glTexSubImage3D(target, level, x, y, z, width, height, depth, format, type, pixels); }
+inline void texture_storage_2d          (u32 texture, s32 levels, e32 format, s32 width, s32 height) { CAPTURE_CALL(TEXTURE_STORAGE_2D, texture, levels, format, width, height); glTextureStorage2D(texture, levels, format, width, height); }
+inline void texture_storage_3d          (u32 texture, s32 levels, e32 format, s32 width, s32 height, s32 depth) { CAPTURE_CALL(TEXTURE_STORAGE_3D, texture, levels, format, width, height, depth); glTextureStorage3D(texture, levels, format, width, height, depth); }
+inline void texture_sub_image_2d        (u32 texture, i32 level, i32 x, i32 y, s32 width, s32 height, e32 format, e32 type, void const* pixels) { g_state->count_pixels(format, type, width, height, 1, pixels); CAPTURE_CALL(TEXTURE_SUB_IMAGE_2D, texture, level, x, y, width, height, format, type, call_capture::pixels(format, type, width, height, 1, pixels)); glTextureSubImage2D(texture, level, x, y, width, height, format, type, pixels); }
+inline void texture_sub_image_3d        (u32 texture, i32 level, i32 x, i32 y, i32 z, s32 width, s32 height, s32 depth, e32 format, e32 type, void const* pixels) { g_state->count_pixels(format, type, width, height, depth, pixels); CAPTURE_CALL(TEXTURE_SUB_IMAGE_3D, texture, level, x, y, z, width, height, depth, format, type, call_capture::pixels(format, type, width, height, depth, pixels)); glTextureSubImage3D(texture, level, x, y, z, width, height, depth, format, type, pixels); }
+inline void uniform_1f                  (i32 location, f32 value)           { CAPTURE_CALL(UNIFORM_1F, location, value); glUniform1f(location, value); }
+inline void uniform_1i                  (i32 location, i32 value)           { CAPTURE_CALL(UNIFORM_1I, location, value); glUniform1i(location, value); }
+inline void uniform_1u                  (i32 location, u32 value)           { CAPTURE_CALL(UNIFORM_1U, location, value); glUniform1ui(location, value); }
+inline void uniform_2f                  (i32 location, s32 count, f32 const* value) { CAPTURE_CALL(UNIFORM_2F, location, count, call_capture::bytes{ value, static_cast<std::size_t>(count) * 2 * sizeof(f32) }); glUniform2fv(location, count, value); }
+inline void uniform_2i                  (i32 location, s32 count, i32 const* value) { CAPTURE_CALL(UNIFORM_2I, location, count, call_capture::bytes{ value, static_cast<std::size_t>(count) * 2 * sizeof(i32) }); glUniform2iv(location, count, value); }
+inline void uniform_3f                  (i32 location, s32 count, f32 const* value) { CAPTURE_CALL(UNIFORM_3F, location, count, call_capture::bytes{ value, static_cast<std::size_t>(count) * 3 * sizeof(f32) }); glUniform3fv(location, count, value); }
+inline void uniform_3i                  (i32 location, s32 count, i32 const* value) { CAPTURE_CALL(UNIFORM_3I, location, count, call_capture::bytes{ value, static_cast<std::size_t>(count) * 3 * sizeof(i32) }); glUniform3iv(location, count, value); }
+inline void uniform_4f                  (i32 location, s32 count, f32 const* value) { CAPTURE_CALL(UNIFORM_4F, location, count, call_capture::bytes{ value, static_cast<std::size_t>(count) * 4 * sizeof(f32) }); glUniform4fv(location, count, value); }
+inline void uniform_4i                  (i32 location, s32 count, i32 const* value) { CAPTURE_CALL(UNIFORM_4I, location, count, call_capture::bytes{ value, static_cast<std::size_t>(count) * 4 * sizeof(i32) }); glUniform4iv(location, count, value); }
+inline void uniform_block_binding       (u32 program, u32 index, u32 binding) { CAPTURE_CALL(UNIFORM_BLOCK_BINDING, program, index, binding); glUniformBlockBinding(program, index, binding); }
+inline void uniform_mat3f               (i32 location, s32 count, b8 transpose, f32 const* value) { CAPTURE_CALL(UNIFORM_MAT3F, location, count, transpose, call_capture::bytes{ value, static_cast<std::size_t>(count) * 9 * sizeof(f32) }); glUniformMatrix3fv(location, count, transpose, value); }
+inline void uniform_mat4f               (i32 location, s32 count, b8 transpose, f32 const* value) { CAPTURE_CALL(UNIFORM_MAT4F, location, count, transpose, call_capture::bytes{ value, static_cast<std::size_t>(count) * 16 * sizeof(f32) }); glUniformMatrix4fv(location, count, transpose, value); }
+inline b8   unmap_buffer                (e32 target)                        { return glUnmapBuffer(target); }
+inline b8   unmap_named_buffer          (u32 buffer)                        { return glUnmapNamedBuffer(buffer); }
+inline void use_program                 (u32 program)                       { if (g_state->change(g_state->program, program)) { ++g_state->frame.program_binds; CAPTURE_CALL(USE_PROGRAM, program); glUseProgram(program); } }
+inline void use_program_stages          (u32 pipeline, b32 stages, u32 program) { CAPTURE_CALL(USE_PROGRAM_STAGES, pipeline, stages, program); glUseProgramStages(pipeline, stages, program); }
 inline void validate_program            (u32 program)                       { glValidateProgram(program); }
-inline void vertex_attrib               (i32 index, f32 const* value)       { glVertexAttrib4fv(index, value); }
-inline void vertex_attrib_pointer       (i32 index, s32 size, e32 type, b8 normalized, s32 stride, void const* pointer) { glVertexAttribPointer(index, size, type, normalized, stride, pointer); }
+inline void validate_program_pipeline   (u32 pipeline)                      { glValidateProgramPipeline(pipeline); }
+inline void vertex_array_attrib_binding (u32 vao, u32 index, u32 binding)  { CAPTURE_CALL(VERTEX_ARRAY_ATTRIB_BINDING, vao, index, binding); glVertexArrayAttribBinding(vao, index, binding); }
+inline void vertex_array_attrib_format  (u32 vao, u32 index, i32 size, e32 type, b8 normalized, u32 offset) { CAPTURE_CALL(VERTEX_ARRAY_ATTRIB_FORMAT, vao, index, size, type, normalized, offset); glVertexArrayAttribFormat(vao, index, size, type, normalized, offset); }
+inline void vertex_array_attrib_i_format (u32 vao, u32 index, i32 size, e32 type, u32 offset) { CAPTURE_CALL(VERTEX_ARRAY_ATTRIB_I_FORMAT, vao, index, size, type, offset); glVertexArrayAttribIFormat(vao, index, size, type, offset); }
+inline void vertex_array_binding_divisor (u32 vao, u32 binding, u32 divisor) { CAPTURE_CALL(VERTEX_ARRAY_BINDING_DIVISOR, vao, binding, divisor); glVertexArrayBindingDivisor(vao, binding, divisor); }
+inline void vertex_array_element_buffer (u32 vao, u32 buffer)               { CAPTURE_CALL(VERTEX_ARRAY_ELEMENT_BUFFER, vao, buffer); glVertexArrayElementBuffer(vao, buffer); }
+inline void vertex_array_vertex_buffer  (u32 vao, u32 binding, u32 buffer, std::intptr_t offset, s32 stride) { CAPTURE_CALL(VERTEX_ARRAY_VERTEX_BUFFER, vao, binding, buffer, static_cast<std::int64_t>(offset), stride); glVertexArrayVertexBuffer(vao, binding, buffer, offset, stride); }
+inline void vertex_array_vertex_buffers (u32 vao, u32 first, s32 count, u32 const* buffers, std::intptr_t const* offsets, s32 const* strides) { CAPTURE_CALL(VERTEX_ARRAY_VERTEX_BUFFERS, vao, first, count, call_capture::array(buffers, static_cast<std::size_t>(count)), call_capture::array(buffers != nullptr ? offsets : nullptr, static_cast<std::size_t>(count)), call_capture::array(buffers != nullptr ? strides : nullptr, static_cast<std::size_t>(count))); glVertexArrayVertexBuffers(vao, first, count, buffers, offsets, strides); }
+inline void vertex_attrib               (i32 index, f32 const* value)       { CAPTURE_CALL(VERTEX_ATTRIB, index, call_capture::bytes{ value, 4 * sizeof(f32) }); glVertexAttrib4fv(index, value); }
+inline void vertex_attrib_divisor       (u32 index, u32 divisor)            { CAPTURE_CALL(VERTEX_ATTRIB_DIVISOR, index, divisor); glVertexAttribDivisor(index, divisor); }
+inline void vertex_attrib_i_pointer     (i32 index, s32 size, e32 type, s32 stride, void const* pointer) { CAPTURE_CALL(VERTEX_ATTRIB_I_POINTER, index, size, type, stride, call_capture::offset(pointer)); glVertexAttribIPointer(index, size, type, stride, pointer); }
+inline void vertex_attrib_pointer       (i32 index, s32 size, e32 type, b8 normalized, s32 stride, void const* pointer) { CAPTURE_CALL(VERTEX_ATTRIB_POINTER, index, size, type, normalized, stride, call_capture::offset(pointer)); glVertexAttribPointer(index, size, type, normalized, stride, pointer); }
+inline void viewport_array              (u32 first, s32 count, f32 const* rectangles) { CAPTURE_CALL(VIEWPORT_ARRAY, first, count, call_capture::bytes{ rectangles, static_cast<std::size_t>(count) * 4 * sizeof(f32) }); glViewportArrayv(first, count, rectangles); }
 
 
 // OpenGL Shader Keywords
@@ -111,13 +1135,16 @@ using monitor_handle = GLFWmonitor*;
 using mouse_button_callback_t = GLFWmousebuttonfun;
 using vidmode_handle = GLFWvidmode const*;
 using window_handle = GLFWwindow*;
+using window_refresh_callback_t = GLFWwindowrefreshfun;
 using window_size_callback_t = GLFWwindowsizefun;
 
 // GLFW Functions
 
 inline auto   create_window              (int width, int height, char const* title, monitor_handle monitor, window_handle share) -> window_handle { return glfwCreateWindow(width, height, title, monitor, share); }
-inline void   destroy_window             (window_handle window)                              { glfwDestroyWindow(window); }
+inline void   destroy_window             (window_handle window)                              { gl::forget_state(window); glfwDestroyWindow(window); }
+inline bool   extension_supported        (char const* extension)                             { return glfwExtensionSupported(extension) == GLFW_TRUE; }
 inline void   focus_window               (window_handle window)                              { glfwFocusWindow(window); }
+inline auto   get_current_context        ()                          -> window_handle       { return glfwGetCurrentContext(); }
 inline void   get_cursor_pos             (window_handle window, double* xpos, double* ypos)  { glfwGetCursorPos(window, xpos, ypos); }
 inline auto   get_cursor_pos             (window_handle window)                              { double xpos, ypos; glfwGetCursorPos(window, &xpos, &ypos); return std::make_pair(xpos, ypos); }
 inline void   get_framebuffer_size       (window_handle window, int* width, int* height)     { glfwGetFramebufferSize(window, width, height); }
@@ -137,9 +1164,11 @@ inline auto   get_primary_monitor        ()                          -> monitor_
 inline void   hide_window                (window_handle window)                              { glfwHideWindow(window); }
 inline void   iconify_window             (window_handle window)                              { glfwIconifyWindow(window); }
 inline int    init                       ()                                                  { return glfwInit(); }
-inline void   make_context_current       (window_handle window)                              { glfwMakeContextCurrent(window); }
+inline void   make_context_current       (window_handle window)                              { if (get_current_context() != window) { glfwMakeContextCurrent(window); gl::select_state(window); } }
 inline void   maximize_window            (window_handle window)                              { glfwMaximizeWindow(window); }
 inline void   poll_events                ()                                                  { glfwPollEvents(); }
+inline void   post_empty_event           ()                                                  { glfwPostEmptyEvent(); }
+inline bool   raw_mouse_motion_supported ()                                                  { return glfwRawMouseMotionSupported() == GLFW_TRUE; }
 inline void   restore_window             (window_handle window)                              { glfwRestoreWindow(window); }
 inline void   set_cursor_pos_callback    (window_handle window, cursor_pos_callback_t callback) { glfwSetCursorPosCallback(window, callback); }
 inline void   set_input_mode             (window_handle window, int mode, int value)         { glfwSetInputMode(window, mode, value); }
@@ -148,6 +1177,7 @@ inline void   set_mouse_button_callback  (window_handle window, mouse_button_cal
 inline void   set_window_aspect_ratio    (window_handle window, int numer, int denom)        { glfwSetWindowAspectRatio(window, numer, denom); }
 inline void   set_window_monitor         (window_handle window, monitor_handle monitor, int xpos, int ypos, int width, int height, int refresh_rate) { glfwSetWindowMonitor(window, monitor, xpos, ypos, width, height, refresh_rate); }
 inline void   set_window_opacity         (window_handle window, float opacity)               { glfwSetWindowOpacity(window, opacity); }
+inline void   set_window_refresh_callback (window_handle window, window_refresh_callback_t callback) { glfwSetWindowRefreshCallback(window, callback); }
 inline void   set_window_should_close    (window_handle window, int value)                   { glfwSetWindowShouldClose(window, value); }
 inline void   set_window_size            (window_handle window, int width, int height)      { glfwSetWindowSize(window, width, height); }
 inline void   set_window_size_callback   (window_handle window, window_size_callback_t callback) { glfwSetWindowSizeCallback(window, callback); }
@@ -156,8 +1186,11 @@ inline void   set_window_title           (window_handle window, char const* titl
 inline void   set_window_user_pointer    (window_handle window, void* pointer)               { glfwSetWindowUserPointer(window, pointer); }
 inline void   show_window                (window_handle window)                              { glfwShowWindow(window); }
 inline void   swap_buffers               (window_handle window)                              { glfwSwapBuffers(window); }
+inline void   swap_interval              (int interval)                                      { glfwSwapInterval(interval); }
 inline void   terminate                  ()                                                  { glfwTerminate(); }
-inline void   viewport                   (int x, int y, int width, int height)               { glViewport(x, y, width, height); }
+inline void   viewport                   (int x, int y, int width, int height)               { CAPTURE_CALL(VIEWPORT, x, y, width, height); glViewport(x, y, width, height); }
+inline void   wait_events                ()                                                  { glfwWaitEvents(); }
+inline void   wait_events_timeout        (double timeout)                                    { glfwWaitEventsTimeout(timeout); }
 inline void   window_hint                (int hint, int value)                               { glfwWindowHint(hint, value); }
 inline int    window_should_close        (window_handle window)                              { return glfwWindowShouldClose(window); }
 
@@ -165,4 +1198,6 @@ inline int    window_should_close        (window_handle window)
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
+#include <glm/gtc/quaternion.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -1,18 +1,41 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cctype>
+#include <charconv>
 #include <chrono>
 #include <concepts>
+#include <condition_variable>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <exception>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
 #include <ranges>
 #include <source_location>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <tuple>
 #include <unordered_map>
+#include <vector>
+#include <version>
+
+#if defined(__cpp_lib_format)
+#include <format>
+#endif
 
 #ifdef __GNUG__
 #include <cxxabi.h>
@@ -28,6 +51,8 @@ namespace gltool {
 
 struct colored_message;
 
+struct colored_view;
+
 struct formatted_message;
 
 struct message;
@@ -119,7 +144,7 @@ struct text_color {
      * [red-channel]  [green-channe/background-regular-colorsl]   [blue-channel/text-regular-colors]  [default-flag]  [text-mode]  [color-mode]  [target]   [regular-flag]
      *     24-31                        16-23                                   8-15                         7            4-6          2-3           1            0
      */
-    mutable enum : unsigned {
+    enum : unsigned {
         MASK = ~0u, DEFAULT_COLOR = 0,
         // regular-color flag
         MASK_REGULAR_FLAG = 0b1, MASK_RGB = ~0b1u, REGULAR = 0b1,
@@ -143,18 +168,31 @@ struct text_color {
 
     using enum_type = decltype(type);
 
-    text_color(unsigned t = REGULAR | WHITE) noexcept
-        : type(static_cast<enum_type>(t)) {}
+    constexpr text_color(unsigned t = REGULAR | WHITE) noexcept
+        : type(static_cast<enum_type>(t)) {
+
+        this->build_escape();
+    }
+
+    constexpr text_color(text_color const& other) noexcept
+        : type(other.type) {
 
-    text_color(text_color const& other) noexcept
-        : type(other.type) {}
+        this->copy_escape(other);
+    }
 
-    text_color& operator =(text_color const& other) noexcept {
+    constexpr text_color& operator =(text_color const& other) noexcept {
         type = other.type;
+        this->copy_escape(other);
         return *this;
     }
 
-    colored_message operator ()(std::string str) const;
+    colored_view operator ()(char const* str) const noexcept;
+
+    colored_view operator ()(std::string_view str) const noexcept;
+
+    colored_view operator ()(std::string const& str) const noexcept;
+
+    colored_message operator ()(std::string&& str) const;
 
     colored_message operator ()(message const& msg) const;
 
@@ -164,16 +202,24 @@ struct text_color {
 
     colored_message operator ()(colored_message&& msg) const noexcept;
 
-    int color_mode() const noexcept {
+    constexpr int color_mode() const noexcept {
         return (type & MASK_COLOR_MODE) >> 2;
     }
 
+    /**
+     * @brief The ANSI escape sequence of the current color. It is built whenever the color is
+     * set, so reading it is safe from any thread; change `type` through set() or reset() only.
+     */
+    constexpr std::string_view escape() const noexcept {
+        return std::string_view(m_escape, m_escape_length);
+    }
+
     static text_color from_rgb(unsigned r, unsigned g, unsigned b) noexcept {
         unsigned color = (r << 24) + (g << 16) + (b << 8);
         return text_color(color);
     }
 
-    bool is(unsigned t) const noexcept {
+    constexpr bool is(unsigned t) const noexcept {
         return (type & t) == t;
     }
 
@@ -184,25 +230,33 @@ struct text_color {
      * TODO: Support case insensitivity. 
      * *(I need better support of the ranges library support for an elegant implementation)
      */
-    static text_color of(std::string const& color) {
-        static auto color_map = std::unordered_map<std::string, text_color>({
-            { "black", BLACK }, { "red", RED }, { "green", GREEN }, { "yellow", YELLOW }, { "blue", BLUE }, { "purple", PURPLE }, { "cyan", CYAN }, { "white", WHITE }
-        });
-        return color_map[color];
+    static text_color of(std::string_view color) noexcept {
+        constexpr std::pair<std::string_view, unsigned> k_names[] = {
+            { "black", BLACK }, { "red", RED }, { "green", GREEN }, { "yellow", YELLOW }, 
+            { "blue", BLUE }, { "purple", PURPLE }, { "cyan", CYAN }, { "white", WHITE }
+        };
+        for (auto const& [name, value] : k_names) {
+            if (name == color) {
+                return text_color(value);
+            }
+        }
+        return text_color(DEFAULT_COLOR);
     }
 
     text_color& reset(auto... flags) {
         type = enum_type(type & DEFAULT_COLOR);
         type = enum_type(type | (flags | ...));
+        this->build_escape();
         return *this;
     }
 
     text_color& set(auto... flags) {
         type = enum_type(type | (flags | ...));
+        this->build_escape();
         return *this;
     }
 
-    int text_mode() const noexcept {
+    constexpr int text_mode() const noexcept {
         int result = (type & MASK_TEXT_MODE) >> 4;
         return result == 0 ? 0 : result + 2;
     }
@@ -213,15 +267,10 @@ struct text_color {
      * 
      * @return int The ANSI code, betwen 30 and 37 (foreground colors). Default is 37 (white).
      */
-    int to_regular_color() const noexcept {
-        static auto fgcolor_code_map = std::unordered_map<text_color, int, hash>({
-            { BLACK, 30 }, { RED, 31 }, { GREEN, 32 }, { YELLOW, 33 }, 
-            { BLUE, 34 }, { PURPLE, 35 }, { CYAN, 36 }, { WHITE, 37 }
-        }, 8, hash());
-        if (fgcolor_code_map.contains(type & MASK_REGULAR_FOREGROUND)) {
-            return fgcolor_code_map[type & MASK_REGULAR_FOREGROUND];
-        }
-        return fgcolor_code_map[WHITE];
+    constexpr int to_regular_color() const noexcept {
+        // Exactly one of the eight color bits must be set, the bit index is the ANSI offset.
+        auto const bits = (type & MASK_REGULAR_FOREGROUND) >> 8;
+        return std::has_single_bit(bits) ? 30 + std::countr_zero(bits) : 37;
     }
 
     /**
@@ -230,16 +279,9 @@ struct text_color {
      * 
      * @return int The ANSI code, betwen 40 and 47 (background colors). Default is 40 (black).
      */
-    int to_regular_color_background() const noexcept {
-        static auto bgcolor_code_map = std::unordered_map<text_color, int, hash>({
-            { BLACK_BACKGROUND, 40 }, { RED_BACKGROUND, 41 }, { GREEN_BACKGROUND, 42 }, 
-            { YELLOW_BACKGROUND, 43 }, { BLUE_BACKGROUND, 44 }, { PURPLE_BACKGROUND, 45 }, 
-            { CYAN_BACKGROUND, 46 }, { WHITE_BACKGROUND, 47 }
-        }, 8, hash());
-        if (bgcolor_code_map.contains(type & MASK_REGULAR_BACKGROUND)) {
-            return bgcolor_code_map[type & MASK_REGULAR_BACKGROUND];
-        }
-        return bgcolor_code_map[BLACK_BACKGROUND];
+    constexpr int to_regular_color_background() const noexcept {
+        auto const bits = (type & MASK_REGULAR_BACKGROUND) >> 16;
+        return std::has_single_bit(bits) ? 40 + std::countr_zero(bits) : 40;
     }
 
     std::tuple<unsigned, unsigned, unsigned> to_rgb() const noexcept {
@@ -249,6 +291,60 @@ struct text_color {
     friend bool operator ==(text_color const& lhs, text_color const& rhs) noexcept {
         return lhs.type == rhs.type;
     }
+
+private:
+    constexpr void copy_escape(text_color const& other) noexcept {
+        m_escape_length = other.m_escape_length;
+        std::copy_n(other.m_escape, m_escape_length, m_escape);
+    }
+
+    constexpr void build_escape() noexcept {
+        auto* out = m_escape;
+        auto const put = [&out](std::string_view text) {
+            out = std::copy(text.begin(), text.end(), out);
+        };
+        auto const put_int = [&out](unsigned value) {
+            char digits[10];
+            auto count = 0;
+            do {
+                digits[count++] = static_cast<char>('0' + value % 10);
+                value /= 10;
+            } while (value != 0);
+            while (count > 0) {
+                *out++ = digits[--count];
+            }
+        };
+        // If the color is RGB based:
+        if (!this->is(REGULAR)) {
+            auto const [r, g, b] = this->to_rgb();
+            put("\033[38m");
+            put_int(r);
+            put(";");
+            put_int(g);
+            put(";");
+            put_int(b);
+            put("\033[m");
+        }
+        else {
+            put("\033[");
+            auto starting = true;
+            for (int const code : { this->text_mode(), this->color_mode(), this->to_regular_color(), this->to_regular_color_background() }) {
+                if (code == 0) {
+                    continue;
+                }
+                if (!starting) {
+                    put(";");
+                }
+                starting = false;
+                put_int(code);
+            }
+            put("m");
+        }
+        m_escape_length = static_cast<std::uint8_t>(out - m_escape);
+    }
+
+    char m_escape[32] = {};
+    std::uint8_t m_escape_length = 0;
 };
 
 
@@ -285,12 +381,51 @@ text_color const k_bright       (text_color::REGULAR | text_color::BRIGHT),
                  k_hidden       (text_color::REGULAR | text_color::HIDDEN),
                  k_striked      (text_color::REGULAR | text_color::STRIKED);
 
-std::unordered_map<std::ostream*, text_color> g_previous_color;
+// Slots in std::ios_base's storage keeping the previous color of each stream, so that no global
+// table keyed by stream has to be looked up for every colored print.
+inline int const k_previous_color_slot = std::ios_base::xalloc();
+inline int const k_previous_color_set_slot = std::ios_base::xalloc();
 
-bool g_update_previous_color = true;
+// Per thread: set while a colored message restores the previous color of the stream.
+inline thread_local bool g_update_previous_color = true;
+
+/**
+ * @brief The color last written to the stream (the default color if there is none).
+ */
+inline text_color previous_color(std::ostream& os) {
+    if (os.iword(k_previous_color_set_slot) == 0) {
+        return g_default_color;
+    }
+    return text_color(static_cast<unsigned>(os.iword(k_previous_color_slot)));
+}
+
+inline void set_previous_color(std::ostream& os, text_color const& color) {
+    os.iword(k_previous_color_slot) = static_cast<long>(color.type);
+    os.iword(k_previous_color_set_slot) = 1;
+}
 
 }
 
+/**
+ * @brief A non-owning colored string, what text_color::operator() returns for string literals,
+ * string views and lvalue strings. Printing it never allocates; the viewed string must outlive
+ * it (which is the case when it is used within one streaming expression).
+ */
+struct colored_view {
+    colored_view& with(text_color const& opts) & noexcept {
+        color.set(opts.type);
+        return *this;
+    }
+
+    colored_view with(text_color const& opts) && noexcept {
+        color.set(opts.type);
+        return *this;
+    }
+
+    std::string_view text;
+    text_color color;
+};
+
 /**
  * @brief A wrapper class for a message object equipped with a color.
  */
@@ -381,16 +516,23 @@ inline auto const k_default = text_format();
 inline auto const k_newline = text_format().with_suffix("\n"),
                   k_double_newline = text_format().with_suffix("\n\n");
 
+} // namespace formats
 
-inline auto g_show_time = true;
 
-inline auto g_show_source_location = true;
+colored_view text_color::operator ()(char const* str) const noexcept {
+    return { .text = str, .color = *this };
+}
 
-} // namespace formats
+colored_view text_color::operator ()(std::string_view str) const noexcept {
+    return { .text = str, .color = *this };
+}
 
+colored_view text_color::operator ()(std::string const& str) const noexcept {
+    return { .text = str, .color = *this };
+}
 
-colored_message text_color::operator ()(std::string str) const {
-    return { .msg = { .content = str, .type = message::NONE }, .color = *this };
+colored_message text_color::operator ()(std::string&& str) const {
+    return { .msg = { .content = std::move(str), .type = message::NONE }, .color = *this };
 }
 
 colored_message text_color::operator ()(message const& msg) const {
@@ -408,51 +550,19 @@ colored_message text_color::operator ()(colored_message const& cmsg) const {
 }
 
 colored_message text_color::operator ()(colored_message&& cmsg) const noexcept {
-    cmsg.color.type = text_color::enum_type(cmsg.color.type | this->type);
+    cmsg.color.set(this->type);
     return std::move(cmsg);
 }
 
 /**
  * @brief An IO manipulator that changes the color of the following text.
  */
-std::ostream& operator <<(std::ostream& os, text_color color) {
+std::ostream& operator <<(std::ostream& os, text_color const& color) {
     if (colors::g_update_previous_color) {
-        colors::g_previous_color[&os] = color;
-    }
-    // If the color is RGB based:
-    if (!color.is(text_color::REGULAR)) {
-        auto const [r, g, b] = color.to_rgb();
-        os << "\033[38m" << r << ';' << g << ';' << b << "\033[m";
-        return os;
-    }
-    bool starting = true;
-    auto const check_starting = [&os, &starting] {
-        if (!starting) {
-            os << ';';
-        }
-        else {
-            starting = false;
-        }
-    };
-
-    os << "\033[";
-    if (color.text_mode()) {
-        check_starting();
-        os << color.text_mode();
-    }
-    if (color.color_mode()) {
-        check_starting();
-        os << color.color_mode();
-    }
-    if (color.to_regular_color()) {
-        check_starting();
-        os << color.to_regular_color();
+        colors::set_previous_color(os, color);
     }
-    if (color.to_regular_color_background()) {
-        check_starting();
-        os << color.to_regular_color_background();
-    }
-    return os << 'm';
+    auto const escape = color.escape();
+    return os.write(escape.data(), escape.size());
 }
 
 
@@ -464,14 +574,17 @@ std::ostream& operator <<(std::ostream& os, message const& msg) {
 
     std::ostream& operator <<(std::ostream&, colored_message const&);
 
+    std::ostream& operator <<(std::ostream&, colored_view const&);
+
     if (msg.type & message::DEBUG) {
         os << k_white("(Debug)").with(text_color::BRIGHT) << '\n';
     }
 
+    auto const content = std::string_view(msg.content);
     switch (msg.type) {
-    case message::INFO:    return os << k_white("[INFORMATION]") << k_blue(msg);
-    case message::WARNING: return os << k_white("[WARNING]") << '\n' << k_yellow(msg);
-    case message::ERROR:   return os << k_white("[ERROR]") << '\n' << k_red(msg);
+    case message::INFO:    return os << k_white("[INFORMATION]") << k_blue(content);
+    case message::WARNING: return os << k_white("[WARNING]") << '\n' << k_yellow(content);
+    case message::ERROR:   return os << k_white("[ERROR]") << '\n' << k_red(content);
     default:               return os << msg.content;
     }
 }
@@ -486,200 +599,2043 @@ std::size_t colored_message::hash::operator ()(colored_message const& cmsg) cons
  */
 std::ostream& operator <<(std::ostream& os, colored_message const& cmsg) {
     using namespace gltool::colors;
-    if (!colors::g_previous_color.contains(&os)) {
-        g_previous_color[&os] = g_default_color;
-    }
+    auto const previous = previous_color(os);
     g_update_previous_color = false;
-    os << cmsg.color << cmsg.msg << g_previous_color[&os];
+    os << cmsg.color << cmsg.msg << previous;
     g_update_previous_color = true;
     return os;
 }
 
+/**
+ * @brief Print a colored string view, with the same color restoration as colored_message.
+ */
+std::ostream& operator <<(std::ostream& os, colored_view const& cview) {
+    auto const color = cview.color.escape();
+    auto const previous_color = colors::previous_color(os);
+    auto const previous = previous_color.escape();
+    os.write(color.data(), color.size());
+    os.write(cview.text.data(), cview.text.size());
+    return os.write(previous.data(), previous.size());
+}
+
 
 colored_message& colored_message::with(text_color const& opts) & noexcept {
-    color.type = static_cast<text_color::enum_type>(color.type | opts.type);
+    color.set(opts.type);
     return *this;
 }
 
 colored_message colored_message::with(text_color const& opts) && noexcept {
-    color.type = static_cast<text_color::enum_type>(color.type | opts.type);
+    color.set(opts.type);
     return std::move(*this);
 }
 
-
 /**
- * @brief The logger class
- * Binds with a output stream (std::ostream&) and provides logging utilities.
- * If the logger owns the stream, it will be freed via RAII, and the global hashtable
- * (colors::k_previous_color) will also erase the stream pointer.
+ * @brief A layout of log statements fixed at compile time: the TIME_STAMP and SOURCE_LOCATION
+ * flags of text_format choose the headers, and header() compiles into the straight-line code
+ * writing just those, so statements do not check any setting. The prefix (after the headers),
+ * the separator (between the pieces of a statement) and the suffix (at its end) of a
+ * text_format are rendered with their colors once, when the layout is made. See
+ * logger::set_layout().
+ * @code
+ *      gl::LOG.set_layout(gltool::text_layout<gltool::text_format::TIME_STAMP>());
+ *      gl::LOG.set_layout(gltool::text_layout<gltool::text_format::NONE>(gltool::formats::k_newline));
+ * @endcode
  */
-class logger {
-public:
-    class logger_aux {
-    public:
-        logger_aux(logger& logger, 
-                   std::source_location const location = std::source_location::current(),
-                   std::chrono::system_clock::time_point const time = std::chrono::system_clock::now())
-            : m_logger(logger), 
-              m_location(location),
-              m_time(time) {}
+template<unsigned Flags = text_format::TIME_STAMP | text_format::SOURCE_LOCATION>
+struct text_layout {
+    static_assert((Flags & ~unsigned(text_format::TIME_STAMP | text_format::SOURCE_LOCATION)) == 0,
+                  "A layout takes the TIME_STAMP and SOURCE_LOCATION flags only");
 
-        template<typename T>
-            requires (!std::is_scalar_v<T>)
-        friend logger_aux&& operator <<(logger_aux&& logger, T* ptr) {
-            std::move(logger) << typeid_name<T> << " Object at ";
-            logger.m_logger.log(ptr);       // Avoid recursive call.
-            return std::move(logger);
-        }
+    static constexpr bool k_time     = (Flags & text_format::TIME_STAMP) != 0;
+    static constexpr bool k_location = (Flags & text_format::SOURCE_LOCATION) != 0;
 
-        /**
-         * @brief Stream operation for printable objects.
-         */
-        friend logger_aux&& operator <<(logger_aux&& logger, streamable auto&& obj) {
-            logger.log_time();
-            logger.log_location();
-            logger.m_logged = true;
-            logger.m_logger.log(std::forward<decltype(obj)>(obj), logger.m_indent);
-            if (logger.m_indent) {
-                logger.m_indent = false;
-            }
-            return std::move(logger);
-        }
+    /**
+     * @brief The default text_format separates by a space; a layout only does when asked.
+     */
+    explicit text_layout(text_format const& format = text_format("", "", ""))
+        : prefix(render(format.prefix)),
+          suffix(render(format.suffix)),
+          separator(render(format.separator)) {}
 
-        friend logger_aux&& operator <<(logger_aux&& logger, std::ostream& (*manip)(std::ostream&)) {
-            logger.m_logger.log(manip);
-            return std::move(logger);
+    /**
+     * @brief Write the headers of a statement, through its logger::logger_aux.
+     */
+    template<typename Aux>
+    static void header(Aux& aux) {
+        if constexpr (k_time) {
+            aux.log_time();
         }
-
-        // TODO: Make this function more elegant.
-        void log_location() {
-            if (!m_logged && formats::g_show_source_location) {
-                auto const path = stdf::path(m_location.file_name());
-                m_logger.log("[ ", true);
-                m_logger.log(colors::k_blue("FILE: "));
-                m_logger.log(path.filename().string());
-                m_logger.log("; ");
-                m_logger.log(colors::k_blue("LINE: "));
-                m_logger.log(m_location.line());
-                m_logger.log(" in ");
-                m_logger.log(colors::k_blue("FUNCTION: "));
-                m_logger.log(m_location.function_name());
-                m_logger.log(" ] \n");
-            }
+        if constexpr (k_location) {
+            aux.log_location();
         }
+    }
 
-        void log_time() {
-            if (!m_logged && formats::g_show_time) {
-                auto time = std::chrono::system_clock::to_time_t(m_time);
-                auto gmt_time = std::gmtime(&time);
-                m_logger.log("[ ", true);
-                m_logger.log(colors::k_blue("TIME: "));
-                m_logger.log(std::put_time(gmt_time, "%Y-%m-%d %H:%M:%S"));
-                m_logger.log(" ] ");
-            }
+    static std::string render(colored_message const& cmsg) {
+        if (cmsg.msg.content.empty()) {
+            return {};
         }
+        auto ss = std::ostringstream();
+        ss << cmsg;
+        return std::move(ss).str();
+    }
 
-    private:
-        logger& m_logger;
-        std::source_location m_location;
-        std::chrono::system_clock::time_point m_time;
-        bool m_logged = false;
-        bool m_indent = true;
+    std::string prefix;
+    std::string suffix;
+    std::string separator;
+};
+
+/**
+ * @brief A call site of a log statement. The strings of a std::source_location are static, so
+ * the pointers identify the site.
+ */
+struct call_site {
+    struct hash {
+        std::size_t operator ()(call_site const& site) const noexcept {
+            return std::hash<void const*>()(site.file) ^ (std::hash<void const*>()(site.function) << 1) ^ (site.line << 7) ^ site.column;
+        }
     };
 
-    logger(std::nullptr_t)
-        : m_out(std::cout),
-          m_owning(false),
-          m_active(false) {}
+    char const* file;
+    char const* function;
+    std::uint_least32_t line;
+    std::uint_least32_t column;
 
-    logger(std::string const& path) try
-        : logger(*new std::ofstream(path), true) {}
-    catch (std::exception const& e) {
-        std::cerr << colors::k_red("Error on contruction of logger object.") << e.what();
+    static call_site of(std::source_location const& location) noexcept {
+        return { location.file_name(), location.function_name(), location.line(), location.column() };
     }
 
-    logger(std::ostream& out = std::cerr, bool owning = false)
-        : m_out(out),
-          m_owning(owning) {}
+    friend bool operator ==(call_site const&, call_site const&) = default;
+};
 
-    virtual ~logger() {
-        if (m_owning) {
-            delete &m_out;
-            if (colors::g_previous_color.contains(&m_out)) {
-                colors::g_previous_color.erase(&m_out);
+/**
+ * @brief Per-thread caches of the "[ TIME: ... ]" and "[ FILE: ...; LINE: ... ]" prefixes.
+ * A call site's prefix is built the first time it logs, the time prefix is only rebuilt when
+ * the wall-clock second changes. The returned views stay valid until the next call on the
+ * same thread.
+ */
+namespace prefixes {
+
+/**
+ * @brief File name without its directories (what std::filesystem::path::filename() gives),
+ * without allocating.
+ */
+constexpr std::string_view file_name_of(std::string_view path) noexcept {
+    auto const pos = path.find_last_of("/\\");
+    return pos == std::string_view::npos ? path : path.substr(pos + 1);
+}
+
+inline std::string_view field(std::string& out, char const* name, text_color const& previous) {
+    out += colors::k_blue.escape();
+    out += name;
+    out += previous.escape();
+    return out;
+}
+
+inline std::string_view time(std::chrono::system_clock::time_point time_point, text_color const& previous) {
+    thread_local auto second = std::time_t(-1);
+    thread_local auto color = 0u;
+    thread_local auto text = std::string();
+    auto const now = std::chrono::system_clock::to_time_t(time_point);
+    if (now != second || previous.type != color) {
+        auto gmt_time = std::tm();
+#ifdef _WIN32
+        gmtime_s(&gmt_time, &now);
+#else
+        gmtime_r(&now, &gmt_time);
+#endif
+        char date[32];
+        auto const length = std::strftime(date, sizeof date, "%Y-%m-%d %H:%M:%S", &gmt_time);
+        text.assign("[ ");
+        field(text, "TIME: ", previous);
+        text.append(date, length).append(" ] ");
+        second = now;
+        color = previous.type;
+    }
+    return text;
+}
+
+inline std::string_view location(call_site const& site, text_color const& previous) {
+    struct entry {
+        unsigned color;
+        std::string text;
+    };
+    thread_local auto cache = std::unordered_map<call_site, entry, call_site::hash>();
+    auto& [color, text] = cache[site];
+    if (text.empty() || color != previous.type) {
+        char line[16];
+        text.assign("[ ");
+        field(text, "FILE: ", previous);
+        text.append(file_name_of(site.file)).append("; ");
+        field(text, "LINE: ", previous);
+        text.append(line, std::to_chars(line, line + sizeof line, site.line).ptr).append(" in ");
+        field(text, "FUNCTION: ", previous);
+        text.append(site.function).append(" ] \n");
+        color = previous.type;
+    }
+    return text;
+}
+
+} // namespace prefixes
+
+
+/**
+ * @brief Compile-time checked format string of logger::logf(). With <format> available this is
+ * std::format_string, otherwise a fallback that supports "{}" placeholders (format specs are
+ * accepted but ignored) and "{{"/"}}" escapes, and checks the placeholder count at compile time.
+ */
+#if defined(__cpp_lib_format)
+template<typename... Args>
+using format_string = std::format_string<Args...>;
+#else
+template<typename... Args>
+struct basic_format_string {
+    template<typename S>
+        requires std::convertible_to<S const&, std::string_view>
+    consteval basic_format_string(S const& str)
+        : m_str(str) {
+
+        auto placeholders = std::size_t(0);
+        for (auto i = std::size_t(0); i < m_str.size(); ++i) {
+            if (m_str[i] == '{' && i + 1 < m_str.size() && m_str[i + 1] == '{') {
+                ++i;
             }
+            else if (m_str[i] == '{') {
+                i = m_str.find('}', i);
+                if (i == std::string_view::npos) {
+                    throw "unterminated placeholder in format string";
+                }
+                ++placeholders;
+            }
+        }
+        if (placeholders != sizeof...(Args)) {
+            throw "the number of placeholders does not match the number of arguments";
         }
     }
 
-    /**
-     * @brief Get the auxiliary logger object, which carries the source location and time
-     * of the caller.
-     * 
-     * @param location 
-     * @param time 
-     * @return logger_aux 
-     */
-    logger_aux operator ()(std::source_location location = std::source_location::current(),
-                           std::chrono::system_clock::time_point time = std::chrono::system_clock::now()) {
-        return logger_aux(*this, location, time);
+    constexpr std::string_view get() const noexcept {
+        return m_str;
+    }
+
+private:
+    std::string_view m_str;
+};
+
+template<typename... Args>
+using format_string = basic_format_string<std::type_identity_t<Args>...>;
+
+/**
+ * @brief Walk a fallback format string, calling on_text() for literal pieces and on_arg() with
+ * each argument in order.
+ */
+template<typename... Args>
+void format_walk(std::string_view format, auto&& on_text, auto&& on_arg, Args const&... args) {
+    auto const visit = [&](std::size_t index) {
+        auto ct = std::size_t(0);
+        ((ct++ == index ? (on_arg(args), 0) : 0), ...);
+    };
+    auto index = std::size_t(0);
+    auto start = std::size_t(0);
+    for (auto i = std::size_t(0); i < format.size(); ++i) {
+        auto const c = format[i];
+        if ((c == '{' || c == '}') && i + 1 < format.size() && format[i + 1] == c) {
+            on_text(format.substr(start, i + 1 - start));
+            start = ++i + 1;
+        }
+        else if (c == '{') {
+            on_text(format.substr(start, i - start));
+            i = format.find('}', i);
+            visit(index++);
+            start = i + 1;
+        }
     }
+    on_text(format.substr(start));
+}
+#endif
+
+
+/**
+ * @brief Compile-time log tags. A log statement carries a severity level and a category,
+ * which are compared against the compile-time threshold so that filtered statements
+ * generate no code at all (see LOG_AT() and INDENT_AT() in application.hpp).
+ */
+struct log_tag {
+    enum level : unsigned {
+        TRACE = 0, DEBUG = 1, INFO = 2, WARNING = 3, ERROR = 4, OFF = 5
+    };
+    enum category : unsigned {
+        GENERAL  = 1,       // Library initialization and miscellaneous messages.
+        RESOURCE = 2,       // Creation, moving and destruction of GPU resources.
+        RENDER   = 4,       // Anything that happens once (or more) per frame.
+        SHADER   = 8,       // Shader compilation, linking and uniforms.
+        WINDOW   = 16,      // Window creation and window events.
+        ALL      = ~0u
+    };
+};
+
+
+/**
+ * @brief Asynchronous logging backend. Producers encode each log statement into a fixed-size
+ * record and push it into their own single-producer/single-consumer ring, a background thread
+ * drains all rings and does the expensive formatting (gmtime, put_time, stream writes).
+ */
+namespace async {
+
+constexpr std::size_t k_payload_size  = 232;     // Bytes of pre-encoded text per record.
+constexpr std::size_t k_ring_capacity = 1024;    // Records per producer thread (power of 2).
+constexpr std::size_t k_history_size  = 64;      // Records kept for the crash flush.
+
+/**
+ * @brief Argument tags used by the binary encoding of a record (see binlog).
+ */
+enum arg_type : std::uint8_t {
+    ARG_BOOL = 1, ARG_CHAR, ARG_INT, ARG_UINT, ARG_FLOAT, ARG_STRING, ARG_POINTER, ARG_COLORED, ARG_NEWLINE
+};
+
+/**
+ * @brief A log statement whose arguments are already encoded, either as text or as tagged raw
+ * bytes (binary mode). Cheap to copy around, never allocates.
+ */
+struct record {
+    std::chrono::system_clock::time_point time;
+    std::source_location location;
+    log_tag::level level    = log_tag::INFO;
+    unsigned indent         = 0;
+    std::uint16_t length    = 0;
+    bool show_time          = false;
+    bool show_location      = false;
+    bool has_header         = false;    // Whether a streamable object (not only manipulators) was logged.
+    bool truncated          = false;
+    bool binary             = false;    // Whether the payload holds tagged arguments instead of text.
+    char payload[k_payload_size];
 
     /**
-     * @brief Log error message and exit the program.
-     * * This function throws an exception!
+     * @brief Make sure n more payload bytes fit. A binary payload is never cut in the middle
+     * of an argument, so that it stays decodable.
      */
-    [[noreturn]]
-    void exception(streamable auto&& msg) {
-        m_out << colors::k_red << "Exception: " << msg << colors::k_white << std::endl;
-        throw 42;
+    bool reserve(std::size_t n) noexcept {
+        if (truncated || length + n > k_payload_size) {
+            truncated = true;
+            return false;
+        }
+        return true;
     }
 
-    void indent() {
-        ++m_indent;
+    template<typename T>
+        requires std::is_trivially_copyable_v<T>
+    void append_raw(T const& value) noexcept {
+        std::memcpy(payload + length, &value, sizeof(T));
+        length += sizeof(T);
     }
 
-    void log(streamable auto&& msg, bool indent = false) {
-        if (!m_active) {
+    void append_tagged(arg_type type, std::string_view text, std::uint32_t color = 0) noexcept {
+        auto const extra = type == ARG_COLORED ? sizeof(std::uint32_t) : 0;
+        auto const room = k_payload_size - length;
+        if (truncated || room < 1 + extra + sizeof(std::uint16_t)) {
+            truncated = true;
             return;
         }
-        if (indent) {
-            int ct = m_indent;
-            while (ct--) { 
-                m_out << "  ";
-            }
+        auto const n = std::min(text.size(), room - 1 - extra - sizeof(std::uint16_t));
+        truncated = n < text.size();
+        this->append_raw(type);
+        if (type == ARG_COLORED) {
+            this->append_raw(color);
         }
-        m_out << msg;
+        this->append_raw(static_cast<std::uint16_t>(n));
+        std::memcpy(payload + length, text.data(), n);
+        length += static_cast<std::uint16_t>(n);
     }
 
-    void log(std::ostream& (*manip)(std::ostream&)) {
-        if (!m_active) {
-            return;
+    template<typename T>
+    void append_scalar(arg_type type, T value) noexcept {
+        if (this->reserve(1 + sizeof(T))) {
+            this->append_raw(type);
+            this->append_raw(value);
         }
-        manip(m_out);
     }
 
-    template<typename... Args>
-    void logf(char const* format, Args... args) {
-        if (!m_active) {
-            return;
+    void append_newline() noexcept {
+        if (!binary) {
+            this->append("\n");
+        }
+        else if (this->reserve(1)) {
+            this->append_raw(ARG_NEWLINE);
         }
-        char buf[1024];
-        sprintf(buf, format, args...);
-        m_out << buf;
     }
 
-    void unindent() {
-        --m_indent;
+    void append(std::string_view text) noexcept {
+        auto const room = k_payload_size - length;
+        if (text.size() > room) {
+            truncated = true;
+        }
+        auto const n = std::min(text.size(), room);
+        std::memcpy(payload + length, text.data(), n);
+        length += static_cast<std::uint16_t>(n);
     }
 
-private:
-    std::ostream& m_out;
-    unsigned m_indent = 0;
-    bool m_owning;
-    bool m_active = true;
-};
+    /**
+     * @brief Encode a streamable object. Strings and scalars are encoded without going through
+     * a std::ostream; everything else falls back to a thread-local string stream.
+     */
+    template<typename T>
+    void encode(T&& value) {
+        if (binary) {
+            return this->encode_binary(std::forward<T>(value));
+        }
+        using U = std::remove_cvref_t<T>;
+        char buf[48];
+        if constexpr (std::same_as<U, bool>) {
+            this->append(value ? "1" : "0");
+        }
+        else if constexpr (std::same_as<U, char>) {
+            this->append(std::string_view(&value, 1));
+        }
+        else if constexpr (std::is_floating_point_v<U>) {
+            auto const [end, ec] = std::to_chars(buf, buf + sizeof buf, value, std::chars_format::general, 6);
+            this->append(std::string_view(buf, end));
+        }
+        else if constexpr (std::is_arithmetic_v<U>) {
+            auto const [end, ec] = std::to_chars(buf, buf + sizeof buf, value);
+            this->append(std::string_view(buf, end));
+        }
+        else if constexpr (std::is_convertible_v<T, std::string_view>) {
+            this->append(std::string_view(value));
+        }
+        else if constexpr (std::is_pointer_v<U>) {
+            auto const [end, ec] = std::to_chars(buf, buf + sizeof buf, reinterpret_cast<std::uintptr_t>(value), 16);
+            this->append("0x");
+            this->append(std::string_view(buf, end));
+        }
+        else {
+            thread_local auto ss = std::ostringstream();
+            ss.str("");
+            ss << std::forward<T>(value);
+            this->append(ss.view());
+        }
+    }
+
+    /**
+     * @brief Encode a streamable object as a tagged argument: scalars are stored as raw 64-bit
+     * values, colored messages keep their color so the decoder can restore it.
+     */
+    template<typename T>
+    void encode_binary(T&& value) {
+        using U = std::remove_cvref_t<T>;
+        if constexpr (std::same_as<U, bool>) {
+            this->append_scalar(ARG_BOOL, static_cast<std::uint8_t>(value));
+        }
+        else if constexpr (std::same_as<U, char>) {
+            this->append_scalar(ARG_CHAR, value);
+        }
+        else if constexpr (std::is_floating_point_v<U>) {
+            this->append_scalar(ARG_FLOAT, static_cast<double>(value));
+        }
+        else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) {
+            this->append_scalar(ARG_INT, static_cast<std::int64_t>(value));
+        }
+        else if constexpr (std::is_integral_v<U> || std::is_enum_v<U>) {
+            this->append_scalar(ARG_UINT, static_cast<std::uint64_t>(value));
+        }
+        else if constexpr (std::is_convertible_v<T, std::string_view>) {
+            this->append_tagged(ARG_STRING, std::string_view(value));
+        }
+        else if constexpr (std::is_pointer_v<U>) {
+            this->append_scalar(ARG_POINTER, static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(value)));
+        }
+        else if constexpr (std::same_as<U, colored_message>) {
+            this->append_tagged(ARG_COLORED, value.msg.content, static_cast<std::uint32_t>(value.color.type));
+        }
+        else if constexpr (std::same_as<U, colored_view>) {
+            this->append_tagged(ARG_COLORED, value.text, static_cast<std::uint32_t>(value.color.type));
+        }
+        else {
+            thread_local auto ss = std::ostringstream();
+            ss.str("");
+            ss << std::forward<T>(value);
+            this->append_tagged(ARG_STRING, ss.view());
+        }
+    }
+};
+
+/**
+ * @brief Lock-free single-producer/single-consumer ring of records. Its slots are inline, so
+ * rings are only ever made on the heap (see sink::local_ring()).
+ */
+using spsc_ring = gltool::spsc_queue<record, k_ring_capacity>;
+
+/**
+ * @brief Write the time/location prefix of a record, in the same layout the synchronous
+ * logger uses.
+ */
+inline void write_header(std::ostream& out, std::chrono::system_clock::time_point time_point, unsigned indent_ct,
+                         bool show_time, std::string_view location) {
+    auto const indent = [&out, indent_ct] {
+        for (auto ct = indent_ct; ct--; ) {
+            out.write("  ", 2);
+        }
+    };
+    auto const previous = colors::previous_color(out);
+    if (show_time) {
+        auto const time = prefixes::time(time_point, previous);
+        indent();
+        out.write(time.data(), time.size());
+    }
+    if (!location.empty()) {
+        indent();
+        out.write(location.data(), location.size());
+    }
+    indent();       // The first piece of the statement is indented as well.
+}
+
+inline void write_header(std::ostream& out, record const& rec) {
+    auto const location = rec.show_location ? prefixes::location(call_site::of(rec.location), colors::previous_color(out)) : "";
+    write_header(out, rec.time, rec.indent, rec.show_time, location);
+}
+
+} // namespace async
+
+
+/**
+ * @brief Compact binary log format. The stream starts with a magic tag, followed by two kinds
+ * of packets: a LOCATION packet interns a call site (file, line, function) the first time it
+ * logs, an ENTRY packet refers to the interned ID and carries a 64-bit timestamp and the raw
+ * tagged arguments of the statement. decode() turns such a stream back into colored text.
+ * All values are stored in native (little-endian on every supported platform) byte order.
+ */
+namespace binlog {
+
+constexpr char k_magic[8] = { 'G', 'L', 'T', 'L', 'O', 'G', '0', '1' };
+
+enum packet : std::uint8_t {
+    LOCATION = 1, ENTRY = 2
+};
+
+enum entry_flag : std::uint8_t {
+    SHOW_TIME = 1, SHOW_LOCATION = 2, HAS_HEADER = 4, TRUNCATED = 8
+};
+
+template<typename T>
+void put(std::ostream& out, T const& value) {
+    out.write(reinterpret_cast<char const*>(&value), sizeof(T));
+}
+
+inline void put(std::ostream& out, std::string_view text) {
+    put(out, static_cast<std::uint16_t>(text.size()));
+    out.write(text.data(), text.size());
+}
+
+template<typename T>
+bool get(std::istream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+inline bool get(std::istream& in, std::string& text) {
+    auto size = std::uint16_t();
+    if (!get(in, size)) {
+        return false;
+    }
+    text.resize(size);
+    return static_cast<bool>(in.read(text.data(), size));
+}
+
+/**
+ * @brief Render the tagged arguments of a binary payload as the text the synchronous logger
+ * would have written.
+ * 
+ * @return false if the payload is corrupt: an unknown tag, or an argument running past the end.
+ * What was rendered before stays written.
+ */
+inline bool render_payload(std::ostream& out, char const* data, std::size_t length) {
+    auto pos = std::size_t(0);
+    auto const read = [&]<typename T>(T& value) {
+        if (length - pos < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, data + pos, sizeof(T));
+        pos += sizeof(T);
+        return true;
+    };
+    auto const read_text = [&](std::string_view& text) {
+        auto size = std::uint16_t();
+        if (!read(size) || length - pos < size) {
+            return false;
+        }
+        text = std::string_view(data + pos, size);
+        pos += size;
+        return true;
+    };
+    while (pos < length) {
+        auto type = async::arg_type();
+        auto text = std::string_view();
+        read(type);
+        switch (type) {
+        case async::ARG_BOOL:    { auto v = std::uint8_t();  if (!read(v)) { return false; } out << (v != 0); break; }
+        case async::ARG_CHAR:    { auto v = char();          if (!read(v)) { return false; } out << v; break; }
+        case async::ARG_INT:     { auto v = std::int64_t();  if (!read(v)) { return false; } out << v; break; }
+        case async::ARG_UINT:    { auto v = std::uint64_t(); if (!read(v)) { return false; } out << v; break; }
+        case async::ARG_FLOAT:   { auto v = double();        if (!read(v)) { return false; } out << v; break; }
+        case async::ARG_POINTER: { auto v = std::uint64_t(); if (!read(v)) { return false; } out << reinterpret_cast<void const*>(v); break; }
+        case async::ARG_STRING:  { if (!read_text(text)) { return false; } out << text; break; }
+        case async::ARG_COLORED: {
+            auto color = std::uint32_t();
+            if (!read(color) || !read_text(text)) {
+                return false;
+            }
+            out << text_color(color)(text);
+            break;
+        }
+        case async::ARG_NEWLINE: { out << '\n'; break; }
+        default:                 { return false; }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Writes records as binary packets, interning call sites on their first use.
+ */
+class writer {
+public:
+    explicit writer(std::ostream& out)
+        : m_out(out) {
+
+        m_out.write(k_magic, sizeof k_magic);
+    }
+
+    void write(async::record const& rec) {
+        auto const key = call_site::of(rec.location);
+        auto [it, inserted] = m_sites.try_emplace(key, static_cast<std::uint32_t>(m_sites.size()));
+        if (inserted) {
+            put(m_out, LOCATION);
+            put(m_out, it->second);
+            put(m_out, static_cast<std::uint32_t>(key.line));
+            put(m_out, std::string_view(key.file));
+            put(m_out, std::string_view(key.function));
+        }
+        auto const flags = static_cast<std::uint8_t>((rec.show_time ? SHOW_TIME : 0) | (rec.show_location ? SHOW_LOCATION : 0) |
+                                                     (rec.has_header ? HAS_HEADER : 0) | (rec.truncated ? TRUNCATED : 0));
+        put(m_out, ENTRY);
+        put(m_out, it->second);
+        put(m_out, static_cast<std::int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(rec.time.time_since_epoch()).count()));
+        put(m_out, static_cast<std::uint16_t>(rec.indent));
+        put(m_out, flags);
+        put(m_out, rec.length);
+        m_out.write(rec.payload, rec.length);
+    }
+
+private:
+    std::ostream& m_out;
+    std::unordered_map<call_site, std::uint32_t, call_site::hash> m_sites;
+};
+
+/**
+ * @brief Decode a binary log stream into the colored text the logger would have printed.
+ * 
+ * @return false if the stream is not a binary log or ends in the middle of a packet.
+ */
+inline bool decode(std::istream& in, std::ostream& out) {
+    char magic[sizeof k_magic];
+    if (!in.read(magic, sizeof magic) || !std::equal(magic, magic + sizeof magic, k_magic)) {
+        return false;
+    }
+    struct site {
+        std::uint32_t line;
+        std::string file;
+        std::string function;
+    };
+    auto sites = std::vector<site>();
+    auto payload = std::string();
+    auto type = packet();
+    while (get(in, type)) {
+        if (type == LOCATION) {
+            auto id = std::uint32_t();
+            auto s = site();
+            if (!get(in, id) || !get(in, s.line) || !get(in, s.file) || !get(in, s.function)) {
+                return false;
+            }
+            // The writer numbers the sites in the order it first writes them.
+            if (id > sites.size()) {
+                return false;
+            }
+            if (id == sites.size()) {
+                sites.push_back(std::move(s));
+            }
+            else {
+                sites[id] = std::move(s);
+            }
+        }
+        else if (type == ENTRY) {
+            auto id = std::uint32_t();
+            auto ns = std::int64_t();
+            auto indent = std::uint16_t();
+            auto flags = std::uint8_t();
+            auto length = std::uint16_t();
+            if (!get(in, id) || !get(in, ns) || !get(in, indent) || !get(in, flags) || !get(in, length) || id >= sites.size()) {
+                return false;
+            }
+            payload.resize(length);
+            if (!in.read(payload.data(), length)) {
+                return false;
+            }
+            if (flags & HAS_HEADER) {
+                auto const time = std::chrono::system_clock::time_point(
+                    std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(ns)));
+                auto location = std::string();
+                if (flags & SHOW_LOCATION) {
+                    auto& [line, file, function] = sites[id];
+                    auto const previous = colors::previous_color(out);
+                    location.assign("[ ");
+                    prefixes::field(location, "FILE: ", previous);
+                    location.append(prefixes::file_name_of(file)).append("; ");
+                    prefixes::field(location, "LINE: ", previous);
+                    location.append(std::to_string(line)).append(" in ");
+                    prefixes::field(location, "FUNCTION: ", previous);
+                    location.append(function).append(" ] \n");
+                }
+                async::write_header(out, time, indent, flags & SHOW_TIME, location);
+            }
+            if (!render_payload(out, payload.data(), payload.size())) {
+                out << "<corrupted record>\n";
+                continue;
+            }
+            if (flags & TRUNCATED) {
+                out << "...\n";
+            }
+        }
+        else {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace binlog
+
+
+namespace async {
+
+/**
+ * @brief Write a record as the text the synchronous logger would have printed.
+ */
+inline void write_text(std::ostream& out, record const& rec) {
+    if (rec.has_header) {
+        write_header(out, rec);
+    }
+    if (rec.binary) {
+        if (!binlog::render_payload(out, rec.payload, rec.length)) {
+            out << "<corrupted record>\n";
+        }
+    }
+    else {
+        out.write(rec.payload, rec.length);
+    }
+    if (rec.truncated) {
+        out << "...\n";
+    }
+}
+
+} // namespace async
+
+
+/**
+ * @brief Additional log destinations of a logger, each one with its own level threshold and
+ * rate limiter. A logger always writes to its own stream; sinks receive the same records, for
+ * example a file at INFO, the console at WARNING and an in-memory ring for crash dumps:
+ * @code
+ *      gl::LOG.set_level(gltool::log_tag::WARNING);
+ *      gl::LOG.add_sink<gltool::sinks::file_sink>("app.log", gltool::log_tag::INFO);
+ *      auto& crash = gl::LOG.add_sink<gltool::sinks::ring_sink>(256);
+ * @endcode
+ * The level of a statement is given by LOG(level) / LOG_AT(), or raised by a streamed message
+ * carrying a message::type (e.g. "oops"_warning). Statements filtered at compile time by
+ * LOG_AT() never reach any sink.
+ */
+namespace sinks {
+
+/**
+ * @brief Token-bucket rate limiter: allows bursts of up to `burst` messages, refilled at
+ * `rate` messages per second. A rate of 0 means unlimited.
+ */
+class token_bucket {
+public:
+    explicit token_bucket(double rate = 0., double burst = 0.) noexcept
+        : m_rate(rate),
+          m_burst(std::max(burst, 1.)),
+          m_tokens(m_burst) {}
+
+    bool try_acquire(std::chrono::steady_clock::time_point now) noexcept {
+        if (m_rate <= 0.) {
+            return true;
+        }
+        auto const elapsed = std::chrono::duration<double>(now - m_last).count();
+        m_tokens = std::min(m_burst, m_tokens + elapsed * m_rate);
+        m_last = now;
+        if (m_tokens < 1.) {
+            return false;
+        }
+        m_tokens -= 1.;
+        return true;
+    }
+
+private:
+    double m_rate;
+    double m_burst;
+    double m_tokens;
+    std::chrono::steady_clock::time_point m_last = std::chrono::steady_clock::now();
+};
+
+/**
+ * @brief Hand the text between the ANSI color sequences ("\033[...m") to `out`, piece by piece.
+ */
+template<std::invocable<std::string_view> Out>
+void for_each_plain(std::string_view text, Out&& out) {
+    while (!text.empty()) {
+        auto const pos = text.find('\033');
+        out(text.substr(0, pos));
+        if (pos == std::string_view::npos) {
+            break;
+        }
+        auto const end = text.find('m', pos);
+        text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+    }
+}
+
+/**
+ * @brief Base class of all sinks. Derived classes only implement write() (and flush()).
+ */
+class log_sink {
+public:
+    explicit log_sink(log_tag::level threshold = log_tag::TRACE, token_bucket limiter = token_bucket()) noexcept
+        : m_threshold(threshold),
+          m_limiter(limiter) {}
+
+    virtual ~log_sink() = default;
+
+    /**
+     * @brief Whether the sink takes a record of the given level now. Records refused by the
+     * rate limiter are counted and reported with the next accepted one.
+     */
+    bool accepts(log_tag::level level, std::chrono::steady_clock::time_point now) noexcept {
+        if (level < m_threshold) {
+            return false;
+        }
+        if (!m_limiter.try_acquire(now)) {
+            ++m_suppressed;
+            return false;
+        }
+        return true;
+    }
+
+    void publish(log_tag::level level, std::string_view text) {
+        if (m_suppressed != 0) {
+            auto notice = "[ " + std::to_string(m_suppressed) + " messages suppressed by rate limit ]\n";
+            m_suppressed = 0;
+            this->write(log_tag::WARNING, notice);
+        }
+        this->write(level, text);
+    }
+
+    virtual void flush() {}
+
+    void set_threshold(log_tag::level threshold) noexcept {
+        m_threshold = threshold;
+    }
+
+protected:
+    virtual void write(log_tag::level level, std::string_view text) = 0;
+
+private:
+    log_tag::level m_threshold;
+    token_bucket m_limiter;
+    std::size_t m_suppressed = 0;
+};
+
+/**
+ * @brief Writes to an existing stream, e.g. std::cerr.
+ */
+class stream_sink : public log_sink {
+public:
+    explicit stream_sink(std::ostream& out, log_tag::level threshold = log_tag::TRACE, token_bucket limiter = token_bucket())
+        : log_sink(threshold, limiter),
+          m_out(out) {}
+
+    void flush() override {
+        m_out.flush();
+    }
+
+protected:
+    void write(log_tag::level, std::string_view text) override {
+        m_out.write(text.data(), text.size());
+    }
+
+    std::ostream& m_out;
+};
+
+/**
+ * @brief Appends to a file. ANSI color sequences are stripped unless asked otherwise.
+ */
+class file_sink : public log_sink {
+public:
+    explicit file_sink(std::string const& path, log_tag::level threshold = log_tag::TRACE,
+                       token_bucket limiter = token_bucket(), bool keep_colors = false)
+        : log_sink(threshold, limiter),
+          m_file(path, std::ios::app),
+          m_keep_colors(keep_colors) {
+
+        if (!m_file.is_open()) {
+            throw std::runtime_error("Could not open log file: " + path);
+        }
+    }
+
+    void flush() override {
+        m_file.flush();
+    }
+
+protected:
+    void write(log_tag::level, std::string_view text) override {
+        if (m_keep_colors) {
+            m_file.write(text.data(), text.size());
+            return;
+        }
+        for_each_plain(text, [this](std::string_view plain) { m_file.write(plain.data(), static_cast<std::streamsize>(plain.size())); });
+    }
+
+    std::ofstream m_file;
+    bool m_keep_colors;
+};
+
+/**
+ * @brief Appends to a file whose size and age are bounded: past `max_bytes` or `max_age` the
+ * file is renamed with the time it was rolled (app.log becomes app.20261014-093000.log) and a
+ * new one is started. A background thread compresses the rolled files with an external
+ * command (zstd by default, fed through its standard input, see gltool::pipe_writer) and
+ * deletes the oldest beyond `keep`. Writes are buffered: the buffer goes to the file when it
+ * fills, on a record at or above `flush_level`, and every `flush_interval` from the
+ * background thread, so a burst of logging does not stall on the disk record by record.
+ * ANSI color sequences are stripped.
+ * @code
+ *      gl::LOG.add_sink<gltool::sinks::rotating_file_sink>(gltool::sinks::rotating_file_sink::options{
+ *          .path = "logs/app.log", .max_bytes = 64 << 20, .keep = 20 });
+ * @endcode
+ */
+class rotating_file_sink : public log_sink {
+public:
+    struct options {
+        std::filesystem::path     path;
+        std::uintmax_t            max_bytes      = std::uintmax_t(16) << 20;
+        std::chrono::seconds      max_age        = std::chrono::hours(24);      // 0: no limit.
+        std::size_t               keep           = 8;                           // Rolled files kept; 0 keeps them all.
+        std::size_t               buffer_bytes   = std::size_t(64) << 10;
+        std::chrono::milliseconds flush_interval = std::chrono::seconds(1);
+        log_tag::level            flush_level    = log_tag::WARNING;
+        std::string               compress       = "zstd -q -f -o";             // Takes the output path; empty: none.
+        std::string               extension      = ".zst";                      // Of the compressed files.
+    };
+
+    explicit rotating_file_sink(options settings, log_tag::level threshold = log_tag::TRACE, token_bucket limiter = token_bucket())
+        : log_sink(threshold, limiter),
+          m_options(std::move(settings)) {
+
+        if (m_options.path.has_parent_path()) {
+            std::filesystem::create_directories(m_options.path.parent_path());
+        }
+        this->open();
+        m_buffer.reserve(m_options.buffer_bytes);
+        m_worker = std::jthread([this](std::stop_token token) { this->run(token); });
+    }
+
+    rotating_file_sink(rotating_file_sink const&) = delete;
+
+    rotating_file_sink& operator =(rotating_file_sink const&) = delete;
+
+    /**
+     * @brief Writes the buffer, then compresses what was rolled before returning.
+     */
+    ~rotating_file_sink() override {
+        m_worker.request_stop();
+        m_wake.notify_all();
+        m_worker.join();
+        auto lock = std::scoped_lock(m_mutex);
+        this->write_buffer();
+    }
+
+    void flush() override {
+        auto lock = std::scoped_lock(m_mutex);
+        this->write_buffer();
+        m_file.flush();
+    }
+
+    /**
+     * @brief Roll the file now, e.g. on a signal from logrotate.
+     */
+    void rotate() {
+        auto lock = std::scoped_lock(m_mutex);
+        this->roll();
+    }
+
+    std::uintmax_t rotations() const noexcept {
+        return m_rotations.load(std::memory_order_relaxed);
+    }
+
+protected:
+    void write(log_tag::level level, std::string_view text) override {
+        auto lock = std::scoped_lock(m_mutex);
+        for_each_plain(text, [this](std::string_view plain) { m_buffer.append(plain); });
+        auto const age = std::chrono::system_clock::now() - m_opened;
+        if (m_written + m_buffer.size() >= m_options.max_bytes || (m_options.max_age.count() > 0 && age >= m_options.max_age)) {
+            this->roll();
+        }
+        else if (m_buffer.size() >= m_options.buffer_bytes || level >= m_options.flush_level) {
+            this->write_buffer();
+            if (level >= m_options.flush_level) {
+                m_file.flush();
+            }
+        }
+    }
+
+private:
+    void open() {
+        m_file.open(m_options.path, std::ios::app | std::ios::binary);
+        if (!m_file.is_open()) {
+            throw std::runtime_error("Could not open log file: " + m_options.path.string());
+        }
+        auto error = std::error_code();
+        auto const size = std::filesystem::file_size(m_options.path, error);
+        m_written = error ? 0 : size;
+        m_opened = std::chrono::system_clock::now();
+    }
+
+    void write_buffer() {
+        if (!m_buffer.empty()) {
+            m_file.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+            m_written += m_buffer.size();
+            m_buffer.clear();
+        }
+    }
+
+    /**
+     * @brief Close the file with what is buffered, rename it by the time and start another.
+     * Under the lock.
+     */
+    void roll() {
+        this->write_buffer();
+        m_file.close();
+        auto const time = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        auto stamp = std::array<char, 32>();
+        auto tm = std::tm();
+#if defined(_WIN32)
+        ::localtime_s(&tm, &time);
+#else
+        ::localtime_r(&time, &tm);
+#endif
+        auto const length = std::strftime(stamp.data(), stamp.size(), "%Y%m%d-%H%M%S", &tm);
+        auto const stem = m_options.path.stem().string() + "." + std::string(stamp.data(), length);
+        auto rolled = m_options.path;
+        rolled.replace_filename(stem + m_options.path.extension().string());
+        for (auto n = 1; std::filesystem::exists(rolled) || std::filesystem::exists(rolled.string() + m_options.extension); ++n) {
+            rolled.replace_filename(stem + "-" + std::to_string(n) + m_options.path.extension().string());
+        }
+        auto error = std::error_code();
+        std::filesystem::rename(m_options.path, rolled, error);
+        this->open();
+        m_rotations.fetch_add(1, std::memory_order_relaxed);
+        if (!error) {
+            m_rolled.push_back(std::move(rolled));
+            m_wake.notify_all();
+        }
+    }
+
+    void run(std::stop_token const& token) {
+        while (true) {
+            auto rolled = std::vector<std::filesystem::path>();
+            {
+                auto lock = std::unique_lock(m_mutex);
+                m_wake.wait_for(lock, m_options.flush_interval, [&] { return token.stop_requested() || !m_rolled.empty(); });
+                this->write_buffer();
+                m_file.flush();
+                rolled.swap(m_rolled);
+            }
+            for (auto const& file : rolled) {
+                this->compress(file);
+            }
+            if (!rolled.empty()) {
+                this->prune();
+            }
+            if (token.stop_requested()) {
+                return;
+            }
+        }
+    }
+
+    void compress(std::filesystem::path const& file) const {
+        if (m_options.compress.empty()) {
+            return;
+        }
+        auto const target = file.string() + m_options.extension;
+        auto status = -1;
+        try {
+            auto const source = mapped_file(file.string().c_str());
+            auto quoted = std::string("'");
+            for (auto const c : target) {
+                quoted += c == '\'' ? std::string("'\\''") : std::string(1, c);
+            }
+            quoted += "'";
+            auto encoder = pipe_writer((m_options.compress + " " + quoted).c_str());
+            auto const written = encoder.write(std::as_bytes(std::span(source.data(), source.size())));
+            status = encoder.close();
+            status = written ? status : -1;
+        }
+        catch (std::exception const& error) {
+            std::cerr << "Could not compress log file " << file.string() << ": " << error.what() << std::endl;
+        }
+        auto ignored = std::error_code();
+        if (status == 0) {
+            std::filesystem::remove(file, ignored);
+        }
+        else {
+            std::filesystem::remove(target, ignored);       // Keep the plain file rather than a partial one.
+        }
+    }
+
+    /**
+     * @brief Delete the oldest rolled files (compressed or not) beyond `keep`, by modification
+     * time (the names do not sort once a second has several rotations).
+     */
+    void prune() const {
+        if (m_options.keep == 0) {
+            return;
+        }
+        auto const directory = m_options.path.has_parent_path() ? m_options.path.parent_path() : std::filesystem::path(".");
+        auto const prefix = m_options.path.stem().string() + ".";
+        auto const current = m_options.path.filename().string();
+        auto rolled = std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>>();
+        auto error = std::error_code();
+        for (auto const& entry : std::filesystem::directory_iterator(directory, error)) {
+            auto const name = entry.path().filename().string();
+            if (name != current && name.starts_with(prefix) && name.size() > prefix.size() && std::isdigit(static_cast<unsigned char>(name[prefix.size()]))) {
+                rolled.emplace_back(entry.last_write_time(error), entry.path());
+            }
+        }
+        if (rolled.size() <= m_options.keep) {
+            return;
+        }
+        std::ranges::sort(rolled);
+        for (auto i = std::size_t(0); i < rolled.size() - m_options.keep; ++i) {
+            std::filesystem::remove(rolled[i].second, error);
+        }
+    }
+
+    options                                 m_options;
+    std::mutex                              m_mutex;        // Guards the members below.
+    std::condition_variable                 m_wake;
+    std::ofstream                           m_file;
+    std::string                             m_buffer;
+    std::uintmax_t                          m_written = 0;  // Bytes in the file, including what it had.
+    std::chrono::system_clock::time_point   m_opened;
+    std::vector<std::filesystem::path>      m_rolled;       // Waiting for compression.
+    std::atomic<std::uintmax_t>             m_rotations = 0;
+    std::jthread                            m_worker;       // Declared last: started once the members above exist.
+};
+
+/**
+ * @brief Keeps the last `capacity` records in memory, e.g. to be dumped after a crash.
+ */
+class ring_sink : public log_sink {
+public:
+    explicit ring_sink(std::size_t capacity, log_tag::level threshold = log_tag::TRACE, token_bucket limiter = token_bucket())
+        : log_sink(threshold, limiter),
+          m_lines(std::max<std::size_t>(capacity, 1)) {}
+
+    /**
+     * @brief Write the kept records, oldest first.
+     */
+    void dump(std::ostream& out) const {
+        auto const count = std::min(m_count, m_lines.size());
+        for (auto i = m_count - count; i < m_count; ++i) {
+            out << m_lines[i % m_lines.size()];
+        }
+        out.flush();
+    }
+
+protected:
+    void write(log_tag::level, std::string_view text) override {
+        m_lines[m_count++ % m_lines.size()].assign(text);     // Reuses the capacity of the slot.
+    }
+
+    std::vector<std::string> m_lines;
+    std::size_t m_count = 0;
+};
+
+/**
+ * @brief Copies the records into the gltool::flight_recorder, without their colors and cut
+ * to its k_text_size, so that a crash dump ends with the last of them. Nothing is copied
+ * while the recorder is off.
+ */
+class flight_sink : public log_sink {
+public:
+    explicit flight_sink(log_tag::level threshold = log_tag::INFO, token_bucket limiter = token_bucket())
+        : log_sink(threshold, limiter) {}
+
+protected:
+    void write(log_tag::level, std::string_view text) override {
+        auto& recorder = flight_recorder::instance();
+        if (!recorder.enabled()) {
+            return;
+        }
+        auto plain = std::array<char, flight_recorder::k_text_size>();
+        auto size = std::size_t(0);
+        for_each_plain(text, [&](std::string_view part) {
+            auto const count = std::min(part.size(), plain.size() - size);
+            std::memcpy(plain.data() + size, part.data(), count);
+            size += count;
+        });
+        while (size > 0 && (plain[size - 1] == '\n' || plain[size - 1] == '\r')) {
+            --size;
+        }
+        std::replace(plain.begin(), plain.begin() + static_cast<std::ptrdiff_t>(size), '\n', ' ');     // One line per entry.
+        recorder.record(flight_recorder::kind::LOG, std::string_view(plain.data(), size));
+    }
+};
+
+/**
+ * @brief The sinks of a logger. Formats a record once and hands the text to every sink
+ * that accepts it.
+ */
+class fanout {
+public:
+    bool empty() const noexcept {
+        return m_count.load(std::memory_order_relaxed) == 0;
+    }
+
+    template<std::derived_from<log_sink> Sink>
+    Sink& add(std::unique_ptr<Sink> sink) {
+        auto lock = std::scoped_lock(m_mutex);
+        auto& result = *sink;
+        m_sinks.push_back(std::move(sink));
+        m_count.store(m_sinks.size(), std::memory_order_relaxed);
+        return result;
+    }
+
+    void clear() {
+        auto lock = std::scoped_lock(m_mutex);
+        m_sinks.clear();
+        m_count.store(0, std::memory_order_relaxed);
+    }
+
+    void dispatch(async::record const& rec) {
+        if (this->empty()) {
+            return;
+        }
+        auto lock = std::scoped_lock(m_mutex);
+        auto const now = std::chrono::steady_clock::now();
+        thread_local auto ss = std::ostringstream();
+        auto formatted = false;
+        for (auto& sink : m_sinks) {
+            if (!sink->accepts(rec.level, now)) {
+                continue;
+            }
+            if (!formatted) {
+                ss.str("");
+                async::write_text(ss, rec);
+                formatted = true;
+            }
+            sink->publish(rec.level, ss.view());
+        }
+    }
+
+    void flush() {
+        auto lock = std::scoped_lock(m_mutex);
+        for (auto& sink : m_sinks) {
+            sink->flush();
+        }
+    }
+
+private:
+    std::mutex m_mutex;
+    std::vector<std::unique_ptr<log_sink>> m_sinks;
+    std::atomic<std::size_t> m_count = 0;
+};
+
+} // namespace sinks
+
+
+namespace async {
+
+/**
+ * @brief The asynchronous sink: owns the per-thread rings and the background drain thread.
+ * It only moves records across threads; what happens to a drained record is decided by the
+ * consumer function (the owning logger writes it to its stream and to its sinks).
+ */
+class sink {
+public:
+    using consumer_t = std::function<void (record const&)>;
+
+    /**
+     * @param out The output stream, flushed after each drain.
+     * @param consume Called on the drain thread for every record, in time order.
+     * @param binary Whether the sink's own notices must be encoded in the binary format.
+     */
+    sink(std::ostream& out, consumer_t consume, bool binary = false)
+        : m_out(out),
+          m_consume(std::move(consume)),
+          m_binary(binary),
+          m_id(s_next_id++),
+          m_worker([this](std::stop_token token) { this->run(token); }) {
+
+        auto lock = std::scoped_lock(registry_mutex());
+        registry().push_back(this);
+    }
+
+    sink(sink const&) = delete;
+
+    sink& operator =(sink const&) = delete;
+
+    ~sink() {
+        {
+            auto lock = std::scoped_lock(registry_mutex());
+            std::erase(registry(), this);
+        }
+        m_worker.request_stop();
+        m_worker.join();
+        this->flush();
+    }
+
+    /**
+     * @brief Hand a record to the background thread. Never blocks: if the calling thread's
+     * ring is full, the record is dropped and counted.
+     */
+    void push(record const& rec) noexcept {
+        if (!this->local_ring().try_push(rec)) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Synchronously drain every ring into the output stream.
+     */
+    void flush() {
+        auto lock = std::scoped_lock(m_drain_mutex);
+        this->drain();
+        m_out.flush();
+    }
+
+    /**
+     * @brief Write the last k_history_size records that were drained, e.g. from a crash handler.
+     */
+    void dump_history(std::ostream& out) {
+        auto lock = std::scoped_lock(m_drain_mutex);
+        auto const count = std::min(m_history_ct, k_history_size);
+        for (auto i = m_history_ct - count; i < m_history_ct; ++i) {
+            write_text(out, m_history[i % k_history_size]);
+        }
+        out.flush();
+    }
+
+    /**
+     * @brief Flush every live sink before the program terminates on an unhandled exception.
+     * The previous terminate handler is still invoked afterwards.
+     */
+    static void install_terminate_handler() {
+        static std::terminate_handler previous = nullptr;
+        if (previous != nullptr) {
+            return;
+        }
+        previous = std::set_terminate([] {
+            if (auto lock = std::unique_lock(registry_mutex(), std::try_to_lock)) {
+                for (auto* s : registry()) {
+                    s->flush();
+                }
+            }
+            if (previous != nullptr) {
+                previous();
+            }
+            std::abort();
+        });
+    }
+
+private:
+    static inline std::atomic<std::size_t> s_next_id = 1;
+
+    static std::vector<sink*>& registry() {
+        static auto sinks = std::vector<sink*>();
+        return sinks;
+    }
+
+    static std::mutex& registry_mutex() {
+        static auto mutex = std::mutex();
+        return mutex;
+    }
+
+    /**
+     * @brief Find (or create, only once per thread) the ring of the calling thread.
+     */
+    spsc_ring& local_ring() {
+        thread_local auto cache = std::vector<std::pair<std::size_t, spsc_ring*>>();
+        for (auto& [id, ring] : cache) {
+            if (id == m_id) {
+                return *ring;
+            }
+        }
+        auto lock = std::scoped_lock(m_rings_mutex);
+        auto& ring = m_rings.emplace_back(std::make_unique<spsc_ring>());
+        cache.emplace_back(m_id, ring.get());
+        return *ring;
+    }
+
+    void run(std::stop_token token) {
+        while (!token.stop_requested()) {
+            auto drained = false;
+            {
+                auto lock = std::scoped_lock(m_drain_mutex);
+                drained = this->drain();
+            }
+            if (!drained) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    }
+
+    /**
+     * @brief Pop everything available, order it by time across threads, then format it.
+     * Must be called with m_drain_mutex held.
+     */
+    bool drain() {
+        m_batch.clear();
+        {
+            auto lock = std::scoped_lock(m_rings_mutex);
+            for (auto& ring : m_rings) {
+                record rec;
+                while (ring->try_pop(rec)) {
+                    m_batch.push_back(rec);
+                }
+            }
+        }
+        std::stable_sort(m_batch.begin(), m_batch.end(), [](record const& lhs, record const& rhs) {
+            return lhs.time < rhs.time;
+        });
+        for (auto const& rec : m_batch) {
+            m_consume(rec);
+            m_history[m_history_ct++ % k_history_size] = rec;
+        }
+        if (auto const dropped = m_dropped.exchange(0, std::memory_order_relaxed)) {
+            auto notice = record { .time = std::chrono::system_clock::now(), .location = {}, .level = log_tag::WARNING, .binary = m_binary, .payload = {} };
+            notice.encode(colors::k_yellow("[ " + std::to_string(dropped) + " log records dropped ]\n"));
+            m_consume(notice);
+        }
+        return !m_batch.empty();
+    }
+
+    std::ostream& m_out;
+    consumer_t m_consume;
+    bool m_binary;
+    std::size_t m_id;
+    std::mutex m_rings_mutex;
+    std::mutex m_drain_mutex;
+    std::vector<std::unique_ptr<spsc_ring>> m_rings;
+    std::vector<record> m_batch;
+    std::unique_ptr<record[]> m_history = std::make_unique<record[]>(k_history_size);
+    std::size_t m_history_ct = 0;
+    std::atomic<std::size_t> m_dropped = 0;
+    std::jthread m_worker;      // Declared last, so that it starts after everything else is constructed.
+};
+
+} // namespace async
+
+
+/**
+ * @brief The logger class
+ * Binds with a output stream (std::ostream&) and provides logging utilities.
+ * If the logger owns the stream, it will be freed via RAII (the previous color of the
+ * stream lives in the stream itself, see colors::previous_color()).
+ */
+class logger {
+public:
+    class logger_aux {
+    public:
+        logger_aux(logger& logger, 
+                   std::source_location const location = std::source_location::current(),
+                   std::chrono::system_clock::time_point const time = std::chrono::system_clock::now(),
+                   log_tag::level const level = log_tag::INFO)
+            : m_logger(logger), 
+              m_location(location),
+              m_time(time),
+              m_level(level) {}
+
+        logger_aux(logger_aux const&) = delete;
+
+        /**
+         * @brief In asynchronous mode, the whole statement is handed to the sink at once when
+         * the temporary is destroyed (i.e. at the end of the full expression).
+         */
+        ~logger_aux() {
+            auto const& suffix = m_logger.m_layout.suffix;
+            if (m_pending) {
+                if (!suffix.empty()) {
+                    m_record.encode(std::string_view(suffix));
+                }
+                m_logger.submit(m_record);
+            }
+            else if (m_logged && !suffix.empty()) {
+                this->print(std::string_view(suffix));
+            }
+        }
+
+        template<typename T>
+            requires (!std::is_scalar_v<T>)
+        friend logger_aux&& operator <<(logger_aux&& logger, T* ptr) {
+            std::move(logger) << typeid_name<T> << " Object at ";
+            if (logger.is_recording()) {
+                logger.record_of().encode(static_cast<void const*>(ptr));
+                return std::move(logger);
+            }
+            logger.print(ptr);      // Avoid recursive call.
+            return std::move(logger);
+        }
+
+        /**
+         * @brief Stream operation for printable objects.
+         */
+        friend logger_aux&& operator <<(logger_aux&& logger, streamable auto&& obj) {
+            if constexpr (std::same_as<std::remove_cvref_t<decltype(obj)>, message>) {
+                logger.raise_level(obj);
+            }
+            auto const& layout = logger.layout();
+            if (logger.is_recording()) {
+                auto& rec = logger.record_of();
+                rec.has_header = true;
+                logger.encode_spacing(rec);
+                rec.encode(std::forward<decltype(obj)>(obj));
+                return std::move(logger);
+            }
+            if (!logger.passes()) {
+                return std::move(logger);
+            }
+            if (!logger.m_logged) {
+                layout.header(logger);
+                logger.m_logged = true;
+                if (!layout.prefix.empty()) {
+                    logger.print(std::string_view(layout.prefix), std::exchange(logger.m_indent, false));
+                }
+            }
+            else if (logger.m_separate && !layout.separator.empty()) {
+                logger.print(std::string_view(layout.separator));
+            }
+            logger.m_separate = true;
+            logger.print(std::forward<decltype(obj)>(obj), logger.m_indent);
+            if (logger.m_indent) {
+                logger.m_indent = false;
+            }
+            return std::move(logger);
+        }
+
+        friend logger_aux&& operator <<(logger_aux&& logger, std::ostream& (*manip)(std::ostream&)) {
+            if (logger.is_recording()) {
+                // Only line breaks are meaningful for a record, flushing is up to the sink.
+                if (manip == static_cast<std::ostream& (*)(std::ostream&)>(std::endl)) {
+                    logger.record_of().append_newline();
+                    logger.m_separate = false;
+                }
+                return std::move(logger);
+            }
+            if (logger.passes()) {
+                logger.print(manip);
+                logger.m_separate = manip != static_cast<std::ostream& (*)(std::ostream&)>(std::endl);
+            }
+            return std::move(logger);
+        }
+
+        /**
+         * @brief Whether the statement is encoded into a record (asynchronous or binary mode,
+         * or when extra sinks are attached) instead of being streamed piece by piece.
+         */
+        bool is_recording() const noexcept {
+            return m_logger.is_recording();
+        }
+
+        auto const& layout() const noexcept {
+            return m_logger.m_layout;
+        }
+
+        /**
+         * @brief Whether the statement passes the level threshold of the logger's own stream.
+         */
+        bool passes() const noexcept {
+            return m_level >= m_logger.m_level.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Take the stream for the rest of the statement, so that statements of different
+         * threads are not interleaved.
+         */
+        void lock() {
+            if (!m_lock.owns_lock()) {
+                m_lock = std::unique_lock(m_logger.m_mutex);
+            }
+        }
+
+        void print(streamable auto&& obj, bool indent = false) {
+            if (!m_logger.m_active) {
+                return;
+            }
+            this->lock();
+            m_logger.write_text(std::forward<decltype(obj)>(obj), indent);
+        }
+
+        void print(std::ostream& (*manip)(std::ostream&)) {
+            if (!m_logger.m_active) {
+                return;
+            }
+            this->lock();
+            manip(m_logger.m_out);
+        }
+
+        /**
+         * @brief A tagged message raises the level of the whole statement, so that e.g.
+         * LOG() << "out of memory"_error reaches sinks that only take errors.
+         */
+        void raise_level(message const& msg) noexcept {
+            auto const level = msg.type & message::ERROR   ? log_tag::ERROR
+                             : msg.type & message::WARNING ? log_tag::WARNING
+                             : msg.type & message::INFO    ? log_tag::INFO
+                             : log_tag::TRACE;
+            m_level = std::max(m_level, level);
+            m_record.level = m_level;
+        }
+
+        /**
+         * @brief The record being built for this statement (asynchronous or binary mode only).
+         */
+        async::record& record_of() noexcept {
+            if (!m_pending) {
+                m_pending = m_logger.m_active;
+                m_record.time = m_time;
+                m_record.location = m_location;
+                m_record.level = m_level;
+                m_record.indent = m_logger.indent_depth();
+                m_record.show_time = m_logger.m_layout.show_time;
+                m_record.show_location = m_logger.m_layout.show_location;
+                m_record.binary = m_logger.m_binary != nullptr;
+            }
+            return m_record;
+        }
+
+        void log_location() {
+            if (!m_logged) {
+                this->lock();
+                this->print(prefixes::location(call_site::of(m_location), colors::previous_color(m_logger.m_out)), true);
+            }
+        }
+
+        void log_time() {
+            if (!m_logged) {
+                this->lock();
+                this->print(prefixes::time(m_time, colors::previous_color(m_logger.m_out)), true);
+            }
+        }
+
+    private:
+        logger& m_logger;
+        std::source_location m_location;
+        std::chrono::system_clock::time_point m_time;
+        log_tag::level m_level;
+        async::record m_record;
+        std::unique_lock<std::recursive_mutex> m_lock;
+        /**
+         * @brief The prefix of the layout before the first piece of a record, its separator
+         * before the others.
+         */
+        void encode_spacing(async::record& rec) {
+            auto const& spacing = m_logged ? m_logger.m_layout.separator : m_logger.m_layout.prefix;
+            if ((!m_logged || m_separate) && !spacing.empty()) {
+                rec.encode(std::string_view(spacing));
+            }
+            m_logged = true;
+            m_separate = true;
+        }
+
+        bool m_logged = false;
+        bool m_indent = true;
+        bool m_pending = false;
+        bool m_separate = false;        // A piece was written since the last line break.
+    };
+
+    /**
+     * @brief The layout in use, see set_layout().
+     */
+    struct layout_state {
+        void (*header)(logger_aux&) = &text_layout<>::header<logger_aux>;
+        bool show_time = text_layout<>::k_time;
+        bool show_location = text_layout<>::k_location;
+        std::string prefix;
+        std::string suffix;
+        std::string separator;
+    };
+
+    logger(std::nullptr_t)
+        : m_out(std::cout),
+          m_owning(false),
+          m_active(false) {}
+
+    logger(std::string const& path) try
+        : logger(*new std::ofstream(path), true) {}
+    catch (std::exception const& e) {
+        std::cerr << colors::k_red("Error on contruction of logger object.") << e.what();
+    }
+
+    logger(std::ostream& out = std::cerr, bool owning = false)
+        : m_out(out),
+          m_owning(owning) {}
+
+    virtual ~logger() {
+        m_async.reset();        // Drain pending records before the stream goes away.
+        if (m_owning) {
+            delete &m_out;
+        }
+    }
+
+    /**
+     * @brief Get the auxiliary logger object, which carries the source location and time
+     * of the caller.
+     * 
+     * @param location 
+     * @param time 
+     * @return logger_aux 
+     */
+    logger_aux operator ()(std::source_location location = std::source_location::current(),
+                           std::chrono::system_clock::time_point time = std::chrono::system_clock::now()) {
+        return logger_aux(*this, location, time);
+    }
+
+    /**
+     * @brief Same as above, for a statement of the given level (see set_level() and sinks).
+     */
+    logger_aux operator ()(log_tag::level level,
+                           std::source_location location = std::source_location::current(),
+                           std::chrono::system_clock::time_point time = std::chrono::system_clock::now()) {
+        return logger_aux(*this, location, time, level);
+    }
+
+    /**
+     * @brief Attach an additional sink, constructed in place from the arguments. The logger
+     * keeps ownership; the returned reference stays valid until clear_sinks().
+     */
+    template<std::derived_from<sinks::log_sink> Sink, typename... Args>
+    Sink& add_sink(Args&&... args) {
+        this->flush();
+        return m_sinks.add(std::make_unique<Sink>(std::forward<Args>(args)...));
+    }
+
+    void clear_sinks() {
+        this->flush();
+        m_sinks.clear();
+    }
+
+    /**
+     * @brief Log error message and exit the program.
+     * * This function throws an exception!
+     * The gltool::flight_recorder, if recording, is dumped first.
+     */
+    [[noreturn]]
+    void exception(streamable auto&& msg) {
+        this->flush();
+        if (m_binary) {
+            auto rec = async::record { .time = std::chrono::system_clock::now(), .location = {}, .has_header = true, .binary = true, .payload = {} };
+            rec.encode(colors::k_red("Exception: "));
+            rec.encode(msg);
+            rec.append_newline();
+            m_binary->write(rec);
+            m_out.flush();
+            flight_recorder::instance().crash_dump("exception");
+            throw 42;
+        }
+        {
+            auto lock = std::scoped_lock(m_mutex);
+            m_out << colors::k_red << "Exception: " << msg << colors::k_white << std::endl;
+        }
+        if (!m_sinks.empty()) {
+            auto rec = async::record { .time = std::chrono::system_clock::now(), .location = {}, .level = log_tag::ERROR, .has_header = true, .payload = {} };
+            rec.encode(colors::k_red("Exception: "));
+            rec.encode(msg);
+            rec.append_newline();
+            m_sinks.dispatch(rec);
+            m_sinks.flush();
+        }
+        flight_recorder::instance().crash_dump("exception");
+        throw 42;
+    }
+
+    /**
+     * @brief Flush the output stream. In asynchronous mode, pending records are drained first.
+     */
+    void flush() {
+        if (m_async) {
+            m_async->flush();
+        }
+        {
+            auto lock = std::scoped_lock(m_mutex);
+            m_out.flush();
+        }
+        m_sinks.flush();
+    }
+
+    void indent() {
+        ++this->indent_depth();
+    }
+
+    bool is_async() const noexcept {
+        return m_async != nullptr;
+    }
+
+    void log(streamable auto&& msg, bool indent = false) {
+        if (!m_active) {
+            return;
+        }
+        if (this->is_recording()) {
+            auto rec = async::record { .time = std::chrono::system_clock::now(), .location = {}, .indent = indent ? this->indent_depth() : 0, .binary = m_binary != nullptr, .payload = {} };
+            rec.encode(std::forward<decltype(msg)>(msg));
+            this->submit(rec);
+            return;
+        }
+        auto lock = std::scoped_lock(m_mutex);
+        this->write_text(std::forward<decltype(msg)>(msg), indent);
+    }
+
+    void log(std::ostream& (*manip)(std::ostream&)) {
+        if (!m_active) {
+            return;
+        }
+        auto lock = std::scoped_lock(m_mutex);
+        manip(m_out);
+    }
+
+    bool is_active() const noexcept {
+        return m_active;
+    }
+
+    /**
+     * @brief Whether statements are encoded into records rather than streamed directly.
+     */
+    bool is_recording() const noexcept {
+        return m_async != nullptr || m_binary != nullptr || !m_sinks.empty();
+    }
+
+    /**
+     * @brief Formatted logging with a compile-time checked format string, e.g.
+     * LOG.logf("frame {} took {} ms\n", frame, ms). The text is formatted straight into the
+     * stream buffer (or into the record in asynchronous/binary mode), no temporary string is
+     * created. Use LOGF() to skip argument evaluation entirely when the logger is inactive.
+     */
+    template<typename... Args>
+    void logf(format_string<Args...> format, Args&&... args) {
+        if (!m_active) {
+            return;
+        }
+#if defined(__cpp_lib_format)
+        this->logv(format.get(), std::make_format_args(args...));
+#else
+        if (this->is_recording()) {
+            auto rec = async::record { .time = std::chrono::system_clock::now(), .location = {}, .binary = m_binary != nullptr, .payload = {} };
+            format_walk(format.get(), [&rec](std::string_view text) {
+                if (!text.empty()) {
+                    rec.encode(text);
+                }
+            }, [&rec](auto const& arg) {
+                rec.encode(arg);
+            }, args...);
+            this->submit(rec);
+            return;
+        }
+        auto lock = std::scoped_lock(m_mutex);
+        format_walk(format.get(), [this](std::string_view text) {
+            m_out.write(text.data(), text.size());
+        }, [this](auto const& arg) {
+            m_out << arg;
+        }, args...);
+#endif
+    }
+
+#if defined(__cpp_lib_format)
+    /**
+     * @brief Type-erased flavor of logf(), for wrappers that forward their own arguments.
+     */
+    void logv(std::string_view format, std::format_args args) {
+        if (!m_active) {
+            return;
+        }
+        if (this->is_recording()) {
+            // Formatted into a reused per-thread buffer, then copied into the record.
+            thread_local auto text = std::string();
+            text.clear();
+            std::vformat_to(std::back_inserter(text), format, args);
+            auto rec = async::record { .time = std::chrono::system_clock::now(), .location = {}, .binary = m_binary != nullptr, .payload = {} };
+            rec.encode(std::string_view(text));
+            this->submit(rec);
+            return;
+        }
+        auto lock = std::scoped_lock(m_mutex);
+        std::vformat_to(std::ostreambuf_iterator<char>(m_out), format, args);
+    }
+#endif
+
+    /**
+     * @brief Switch between synchronous and asynchronous mode. In asynchronous mode, the calling
+     * thread only encodes the statement and pushes it into a lock-free ring; a background thread
+     * formats and writes it. Switching back to synchronous mode drains everything first.
+     */
+    void set_async(bool flag = true) {
+        if (flag && m_async == nullptr) {
+            m_async = std::make_unique<async::sink>(m_out, [this](async::record const& rec) {
+                this->write_record(rec);
+            }, m_binary != nullptr);
+        }
+        else if (!flag) {
+            m_async.reset();
+        }
+    }
+
+    /**
+     * @brief Switch to the compact binary log format (see binlog), or back to colored text.
+     * The magic tag is written to the stream when the binary format is turned on, so the
+     * stream should be dedicated to (and, on Windows, opened in binary mode for) this logger.
+     * Use binlog::decode() to turn the log back into text.
+     */
+    void set_binary(bool flag = true) {
+        if (flag == (m_binary != nullptr)) {
+            return;
+        }
+        auto const async = this->is_async();
+        m_async.reset();        // Drained records go through the binary writer.
+        m_binary = flag ? std::make_unique<binlog::writer>(m_out) : nullptr;
+        this->set_async(async);
+    }
+
+    /**
+     * @brief Access the asynchronous sink, e.g. to dump its history in a crash handler.
+     * Returns nullptr in synchronous mode.
+     */
+    async::sink* get_async_sink() noexcept {
+        return m_async.get();
+    }
+
+    /**
+     * @brief Lay statements out as `layout` says, from now on; set it before other threads log.
+     */
+    template<unsigned Flags>
+    void set_layout(text_layout<Flags> layout) {
+        auto lock = std::scoped_lock(m_mutex);
+        m_layout = {
+            .header = &text_layout<Flags>::template header<logger_aux>,
+            .show_time = text_layout<Flags>::k_time,
+            .show_location = text_layout<Flags>::k_location,
+            .prefix = std::move(layout.prefix),
+            .suffix = std::move(layout.suffix),
+            .separator = std::move(layout.separator)
+        };
+    }
+
+    /**
+     * @brief Statements below this level are not written to the logger's own stream. Sinks
+     * have their own thresholds.
+     */
+    void set_level(log_tag::level level) noexcept {
+        m_level.store(level, std::memory_order_relaxed);
+    }
+
+    void unindent() {
+        --this->indent_depth();
+    }
+
+private:
+    std::ostream& m_out;
+    std::recursive_mutex m_mutex;       // Guards m_out; recursive since streamed objects may log.
+    std::uint64_t m_id = s_next_id++;
+    bool m_owning;
+    bool m_active = true;
+    std::atomic<log_tag::level> m_level = log_tag::TRACE;
+    layout_state m_layout;
+    std::unique_ptr<binlog::writer> m_binary;
+    sinks::fanout m_sinks;
+    std::unique_ptr<async::sink> m_async;      // Declared last, its drain thread uses the members above.
+
+    static inline std::atomic<std::uint64_t> s_next_id = 1;
+
+    /**
+     * @brief The indentation depth of the calling thread, so that INDENT() on a loader thread
+     * does not shift the output of the main thread. The last logger used by the thread is cached.
+     */
+    unsigned& indent_depth() const {
+        thread_local auto cached_id = std::uint64_t(0);
+        thread_local auto* cached_depth = static_cast<unsigned*>(nullptr);
+        if (cached_id != m_id) {
+            thread_local auto depths = std::unordered_map<std::uint64_t, unsigned>();
+            cached_depth = &depths[m_id];
+            cached_id = m_id;
+        }
+        return *cached_depth;
+    }
+
+    /**
+     * @brief Write a piece of a statement to the stream. The caller holds m_mutex.
+     */
+    void write_text(streamable auto&& msg, bool indent) {
+        if (indent) {
+            auto ct = this->indent_depth();
+            while (ct--) { 
+                m_out << "  ";
+            }
+        }
+        m_out << msg;
+    }
+
+    /**
+     * @brief Hand a finished record to the asynchronous sink, or write it synchronously.
+     */
+    void submit(async::record const& rec) {
+        if (m_async) {
+            m_async->push(rec);
+        }
+        else {
+            this->write_record(rec);
+        }
+    }
+
+    /**
+     * @brief Write a record to the logger's own stream (if its level passes) and to the sinks.
+     */
+    void write_record(async::record const& rec) {
+        if (rec.level >= m_level.load(std::memory_order_relaxed)) {
+            auto lock = std::scoped_lock(m_mutex);
+            if (m_binary) {
+                m_binary->write(rec);
+            }
+            else {
+                async::write_text(m_out, rec);
+            }
+        }
+        m_sinks.dispatch(rec);
+    }
+};
+
+/**
+ * @brief Indentation guard whose existence is decided at compile time. The disabled
+ * specialization is an empty object, so a filtered INDENT_AT() costs nothing.
+ */
+template<bool Enabled>
+struct [[nodiscard]] indent_guard : scoped_call<&logger::indent, &logger::unindent, logger> {
+    using scoped_call::scoped_call;
+};
+
+template<>
+struct [[nodiscard]] indent_guard<false> {
+    explicit indent_guard(logger&) noexcept {}
+};
+
+/**
+ * @brief Call logger::logf() only if the logger is active, so that the arguments are not even
+ * evaluated otherwise.
+ */
+#define LOGF(LOG, ...) do { if ((LOG).is_active()) { (LOG).logf(__VA_ARGS__); } } while (false)
 
-#define INDENT(LOG) auto indent_guard = gltool::scoped_operation(LOG, &gltool::logger::indent, &gltool::logger::unindent)
+#define INDENT(LOG) auto indent_guard = gltool::indent_guard<true>(LOG)
 
 } // namespace gltool
 
@@ -1,12 +1,79 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <csignal>
 #include <concepts>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <filesystem>
 #include <fstream>
 #include <functional>
+#include <future>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <shared_mutex>
+#include <span>
 #include <sstream>
 #include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
+#include <variant>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define M_HAS_MMAP 1
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#define M_HAS_SOCKETS 1
+
+#include <signal.h>
+#define M_HAS_SIGACTION 1
+#endif
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#define M_HAS_INOTIFY 1
+
+#include <sched.h>
+#include <sys/resource.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define M_HAS_SSE2 1
+#endif
 
 namespace gltool {
 
@@ -20,40 +87,7828 @@ concept streamable = requires (std::decay_t<T> t) {
     { std::declval<std::ostream&>() << t } -> std::same_as<std::ostream&>;
 };
 
-std::string read_file(char const* path) {
-    auto file = std::ifstream(path);
-    if (!file.is_open()) {
-        throw std::runtime_error("Could not open file: " + std::string(path));
+class mapped_file;
+
+/**
+ * @brief Open `path` from the archives mounted with vfs::mount(), if one of them has it.
+ * Defined with vfs below.
+ */
+inline bool open_mounted(char const* path, bool populate, mapped_file& file);
+
+/**
+ * @brief A read-only view of a whole file. The file is memory-mapped where the platform
+ * allows it (no copy at all), otherwise it is read once into an owned buffer. Paths inside
+ * a mounted asset archive (see vfs) resolve to the entry instead.
+ * Move-only; the view is valid as long as the object lives.
+ */
+class mapped_file {
+public:
+    mapped_file() noexcept = default;
+
+    /**
+     * @param path Path of the file.
+     * @param populate Fault all pages in now (e.g. on a loader thread), instead of on first access.
+     */
+    explicit mapped_file(char const* path, bool populate = false) {
+        if (open_mounted(path, populate, *this)) {
+            return;
+        }
+#if defined(M_HAS_MMAP)
+        auto const fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::runtime_error("Could not open file: " + std::string(path));
+        }
+        struct stat info {};
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Could not stat file: " + std::string(path));
+        }
+        m_size = static_cast<std::size_t>(info.st_size);
+        if (m_size != 0) {
+            auto flags = MAP_PRIVATE;
+#if defined(MAP_POPULATE)
+            if (populate) {
+                flags |= MAP_POPULATE;
+            }
+#endif
+            auto* const address = ::mmap(nullptr, m_size, PROT_READ, flags, fd, 0);
+            if (address == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Could not map file: " + std::string(path));
+            }
+            m_data = static_cast<char const*>(address);
+            m_mapped = true;
+        }
+        ::close(fd);        // The mapping keeps the file alive.
+#else
+        (void) populate;
+        auto file = std::ifstream(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) {
+            throw std::runtime_error("Could not open file: " + std::string(path));
+        }
+        m_buffer.resize(static_cast<std::size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+        m_data = m_buffer.data();
+        m_size = m_buffer.size();
+#endif
+    }
+
+    mapped_file(mapped_file const&) = delete;
+
+    mapped_file(mapped_file&& other) noexcept
+        : m_data(std::exchange(other.m_data, nullptr)),
+          m_size(std::exchange(other.m_size, 0)),
+          m_mapped(std::exchange(other.m_mapped, false)),
+          m_buffer(std::move(other.m_buffer)),
+          m_owner(std::move(other.m_owner)) {
+
+        if (!m_mapped && m_owner == nullptr && m_size != 0) {
+            m_data = m_buffer.data();
+        }
+    }
+
+    mapped_file& operator =(mapped_file const&) = delete;
+
+    mapped_file& operator =(mapped_file&& other) noexcept {
+        if (this != &other) {
+            this->unmap();
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+            m_mapped = std::exchange(other.m_mapped, false);
+            m_buffer = std::move(other.m_buffer);
+            m_owner = std::move(other.m_owner);
+            if (!m_mapped && m_owner == nullptr && m_size != 0) {
+                m_data = m_buffer.data();
+            }
+        }
+        return *this;
+    }
+
+    ~mapped_file() {
+        this->unmap();
+    }
+
+    /**
+     * @brief A view of bytes that `owner` keeps alive, e.g. an entry of a mapped archive.
+     */
+    static mapped_file borrow(std::string_view bytes, std::shared_ptr<void const> owner) {
+        auto result = mapped_file();
+        result.m_data = bytes.data();
+        result.m_size = bytes.size();
+        result.m_owner = std::move(owner);
+        return result;
+    }
+
+    /**
+     * @brief Take over bytes already in memory, e.g. a decompressed archive entry.
+     */
+    static mapped_file adopt(std::string bytes) {
+        auto result = mapped_file();
+        result.m_buffer = std::move(bytes);
+        result.m_data = result.m_buffer.data();
+        result.m_size = result.m_buffer.size();
+        return result;
+    }
+
+    char const* data() const noexcept {
+        return m_data;
+    }
+
+    bool empty() const noexcept {
+        return m_size == 0;
+    }
+
+    std::size_t size() const noexcept {
+        return m_size;
+    }
+
+    std::string_view view() const noexcept {
+        return { m_data, m_size };
+    }
+
+    operator std::string_view() const noexcept {
+        return this->view();
     }
 
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    file.close();
+private:
+    void unmap() noexcept {
+#if defined(M_HAS_MMAP)
+        if (m_mapped) {
+            ::munmap(const_cast<char*>(m_data), m_size);
+            m_mapped = false;
+        }
+#endif
+        m_owner.reset();
+    }
+
+    char const* m_data = nullptr;
+    std::size_t m_size = 0;
+    bool m_mapped = false;
+    std::string m_buffer;                   // Where mmap is not available, or adopted bytes.
+    std::shared_ptr<void const> m_owner;    // What a borrowed view points into.
+};
 
-    return buffer.str();
+inline std::string read_file(char const* path) {
+    auto const file = mapped_file(path);
+    return std::string(file.view());
 }
 
-template<typename T>
-struct scoped_operation {
-    template<typename... Args>
-    scoped_operation(T& object, void (T::* do_something)(Args...), void (T::* undo_something)(Args...), Args&&... args)
-        : m_undo_function([&object, undo_something, &args...] { (object.*undo_something)(args...); }) {
+/**
+ * @brief 64-bit XXH64 of a blob, the key under which identical sources are loaded once (see
+ * gl::resource_manager::proxy::intern()). Reads 32 bytes per round in four lanes, several
+ * GB/s, so hashing a file costs little next to reading it.
+ * @code
+ *      auto const key = gltool::content_hash(std::as_bytes(std::span(file.data(), file.size())));
+ * @endcode
+ */
+inline std::uint64_t content_hash(std::span<std::byte const> bytes, std::uint64_t seed = 0) noexcept {
+    constexpr auto k_prime_1 = std::uint64_t(0x9E3779B185EBCA87ull);
+    constexpr auto k_prime_2 = std::uint64_t(0xC2B2AE3D27D4EB4Full);
+    constexpr auto k_prime_3 = std::uint64_t(0x165667B19E3779F9ull);
+    constexpr auto k_prime_4 = std::uint64_t(0x85EBCA77C2B2AE63ull);
+    constexpr auto k_prime_5 = std::uint64_t(0x27D4EB2F165667C5ull);
+    auto const load = [&bytes]<typename T>(std::size_t at, T) {
+        auto value = T(0);
+        std::memcpy(&value, bytes.data() + at, sizeof value);      /* Little endian, as on every target */
+        return value;
+    };
+    auto const round = [](std::uint64_t acc, std::uint64_t input) {
+        return std::rotl(acc + input * k_prime_2, 31) * k_prime_1;
+    };
+    auto const n = bytes.size();
+    auto at = std::size_t(0);
+    auto hash = std::uint64_t(0);
+    if (n >= 32) {
+        std::uint64_t lanes[] = { seed + k_prime_1 + k_prime_2, seed + k_prime_2, seed, seed - k_prime_1 };
+        for (; at + 32 <= n; at += 32) {
+            for (auto i = 0u; i < 4; ++i) {
+                lanes[i] = round(lanes[i], load(at + i * 8, std::uint64_t()));
+            }
+        }
+        hash = std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) + std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18);
+        for (auto const lane : lanes) {
+            hash = (hash ^ round(0, lane)) * k_prime_1 + k_prime_4;
+        }
+    }
+    else {
+        hash = seed + k_prime_5;
+    }
+    hash += n;
+    for (; at + 8 <= n; at += 8) {
+        hash = std::rotl(hash ^ round(0, load(at, std::uint64_t())), 27) * k_prime_1 + k_prime_4;
+    }
+    if (at + 4 <= n) {
+        hash = std::rotl(hash ^ (load(at, std::uint32_t()) * k_prime_1), 23) * k_prime_2 + k_prime_3;
+        at += 4;
+    }
+    for (; at < n; ++at) {
+        hash = std::rotl(hash ^ (std::to_integer<std::uint64_t>(bytes[at]) * k_prime_5), 11) * k_prime_1;
+    }
+    hash = (hash ^ (hash >> 33)) * k_prime_2;
+    hash = (hash ^ (hash >> 29)) * k_prime_3;
+    return hash ^ (hash >> 32);
+}
+
+/**
+ * @brief A versioned on-disk cache of derived data: what the loaders compute from a source
+ * (transcoded texture levels, optimized meshes) is saved under a key made of the source's
+ * content_hash(), the name of the processing stage and its settings, so a later run maps the
+ * result instead of computing it again. An entry is a small header and the payload; find()
+ * maps it and hands out a view of the payload, no copy. Entries of another format version,
+ * truncated or with another key are misses. Writes go through a temporary file renamed into
+ * place, so concurrent loaders and crashed runs never leave a half entry. Thread-safe.
+ * @code
+ *      auto cache = gltool::derived_cache(".derived_cache");
+ *      auto const key = gltool::derived_cache::key_of(gltool::content_hash(source), "transcode", "bc7");
+ *      auto levels = cache.get_or(key, [&] { return transcode(source); });
+ * @endcode
+ */
+class derived_cache {
+public:
+    static constexpr std::uint32_t k_format_version = 1;
+
+    struct statistics {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::uint64_t stores = 0;
+        std::uint64_t bytes_mapped = 0;
+    };
 
-        (object.*do_something)(args...);
+    /**
+     * @param version Bump it when a stage changes its output, which invalidates every entry.
+     */
+    explicit derived_cache(std::filesystem::path directory, std::uint32_t version = k_format_version)
+        : m_directory(std::move(directory)),
+          m_version(version) {}
+
+    derived_cache(derived_cache const&) = delete;
+
+    derived_cache& operator =(derived_cache const&) = delete;
+
+    /**
+     * @brief The key of the output of `stage` run with `settings` on a source of hash `content`.
+     */
+    static std::uint64_t key_of(std::uint64_t content, std::string_view stage, std::string_view settings = {}) noexcept {
+        auto key = content_hash(std::as_bytes(std::span(stage)), content);
+        return content_hash(std::as_bytes(std::span(settings)), key);
     }
-    
-    template<typename... Args>
-    scoped_operation(T const& object, void (T::* do_something)(Args...) const, void (T::* undo_something)(Args...) const, Args&&... args)
-        : m_undo_function([&object, undo_something, &args...] { (object.*undo_something)(args...); }) {
 
-        (object.*do_something)(args...);
+    /**
+     * @brief The payload stored under `key`, mapped, if there is a valid entry.
+     */
+    std::optional<mapped_file> find(std::uint64_t key) {
+        auto const path = this->path_of(key);
+        auto error = std::error_code();
+        if (!std::filesystem::exists(path, error)) {
+            m_misses.fetch_add(1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+        try {
+            auto file = std::make_shared<mapped_file const>(path.string().c_str());
+            auto entry = header();
+            if (file->size() >= sizeof entry) {
+                std::memcpy(&entry, file->data(), sizeof entry);
+            }
+            if (file->size() < sizeof entry || std::memcmp(entry.magic, k_magic, sizeof k_magic) != 0 || entry.version != m_version ||
+                entry.key != key || entry.size != file->size() - sizeof entry) {
+                m_misses.fetch_add(1, std::memory_order_relaxed);
+                return std::nullopt;
+            }
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            m_bytes_mapped.fetch_add(entry.size, std::memory_order_relaxed);
+            auto const payload = std::string_view(file->data() + sizeof entry, static_cast<std::size_t>(entry.size));
+            return mapped_file::borrow(payload, std::move(file));
+        }
+        catch (std::exception const&) {
+            m_misses.fetch_add(1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
     }
 
-    ~scoped_operation() {
-        m_undo_function();
+    /**
+     * @brief Save `payload` under `key`. Failures (a read-only disk, no space) only cost
+     * recomputing the data next time; returns whether the entry was written.
+     */
+    bool store(std::uint64_t key, std::span<std::byte const> payload) {
+        auto const path = this->path_of(key);
+        auto error = std::error_code();
+        std::filesystem::create_directories(path.parent_path(), error);
+        auto entry = header{ .version = m_version, .key = key, .size = payload.size() };
+        std::memcpy(entry.magic, k_magic, sizeof k_magic);
+        auto temporary = path;
+        temporary += "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+        {
+            auto file = std::ofstream(temporary, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<char const*>(&entry), sizeof entry);
+            file.write(reinterpret_cast<char const*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+            if (!file) {
+                file.close();
+                std::filesystem::remove(temporary, error);
+                return false;
+            }
+        }
+        std::filesystem::rename(temporary, path, error);
+        if (error) {
+            std::filesystem::remove(temporary, error);
+            return false;
+        }
+        m_stores.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief The payload under `key`, or else what `produce` returns (bytes in a contiguous
+     * container, e.g. a std::vector<std::byte> or a std::string), which is stored.
+     */
+    template<std::invocable Produce>
+    mapped_file get_or(std::uint64_t key, Produce&& produce) {
+        if (auto found = this->find(key)) {
+            return std::move(*found);
+        }
+        auto const produced = std::invoke(std::forward<Produce>(produce));
+        auto const bytes = std::as_bytes(std::span(produced));
+        this->store(key, bytes);
+        return mapped_file::adopt(std::string(reinterpret_cast<char const*>(bytes.data()), bytes.size()));
+    }
+
+    /**
+     * @brief Remove every entry, e.g. from a "clear cache" menu.
+     */
+    void clear() {
+        auto error = std::error_code();
+        std::filesystem::remove_all(m_directory, error);
+    }
+
+    std::filesystem::path const& get_directory() const noexcept {
+        return m_directory;
+    }
+
+    statistics get_statistics() const noexcept {
+        return { m_hits.load(std::memory_order_relaxed), m_misses.load(std::memory_order_relaxed),
+                 m_stores.load(std::memory_order_relaxed), m_bytes_mapped.load(std::memory_order_relaxed) };
+    }
+
+private:
+    static constexpr char k_magic[4] = { 'G', 'L', 'D', 'C' };
+
+    struct header {
+        char magic[4] = {};
+        std::uint32_t version;
+        std::uint64_t key;
+        std::uint64_t size;
+    };
+
+    /**
+     * @brief Entries are spread over 256 directories by the high byte of the key.
+     */
+    std::filesystem::path path_of(std::uint64_t key) const {
+        char name[24];
+        auto const end = std::to_chars(name, name + sizeof name, key, 16).ptr;
+        char bucket[4];
+        auto const bucket_end = std::to_chars(bucket, bucket + sizeof bucket, key >> 56, 16).ptr;
+        return m_directory / std::string(bucket, bucket_end) / std::string(name, end).append(".bin");
+    }
+
+    std::filesystem::path m_directory;
+    std::uint32_t m_version;
+    std::atomic<std::uint64_t> m_hits = 0;
+    std::atomic<std::uint64_t> m_misses = 0;
+    std::atomic<std::uint64_t> m_stores = 0;
+    std::atomic<std::uint64_t> m_bytes_mapped = 0;
+};
+
+/**
+ * @brief The LZ4 block format (no frame): sequences of a token, literals, a 16-bit match
+ * offset and a match length. Decoding is a couple of copies per sequence, fast enough to
+ * decompress assets on the I/O threads as they are read.
+ */
+namespace lz4 {
+
+constexpr std::size_t k_min_match = 4;
+constexpr std::size_t k_last_literals = 5;      /* The block always ends with as many literals */
+constexpr std::size_t k_match_limit = 12;       /* No match starts in the last bytes */
+constexpr std::size_t k_max_offset = 0xFFFF;
+
+/**
+ * @brief Compress `input` greedily with a hash table of 4-byte sequences, appending the block
+ * to `out`. Returns the size of the block.
+ */
+inline std::size_t compress(std::span<std::byte const> input, std::vector<std::byte>& out) {
+    constexpr auto k_hash_bits = 16u;
+    auto const start = out.size();
+    auto const n = input.size();
+    auto const load = [&input](std::size_t at) {
+        auto value = std::uint32_t(0);
+        std::memcpy(&value, input.data() + at, sizeof(value));
+        return value;
+    };
+    auto const put_length = [&out](std::size_t length) {
+        for (; length >= 255; length -= 255) {
+            out.push_back(std::byte(255));
+        }
+        out.push_back(std::byte(length));
+    };
+    auto const put_literals = [&](std::size_t from, std::size_t to, std::size_t match) {
+        auto const literals = to - from;
+        out.push_back(std::byte((std::min<std::size_t>(literals, 15) << 4) | std::min<std::size_t>(match, 15)));
+        if (literals >= 15) {
+            put_length(literals - 15);
+        }
+        out.insert(out.end(), input.begin() + from, input.begin() + to);
+    };
+
+    auto table = std::vector<std::uint32_t>(std::size_t(1) << k_hash_bits, std::numeric_limits<std::uint32_t>::max());
+    auto anchor = std::size_t(0);
+    auto const limit = n > k_match_limit ? n - k_match_limit : 0;
+    for (auto i = std::size_t(0); i < limit;) {
+        auto const sequence = load(i);
+        auto& slot = table[(sequence * 2654435761u) >> (32 - k_hash_bits)];
+        auto const candidate = std::exchange(slot, static_cast<std::uint32_t>(i));
+        if (candidate == std::numeric_limits<std::uint32_t>::max() || i - candidate > k_max_offset || load(candidate) != sequence) {
+            ++i;
+            continue;
+        }
+        auto length = k_min_match;
+        while (i + length < n - k_last_literals && input[candidate + length] == input[i + length]) {
+            ++length;
+        }
+        put_literals(anchor, i, length - k_min_match);
+        auto const offset = i - candidate;
+        out.push_back(std::byte(offset & 0xFF));
+        out.push_back(std::byte(offset >> 8));
+        if (length - k_min_match >= 15) {
+            put_length(length - k_min_match - 15);
+        }
+        i += length;
+        anchor = i;
+    }
+    put_literals(anchor, n, 0);
+    return out.size() - start;
+}
+
+/**
+ * @brief Decompress a block into `output`, which must be exactly the original size.
+ * Throws on a malformed block instead of reading or writing out of bounds.
+ */
+inline void decompress(std::span<std::byte const> input, std::span<std::byte> output) {
+    auto in = std::size_t(0);
+    auto at = std::size_t(0);
+    auto const length = [&](std::size_t value) {
+        if (value == 15) {
+            auto extra = std::byte(255);
+            while (extra == std::byte(255)) {
+                if (in >= input.size()) {
+                    throw std::runtime_error("Corrupt LZ4 block: truncated length");
+                }
+                extra = input[in++];
+                value += std::to_integer<std::size_t>(extra);
+            }
+        }
+        return value;
+    };
+    while (in < input.size()) {
+        auto const token = std::to_integer<std::size_t>(input[in++]);
+        auto const literals = length(token >> 4);
+        if (literals > input.size() - in || literals > output.size() - at) {
+            throw std::runtime_error("Corrupt LZ4 block: literals out of range");
+        }
+        std::copy_n(input.begin() + in, literals, output.begin() + at);
+        in += literals;
+        at += literals;
+        if (in == input.size()) {
+            break;          // The last sequence has no match.
+        }
+        if (input.size() - in < 2) {
+            throw std::runtime_error("Corrupt LZ4 block: truncated offset");
+        }
+        auto const offset = std::to_integer<std::size_t>(input[in]) | std::to_integer<std::size_t>(input[in + 1]) << 8;
+        in += 2;
+        auto const match = length(token & 15) + k_min_match;
+        if (offset == 0 || offset > at || match > output.size() - at) {
+            throw std::runtime_error("Corrupt LZ4 block: match out of range");
+        }
+        for (auto k = std::size_t(0); k < match; ++k, ++at) {
+            output[at] = output[at - offset];        // Byte by byte: the match may overlap itself.
+        }
+    }
+    if (at != output.size()) {
+        throw std::runtime_error("Corrupt LZ4 block: wrong decompressed size");
+    }
+}
+
+} // namespace lz4
+
+/**
+ * @brief A packed archive of asset files, read in place from a single mapping: a header, the
+ * file contents as k_alignment-aligned blobs, the names, and a table of contents sorted by
+ * the hash of the names so lookups are a binary search. Entries are stored as they are, and
+ * served as views into the mapping, or LZ4-compressed and decompressed on read.
+ * Written by write() (see tools/pack_assets.cpp), read by archive, mounted with vfs.
+ */
+namespace asset_archive {
+
+constexpr std::uint32_t k_magic = 0x52414C47;       // "GLAR"
+constexpr std::uint32_t k_version = 1;
+constexpr std::size_t k_alignment = 64;
+
+struct compression {
+    enum type : std::uint32_t {
+        NONE = 0,
+        LZ4 = 1
+    };
+};
+
+struct header {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t entry_ct;
+    std::uint32_t reserved;
+    std::uint64_t toc_offset;           /* Byte offsets from the start of the file */
+    std::uint64_t names_offset;
+    std::uint64_t names_bytes;
+};
+
+struct entry {
+    std::uint64_t name_hash;
+    std::uint64_t offset;               /* Of the blob */
+    std::uint64_t size;                 /* Once decompressed */
+    std::uint64_t stored_size;          /* In the archive */
+    std::uint32_t name_offset;          /* Into the names block */
+    std::uint32_t name_size;
+    std::uint32_t compression;
+    std::uint32_t reserved;
+};
+
+static_assert(sizeof(header) == 40 && sizeof(entry) == 48, "The layout of the format is fixed");
+
+/**
+ * @brief The name an entry is stored and looked up under: separators are forward slashes,
+ * with no leading "./" or "/".
+ */
+inline std::string normalize(std::string_view path) {
+    auto result = std::string(path);
+    std::ranges::replace(result, '\\', '/');
+    while (result.starts_with("./") || result.starts_with("/")) {
+        result.erase(0, result.front() == '/' ? 1 : 2);
+    }
+    return result;
+}
+
+/**
+ * @brief 64-bit FNV-1a of a normalized name.
+ */
+inline std::uint64_t hash_name(std::string_view name) noexcept {
+    auto hash = std::uint64_t(14695981039346656037ull);
+    for (auto const c : name) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+    }
+    return hash;
+}
+
+/**
+ * @brief An archive mapped once and validated up front; entries are looked up by name and
+ * opened as mapped_file, so whatever reads files reads archived ones unchanged.
+ * Held by shared pointer: stored entries borrow the mapping and keep the archive alive.
+ */
+class archive : public std::enable_shared_from_this<archive> {
+public:
+    static std::shared_ptr<archive> open(char const* path) {
+        return std::shared_ptr<archive>(new archive(mapped_file(path)));
+    }
+
+    std::span<entry const> entries() const noexcept {
+        return m_entries;
+    }
+
+    std::string_view name_of(entry const& item) const noexcept {
+        return m_names.substr(item.name_offset, item.name_size);
+    }
+
+    entry const* find(std::string_view path) const {
+        auto const name = normalize(path);
+        auto const hash = hash_name(name);
+        auto it = std::ranges::lower_bound(m_entries, hash, {}, &entry::name_hash);
+        for (; it != m_entries.end() && it->name_hash == hash; ++it) {
+            if (this->name_of(*it) == name) {
+                return &*it;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief The entry's bytes: a view into the mapping if stored as they are, otherwise
+     * decompressed into a buffer of their own.
+     * @param populate Fault the pages of a stored entry in now.
+     */
+    mapped_file read(entry const& item, bool populate = false) const {
+        auto const* const blob = m_file.data() + item.offset;
+        if (item.compression == compression::NONE) {
+#if defined(M_HAS_MMAP) && defined(MADV_WILLNEED)
+            if (populate && item.size != 0) {
+                auto const page = static_cast<std::uintptr_t>(::sysconf(_SC_PAGESIZE));
+                auto const first = reinterpret_cast<std::uintptr_t>(blob) / page * page;
+                ::madvise(reinterpret_cast<void*>(first), reinterpret_cast<std::uintptr_t>(blob) + item.size - first, MADV_WILLNEED);
+            }
+#else
+            (void) populate;
+#endif
+            return mapped_file::borrow({ blob, static_cast<std::size_t>(item.size) }, this->shared_from_this());
+        }
+        auto bytes = std::string(static_cast<std::size_t>(item.size), '\0');
+        lz4::decompress(std::as_bytes(std::span(blob, static_cast<std::size_t>(item.stored_size))),
+                        std::as_writable_bytes(std::span(bytes)));
+        return mapped_file::adopt(std::move(bytes));
+    }
+
+private:
+    explicit archive(mapped_file file)
+        : m_file(std::move(file)) {
+
+        auto const size = m_file.size();
+        if (size < sizeof(header) || reinterpret_cast<std::uintptr_t>(m_file.data()) % alignof(header) != 0) {
+            throw std::runtime_error("Not an asset archive");
+        }
+        auto const* const info = reinterpret_cast<header const*>(m_file.data());
+        if (info->magic != k_magic || info->version != k_version) {
+            throw std::runtime_error("Not an asset archive, or of another version");
+        }
+        if (info->toc_offset % alignof(entry) != 0 || info->toc_offset > size
+            || (size - info->toc_offset) / sizeof(entry) < info->entry_ct
+            || info->names_offset > size || size - info->names_offset < info->names_bytes) {
+            throw std::runtime_error("Corrupt asset archive: table of contents out of the file");
+        }
+        m_entries = { reinterpret_cast<entry const*>(m_file.data() + info->toc_offset), info->entry_ct };
+        m_names = m_file.view().substr(static_cast<std::size_t>(info->names_offset), static_cast<std::size_t>(info->names_bytes));
+        for (auto const& item : m_entries) {
+            if (item.offset > size || size - item.offset < item.stored_size
+                || std::uint64_t(item.name_offset) + item.name_size > m_names.size()
+                || item.compression > compression::LZ4 || (item.compression == compression::NONE && item.size != item.stored_size)) {
+                throw std::runtime_error("Corrupt asset archive: entry out of the file");
+            }
+        }
+        if (!std::ranges::is_sorted(m_entries, {}, &entry::name_hash)) {
+            throw std::runtime_error("Corrupt asset archive: table of contents not sorted");
+        }
+    }
+
+    mapped_file m_file;
+    std::span<entry const> m_entries;
+    std::string_view m_names;
+};
+
+/**
+ * @brief A file to pack. Compression is kept only where it saves space.
+ */
+struct source {
+    std::string name;
+    std::span<std::byte const> data;
+    bool compress = false;
+};
+
+inline void write(std::ostream& out, std::span<source const> files) {
+    auto entries = std::vector<entry>();
+    auto names = std::string();
+    auto blobs = std::vector<std::vector<std::byte>>(files.size());
+    auto end = std::uint64_t(sizeof(header));
+    auto const place = [&end](std::uint64_t size, std::size_t alignment) {
+        auto const offset = (end + alignment - 1) / alignment * alignment;
+        end = offset + size;
+        return offset;
+    };
+    for (auto i = std::size_t(0); i < files.size(); ++i) {
+        auto const name = normalize(files[i].name);
+        auto item = entry();
+        item.name_hash = hash_name(name);
+        item.size = files[i].data.size();
+        item.compression = compression::NONE;
+        if (files[i].compress && lz4::compress(files[i].data, blobs[i]) < files[i].data.size()) {
+            item.compression = compression::LZ4;
+        }
+        else {
+            blobs[i].clear();
+        }
+        item.stored_size = item.compression == compression::NONE ? item.size : blobs[i].size();
+        item.offset = place(item.stored_size, k_alignment);
+        item.name_offset = static_cast<std::uint32_t>(names.size());
+        item.name_size = static_cast<std::uint32_t>(name.size());
+        names += name;
+        entries.push_back(item);
+    }
+
+    auto info = header();
+    info.magic = k_magic;
+    info.version = k_version;
+    info.entry_ct = static_cast<std::uint32_t>(entries.size());
+    info.names_offset = place(names.size(), 1);
+    info.names_bytes = names.size();
+    info.toc_offset = place(entries.size() * sizeof(entry), alignof(entry));
+
+    auto written = std::uint64_t(0);
+    auto const put = [&](std::uint64_t offset, void const* data, std::size_t size) {
+        static constexpr char k_padding[k_alignment] = {};
+        out.write(k_padding, static_cast<std::streamsize>(offset - written));
+        out.write(static_cast<char const*>(data), static_cast<std::streamsize>(size));
+        written = offset + size;
+    };
+    put(0, &info, sizeof(info));
+    for (auto i = std::size_t(0); i < files.size(); ++i) {
+        auto const& stored = entries[i].compression == compression::NONE ? files[i].data : std::span<std::byte const>(blobs[i]);
+        put(entries[i].offset, stored.data(), stored.size());
+    }
+    put(info.names_offset, names.data(), names.size());
+
+    std::ranges::sort(entries, {}, &entry::name_hash);
+    auto const duplicate = std::ranges::adjacent_find(entries, {}, &entry::name_hash);
+    if (duplicate != entries.end()) {
+        throw std::runtime_error("Two files of the archive have one name hash: "
+                                 + names.substr(duplicate->name_offset, duplicate->name_size));
+    }
+    put(info.toc_offset, entries.data(), entries.size() * sizeof(entry));
+    if (!out) {
+        throw std::runtime_error("Could not write the asset archive");
+    }
+}
+
+} // namespace asset_archive
+
+/**
+ * @brief The virtual file system: asset archives mounted under a path prefix, consulted by
+ * mapped_file (and so read_file(), async_read_file() and every loader) before the disk.
+ * The last archive mounted wins; paths no archive has fall through to the disk.
+ * @code
+ * gltool::vfs::mount("assets.pak", "assets");
+ * auto mesh = gl::mesh::from_file("assets/meshes/bunny.mesh");     // Read from the archive
+ * @endcode
+ */
+class vfs {
+public:
+    static void mount(char const* archive_path, std::string_view prefix = {}) {
+        auto mounted = mount_point{ archive_path, asset_archive::normalize(prefix), asset_archive::archive::open(archive_path) };
+        if (!mounted.prefix.empty() && !mounted.prefix.ends_with('/')) {
+            mounted.prefix += '/';
+        }
+        auto lock = std::unique_lock(get().m_mutex);
+        get().m_mounts.push_back(std::move(mounted));
+    }
+
+    /**
+     * @brief Unmount an archive; files already opened from it stay valid.
+     */
+    static bool unmount(char const* archive_path) {
+        auto lock = std::unique_lock(get().m_mutex);
+        return std::erase_if(get().m_mounts, [archive_path](auto const& mounted) { return mounted.path == archive_path; }) != 0;
+    }
+
+    static bool empty() {
+        auto lock = std::shared_lock(get().m_mutex);
+        return get().m_mounts.empty();
+    }
+
+    static std::optional<mapped_file> open(std::string_view path, bool populate = false) {
+        auto lock = std::shared_lock(get().m_mutex);
+        if (get().m_mounts.empty()) {
+            return std::nullopt;
+        }
+        auto const name = asset_archive::normalize(path);
+        for (auto it = get().m_mounts.rbegin(); it != get().m_mounts.rend(); ++it) {
+            if (!name.starts_with(it->prefix)) {
+                continue;
+            }
+            if (auto const* const item = it->archive->find(std::string_view(name).substr(it->prefix.size()))) {
+                return it->archive->read(*item, populate);
+            }
+        }
+        return std::nullopt;
+    }
+
+private:
+    struct mount_point {
+        std::string path;
+        std::string prefix;
+        std::shared_ptr<asset_archive::archive const> archive;
+    };
+
+    static vfs& get() {
+        static auto instance = vfs();
+        return instance;
+    }
+
+    std::shared_mutex m_mutex;
+    std::vector<mount_point> m_mounts;
+};
+
+inline bool open_mounted(char const* path, bool populate, mapped_file& file) {
+    auto opened = vfs::open(path, populate);
+    if (!opened) {
+        return false;
+    }
+    file = std::move(*opened);
+    return true;
+}
+
+/**
+ * @brief A small pool of I/O threads shared by all asynchronous loaders. Threads are started
+ * on first use and joined at exit. Tasks start in submission order, but up to four run at
+ * once and may finish in any order: a loader that needs an order waits on its own futures.
+ */
+class io_pool {
+public:
+    static io_pool& instance() {
+        static auto pool = io_pool(std::clamp(std::thread::hardware_concurrency(), 1u, 4u));
+        return pool;
+    }
+
+    ~io_pool() {
+        {
+            auto lock = std::scoped_lock(m_mutex);
+            m_stopping = true;
+        }
+        m_ready.notify_all();
+    }
+
+    /**
+     * @brief Run a callable on the pool; its result (or exception) is delivered through the future.
+     */
+    template<std::invocable F>
+    auto submit(F&& function) -> std::future<std::invoke_result_t<F>> {
+        using result_t = std::invoke_result_t<F>;
+        auto task = std::make_shared<std::packaged_task<result_t ()>>(std::forward<F>(function));
+        auto result = task->get_future();
+        {
+            auto lock = std::scoped_lock(m_mutex);
+            m_tasks.emplace_back([task] { (*task)(); });
+        }
+        m_ready.notify_one();
+        return result;
+    }
+
+private:
+    explicit io_pool(unsigned count) {
+        for (auto i = 0u; i < count; ++i) {
+            m_threads.emplace_back([this] { this->work(); });
+        }
+    }
+
+    void work() {
+        while (true) {
+            auto task = std::function<void ()>();
+            {
+                auto lock = std::unique_lock(m_mutex);
+                m_ready.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+                if (m_tasks.empty()) {
+                    return;
+                }
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_ready;
+    std::deque<std::function<void ()>> m_tasks;
+    bool m_stopping = false;
+    std::vector<std::jthread> m_threads;        // Declared last: joined before the queue goes away.
+};
+
+/**
+ * @brief Map (and fault in) a file on the I/O pool. Errors are rethrown by future::get().
+ * Start all loads first and wait afterwards, so that the disk reads overlap:
+ * @code
+ *      auto vertex = gltool::async_read_file("shader.vert");
+ *      auto fragment = gltool::async_read_file("shader.frag");
+ *      compile(vertex.get().view(), fragment.get().view());
+ * @endcode
+ */
+inline std::future<mapped_file> async_read_file(std::string path) {
+    return io_pool::instance().submit([path = std::move(path)] {
+        return mapped_file(path.c_str(), true);
+    });
+}
+
+/**
+ * @brief The logical CPUs this process may run on, with their physical core and NUMA node,
+ * for pinning threads. Read from sysfs on Linux; elsewhere every hardware thread counts as a
+ * core of node 0.
+ */
+struct cpu_topology {
+    struct cpu {
+        unsigned index = 0;         // As in the affinity mask.
+        unsigned core = 0;          // Physical core, numbered from 0 across the packages.
+        unsigned node = 0;
+        bool primary = true;        // First hardware thread of its core; the others are SMT siblings.
+    };
+
+    std::vector<cpu> cpus;          // By node, then core, primary threads first.
+
+    static cpu_topology detect() {
+        auto result = cpu_topology();
+#if defined(__linux__)
+        auto allowed = cpu_set_t();
+        CPU_ZERO(&allowed);
+        auto const masked = ::sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+        auto const number = [](std::filesystem::path const& path) -> std::optional<unsigned> {
+            auto text = std::string();
+            auto file = std::ifstream(path);
+            std::getline(file, text);
+            auto value = 0u;
+            auto const [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+            return error == std::errc() ? std::optional(value) : std::nullopt;
+        };
+        auto cores = std::map<std::pair<unsigned, unsigned>, unsigned>();      // (package, core id) -> core.
+        auto error = std::error_code();
+        for (auto const& entry : std::filesystem::directory_iterator("/sys/devices/system/cpu", error)) {
+            auto const name = entry.path().filename().string();
+            auto index = 0u;
+            if (!name.starts_with("cpu") || std::from_chars(name.data() + 3, name.data() + name.size(), index).ptr != name.data() + name.size()) {
+                continue;
+            }
+            if (masked && (index >= CPU_SETSIZE || !CPU_ISSET(index, &allowed))) {
+                continue;
+            }
+            auto processor = cpu{ .index = index };
+            auto const package = number(entry.path() / "topology" / "physical_package_id").value_or(0);
+            auto const core_id = number(entry.path() / "topology" / "core_id").value_or(index);
+            processor.core = cores.try_emplace({ package, core_id }, static_cast<unsigned>(cores.size())).first->second;
+            for (auto const& link : std::filesystem::directory_iterator(entry.path(), error)) {
+                auto const node = link.path().filename().string();
+                if (node.starts_with("node")) {
+                    std::from_chars(node.data() + 4, node.data() + node.size(), processor.node);
+                }
+            }
+            result.cpus.push_back(processor);
+        }
+#endif
+        if (result.cpus.empty()) {
+            for (auto i = 0u; i < std::max(std::thread::hardware_concurrency(), 1u); ++i) {
+                result.cpus.push_back({ .index = i, .core = i });
+            }
+        }
+        std::ranges::sort(result.cpus, {}, [](cpu const& c) { return std::tuple(c.node, c.core, c.index); });
+        for (auto i = std::size_t(1); i < result.cpus.size(); ++i) {
+            result.cpus[i].primary = result.cpus[i].core != result.cpus[i - 1].core;
+        }
+        std::ranges::stable_sort(result.cpus, {}, [](cpu const& c) { return std::tuple(c.node, !c.primary); });
+        return result;
+    }
+
+    std::size_t core_count() const noexcept {
+        return static_cast<std::size_t>(std::ranges::count_if(cpus, &cpu::primary));
+    }
+
+    std::size_t node_count() const noexcept {
+        auto nodes = std::vector<unsigned>();
+        for (auto const& c : cpus) {
+            if (std::ranges::find(nodes, c.node) == nodes.end()) {
+                nodes.push_back(c.node);
+            }
+        }
+        return nodes.size();
+    }
+};
+
+/**
+ * @brief A work-stealing job system for the CPU work of a frame: culling, transforms,
+ * animation, decoding. Every worker has its own deques, one per priority lane; it pushes and
+ * pops its jobs at the back (the newest, still in cache) and, out of work, steals from the
+ * front of the others (the oldest, usually the biggest pieces), workers of its own NUMA node
+ * first. Frame jobs always go before normal ones. Background jobs (asset decoding, I/O) have
+ * their own workers, at a lower OS priority, so streaming never holds up a frame; without
+ * background workers the others run them when nothing else is queued. Workers can be pinned
+ * to physical cores, one each, leaving SMT siblings alone.
+ * Jobs submitted from other threads are dealt to the workers in turn. Dependencies go through
+ * counters: a job can signal one when it ends, or be a continuation that starts once another
+ * counter reaches zero. wait() runs jobs while it waits instead of blocking, so a job waiting
+ * on others can't starve the pool; it rethrows the first exception of the jobs it waited for.
+ * @code
+ *      auto& jobs = gl::states::jobs();
+ *      auto decoded = gltool::job_system::counter();
+ *      jobs.submit([&] { decode(file); }, &decoded, gltool::job_system::priority::BACKGROUND);
+ *      jobs.submit_after(decoded, [&] { build_mips(); });
+ *      jobs.parallel_for(0, count, [&](std::size_t first, std::size_t last) { cull(first, last); }, 256,
+ *                        gltool::job_system::priority::FRAME);
+ *      jobs.wait(decoded);
+ * @endcode
+ */
+class job_system {
+public:
+    struct priority {
+        enum type {
+            FRAME,          // Needed by the frame being built: culling, transforms, command recording.
+            NORMAL,
+            BACKGROUND      // Asset decoding and other streaming work, on the background workers.
+        };
+    };
+
+    /**
+     * @brief Jobs not finished yet, with the continuations to start when none are left. A
+     * counter can be reused once done; it must outlive its jobs, so wait() on it before it
+     * goes out of scope.
+     */
+    class counter {
+    public:
+        bool done() const noexcept {
+            return m_pending.load(std::memory_order_acquire) == 0;
+        }
+
+    private:
+        friend class job_system;
+
+        std::atomic<std::size_t> m_pending = 0;
+        std::mutex m_mutex;                     // Guards the members below.
+        std::vector<std::tuple<std::function<void ()>, counter*, priority::type>> m_continuations;
+        std::exception_ptr m_error;
+    };
+
+    struct settings {
+        unsigned workers            = 0;        // Frame and normal jobs; 0: one less than the cores (the physical ones with pin_threads).
+        unsigned background_workers = 0;        // 0: background jobs run on the workers, last.
+        bool     pin_threads        = false;    // Each worker on a core of its own, filling NUMA nodes in turn.
+        bool     skip_smt           = true;     // Pin to a single hardware thread per physical core.
+        int      background_nice    = 10;       // Added to the nice value of background workers (Linux).
+    };
+
+    /**
+     * @param workers Worker threads; by default one less than the cores, the calling thread
+     * being the last one when it waits.
+     */
+    explicit job_system(unsigned workers = std::max(std::thread::hardware_concurrency(), 2u) - 1)
+        : job_system(settings{ .workers = workers }) {}
+
+    explicit job_system(settings const& options)
+        : m_topology(cpu_topology::detect()) {
+
+        auto cpus = std::vector<cpu_topology::cpu>();
+        for (auto const& c : m_topology.cpus) {
+            if (c.primary || !options.skip_smt) {
+                cpus.push_back(c);
+            }
+        }
+        auto const pinned = options.pin_threads ? cpus.size() : m_topology.cpus.size();
+        auto const workers = std::max(options.workers != 0 ? options.workers : static_cast<unsigned>(pinned) - 1, 1u);
+        for (auto i = 0u; i < workers; ++i) {
+            m_queues.push_back(std::make_unique<queue>());
+            m_queues.back()->cpu = options.pin_threads && !cpus.empty() ? std::optional(cpus[i % cpus.size()]) : std::nullopt;
+        }
+        // Steal from the workers of the same node first, each starting after itself.
+        for (auto i = std::size_t(0); i < workers; ++i) {
+            auto const node_of = [this](std::size_t k) { return m_queues[k]->cpu ? m_queues[k]->cpu->node : 0u; };
+            for (auto k = std::size_t(1); k < workers; ++k) {
+                m_queues[i]->victims.push_back((i + k) % workers);
+            }
+            std::ranges::stable_partition(m_queues[i]->victims, [&](std::size_t k) { return node_of(k) == node_of(i); });
+        }
+        m_background_ct = options.background_workers;
+        for (auto i = 0u; i < workers; ++i) {
+            m_threads.emplace_back([this, i] { this->work(i); });
+        }
+        for (auto i = 0u; i < options.background_workers; ++i) {
+            m_threads.emplace_back([this, i, nice = options.background_nice] { this->work_background(m_queues.size() + i, nice); });
+        }
+    }
+
+    job_system(job_system const&) = delete;
+    job_system& operator =(job_system const&) = delete;
+
+    /**
+     * @brief Run the jobs still queued, then stop the workers.
+     */
+    ~job_system() {
+        {
+            auto const lock = std::scoped_lock(m_sleep_mutex);
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+        m_background_wake.notify_all();
+        m_threads.clear();
+    }
+
+    std::size_t worker_count() const noexcept {
+        return m_queues.size();
+    }
+
+    std::size_t background_worker_count() const noexcept {
+        return m_background_ct;
+    }
+
+    cpu_topology const& get_topology() const noexcept {
+        return m_topology;
+    }
+
+    /**
+     * @brief Queue a job; `signal`, if any, counts it until it has run.
+     */
+    void submit(std::function<void ()> function, counter* signal = nullptr, priority::type lane = priority::NORMAL) {
+        if (signal != nullptr) {
+            signal->m_pending.fetch_add(1, std::memory_order_relaxed);
+        }
+        this->enqueue({ std::move(function), signal, lane });
+    }
+
+    /**
+     * @brief Queue a job once every job counted by `dependency` has run (at once if none is
+     * left); `signal` counts it from now on.
+     */
+    void submit_after(counter& dependency, std::function<void ()> function, counter* signal = nullptr, priority::type lane = priority::NORMAL) {
+        if (signal != nullptr) {
+            signal->m_pending.fetch_add(1, std::memory_order_relaxed);
+        }
+        {
+            auto const lock = std::scoped_lock(dependency.m_mutex);
+            if (!dependency.done()) {
+                dependency.m_continuations.emplace_back(std::move(function), signal, lane);
+                return;
+            }
+        }
+        this->enqueue({ std::move(function), signal, lane });
+    }
+
+    /**
+     * @brief Run queued jobs until every job counted by `group` has run, then rethrow the
+     * first exception one of them threw. Background jobs are only run here on a background
+     * worker, or when there are none.
+     */
+    void wait(counter& group) {
+        auto const self = this->current_worker();
+        while (!group.done()) {
+            if (auto next = this->take(self)) {
+                this->execute(*next);
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+        auto error = std::exception_ptr();
+        {
+            auto const lock = std::scoped_lock(group.m_mutex);
+            error = std::exchange(group.m_error, nullptr);
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    /**
+     * @brief Call `function(first, last)` over [begin, end) split into chunks of at least
+     * `grain` indices, on the workers of the lane and the calling thread, and return when all
+     * are done.
+     */
+    template<typename F>
+        requires std::invocable<F&, std::size_t, std::size_t>
+    void parallel_for(std::size_t begin, std::size_t end, F&& function, std::size_t grain = 1, priority::type lane = priority::NORMAL) {
+        if (end <= begin) {
+            return;
+        }
+        auto const size = end - begin;
+        grain = std::max<std::size_t>(grain, 1);
+        auto const threads = lane == priority::BACKGROUND && m_background_ct > 0 ? m_background_ct : m_queues.size();
+        auto const chunk_ct = std::min((size + grain - 1) / grain, (threads + 1) * 4);     // A few per thread, to balance.
+        if (chunk_ct <= 1) {
+            function(begin, end);
+            return;
+        }
+        auto const chunk = (size + chunk_ct - 1) / chunk_ct;
+        auto group = counter();
+        for (auto first = begin + chunk; first < end; first += chunk) {
+            this->submit([&function, first, last = std::min(first + chunk, end)] { function(first, last); }, &group, lane);
+        }
+        auto error = std::exception_ptr();
+        try {
+            function(begin, begin + chunk);
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+        this->wait(group);          // The other chunks refer to `function` either way.
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    struct job {
+        std::function<void ()> function;
+        counter* signal = nullptr;
+        priority::type lane = priority::NORMAL;
+    };
+
+    struct queue {
+        std::mutex mutex;
+        std::array<std::deque<job>, priority::BACKGROUND> lanes;    // Frame and normal jobs.
+        std::optional<cpu_topology::cpu> cpu;                       // Where the worker is pinned.
+        std::vector<std::size_t> victims;                           // Order to steal in.
+    };
+
+    static constexpr auto k_not_a_worker = ~std::size_t(0);
+
+    /**
+     * @brief The index of this thread among the workers of this system, if it is one; the
+     * background workers come after the others.
+     */
+    std::size_t current_worker() const noexcept {
+        return t_owner == this ? t_index : k_not_a_worker;
+    }
+
+    bool has_work(bool background) const noexcept {
+        return m_queued[priority::FRAME].load(std::memory_order_acquire) > 0 || m_queued[priority::NORMAL].load(std::memory_order_acquire) > 0
+            || (background && m_background_queued.load(std::memory_order_acquire) > 0);
+    }
+
+    void enqueue(job next) {
+        if (next.lane == priority::BACKGROUND) {
+            {
+                auto const lock = std::scoped_lock(m_background.mutex);
+                m_background.lanes[0].push_back(std::move(next));
+            }
+            m_background_queued.fetch_add(1, std::memory_order_release);
+            {
+                auto const lock = std::scoped_lock(m_sleep_mutex);
+            }
+            (m_background_ct > 0 ? m_background_wake : m_wake).notify_one();
+            return;
+        }
+        auto const self = this->current_worker();
+        auto const index = self < m_queues.size() ? self : m_next.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+        auto const lane = next.lane;
+        {
+            auto const lock = std::scoped_lock(m_queues[index]->mutex);
+            m_queues[index]->lanes[lane].push_back(std::move(next));
+        }
+        m_queued[lane].fetch_add(1, std::memory_order_release);
+        {
+            auto const lock = std::scoped_lock(m_sleep_mutex);     // A worker between its check and its wait sees the job.
+        }
+        m_wake.notify_one();
+    }
+
+    /**
+     * @brief By lane, the newest job of this worker's deque or else the oldest of another;
+     * then a background job if this thread may run one.
+     */
+    std::optional<job> take(std::size_t self) {
+        auto const background = self == k_not_a_worker || self < m_queues.size() ? m_background_ct == 0 : true;
+        if (self == k_not_a_worker || self < m_queues.size()) {
+            for (auto const lane : { priority::FRAME, priority::NORMAL }) {
+                if (m_queued[lane].load(std::memory_order_acquire) == 0) {
+                    continue;
+                }
+                if (self != k_not_a_worker) {
+                    auto& own = *m_queues[self];
+                    auto const lock = std::scoped_lock(own.mutex);
+                    if (!own.lanes[lane].empty()) {
+                        auto result = std::move(own.lanes[lane].back());
+                        own.lanes[lane].pop_back();
+                        m_queued[lane].fetch_sub(1, std::memory_order_relaxed);
+                        return result;
+                    }
+                }
+                auto const start = m_next.load(std::memory_order_relaxed);
+                for (auto i = std::size_t(0); i < m_queues.size(); ++i) {
+                    auto const victim = self != k_not_a_worker ? (i < m_queues[self]->victims.size() ? m_queues[self]->victims[i] : self)
+                                                               : (start + i) % m_queues.size();
+                    if (auto result = this->steal(*m_queues[victim], lane)) {
+                        return result;
+                    }
+                }
+            }
+        }
+        if (background && m_background_queued.load(std::memory_order_acquire) > 0) {
+            if (auto result = this->steal(m_background, 0)) {
+                m_background_queued.fetch_sub(1, std::memory_order_relaxed);
+                return result;
+            }
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * @brief The oldest job of a lane of another deque.
+     */
+    std::optional<job> steal(queue& other, std::size_t lane) {
+        auto const lock = std::scoped_lock(other.mutex);
+        if (other.lanes[lane].empty()) {
+            return std::nullopt;
+        }
+        auto result = std::move(other.lanes[lane].front());
+        other.lanes[lane].pop_front();
+        if (&other != &m_background) {
+            m_queued[lane].fetch_sub(1, std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+    void execute(job& current) {
+        auto error = std::exception_ptr();
+        try {
+            current.function();
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+        auto* const signal = current.signal;
+        if (signal == nullptr) {
+            return;
+        }
+        if (error) {
+            auto const lock = std::scoped_lock(signal->m_mutex);
+            if (!signal->m_error) {
+                signal->m_error = error;
+            }
+        }
+        // Under the lock: wait() takes it after the counter reads done, before the counter may go.
+        auto continuations = std::vector<std::tuple<std::function<void ()>, counter*, priority::type>>();
+        {
+            auto const lock = std::scoped_lock(signal->m_mutex);
+            if (signal->m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                continuations.swap(signal->m_continuations);
+            }
+        }
+        for (auto& [function, next, lane] : continuations) {
+            this->enqueue({ std::move(function), next, lane });
+        }
+    }
+
+    /**
+     * @brief Pin the calling thread to a logical CPU, where the platform allows.
+     */
+    static void pin_current_thread([[maybe_unused]] cpu_topology::cpu const& where) noexcept {
+#if defined(__linux__)
+        auto set = cpu_set_t();
+        CPU_ZERO(&set);
+        CPU_SET(where.index, &set);
+        ::sched_setaffinity(0, sizeof(set), &set);
+#endif
+    }
+
+    void work(std::size_t index) {
+        t_owner = this;
+        t_index = index;
+        if (m_queues[index]->cpu) {
+            pin_current_thread(*m_queues[index]->cpu);
+        }
+        while (true) {
+            if (auto next = this->take(index)) {
+                this->execute(*next);
+                continue;
+            }
+            auto lock = std::unique_lock(m_sleep_mutex);
+            m_wake.wait(lock, [this] { return m_stopping || this->has_work(m_background_ct == 0); });
+            if (m_stopping && !this->has_work(m_background_ct == 0)) {
+                return;
+            }
+        }
+    }
+
+    void work_background(std::size_t index, [[maybe_unused]] int nice) {
+        t_owner = this;
+        t_index = index;
+#if defined(__linux__)
+        ::setpriority(PRIO_PROCESS, 0, ::getpriority(PRIO_PROCESS, 0) + nice);     // Linux: this thread only.
+#endif
+        while (true) {
+            if (auto next = this->take(index)) {
+                this->execute(*next);
+                continue;
+            }
+            auto lock = std::unique_lock(m_sleep_mutex);
+            m_background_wake.wait(lock, [this] { return m_stopping || m_background_queued.load(std::memory_order_acquire) > 0; });
+            if (m_stopping && m_background_queued.load(std::memory_order_acquire) == 0) {
+                return;
+            }
+        }
+    }
+
+    static inline thread_local job_system const* t_owner = nullptr;
+    static inline thread_local std::size_t t_index = 0;
+
+    cpu_topology m_topology;
+    std::vector<std::unique_ptr<queue>> m_queues;
+    queue m_background;                                 // The first lane holds the background jobs.
+    std::size_t m_background_ct = 0;
+    std::array<std::atomic<std::size_t>, priority::BACKGROUND> m_queued = {};     // Jobs in all the deques, by lane.
+    std::atomic<std::size_t> m_background_queued = 0;
+    std::atomic<std::size_t> m_next = 0;            // Deque of the next job from outside.
+    std::mutex m_sleep_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_background_wake;
+    bool m_stopping = false;
+    std::vector<std::jthread> m_threads;            // Declared last: joined before the deques go away.
+};
+
+/**
+ * @brief Epoch-based reclamation for data one thread publishes and any thread reads: readers
+ * pin() the current epoch for as long as they hold pointers to published data, which takes a
+ * compare-exchange on a slot of their own, lock-free; the writer retires what it replaced, and collect() reclaims it
+ * once no reader pinned before the replacement is still pinned. Meant for read-mostly tables
+ * swapped now and then, e.g. once per frame.
+ * @code
+ *      auto const pinned = domain.pin();
+ *      auto const* const table = published.load();        // Valid until `pinned` goes.
+ *      // The writer:
+ *      domain.retire([old = published.exchange(replacement)] { delete old; });
+ *      domain.collect();
+ * @endcode
+ */
+class epoch_domain {
+public:
+    static constexpr std::size_t k_max_readers = 128;      // Pinned at once.
+
+    /**
+     * @brief A pinned epoch; readers keep it while they use published data.
+     */
+    class guard {
+    public:
+        guard(guard const&) = delete;
+        guard& operator =(guard const&) = delete;
+
+        guard(guard&& other) noexcept
+            : m_slot(std::exchange(other.m_slot, nullptr)) {}
+
+        ~guard() {
+            if (m_slot != nullptr) {
+                m_slot->store(0, std::memory_order_release);
+            }
+        }
+
+    private:
+        friend class epoch_domain;
+
+        explicit guard(std::atomic<std::uint64_t>* slot) noexcept
+            : m_slot(slot) {}
+
+        std::atomic<std::uint64_t>* m_slot;
+    };
+
+    epoch_domain() = default;
+    epoch_domain(epoch_domain const&) = delete;
+    epoch_domain& operator =(epoch_domain const&) = delete;
+
+    /**
+     * @brief Reclaim everything still retired: no reader may be pinned any more.
+     */
+    ~epoch_domain() {
+        for (auto& [epoch, reclaim] : m_retired) {
+            reclaim();
+        }
+    }
+
+    /**
+     * @brief Pin the current epoch, from any thread; loads of published data must come after.
+     */
+    guard pin() noexcept {
+        auto const start = std::hash<std::thread::id>()(std::this_thread::get_id());
+        while (true) {
+            for (auto i = std::size_t(0); i < k_max_readers; ++i) {
+                auto& slot = m_slots[(start + i) % k_max_readers];
+                auto expected = std::uint64_t(0);
+                auto const current = m_epoch.load(std::memory_order_seq_cst);
+                if (slot.epoch.compare_exchange_strong(expected, current, std::memory_order_seq_cst)) {
+                    return guard(&slot.epoch);
+                }
+            }
+            std::this_thread::yield();      // More readers than slots: wait for one to leave.
+        }
+    }
+
+    /**
+     * @brief Run `reclaim` once no reader pinned now is left; the data it frees must be
+     * unpublished already. Writer only.
+     */
+    void retire(std::function<void ()> reclaim) {
+        m_retired.emplace_back(m_epoch.fetch_add(1, std::memory_order_seq_cst), std::move(reclaim));
+    }
+
+    /**
+     * @brief Reclaim what no pinned reader may still see. Writer only.
+     * @return How many were reclaimed.
+     */
+    std::size_t collect() {
+        auto oldest = std::numeric_limits<std::uint64_t>::max();
+        for (auto const& slot : m_slots) {
+            if (auto const epoch = slot.epoch.load(std::memory_order_seq_cst); epoch != 0) {
+                oldest = std::min(oldest, epoch);
+            }
+        }
+        auto const expired = std::ranges::partition(m_retired, [oldest](auto const& retired) { return retired.first >= oldest; });
+        auto const count = static_cast<std::size_t>(std::ranges::distance(expired));
+        for (auto& [epoch, reclaim] : expired) {
+            reclaim();
+        }
+        m_retired.erase(expired.begin(), expired.end());
+        return count;
+    }
+
+    /**
+     * @brief Retired and not reclaimed yet.
+     */
+    std::size_t pending() const noexcept {
+        return m_retired.size();
+    }
+
+private:
+    struct alignas(64) slot {           // One per cache line: readers do not share lines.
+        std::atomic<std::uint64_t> epoch = 0;           // 0 while free.
+    };
+
+    std::atomic<std::uint64_t>                                    m_epoch = 1;
+    std::array<slot, k_max_readers>                               m_slots;
+    std::vector<std::pair<std::uint64_t, std::function<void ()>>> m_retired;    // With the epoch they were retired in.
+};
+
+/**
+ * @brief Watches files for modification on a background thread. Changes are collected and
+ * handed out by take_changes(), so the owner decides when to react (e.g. between frames).
+ * Uses inotify on Linux, where the parent directories are watched so that editors saving
+ * through a rename are noticed too; elsewhere the modification times are polled.
+ */
+class file_watcher {
+public:
+    using path_t = std::filesystem::path;
+
+    explicit file_watcher(std::chrono::milliseconds period = std::chrono::milliseconds(200)) {
+#if defined(M_HAS_INOTIFY)
+        m_fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (m_fd < 0) {
+            throw std::runtime_error("Could not initialize inotify");
+        }
+#endif
+        m_thread = std::jthread([this, period](std::stop_token token) {
+            while (!token.stop_requested()) {
+                this->scan(period);
+            }
+        });
+    }
+
+    file_watcher(file_watcher const&) = delete;
+
+    file_watcher& operator =(file_watcher const&) = delete;
+
+    ~file_watcher() {
+        m_thread.request_stop();
+        m_thread.join();
+#if defined(M_HAS_INOTIFY)
+        ::close(m_fd);
+#endif
+    }
+
+    /**
+     * @brief Start watching a file. Watching the same file twice has no effect.
+     */
+    void add(path_t const& path) {
+        auto const key = key_of(path);
+        auto lock = std::scoped_lock(m_mutex);
+        if (m_files.contains(key)) {
+            return;
+        }
+        auto error = std::error_code();
+        m_files.emplace(key, std::filesystem::last_write_time(key, error));
+#if defined(M_HAS_INOTIFY)
+        auto const directory = key.parent_path();
+        if (std::ranges::find(m_directories, directory, &std::pair<int, path_t>::second) == m_directories.end()) {
+            auto const wd = ::inotify_add_watch(m_fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+            if (wd >= 0) {
+                m_directories.emplace_back(wd, directory);
+            }
+        }
+#endif
+    }
+
+    /**
+     * @brief The watched files modified since the last call (normalized absolute paths).
+     */
+    std::vector<path_t> take_changes() {
+        auto lock = std::scoped_lock(m_mutex);
+        auto result = std::vector<path_t>(m_changes.begin(), m_changes.end());
+        m_changes.clear();
+        return result;
+    }
+
+    static path_t key_of(path_t const& path) {
+        auto error = std::error_code();
+        return std::filesystem::absolute(path, error).lexically_normal();
+    }
+
+private:
+    struct path_hash {
+        std::size_t operator ()(path_t const& path) const noexcept {
+            return std::filesystem::hash_value(path);
+        }
+    };
+
+    void scan(std::chrono::milliseconds period) {
+#if defined(M_HAS_INOTIFY)
+        auto descriptor = ::pollfd { .fd = m_fd, .events = POLLIN, .revents = 0 };
+        if (::poll(&descriptor, 1, static_cast<int>(period.count())) <= 0) {
+            return;
+        }
+        alignas(::inotify_event) char buffer[4096];
+        auto length = ::ssize_t(0);
+        while ((length = ::read(m_fd, buffer, sizeof buffer)) > 0) {
+            auto lock = std::scoped_lock(m_mutex);
+            for (auto* cursor = buffer; cursor < buffer + length; ) {
+                auto const* const event = reinterpret_cast<::inotify_event const*>(cursor);
+                cursor += sizeof(::inotify_event) + event->len;
+                auto const directory = std::ranges::find(m_directories, event->wd, &std::pair<int, path_t>::first);
+                if (directory == m_directories.end() || event->len == 0) {
+                    continue;
+                }
+                auto const path = directory->second / event->name;
+                if (m_files.contains(path)) {
+                    m_changes.insert(path);
+                }
+            }
+        }
+#else
+        std::this_thread::sleep_for(period);
+        auto lock = std::scoped_lock(m_mutex);
+        for (auto& [path, time] : m_files) {
+            auto error = std::error_code();
+            auto const current = std::filesystem::last_write_time(path, error);
+            if (!error && current != time) {
+                time = current;
+                m_changes.insert(path);
+            }
+        }
+#endif
+    }
+
+    std::mutex m_mutex;
+    std::unordered_map<path_t, std::filesystem::file_time_type, path_hash> m_files;
+    std::unordered_set<path_t, path_hash> m_changes;
+#if defined(M_HAS_INOTIFY)
+    int m_fd = -1;
+    std::vector<std::pair<int, path_t>> m_directories;
+#endif
+    std::jthread m_thread;      // Declared last: started once the members above exist.
+};
+
+/**
+ * @brief The class of a pointer to member: `logger` for `&logger::indent`.
+ */
+template<typename>
+struct member_class;
+
+template<typename R, typename C>
+struct member_class<R C::*> {
+    using type = C;
+};
+
+template<typename M>
+using member_class_t = typename member_class<M>::type;
+
+/**
+ * @brief Scope guard that calls a member function now and its counterpart at the end of the
+ * scope. Both member functions are template arguments and the arguments are stored by value,
+ * so the guard is a reference plus a tuple and both calls inline. The class defaults to the
+ * one of `Do`; it and the argument types only need spelling out for arguments.
+ * @code
+ *      auto guard = gltool::scoped_call<&logger::indent, &logger::unindent>(LOG);
+ * @endcode
+ */
+template<auto Do, auto Undo, typename T = member_class_t<decltype(Do)>, typename... Args>
+class [[nodiscard]] scoped_call {
+public:
+    template<typename... Ts>
+    explicit scoped_call(T& object, Ts&&... args)
+        : m_object(object),
+          m_args(std::forward<Ts>(args)...) {
+
+        std::apply([this](auto const&... args) { (m_object.*Do)(args...); }, m_args);
+    }
+
+    scoped_call(scoped_call const&) = delete;
+    scoped_call& operator =(scoped_call const&) = delete;
+
+    ~scoped_call() {
+        std::apply([this](auto const&... args) { (m_object.*Undo)(args...); }, m_args);
     }
 
-    std::function<void ()> m_undo_function;
+private:
+    T& m_object;
+    [[no_unique_address]] std::tuple<Args...> m_args;
+};
+
+/**
+ * @brief Same as scoped_call, for member functions only known at run time. The pointers are
+ * stored in the guard itself (no type erasure, no allocation).
+ */
+template<typename T, typename F, typename... Args>
+class [[nodiscard]] scoped_operation {
+public:
+    template<typename... Ts>
+    scoped_operation(T& object, F do_something, F undo_something, Ts&&... args)
+        : m_object(object),
+          m_undo(undo_something),
+          m_args(std::forward<Ts>(args)...) {
+
+        std::apply([this, do_something](auto const&... args) { (m_object.*do_something)(args...); }, m_args);
+    }
+
+    scoped_operation(scoped_operation const&) = delete;
+    scoped_operation& operator =(scoped_operation const&) = delete;
+
+    ~scoped_operation() {
+        std::apply([this](auto const&... args) { (m_object.*m_undo)(args...); }, m_args);
+    }
+
+private:
+    T& m_object;
+    F m_undo;
+    [[no_unique_address]] std::tuple<Args...> m_args;
+};
+
+template<typename T, typename F, typename... Ts>
+scoped_operation(T&, F, F, Ts&&...) -> scoped_operation<T, F, std::decay_t<Ts>...>;
+
+/**
+ * @brief Holds a loop to a target rate. OS sleeps overshoot by up to a scheduler tick, so
+ * wait() sleeps until `spin` before the deadline and spins (yielding) the rest of the way.
+ * The deadlines advance by whole periods, so the rate does not drift with the overshoot;
+ * after a hitch longer than a period the schedule restarts instead of catching up.
+ * @code
+ *      auto limiter = gltool::frame_limiter(144.0);
+ *      while (running) {
+ *          draw();
+ *          limiter.wait();
+ *      }
+ * @endcode
+ */
+class frame_limiter {
+public:
+    using clock = std::chrono::steady_clock;
+
+    /**
+     * @param rate Frames per second; 0 or less does not limit.
+     * @param spin How long before the deadline to stop sleeping.
+     */
+    explicit frame_limiter(double rate = 0.0, clock::duration spin = std::chrono::microseconds(1500)) noexcept
+        : m_spin(spin) {
+        this->set_rate(rate);
+    }
+
+    void set_rate(double rate) noexcept {
+        m_period = rate > 0.0 ? std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / rate))
+                              : clock::duration::zero();
+        m_deadline = clock::time_point();
+    }
+
+    double get_rate() const noexcept {
+        return m_period > clock::duration::zero() ? 1.0 / std::chrono::duration<double>(m_period).count() : 0.0;
+    }
+
+    /**
+     * @brief Block until the next frame is due; returns at once without a rate.
+     */
+    void wait() {
+        if (m_period == clock::duration::zero()) {
+            return;
+        }
+        auto now = clock::now();
+        if (m_deadline == clock::time_point() || now - m_deadline > m_period) {
+            m_deadline = now + m_period;        // First frame, or too late to keep the schedule.
+            return;
+        }
+        if (m_deadline - now > m_spin) {
+            std::this_thread::sleep_until(m_deadline - m_spin);
+        }
+        while (clock::now() < m_deadline) {
+            std::this_thread::yield();
+        }
+        m_deadline += m_period;
+    }
+
+private:
+    clock::duration m_period = clock::duration::zero();
+    clock::duration m_spin;
+    clock::time_point m_deadline;
+};
+
+/**
+ * @brief What the platform tells about power and heat, for the frame rate to back off before
+ * the firmware throttles: whether the device runs on battery, the charge left and the hottest
+ * thermal zone. Read from sysfs on Linux (power_supply and thermal classes); elsewhere, and
+ * for whatever the machine does not report, the fields stay empty and the device counts as
+ * plugged in and cool.
+ */
+struct power_status {
+    bool                 on_battery  = false;
+    std::optional<float> charge;                // Of the batteries, in [0, 1].
+    std::optional<float> temperature;           // Of the hottest thermal zone, in degrees Celsius.
+
+    /**
+     * @brief Read the current status; a few small file reads, so poll it every second or so,
+     * not every frame.
+     */
+    static power_status read() {
+        auto result = power_status();
+#if defined(__linux__)
+        auto const value = [](std::filesystem::path const& path) {
+            auto text = std::string();
+            auto file = std::ifstream(path);
+            std::getline(file, text);
+            return text;
+        };
+        auto const number = [&value](std::filesystem::path const& path) -> std::optional<double> {
+            auto const text = value(path);
+            auto parsed = 0.0;
+            auto const [end, error] = std::from_chars(text.data(), text.data() + text.size(), parsed);
+            return error == std::errc() ? std::optional(parsed) : std::nullopt;
+        };
+        auto error = std::error_code();
+        auto mains = false;
+        auto batteries = false;
+        auto charges = std::vector<double>();
+        for (auto const& supply : std::filesystem::directory_iterator("/sys/class/power_supply", error)) {
+            auto const type = value(supply.path() / "type");
+            if (type == "Mains" || type == "USB") {
+                mains |= number(supply.path() / "online").value_or(0.0) > 0.0;
+            }
+            else if (type == "Battery") {
+                batteries = true;
+                if (auto const capacity = number(supply.path() / "capacity")) {
+                    charges.push_back(*capacity / 100.0);
+                }
+            }
+        }
+        result.on_battery = batteries && !mains;
+        if (!charges.empty()) {
+            result.charge = static_cast<float>(std::accumulate(charges.begin(), charges.end(), 0.0) / static_cast<double>(charges.size()));
+        }
+        for (auto const& zone : std::filesystem::directory_iterator("/sys/class/thermal", error)) {
+            if (!zone.path().filename().string().starts_with("thermal_zone")) {
+                continue;
+            }
+            if (auto const millidegrees = number(zone.path() / "temp"); millidegrees && *millidegrees > 0.0) {
+                auto const celsius = static_cast<float>(*millidegrees / 1000.0);
+                result.temperature = std::max(result.temperature.value_or(celsius), celsius);
+            }
+        }
+#endif
+        return result;
+    }
+};
+
+/**
+ * @brief Fixed simulation steps out of variable frame times. The time not yet simulated is
+ * kept in integer clock ticks, so a kiosk running for weeks steps exactly as on the first
+ * day and no fraction of a step is lost; a long hitch runs at most `max_steps` steps, and
+ * drops the rest instead of spiralling into ever longer frames.
+ * @code
+ *      auto timestep = gltool::fixed_timestep(120.0);
+ *      for (auto steps = timestep.advance(frame_seconds); steps > 0; --steps) {
+ *          world.step(timestep.step());
+ *      }
+ *      world.draw(timestep.alpha());           // Between the last two steps.
+ * @endcode
+ */
+class fixed_timestep {
+public:
+    using clock = std::chrono::steady_clock;
+
+    static constexpr std::uint32_t k_default_max_steps = 8;
+
+    explicit fixed_timestep(double rate = 60.0, std::uint32_t max_steps = k_default_max_steps) noexcept {
+        this->set_rate(rate);
+        this->set_max_steps(max_steps);
+    }
+
+    /**
+     * @brief Steps per second; the time already accumulated is kept.
+     */
+    void set_rate(double rate) noexcept {
+        auto const period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / std::max(rate, 1e-3)));
+        m_step = std::max(period, clock::duration(1));
+    }
+
+    double get_rate() const noexcept {
+        return 1.0 / this->step();
+    }
+
+    /**
+     * @brief Most steps run by one advance(); the rest of a long hitch is dropped.
+     */
+    void set_max_steps(std::uint32_t steps) noexcept {
+        m_max_steps = std::max(steps, 1u);
+    }
+
+    std::uint32_t get_max_steps() const noexcept {
+        return m_max_steps;
+    }
+
+    /**
+     * @brief Add the time of a frame; returns how many steps it completes.
+     */
+    std::uint32_t advance(clock::duration elapsed) noexcept {
+        m_accumulator += std::max(elapsed, clock::duration::zero());
+        auto steps = static_cast<std::uint64_t>(m_accumulator / m_step);
+        if (steps > m_max_steps) {
+            m_dropped += steps - m_max_steps;
+            steps = m_max_steps;
+            m_accumulator %= m_step;
+        }
+        else {
+            m_accumulator -= m_step * static_cast<clock::rep>(steps);
+        }
+        m_ticks += steps;
+        return static_cast<std::uint32_t>(steps);
+    }
+
+    std::uint32_t advance(double seconds) noexcept {
+        return this->advance(std::chrono::round<clock::duration>(std::chrono::duration<double>(seconds)));
+    }
+
+    /**
+     * @brief The length of a step, in seconds.
+     */
+    double step() const noexcept {
+        return std::chrono::duration<double>(m_step).count();
+    }
+
+    /**
+     * @brief How far the time is between the last step and the next one, in [0, 1): what to
+     * interpolate the last two simulated states by for rendering.
+     */
+    double alpha() const noexcept {
+        return static_cast<double>(m_accumulator.count()) / static_cast<double>(m_step.count());
+    }
+
+    /**
+     * @brief Steps run since creation.
+     */
+    std::uint64_t ticks() const noexcept {
+        return m_ticks;
+    }
+
+    /**
+     * @brief Steps dropped by the catch-up limit since creation.
+     */
+    std::uint64_t dropped() const noexcept {
+        return m_dropped;
+    }
+
+private:
+    clock::duration m_step = clock::duration(1);
+    clock::duration m_accumulator = clock::duration::zero();
+    std::uint32_t m_max_steps = k_default_max_steps;
+    std::uint64_t m_ticks = 0;
+    std::uint64_t m_dropped = 0;
+};
+
+/**
+ * @brief Bump allocator for data that lives one frame: allocating moves a pointer, freeing does
+ * nothing, and reset() takes everything back at once. When a frame outgrows the first block,
+ * the next reset() replaces the blocks with one of their total size, so a steady workload
+ * stops allocating after its first frames. A std::pmr::memory_resource, for pmr containers.
+ * Not thread safe: one arena per thread, see frame_allocator.
+ * @code
+ *      auto arena = gltool::linear_arena();
+ *      auto visible = std::pmr::vector<std::uint32_t>(&arena);
+ *      cull(visible);
+ *      arena.reset();                      // Once nothing points into the frame's memory.
+ * @endcode
+ */
+class linear_arena : public std::pmr::memory_resource {
+public:
+    static constexpr std::size_t k_default_capacity = std::size_t(1) << 16;
+
+    explicit linear_arena(std::size_t capacity = k_default_capacity) {
+        this->grow(capacity);
+    }
+
+    linear_arena(linear_arena const&) = delete;
+    linear_arena& operator=(linear_arena const&) = delete;
+
+    /**
+     * @brief Release every allocation of the frame; the memory behind them stays for the next.
+     */
+    void reset() {
+        m_peak = std::max(m_peak, this->used());
+        if (m_blocks.size() > 1) {
+            auto const total = this->capacity();
+            m_blocks.clear();
+            this->grow(total);
+        }
+        m_current = 0;
+        m_offset = 0;
+        m_used = 0;
+    }
+
+    /**
+     * @brief Bytes handed out since the last reset(), alignment padding included.
+     */
+    std::size_t used() const noexcept {
+        return m_used + m_offset;
+    }
+
+    std::size_t capacity() const noexcept {
+        auto total = std::size_t(0);
+        for (auto const& item : m_blocks) {
+            total += item.size;
+        }
+        return total;
+    }
+
+    /**
+     * @brief The most bytes a frame has used.
+     */
+    std::size_t peak() const noexcept {
+        return std::max(m_peak, this->used());
+    }
+
+private:
+    struct block {
+        std::unique_ptr<std::byte[]> data;
+        std::size_t size;
+    };
+
+    void grow(std::size_t size) {
+        m_blocks.push_back({ std::make_unique_for_overwrite<std::byte[]>(size), size });
+    }
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        while (true) {
+            auto& current = m_blocks[m_current];
+            auto const base = reinterpret_cast<std::uintptr_t>(current.data.get());
+            auto const at = ((base + m_offset + alignment - 1) & ~(alignment - 1)) - base;
+            if (at + bytes <= current.size) {
+                m_offset = at + bytes;
+                return current.data.get() + at;
+            }
+            m_used += m_offset;
+            m_offset = 0;
+            if (++m_current == m_blocks.size()) {
+                this->grow(std::max(current.size * 2, bytes + alignment));
+            }
+        }
+    }
+
+    void do_deallocate(void*, std::size_t, std::size_t) override {}
+
+    bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::vector<block> m_blocks;
+    std::size_t m_current = 0;      // Block allocated from.
+    std::size_t m_offset = 0;       // Into the current block.
+    std::size_t m_used = 0;         // In the blocks before it.
+    std::size_t m_peak = 0;
+};
+
+/**
+ * @brief One linear_arena per thread, reset together at the end of a frame: the render thread
+ * and the job workers each bump their own pointer, with no lock after a thread's first local().
+ * reset() must not run while a thread still uses its frame's memory.
+ * @code
+ *      jobs.parallel_for(0, objects.size(), [&](std::size_t first, std::size_t last) {
+ *          auto visible = std::pmr::vector<std::uint32_t>(&frame_memory.local());
+ *          ...
+ *      });
+ *      frame_memory.reset();               // After the frame, e.g. by gl::application.
+ * @endcode
+ */
+class frame_allocator {
+public:
+    explicit frame_allocator(std::size_t capacity = linear_arena::k_default_capacity) noexcept
+        : m_capacity(capacity) {}
+
+    frame_allocator(frame_allocator const&) = delete;
+    frame_allocator& operator=(frame_allocator const&) = delete;
+
+    /**
+     * @brief The arena of the calling thread, created on its first call.
+     */
+    linear_arena& local() {
+        thread_local auto cache = std::pair<std::uint64_t, linear_arena*>(0, nullptr);
+        if (cache.first == m_id) {
+            return *cache.second;
+        }
+        auto const lock = std::scoped_lock(m_mutex);
+        auto& arena = m_arenas[std::this_thread::get_id()];
+        if (!arena) {
+            arena = std::make_unique<linear_arena>(m_capacity);
+        }
+        cache = { m_id, arena.get() };
+        return *arena;
+    }
+
+    void reset() {
+        auto const lock = std::scoped_lock(m_mutex);
+        for (auto& [thread, arena] : m_arenas) {
+            arena->reset();
+        }
+    }
+
+    /**
+     * @brief Bytes of all the arenas, and the sum of the most each thread used in a frame.
+     */
+    std::size_t capacity() const {
+        auto const lock = std::scoped_lock(m_mutex);
+        auto total = std::size_t(0);
+        for (auto const& [thread, arena] : m_arenas) {
+            total += arena->capacity();
+        }
+        return total;
+    }
+
+    std::size_t peak() const {
+        auto const lock = std::scoped_lock(m_mutex);
+        auto total = std::size_t(0);
+        for (auto const& [thread, arena] : m_arenas) {
+            total += arena->peak();
+        }
+        return total;
+    }
+
+private:
+    static std::uint64_t next_id() noexcept {
+        static auto s_id = std::atomic<std::uint64_t>(0);
+        return ++s_id;
+    }
+
+    std::uint64_t m_id = next_id();     // Tells the thread caches of instances apart.
+    std::size_t m_capacity;
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::thread::id, std::unique_ptr<linear_arena>> m_arenas;
+};
+
+/**
+ * @brief A std::pmr::memory_resource that counts what goes through it to its upstream: the
+ * bytes live and at most, and the allocations made and freed. Put one in front of a pool to
+ * see what one owner keeps, e.g. the records of each resource type of gl::resource_manager.
+ * Thread safe if the upstream is.
+ * @code
+ *      auto tracked = gltool::tracking_resource(&pool);
+ *      auto names = std::pmr::vector<std::pmr::string>(&tracked);
+ *      std::cout << tracked.get_statistics().bytes << " bytes live\n";
+ * @endcode
+ */
+class tracking_resource : public std::pmr::memory_resource {
+public:
+    struct statistics {
+        std::size_t   bytes         = 0;        // Live.
+        std::size_t   peak          = 0;
+        std::uint64_t allocations   = 0;
+        std::uint64_t deallocations = 0;
+    };
+
+    explicit tracking_resource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource()) noexcept
+        : m_upstream(upstream) {}
+
+    tracking_resource(tracking_resource const&) = delete;
+    tracking_resource& operator=(tracking_resource const&) = delete;
+
+    std::pmr::memory_resource* upstream() const noexcept {
+        return m_upstream;
+    }
+
+    statistics get_statistics() const noexcept {
+        return { m_bytes.load(std::memory_order_relaxed), m_peak.load(std::memory_order_relaxed),
+                 m_allocations.load(std::memory_order_relaxed), m_deallocations.load(std::memory_order_relaxed) };
+    }
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        auto* const result = m_upstream->allocate(bytes, alignment);
+        m_allocations.fetch_add(1, std::memory_order_relaxed);
+        auto const live = m_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        auto peak = m_peak.load(std::memory_order_relaxed);
+        while (live > peak && !m_peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+        return result;
+    }
+
+    void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override {
+        m_upstream->deallocate(pointer, bytes, alignment);
+        m_deallocations.fetch_add(1, std::memory_order_relaxed);
+        m_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::pmr::memory_resource* m_upstream;
+    std::atomic<std::size_t> m_bytes = 0;
+    std::atomic<std::size_t> m_peak = 0;
+    std::atomic<std::uint64_t> m_allocations = 0;
+    std::atomic<std::uint64_t> m_deallocations = 0;
+};
+
+/**
+ * @brief Bounded lock-free queue for one producer thread and one consumer thread. The two
+ * indices only grow, each written by one side; their difference is the fill level, and the
+ * capacity is a power of two so that a slot is an index masked.
+ * @code
+ *      auto events = gltool::spsc_queue<event, 256>();
+ *      events.try_push(e);                 // Producer; false when full.
+ *      while (auto const next = events.try_pop()) {
+ *          handle(*next);                  // Consumer.
+ *      }
+ * @endcode
+ */
+template<typename T, std::size_t Capacity>
+class spsc_queue {
+    static_assert(std::has_single_bit(Capacity), "The capacity must be a power of two");
+public:
+    bool try_push(T const& value) noexcept(std::is_nothrow_copy_assignable_v<T>) {
+        auto const tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        m_slots[tail & (Capacity - 1)] = value;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::optional<T> try_pop() noexcept(std::is_nothrow_copy_constructible_v<T>) {
+        auto const head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) {
+            return std::nullopt;
+        }
+        auto result = std::optional<T>(m_slots[head & (Capacity - 1)]);
+        m_head.store(head + 1, std::memory_order_release);
+        return result;
+    }
+
+    /**
+     * @brief Same, into `value`: a large T is copied once instead of through an optional.
+     */
+    bool try_pop(T& value) noexcept(std::is_nothrow_copy_assignable_v<T>) {
+        auto const head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = m_slots[head & (Capacity - 1)];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Exact on either side for the other side's past; a snapshot otherwise.
+     */
+    std::size_t size() const noexcept {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+
+private:
+    std::array<T, Capacity> m_slots = {};
+    alignas(64) std::atomic<std::size_t> m_head = 0;        // Apart: each side writes its own line.
+    alignas(64) std::atomic<std::size_t> m_tail = 0;
+};
+
+/**
+ * @brief Hands values from one producer thread to one consumer thread without either
+ * copying: the producer fills back(), publish() swaps it with the ready slot, and the
+ * consumer's acquire() swaps the ready slot with its front one. Both sides work on their own
+ * slot meanwhile, so producing value N + 1 overlaps consuming value N. Without waiting in
+ * publish() a value the consumer did not reach is replaced (the newest wins); with it the
+ * producer stays at most one value ahead and none is skipped.
+ * @code
+ *      auto frames = gltool::triple_buffer<frame>();
+ *      // Producer:
+ *      frames.back() = simulate();
+ *      frames.publish();
+ *      // Consumer:
+ *      while (auto const* next = frames.acquire()) {
+ *          draw(*next);
+ *      }
+ * @endcode
+ */
+template<typename T>
+class triple_buffer {
+public:
+    /**
+     * @brief The slot of the producer, to fill before publish().
+     */
+    T& back() noexcept {
+        return m_slots[m_back];
+    }
+
+    /**
+     * @brief Make back() the newest value. With `wait`, first wait until the consumer took the
+     * previous one (or the buffer was stopped).
+     */
+    void publish(bool wait = false) {
+        auto lock = std::unique_lock(m_mutex);
+        if (wait) {
+            m_consumed.wait(lock, [this] { return !m_fresh || m_stopped; });
+        }
+        std::swap(m_back, m_ready);
+        m_fresh = true;
+        m_published.notify_one();
+    }
+
+    /**
+     * @brief Wait for a value newer than the last one acquired and return it; it stays valid
+     * until the next call. Null once stop() was called.
+     */
+    T const* acquire() {
+        auto lock = std::unique_lock(m_mutex);
+        m_published.wait(lock, [this] { return m_fresh || m_stopped; });
+        if (m_stopped) {
+            return nullptr;
+        }
+        std::swap(m_front, m_ready);
+        m_fresh = false;
+        m_consumed.notify_one();
+        return &m_slots[m_front];
+    }
+
+    /**
+     * @brief Release both sides: acquire() returns null and publish() no longer waits.
+     */
+    void stop() {
+        auto const lock = std::lock_guard(m_mutex);
+        m_stopped = true;
+        m_published.notify_all();
+        m_consumed.notify_all();
+    }
+
+private:
+    std::array<T, 3> m_slots = {};
+    std::size_t m_back = 0;
+    std::size_t m_ready = 1;
+    std::size_t m_front = 2;
+    bool m_fresh = false;
+    bool m_stopped = false;
+    std::mutex m_mutex;
+    std::condition_variable m_published;
+    std::condition_variable m_consumed;
+};
+
+/**
+ * @brief Frame times over the last `Window` frames: the latest, mean, extremes and percentiles
+ * (the 99th shows the stutter a mean hides), in seconds. Any other per-frame value works too.
+ */
+template<std::size_t Window = 120>
+class frame_statistics {
+public:
+    void add(double seconds) noexcept {
+        m_times[m_next] = seconds;
+        m_next = (m_next + 1) % Window;
+        m_ct = std::min(m_ct + 1, Window);
+        m_last = seconds;
+        ++m_total;
+    }
+
+    double last() const noexcept {
+        return m_last;
+    }
+
+    double average() const noexcept {
+        return m_ct == 0 ? 0.0 : std::accumulate(m_times.begin(), m_times.begin() + m_ct, 0.0) / static_cast<double>(m_ct);
+    }
+
+    double minimum() const noexcept {
+        return m_ct == 0 ? 0.0 : *std::min_element(m_times.begin(), m_times.begin() + m_ct);
+    }
+
+    double maximum() const noexcept {
+        return m_ct == 0 ? 0.0 : *std::max_element(m_times.begin(), m_times.begin() + m_ct);
+    }
+
+    /**
+     * @brief The value `percent` of the frames in the window are at or below (nearest rank).
+     */
+    double percentile(std::size_t percent) const noexcept {
+        if (m_ct == 0) {
+            return 0.0;
+        }
+        auto sorted = m_times;
+        auto const nth = sorted.begin() + (m_ct - 1) * std::min(percent, std::size_t(100)) / 100;
+        std::nth_element(sorted.begin(), nth, sorted.begin() + m_ct);
+        return *nth;
+    }
+
+    double percentile_50() const noexcept {
+        return this->percentile(50);
+    }
+
+    double percentile_99() const noexcept {
+        return this->percentile(99);
+    }
+
+    /**
+     * @brief Frames measured since creation, not only the ones in the window.
+     */
+    std::uint64_t frames() const noexcept {
+        return m_total;
+    }
+
+    /**
+     * @brief Frames in the window, at most `Window`.
+     */
+    std::size_t size() const noexcept {
+        return m_ct;
+    }
+
+    /**
+     * @brief The value `age` frames before the latest (0: the latest), for age < size().
+     */
+    double at(std::size_t age) const noexcept {
+        return m_times[(m_next + Window - 1 - age % Window) % Window];
+    }
+
+private:
+    std::array<double, Window> m_times = {};
+    std::size_t m_next = 0;
+    std::size_t m_ct = 0;
+    double m_last = 0.0;
+    std::uint64_t m_total = 0;
+};
+
+/**
+ * @brief Fixed-size record of what led up to a crash: the last log records (through
+ * sinks::flight_sink), the CPU profiler scopes entered and left, and the passes of the frames
+ * with how far the GPU got through them (gl::gpu_breadcrumbs). The threads share one ring of
+ * k_capacity entries; an entry claims its slot with one atomic increment and copies at most
+ * k_text_size bytes of text, nothing locks or allocates. Recording is off until enable(), and
+ * a disabled record costs one relaxed load.
+ * The dump formats with to_chars and writes with write(2), so it is safe in a signal handler:
+ * install_signal_handlers() dumps on SIGSEGV, SIGBUS, SIGFPE, SIGILL and SIGABRT before the
+ * default action runs, and gl::logger::exception() dumps before it throws.
+ * @code
+ *      auto& recorder = gltool::flight_recorder::instance();
+ *      recorder.set_dump_path("crash.txt");
+ *      recorder.enable(true);
+ *      recorder.install_signal_handlers();
+ *      recorder.note("level loaded");
+ * @endcode
+ */
+class flight_recorder {
+public:
+    static constexpr std::size_t k_capacity  = 4096;    // Entries kept (a power of 2), 128 bytes each.
+    static constexpr std::size_t k_text_size = 106;     // Bytes of text per entry; the rest is cut.
+
+    struct kind {
+        enum type : std::uint8_t {
+            LOG,            // A log record.
+            SCOPE_BEGIN,    // A cpu_profiler::scope was entered...
+            SCOPE_END,      // ... and left.
+            PASS,           // A pass was submitted; the GPU writes its sequence number when done.
+            NOTE            // note()
+        };
+    };
+
+    static flight_recorder& instance() {
+        static auto recorder = flight_recorder();
+        return recorder;
+    }
+
+    flight_recorder(flight_recorder const&) = delete;
+
+    flight_recorder& operator=(flight_recorder const&) = delete;
+
+    void enable(bool enabled) noexcept {
+        m_enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool enabled() const noexcept {
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Add an entry. Returns its sequence number (from 1), or 0 while recording is off.
+     */
+    std::uint64_t record(kind::type type, std::string_view text) noexcept {
+        if (!this->enabled()) {
+            return 0;
+        }
+        auto const sequence = m_next.fetch_add(1, std::memory_order_relaxed) + 1;
+        auto& item = m_entries[(sequence - 1) & (k_capacity - 1)];
+        item.sequence.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        item.time = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count());
+        item.thread = thread_index();
+        item.type = type;
+        item.length = static_cast<std::uint8_t>(std::min(text.size(), k_text_size));
+        std::memcpy(item.text, text.data(), item.length);
+        item.sequence.store(sequence, std::memory_order_release);
+        return sequence;
+    }
+
+    void note(std::string_view text) noexcept {
+        this->record(kind::NOTE, text);
+    }
+
+    /**
+     * @brief Where dumps are written, besides a line on stderr; without one, the entries go to
+     * stderr. Set it before the signal handlers can run.
+     */
+    void set_dump_path(std::string_view path) noexcept {
+        auto const size = std::min(path.size(), m_path.size() - 1);
+        std::memcpy(m_path.data(), path.data(), size);
+        m_path[size] = '\0';
+    }
+
+    /**
+     * @brief The breadcrumb the GPU writes as it completes passes, in memory that stays mapped
+     * (see gl::gpu_breadcrumbs); null to forget it.
+     */
+    void set_gpu_progress(std::uint32_t const volatile* completed) noexcept {
+        m_gpu_progress.store(completed, std::memory_order_release);
+    }
+
+    std::uint32_t const volatile* get_gpu_progress() const noexcept {
+        return m_gpu_progress.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Write the entries, oldest first, then how far the GPU got.
+     */
+    void dump(std::ostream& out) const {
+        this->format([&out](std::string_view text) { out.write(text.data(), static_cast<std::streamsize>(text.size())); });
+        out.flush();
+    }
+
+#if defined(M_HAS_SIGACTION)
+    void dump(int fd) const noexcept {
+        this->format([fd](std::string_view text) {
+            while (!text.empty()) {
+                auto const written = ::write(fd, text.data(), text.size());
+                if (written <= 0) {
+                    return;
+                }
+                text.remove_prefix(static_cast<std::size_t>(written));
+            }
+        });
+    }
+#endif
+
+    /**
+     * @brief Dump with `reason` to the dump path, or stderr without one. Does nothing while
+     * recording is off. Recording goes on afterwards, the caller may recover.
+     */
+    void crash_dump(std::string_view reason) noexcept {
+        if (!this->enabled()) {
+            return;
+        }
+#if defined(M_HAS_SIGACTION)
+        auto const put = [](int fd, std::string_view text) {
+            if (::write(fd, text.data(), text.size()) < 0) {
+                return;
+            }
+        };
+        auto const fd = m_path[0] != '\0' ? ::open(m_path.data(), O_WRONLY | O_CREAT | O_TRUNC, 0644) : -1;
+        put(2, "Flight recorder: ");
+        put(2, reason);
+        if (fd >= 0) {
+            put(2, ", written to ");
+            put(2, m_path.data());
+            put(2, "\n");
+            put(fd, reason);
+            put(fd, "\n");
+            this->dump(fd);
+            ::close(fd);
+        }
+        else {
+            put(2, "\n");
+            this->dump(2);
+        }
+#else
+        try {
+            auto file = std::ofstream(m_path.data());
+            auto& out = file.is_open() ? static_cast<std::ostream&>(file) : std::cerr;
+            std::cerr << "Flight recorder: " << reason << std::endl;
+            out << reason << '\n';
+            this->dump(out);
+        }
+        catch (...) {
+        }
+#endif
+    }
+
+    /**
+     * @brief Dump on the fatal signals, then let their default action end the process. Stack
+     * overflows are caught on the thread that installed the handlers.
+     */
+    void install_signal_handlers() {
+        static auto installed = false;
+        if (std::exchange(installed, true)) {
+            return;
+        }
+#if defined(M_HAS_SIGACTION)
+        static auto stack = std::array<std::byte, 64 * 1024>();
+        auto alternate = stack_t();
+        alternate.ss_sp = stack.data();
+        alternate.ss_size = stack.size();
+        ::sigaltstack(&alternate, nullptr);
+        struct sigaction action = {};
+        action.sa_handler = &flight_recorder::on_signal;
+        ::sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_ONSTACK | SA_RESETHAND;
+        for (auto const signal : { SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT }) {
+            ::sigaction(signal, &action, nullptr);
+        }
+#else
+        for (auto const signal : { SIGSEGV, SIGFPE, SIGILL, SIGABRT }) {
+            std::signal(signal, &flight_recorder::on_signal);
+        }
+#endif
+    }
+
+private:
+    struct entry {
+        std::atomic<std::uint64_t> sequence;    // Of what the slot holds, 0 while it is written.
+        std::uint64_t              time;        // Nanoseconds since the recorder was created.
+        std::uint32_t              thread;      // Recording threads in order of their first entry.
+        std::uint8_t               type;
+        std::uint8_t               length;
+        char                       text[k_text_size];
+    };
+
+    flight_recorder() = default;
+
+    std::uint32_t thread_index() noexcept {
+        static thread_local auto const index = m_threads.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+
+    static void on_signal(int signal) {
+        auto& recorder = instance();
+        auto reason = std::array<char, 48>();
+        auto const name = signal == SIGSEGV ? "SIGSEGV" : signal == SIGFPE ? "SIGFPE" : signal == SIGILL ? "SIGILL" : signal == SIGABRT ? "SIGABRT" : "signal";
+        auto const length = std::min(std::strlen(name), reason.size() - 16);
+        std::memcpy(reason.data(), name, length);
+        reason[length] = ' ';
+        auto const end = std::to_chars(reason.data() + length + 1, reason.data() + reason.size(), signal).ptr;
+        recorder.crash_dump(std::string_view(reason.data(), static_cast<std::size_t>(end - reason.data())));
+        recorder.enable(false);
+        std::raise(signal);             // The handler was reset: the default action ends the process.
+    }
+
+    /**
+     * @brief Hand the dump to `out` line by line, built on the stack.
+     */
+    template<typename Out>
+    void format(Out&& out) const {
+        static constexpr auto k_kinds = std::array<std::string_view, 5>{ "log   ", "enter ", "leave ", "pass  ", "note  " };
+        auto line = std::array<char, 48 + k_text_size>();
+        auto size = std::size_t(0);
+        auto const put = [&](std::string_view text) {
+            auto const count = std::min(text.size(), line.size() - size);
+            std::memcpy(line.data() + size, text.data(), count);
+            size += count;
+        };
+        auto const put_number = [&](std::uint64_t number, int width = 0) {
+            auto digits = std::array<char, 24>();
+            auto const end = std::to_chars(digits.data(), digits.data() + digits.size(), number).ptr;
+            for (auto n = end - digits.data(); n < width; ++n) {
+                put("0");
+            }
+            put(std::string_view(digits.data(), static_cast<std::size_t>(end - digits.data())));
+        };
+
+        auto const* const progress = this->get_gpu_progress();
+        auto const completed = progress != nullptr ? std::uint32_t(*progress) : 0u;
+        auto const last = m_next.load(std::memory_order_acquire);
+        auto const first = last > k_capacity ? last - k_capacity + 1 : std::uint64_t(1);
+        for (auto sequence = first; sequence <= last; ++sequence) {
+            auto const& item = m_entries[(sequence - 1) & (k_capacity - 1)];
+            if (item.sequence.load(std::memory_order_acquire) != sequence) {
+                continue;       // Being written, or already overwritten.
+            }
+            size = 0;
+            put("+");
+            put_number(item.time / 1'000'000'000);
+            put(".");
+            put_number(item.time / 1000 % 1'000'000, 6);
+            put(" t");
+            put_number(item.thread);
+            put(" ");
+            put(item.type < k_kinds.size() ? k_kinds[item.type] : std::string_view("?     "));
+            put(std::string_view(item.text, std::min<std::size_t>(item.length, k_text_size)));
+            if (item.type == kind::PASS) {
+                put(" #");
+                put_number(sequence);
+                if (progress != nullptr) {
+                    put(static_cast<std::int32_t>(completed - static_cast<std::uint32_t>(sequence)) >= 0 ? " (GPU done)" : " (GPU not done)");
+                }
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (item.sequence.load(std::memory_order_relaxed) != sequence) {
+                continue;
+            }
+            put("\n");
+            out(std::string_view(line.data(), size));
+        }
+        size = 0;
+        put("Entries: ");
+        put_number(last);
+        if (progress != nullptr) {
+            put(", the GPU completed pass #");
+            put_number(completed);
+        }
+        put("\n");
+        out(std::string_view(line.data(), size));
+    }
+
+    std::array<entry, k_capacity>               m_entries = {};
+    std::atomic<std::uint64_t>                  m_next = 0;
+    std::atomic<std::uint32_t>                  m_threads = 0;
+    std::atomic<bool>                           m_enabled = false;
+    std::atomic<std::uint32_t const volatile*>  m_gpu_progress = nullptr;
+    std::array<char, 512>                       m_path = {};
+    std::chrono::steady_clock::time_point       m_start = std::chrono::steady_clock::now();
+};
+
+/**
+ * @brief Hierarchical CPU profiler: scopes record their start and end times into a buffer
+ * of their thread, and write_chrome_trace() merges the threads into one timeline in the
+ * Chrome trace_event format, opened by chrome://tracing, Perfetto, or Tracy (through its
+ * import-chrome tool). Recording is off until enable(); a disabled scope costs a relaxed
+ * load, and another for the flight_recorder, which also notes the scopes while it records.
+ * Scope names must outlive the profiler, e.g. string literals.
+ * @code
+ *      gltool::cpu_profiler::instance().enable(true);
+ *      {
+ *          auto const scope = gltool::cpu_profiler::scope("load level");
+ *          load_level();
+ *      }
+ *      gltool::cpu_profiler::instance().save("frame.json");
+ * @endcode
+ */
+class cpu_profiler {
+public:
+    using clock = std::chrono::steady_clock;
+
+    static constexpr std::size_t k_default_capacity = std::size_t(1) << 20;
+
+    struct event {
+        char const*   name;
+        std::uint64_t begin;        // Nanoseconds since the profiler started.
+        std::uint64_t end;
+        std::uint32_t depth;        // Scopes open around it on its thread.
+    };
+
+    /**
+     * @brief Records the time from its construction to its destruction.
+     */
+    class [[nodiscard]] scope {
+    public:
+        explicit scope(char const* name) noexcept
+            : m_name(name) {
+            if (auto& recorder = flight_recorder::instance(); recorder.enabled()) {
+                m_recorded = recorder.record(flight_recorder::kind::SCOPE_BEGIN, name) != 0;
+            }
+            auto& profiler = instance();
+            if (profiler.m_enabled.load(std::memory_order_relaxed)) {
+                m_begin = profiler.now();
+                m_active = true;
+                ++profiler.local().depth;
+            }
+        }
+
+        scope(scope const&) = delete;
+
+        scope& operator=(scope const&) = delete;
+
+        ~scope() {
+            if (m_active) {
+                auto& profiler = instance();
+                profiler.record(m_name, m_begin, profiler.now());
+            }
+            if (m_recorded) {
+                flight_recorder::instance().record(flight_recorder::kind::SCOPE_END, m_name);
+            }
+        }
+
+    private:
+        char const*   m_name;
+        std::uint64_t m_begin = 0;
+        bool          m_active = false;
+        bool          m_recorded = false;       // Entered in the flight_recorder.
+    };
+
+    static cpu_profiler& instance() {
+        static auto profiler = cpu_profiler();
+        return profiler;
+    }
+
+    cpu_profiler(cpu_profiler const&) = delete;
+
+    cpu_profiler& operator=(cpu_profiler const&) = delete;
+
+    /**
+     * @brief Start or stop recording. Scopes open when it changes record as they were opened.
+     */
+    void enable(bool enabled) noexcept {
+        m_enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool enabled() const noexcept {
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Events kept per thread; later ones are dropped (and counted) until clear().
+     */
+    void set_capacity(std::size_t events) noexcept {
+        m_capacity.store(events, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Name the calling thread in the exported timeline.
+     */
+    void set_thread_name(std::string name) {
+        auto& buffer = this->local();
+        auto const lock = std::scoped_lock(buffer.mutex);
+        buffer.name = std::move(name);
+    }
+
+    /**
+     * @brief Drop the events recorded so far.
+     */
+    void clear() {
+        auto const lock = std::scoped_lock(m_mutex);
+        for (auto const& buffer : m_threads) {
+            auto const buffer_lock = std::scoped_lock(buffer->mutex);
+            buffer->events.clear();
+            buffer->dropped = 0;
+        }
+    }
+
+    /**
+     * @brief The last events (at most `count`) the calling thread recorded, in the order they
+     * ended; cheap enough to read every frame, unlike timeline().
+     */
+    std::vector<event> recent(std::size_t count) {
+        auto& buffer = this->local();
+        auto const lock = std::scoped_lock(buffer.mutex);
+        auto const first = buffer.events.size() - std::min(count, buffer.events.size());
+        return { buffer.events.begin() + static_cast<std::ptrdiff_t>(first), buffer.events.end() };
+    }
+
+    /**
+     * @brief The events of all the threads, as (thread index, event) in start order.
+     */
+    std::vector<std::pair<std::uint32_t, event>> timeline() const {
+        auto result = std::vector<std::pair<std::uint32_t, event>>();
+        auto const lock = std::scoped_lock(m_mutex);
+        for (auto const& buffer : m_threads) {
+            auto const buffer_lock = std::scoped_lock(buffer->mutex);
+            for (auto const& item : buffer->events) {
+                result.emplace_back(buffer->index, item);
+            }
+        }
+        std::ranges::sort(result, [](auto const& a, auto const& b) {
+            return a.second.begin != b.second.begin ? a.second.begin < b.second.begin : a.second.depth < b.second.depth;
+        });
+        return result;
+    }
+
+    std::uint64_t dropped() const {
+        auto total = std::uint64_t(0);
+        auto const lock = std::scoped_lock(m_mutex);
+        for (auto const& buffer : m_threads) {
+            auto const buffer_lock = std::scoped_lock(buffer->mutex);
+            total += buffer->dropped;
+        }
+        return total;
+    }
+
+    /**
+     * @brief Write the timeline as a JSON trace of complete ("X") events, times in microseconds.
+     */
+    void write_chrome_trace(std::ostream& out) const {
+        auto const events = this->timeline();
+        auto const escaped = [](std::string_view text) {
+            auto result = std::string();
+            for (auto const c : text) {
+                if (c == '"' || c == '\\') {
+                    result += '\\';
+                    result += c;
+                }
+                else if (static_cast<unsigned char>(c) < 0x20) {
+                    char code[8];
+                    std::snprintf(code, sizeof(code), "\\u%04x", c);
+                    result += code;
+                }
+                else {
+                    result += c;
+                }
+            }
+            return result;
+        };
+        auto const microseconds = [](std::uint64_t ns) {
+            char text[32];
+            std::snprintf(text, sizeof(text), "%.3f", static_cast<double>(ns) * 1e-3);
+            return std::string(text);
+        };
+
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        auto first = true;
+        {
+            auto const lock = std::scoped_lock(m_mutex);
+            for (auto const& buffer : m_threads) {
+                auto const buffer_lock = std::scoped_lock(buffer->mutex);
+                if (buffer->name.empty()) {
+                    continue;
+                }
+                out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->index
+                    << ",\"args\":{\"name\":\"" << escaped(buffer->name) << "\"}}";
+                first = false;
+            }
+        }
+        for (auto const& [thread, item] : events) {
+            out << (first ? "" : ",") << "\n{\"name\":\"" << escaped(item.name) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread
+                << ",\"ts\":" << microseconds(item.begin) << ",\"dur\":" << microseconds(item.end - item.begin) << "}";
+            first = false;
+        }
+        out << "\n]}\n";
+    }
+
+    /**
+     * @brief Same as above into a file, e.g. on a key press in a production build.
+     */
+    void save(std::filesystem::path const& path) const {
+        auto out = std::ofstream(path);
+        if (!out.is_open()) {
+            throw std::runtime_error("Could not open file: " + path.string());
+        }
+        this->write_chrome_trace(out);
+    }
+
+private:
+    struct thread_buffer {
+        std::uint32_t      index;
+        std::string        name;
+        std::uint32_t      depth = 0;       // Only touched by the owning thread.
+        std::uint64_t      dropped = 0;
+        std::vector<event> events;
+        std::mutex         mutex;           // Between the owner and the exporters.
+    };
+
+    cpu_profiler() = default;
+
+    std::uint64_t now() const noexcept {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - m_start).count());
+    }
+
+    thread_buffer& local() {
+        thread_local auto* cached = static_cast<thread_buffer*>(nullptr);
+        if (cached == nullptr) {
+            auto const lock = std::scoped_lock(m_mutex);
+            auto& buffer = m_threads.emplace_back(std::make_unique<thread_buffer>());
+            buffer->index = static_cast<std::uint32_t>(m_threads.size());
+            cached = buffer.get();
+        }
+        return *cached;
+    }
+
+    void record(char const* name, std::uint64_t begin, std::uint64_t end) {
+        auto& buffer = this->local();
+        auto const depth = --buffer.depth;
+        auto const lock = std::scoped_lock(buffer.mutex);
+        if (buffer.events.size() >= m_capacity.load(std::memory_order_relaxed)) {
+            ++buffer.dropped;
+            return;
+        }
+        buffer.events.push_back({ name, begin, end, depth });
+    }
+
+    clock::time_point                          m_start = clock::now();
+    std::atomic<bool>                          m_enabled = false;
+    std::atomic<std::size_t>                   m_capacity = k_default_capacity;
+    mutable std::mutex                         m_mutex;             // Guards the list of threads.
+    std::vector<std::unique_ptr<thread_buffer>> m_threads;          // Kept after their thread exits.
+};
+
+/**
+ * @brief A child process fed through its standard input, e.g. a video encoder taking raw
+ * frames. Closing waits for the process to exit.
+ * @code
+ *      auto encoder = gltool::pipe_writer("ffmpeg -y -f rawvideo -pix_fmt rgba -s 1280x720 -i - out.mp4");
+ *      encoder.write(std::as_bytes(std::span(pixels)));
+ * @endcode
+ */
+class pipe_writer {
+public:
+    explicit pipe_writer(char const* command) {
+#if defined(_WIN32)
+        m_pipe = ::_popen(command, "wb");
+#else
+        m_pipe = ::popen(command, "w");
+#endif
+        if (m_pipe == nullptr) {
+            throw std::runtime_error("Could not start process: " + std::string(command));
+        }
+    }
+
+    pipe_writer(pipe_writer const&) = delete;
+
+    pipe_writer(pipe_writer&& other) noexcept
+        : m_pipe(std::exchange(other.m_pipe, nullptr)) {}
+
+    pipe_writer& operator =(pipe_writer const&) = delete;
+
+    pipe_writer& operator =(pipe_writer&& other) noexcept {
+        if (this != &other) {
+            this->close();
+            m_pipe = std::exchange(other.m_pipe, nullptr);
+        }
+        return *this;
+    }
+
+    ~pipe_writer() {
+        this->close();
+    }
+
+    /**
+     * @brief Returns whether all the bytes were written; false once the process has exited.
+     */
+    bool write(std::span<std::byte const> bytes) noexcept {
+        return m_pipe != nullptr && std::fwrite(bytes.data(), 1, bytes.size(), m_pipe) == bytes.size();
+    }
+
+    /**
+     * @brief Close the input of the process and wait for it; returns its exit status.
+     */
+    int close() noexcept {
+        if (m_pipe == nullptr) {
+            return 0;
+        }
+#if defined(_WIN32)
+        return ::_pclose(std::exchange(m_pipe, nullptr));
+#else
+        return ::pclose(std::exchange(m_pipe, nullptr));
+#endif
+    }
+
+    std::FILE* get() const noexcept {
+        return m_pipe;
+    }
+
+private:
+    std::FILE* m_pipe = nullptr;
+};
+
+/**
+ * @brief A child process read through its standard output, e.g. a video decoder writing raw
+ * frames. Closing waits for the process to exit.
+ * @code
+ *      auto decoder = gltool::pipe_reader("ffmpeg -loglevel error -i in.mp4 -f rawvideo -pix_fmt rgba -");
+ *      while (decoder.read(std::as_writable_bytes(std::span(pixels)))) { ... }
+ * @endcode
+ */
+class pipe_reader {
+public:
+    explicit pipe_reader(char const* command) {
+#if defined(_WIN32)
+        m_pipe = ::_popen(command, "rb");
+#else
+        m_pipe = ::popen(command, "r");
+#endif
+        if (m_pipe == nullptr) {
+            throw std::runtime_error("Could not start process: " + std::string(command));
+        }
+    }
+
+    pipe_reader(pipe_reader const&) = delete;
+
+    pipe_reader(pipe_reader&& other) noexcept
+        : m_pipe(std::exchange(other.m_pipe, nullptr)) {}
+
+    pipe_reader& operator =(pipe_reader const&) = delete;
+
+    pipe_reader& operator =(pipe_reader&& other) noexcept {
+        if (this != &other) {
+            this->close();
+            m_pipe = std::exchange(other.m_pipe, nullptr);
+        }
+        return *this;
+    }
+
+    ~pipe_reader() {
+        this->close();
+    }
+
+    /**
+     * @brief Fill all of `bytes`; returns false if the output ended first.
+     */
+    bool read(std::span<std::byte> bytes) noexcept {
+        return m_pipe != nullptr && std::fread(bytes.data(), 1, bytes.size(), m_pipe) == bytes.size();
+    }
+
+    /**
+     * @brief Stop reading and wait for the process; returns its exit status.
+     */
+    int close() noexcept {
+        if (m_pipe == nullptr) {
+            return 0;
+        }
+#if defined(_WIN32)
+        return ::_pclose(std::exchange(m_pipe, nullptr));
+#else
+        return ::pclose(std::exchange(m_pipe, nullptr));
+#endif
+    }
+
+    std::FILE* get() const noexcept {
+        return m_pipe;
+    }
+
+private:
+    std::FILE* m_pipe = nullptr;
+};
+
+/**
+ * @brief Values of a moment for a metrics_exporter: gauges and counters by name, with
+ * optional Prometheus labels (e.g. `scope="shadows"`).
+ */
+struct metrics_snapshot {
+    enum kind : std::uint8_t { GAUGE, COUNTER };
+
+    struct sample {
+        std::string name;
+        std::string labels;         // Without the braces; empty for none.
+        double      value = 0.0;
+        kind        type  = GAUGE;
+    };
+
+    void add(std::string name, double value, kind type = GAUGE, std::string labels = {}) {
+        samples.push_back({ std::move(name), std::move(labels), value, type });
+    }
+
+    /**
+     * @brief A label as the exposition format writes it, `key="value"`, with the value escaped.
+     */
+    static std::string label(std::string_view key, std::string_view value) {
+        auto result = std::string(key).append("=\"");
+        for (auto const c : value) {
+            if (c == '"' || c == '\\') {
+                result.push_back('\\');
+            }
+            result.push_back(c == '\n' ? ' ' : c);
+        }
+        return result.append("\"");
+    }
+
+    /**
+     * @brief The Prometheus text exposition format, names prefixed with `prefix` and "_".
+     */
+    std::string prometheus(std::string_view prefix) const {
+        auto out = std::ostringstream();
+        out.imbue(std::locale::classic());
+        auto typed = std::unordered_set<std::string>();
+        for (auto const& s : samples) {
+            auto const name = std::string(prefix).append("_").append(s.name);
+            if (typed.insert(name).second) {
+                out << "# TYPE " << name << (s.type == COUNTER ? " counter\n" : " gauge\n");
+            }
+            out << name;
+            if (!s.labels.empty()) {
+                out << '{' << s.labels << '}';
+            }
+            out << ' ' << s.value << '\n';
+        }
+        return out.str();
+    }
+
+    /**
+     * @brief StatsD gauges, one per line; the label values become dotted suffixes of the name.
+     */
+    std::string statsd(std::string_view prefix) const {
+        auto out = std::ostringstream();
+        out.imbue(std::locale::classic());
+        for (auto const& s : samples) {
+            out << prefix << '.' << s.name;
+            auto quoted = false;
+            for (auto i = std::size_t(0); i < s.labels.size(); ++i) {
+                auto const c = s.labels[i];
+                if (c == '\\') {
+                    ++i;
+                }
+                else if (c == '"') {
+                    quoted = !quoted;
+                    if (quoted) {
+                        out << '.';
+                    }
+                }
+                else if (quoted) {
+                    out << (std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '-' ? c : '_');
+                }
+            }
+            out << ':' << s.value << "|g\n";
+        }
+        return out.str();
+    }
+
+    std::vector<sample> samples;
+};
+
+/**
+ * @brief Serves the latest metrics_snapshot to monitoring from a background thread, both ways
+ * at once if asked: a minimal HTTP server answering `GET /metrics` in the Prometheus format,
+ * and a periodic UDP push of StatsD gauges. publish() only swaps a shared pointer, so the
+ * thread producing the snapshots never waits for a scrape, and the server never sees a
+ * snapshot being written. The server binds the loopback address by default. Sockets are
+ * POSIX; elsewhere the exporter only keeps the snapshots.
+ * @code
+ *      auto exporter = gltool::metrics_exporter({ .http_port = 9100, .statsd_host = "10.0.0.5", .statsd_port = 8125 });
+ *      auto snapshot = gltool::metrics_snapshot();
+ *      snapshot.add("frame_time_seconds", dt);
+ *      exporter.publish(std::move(snapshot));
+ * @endcode
+ */
+class metrics_exporter {
+public:
+    struct options {
+        std::uint16_t             http_port     = 0;            // 0: no HTTP endpoint.
+        std::string               http_address  = "127.0.0.1";
+        std::string               statsd_host;                  // IPv4 address; empty: no push.
+        std::uint16_t             statsd_port   = 8125;
+        std::chrono::milliseconds push_interval = std::chrono::seconds(10);
+        std::string               prefix        = "gltool";
+    };
+
+    explicit metrics_exporter(options settings)
+        : m_options(std::move(settings)),
+          m_latest(std::make_shared<metrics_snapshot const>()) {
+#if defined(M_HAS_SOCKETS)
+        if (m_options.http_port != 0) {
+            m_listener = open_listener(m_options.http_address, m_options.http_port);
+        }
+        if (!m_options.statsd_host.empty()) {
+            m_statsd = ::socket(AF_INET, SOCK_DGRAM, 0);
+            m_statsd_address.sin_family = AF_INET;
+            m_statsd_address.sin_port = htons(m_options.statsd_port);
+            if (m_statsd < 0 || ::inet_pton(AF_INET, m_options.statsd_host.c_str(), &m_statsd_address.sin_addr) != 1) {
+                this->close();
+                throw std::runtime_error("Invalid StatsD address: " + m_options.statsd_host);
+            }
+        }
+        if (m_listener >= 0 || m_statsd >= 0) {
+            m_worker = std::jthread([this](std::stop_token stop) { this->work(stop); });
+        }
+#endif
+    }
+
+    metrics_exporter(metrics_exporter const&) = delete;
+
+    metrics_exporter& operator =(metrics_exporter const&) = delete;
+
+    ~metrics_exporter() {
+        if (m_worker.joinable()) {
+            m_worker.request_stop();
+            m_worker.join();
+        }
+        this->close();
+    }
+
+    /**
+     * @brief Make `snapshot` the one served from now on. From any thread.
+     */
+    void publish(metrics_snapshot snapshot) {
+        m_latest.store(std::make_shared<metrics_snapshot const>(std::move(snapshot)), std::memory_order_release);
+    }
+
+    std::shared_ptr<metrics_snapshot const> latest() const {
+        return m_latest.load(std::memory_order_acquire);
+    }
+
+    options const& get_options() const noexcept {
+        return m_options;
+    }
+
+    /**
+     * @brief Requests answered by the HTTP endpoint so far.
+     */
+    std::uint64_t scrapes() const noexcept {
+        return m_scrapes.load(std::memory_order_relaxed);
+    }
+
+private:
+#if defined(M_HAS_SOCKETS)
+    static int open_listener(std::string const& address, std::uint16_t port) {
+        auto const fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) {
+            throw std::runtime_error("Could not create the metrics socket");
+        }
+        auto const reuse = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        auto bound = sockaddr_in();
+        bound.sin_family = AF_INET;
+        bound.sin_port = htons(port);
+        if (::inet_pton(AF_INET, address.c_str(), &bound.sin_addr) != 1 ||
+            ::bind(fd, reinterpret_cast<sockaddr const*>(&bound), sizeof(bound)) != 0 || ::listen(fd, 8) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Could not serve metrics on " + address + ":" + std::to_string(port));
+        }
+        return fd;
+    }
+
+    void work(std::stop_token const& stop) {
+        auto next_push = std::chrono::steady_clock::now();
+        while (!stop.stop_requested()) {
+            if (m_statsd >= 0 && std::chrono::steady_clock::now() >= next_push) {
+                this->push();
+                next_push += m_options.push_interval;
+            }
+            if (m_listener < 0) {
+                std::this_thread::sleep_for(k_tick);
+                continue;
+            }
+            auto listening = pollfd{ m_listener, POLLIN, 0 };
+            if (::poll(&listening, 1, static_cast<int>(k_tick.count())) > 0 && (listening.revents & POLLIN) != 0) {
+                if (auto const client = ::accept(m_listener, nullptr, nullptr); client >= 0) {
+                    this->answer(client);
+                    ::close(client);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Read the request line (one read, with a short timeout) and answer it.
+     */
+    void answer(int client) {
+        auto const timeout = timeval{ 0, 200'000 };
+        ::setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        auto request = std::array<char, 1024>();
+        auto const read = ::recv(client, request.data(), request.size(), 0);
+        auto const line = std::string_view(request.data(), read > 0 ? static_cast<std::size_t>(read) : 0);
+        auto body = std::string();
+        auto status = std::string_view("404 Not Found");
+        if (line.starts_with("GET /metrics ") || line.starts_with("GET /metrics?")) {
+            body = this->latest()->prometheus(m_options.prefix);
+            status = "200 OK";
+            m_scrapes.fetch_add(1, std::memory_order_relaxed);
+        }
+        auto response = std::string("HTTP/1.1 ").append(status)
+                            .append("\r\nContent-Type: text/plain; version=0.0.4\r\nConnection: close\r\nContent-Length: ")
+                            .append(std::to_string(body.size())).append("\r\n\r\n").append(body);
+        for (auto sent = std::size_t(0); sent < response.size();) {
+            auto const n = ::send(client, response.data() + sent, response.size() - sent, k_send_flags);
+            if (n <= 0) {
+                break;
+            }
+            sent += static_cast<std::size_t>(n);
+        }
+    }
+
+    /**
+     * @brief Send the gauges in datagrams that fit the usual MTU, whole lines each.
+     */
+    void push() {
+        auto const text = this->latest()->statsd(m_options.prefix);
+        auto const send = [this](std::string_view datagram) {
+            if (!datagram.empty()) {
+                ::sendto(m_statsd, datagram.data(), datagram.size(), 0, reinterpret_cast<sockaddr const*>(&m_statsd_address),
+                         sizeof(m_statsd_address));
+            }
+        };
+        auto begin = std::size_t(0);
+        auto end = std::size_t(0);
+        while (end < text.size()) {
+            auto const line_end = std::min(text.find('\n', end), text.size() - 1) + 1;
+            if (line_end - begin > k_datagram && end > begin) {
+                send(std::string_view(text).substr(begin, end - begin));
+                begin = end;
+            }
+            end = line_end;
+        }
+        send(std::string_view(text).substr(begin));
+    }
+
+    static constexpr auto k_tick = std::chrono::milliseconds(100);                  // Stop latency of the thread.
+    static constexpr std::size_t k_datagram = 1432;
+#if defined(MSG_NOSIGNAL)
+    static constexpr int k_send_flags = MSG_NOSIGNAL;                                // No SIGPIPE when a scraper hangs up.
+#else
+    static constexpr int k_send_flags = 0;
+#endif
+#endif
+
+    void close() noexcept {
+#if defined(M_HAS_SOCKETS)
+        if (m_listener >= 0) {
+            ::close(std::exchange(m_listener, -1));
+        }
+        if (m_statsd >= 0) {
+            ::close(std::exchange(m_statsd, -1));
+        }
+#endif
+    }
+
+    options                                              m_options;
+    std::atomic<std::shared_ptr<metrics_snapshot const>> m_latest;
+    std::atomic<std::uint64_t>                           m_scrapes   = 0;
+#if defined(M_HAS_SOCKETS)
+    int                                                  m_listener = -1;
+    int                                                  m_statsd   = -1;
+    sockaddr_in                                          m_statsd_address = {};
+#endif
+    std::jthread                                         m_worker;          // Declared last: stopped before the sockets close.
+};
+
+/**
+ * @brief A minimal PNG encoder for screenshots and captured frames, without a dependency: the
+ * image data goes into stored (uncompressed) deflate blocks, so encoding is a copy plus the
+ * checksums, and the files are as big as the pixels.
+ */
+namespace png {
+
+/**
+ * @brief CRC-32 of the chunks (the polynomial of zlib and PNG).
+ */
+inline std::uint32_t crc32(std::span<std::uint8_t const> bytes, std::uint32_t crc = 0) noexcept {
+    static auto const k_table = [] {
+        auto table = std::array<std::uint32_t, 256>();
+        for (auto n = std::uint32_t(0); n < 256; ++n) {
+            auto c = n;
+            for (auto k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[n] = c;
+        }
+        return table;
+    }();
+    crc = ~crc;
+    for (auto const byte : bytes) {
+        crc = k_table[(crc ^ byte) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+/**
+ * @brief Encode 8-bit pixels with 1 (gray), 2 (gray and alpha), 3 (RGB) or 4 (RGBA) channels.
+ * @param bottom_up Rows are given bottom first, as glReadPixels() returns them.
+ */
+inline std::vector<std::uint8_t> encode(std::span<std::uint8_t const> pixels, std::uint32_t width, std::uint32_t height,
+                                        std::uint32_t channels = 4, bool bottom_up = false) {
+    constexpr auto k_color_types = std::array<std::uint8_t, 5>{ 0, 0, 4, 2, 6 };
+    auto const row = static_cast<std::size_t>(width) * channels;
+    if (channels == 0 || channels > 4 || pixels.size() < row * height) {
+        throw std::runtime_error("PNG: the pixels do not match the image size");
+    }
+
+    // Scanlines, each behind filter type 0 (none).
+    auto raw = std::vector<std::uint8_t>();
+    raw.reserve((row + 1) * height);
+    for (auto y = std::size_t(0); y < height; ++y) {
+        auto const* const line = pixels.data() + (bottom_up ? height - 1 - y : y) * row;
+        raw.push_back(0);
+        raw.insert(raw.end(), line, line + row);
+    }
+
+    auto out = std::vector<std::uint8_t>{ 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    auto const put_u32 = [](std::vector<std::uint8_t>& bytes, std::uint32_t value) {
+        bytes.insert(bytes.end(), { std::uint8_t(value >> 24), std::uint8_t(value >> 16), std::uint8_t(value >> 8), std::uint8_t(value) });
+    };
+    auto const chunk = [&](char const (&type)[5], std::span<std::uint8_t const> data) {
+        put_u32(out, static_cast<std::uint32_t>(data.size()));
+        auto const start = out.size();
+        out.insert(out.end(), type, type + 4);
+        out.insert(out.end(), data.begin(), data.end());
+        put_u32(out, crc32(std::span(out).subspan(start)));
+    };
+
+    auto header = std::vector<std::uint8_t>();
+    put_u32(header, width);
+    put_u32(header, height);
+    header.insert(header.end(), { 8, k_color_types[channels], 0, 0, 0 });
+    chunk("IHDR", header);
+
+    // A zlib stream of stored blocks, at most 65535 bytes each.
+    auto data = std::vector<std::uint8_t>{ 0x78, 0x01 };
+    data.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+    auto a = std::uint32_t(1);
+    auto b = std::uint32_t(0);
+    for (auto offset = std::size_t(0); offset < raw.size() || offset == 0; ) {
+        auto const size = static_cast<std::uint16_t>(std::min<std::size_t>(raw.size() - offset, 65535));
+        auto const last = offset + size == raw.size();
+        data.insert(data.end(), { std::uint8_t(last), std::uint8_t(size), std::uint8_t(size >> 8),
+                                  std::uint8_t(~size), std::uint8_t(~size >> 8) });
+        data.insert(data.end(), raw.begin() + offset, raw.begin() + offset + size);
+        for (auto i = offset; i < offset + size; ++i) {
+            a = (a + raw[i]) % 65521;
+            b = (b + a) % 65521;
+        }
+        offset += size;
+        if (last) {
+            break;
+        }
+    }
+    put_u32(data, (b << 16) | a);
+    chunk("IDAT", data);
+    chunk("IEND", {});
+    return out;
+}
+
+inline void write(std::filesystem::path const& path, std::span<std::uint8_t const> pixels, std::uint32_t width,
+                  std::uint32_t height, std::uint32_t channels = 4, bool bottom_up = false) {
+    auto const bytes = encode(pixels, width, height, channels, bottom_up);
+    auto out = std::ofstream(path, std::ios::binary);
+    if (!out.is_open()) {
+        throw std::runtime_error("Could not open file: " + path.string());
+    }
+    out.write(reinterpret_cast<char const*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+} // namespace png
+
+/**
+ * @brief Compact on-disk encoding of index buffers. Every index is stored as the zigzagged
+ * difference to the previous one in a LEB128 varint; indices of a mesh are mostly close to
+ * each other (even more so after vertex cache optimization), so most take a single byte.
+ */
+namespace index_codec {
+
+constexpr std::uint8_t k_version = 1;
+
+inline void put_varint(std::vector<std::uint8_t>& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+inline std::uint64_t get_varint(std::span<std::uint8_t const> in, std::size_t& position) {
+    auto value = std::uint64_t(0);
+    for (auto shift = 0; shift < 64; shift += 7) {
+        if (position >= in.size()) {
+            throw std::runtime_error("Truncated index data");
+        }
+        auto const byte = in[position++];
+        value |= std::uint64_t(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+    throw std::runtime_error("Malformed index data");
+}
+
+/**
+ * @brief Encode indices of any unsigned integer type.
+ */
+template<std::unsigned_integral T>
+std::vector<std::uint8_t> encode(std::span<T const> indices) {
+    auto result = std::vector<std::uint8_t>();
+    result.reserve(indices.size() + 8);
+    result.push_back(k_version);
+    put_varint(result, indices.size());
+    auto previous = std::int64_t(0);
+    for (auto const index : indices) {
+        auto const delta = static_cast<std::int64_t>(index) - previous;
+        put_varint(result, (static_cast<std::uint64_t>(delta) << 1) ^ static_cast<std::uint64_t>(delta >> 63));
+        previous = static_cast<std::int64_t>(index);
+    }
+    return result;
+}
+
+/**
+ * @brief Decode data from encode(). Throws std::runtime_error on malformed input.
+ */
+inline std::vector<std::uint32_t> decode(std::span<std::uint8_t const> data) {
+    if (data.empty() || data[0] != k_version) {
+        throw std::runtime_error("Unknown index data version");
+    }
+    auto position = std::size_t(1);
+    auto const count = get_varint(data, position);
+    if (count > data.size()) {          // Every index takes at least a byte.
+        throw std::runtime_error("Malformed index data");
+    }
+    auto result = std::vector<std::uint32_t>(count);
+    auto previous = std::int64_t(0);
+    for (auto& index : result) {
+        auto const zigzag = get_varint(data, position);
+        previous += static_cast<std::int64_t>(zigzag >> 1) ^ -static_cast<std::int64_t>(zigzag & 1);
+        index = static_cast<std::uint32_t>(previous);
+    }
+    return result;
+}
+
+} // namespace index_codec
+
+/**
+ * @brief Compression of 32-bit word streams that a compute shader decodes in parallel, a word
+ * per invocation (see gl::buffer_decompressor). The words are split into `stride` columns,
+ * e.g. the words of a vertex, and every run of k_block_elements words of a column is a block:
+ * its smallest word, and the differences to it bit packed at the width of the largest. Indices
+ * and quantized attributes, whose neighbours are close, take a few bits per word; no block
+ * depends on another, so any run of groups (the blocks of k_block_elements elements) decodes
+ * on its own.
+ */
+namespace gpu_codec {
+
+constexpr std::uint32_t k_block_elements = 64;
+constexpr std::uint32_t k_max_payload = 1u << 26;   /* Words, as addressed by block::packing */
+
+struct block {
+    std::uint32_t reference;        // Smallest word of the block.
+    std::uint32_t packing;          // Offset of the bits in the payload, in words, << 6 | bits per word.
+};
+
+struct stream {
+    std::uint32_t word_ct = 0;
+    std::uint32_t stride = 1;       // Words per element.
+    std::vector<block> blocks;      // Group by group, a block per column.
+    std::vector<std::uint32_t> payload;
+
+    std::uint32_t group_ct() const noexcept {
+        return static_cast<std::uint32_t>(blocks.size() / stride);
+    }
+
+    /**
+     * @brief First payload word of a group; group_ct() gives the end of the payload.
+     */
+    std::uint32_t payload_of(std::uint32_t group) const noexcept {
+        return group < this->group_ct() ? blocks[std::size_t(group) * stride].packing >> 6 : static_cast<std::uint32_t>(payload.size());
+    }
+
+    std::size_t size_bytes() const noexcept {
+        return blocks.size() * sizeof(block) + payload.size() * sizeof(std::uint32_t);
+    }
+};
+
+/**
+ * @brief Encode words made of elements of `stride` words each.
+ */
+inline stream encode(std::span<std::uint32_t const> words, std::uint32_t stride = 1) {
+    if (stride == 0 || words.size() % stride != 0 || words.size() > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::runtime_error("Words do not make whole elements of the stride");
+    }
+    auto result = stream();
+    result.word_ct = static_cast<std::uint32_t>(words.size());
+    result.stride = stride;
+    auto const element_ct = words.size() / stride;
+    for (auto first = std::size_t(0); first < element_ct; first += k_block_elements) {
+        auto const count = std::min<std::size_t>(k_block_elements, element_ct - first);
+        for (auto column = std::size_t(0); column < stride; ++column) {
+            auto const word = [&](std::size_t k) { return words[(first + k) * stride + column]; };
+            auto low = word(0);
+            auto high = word(0);
+            for (auto k = std::size_t(1); k < count; ++k) {
+                low = std::min(low, word(k));
+                high = std::max(high, word(k));
+            }
+            auto const bits = static_cast<std::uint32_t>(std::bit_width(high - low));
+            auto const offset = result.payload.size();
+            if (offset + 2 * bits > k_max_payload) {
+                throw std::runtime_error("Too many words for a compressed stream");
+            }
+            result.blocks.push_back({ low, static_cast<std::uint32_t>(offset << 6) | bits });
+            result.payload.resize(offset + (count * bits + 31) / 32);
+            for (auto k = std::size_t(0); k < count && bits != 0; ++k) {
+                auto const value = std::uint64_t(word(k) - low) << ((k * bits) & 31);
+                auto const at = offset + k * bits / 32;
+                result.payload[at] |= static_cast<std::uint32_t>(value);
+                if ((k * bits & 31) + bits > 32) {
+                    result.payload[at + 1] |= static_cast<std::uint32_t>(value >> 32);
+                }
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Same as above for trivially copyable elements of whole words, e.g. vertices.
+ */
+template<typename T>
+    requires std::is_trivially_copyable_v<T>
+stream encode(std::span<T const> elements) {
+    static_assert(sizeof(T) % sizeof(std::uint32_t) == 0, "Elements are split into 32-bit words");
+    auto words = std::vector<std::uint32_t>(elements.size_bytes() / sizeof(std::uint32_t));
+    std::memcpy(words.data(), elements.data(), elements.size_bytes());
+    return encode(std::span<std::uint32_t const>(words), static_cast<std::uint32_t>(sizeof(T) / sizeof(std::uint32_t)));
+}
+
+/**
+ * @brief Decode a stream on the CPU, where compute shaders are not available, into its
+ * `word_ct` words. Throws std::runtime_error on malformed input.
+ */
+inline void decode(stream const& data, std::span<std::uint32_t> out) {
+    if (data.stride == 0 || out.size() != data.word_ct || data.word_ct % data.stride != 0
+        || data.blocks.size() != std::size_t(data.word_ct / data.stride + k_block_elements - 1) / k_block_elements * data.stride) {
+        throw std::runtime_error("Malformed compressed stream");
+    }
+    for (auto i = std::size_t(0); i < out.size(); ++i) {
+        auto const element = i / data.stride;
+        auto const column = i % data.stride;
+        auto const& info = data.blocks[element / k_block_elements * data.stride + column];
+        auto const bits = info.packing & 63;
+        auto value = std::uint64_t(0);
+        if (bits != 0) {
+            auto const at = (element % k_block_elements) * bits;
+            auto const word = (info.packing >> 6) + at / 32;
+            if (bits > 32 || word + ((at & 31) + bits > 32 ? 1 : 0) >= data.payload.size()) {
+                throw std::runtime_error("Malformed compressed stream");
+            }
+            value = data.payload[word] >> (at & 31);
+            if ((at & 31) + bits > 32) {
+                value |= std::uint64_t(data.payload[word + 1]) << (32 - (at & 31));
+            }
+            value &= (std::uint64_t(1) << bits) - 1;
+        }
+        out[i] = info.reference + static_cast<std::uint32_t>(value);
+    }
+}
+
+} // namespace gpu_codec
+
+/**
+ * @brief Offline reordering of indexed triangle lists for the post-transform vertex cache,
+ * for overdraw and for vertex fetch, following Sander et al., "Fast Triangle Reordering for
+ * Vertex Locality and Reduced Overdraw" (Tipsify). All passes are pure CPU work on plain
+ * arrays, so they run the same at load time and in asset tools.
+ */
+namespace mesh_optimizer {
+
+constexpr std::uint32_t k_cache_size = 16;
+constexpr std::uint32_t k_meshlet_vertices = 64;
+constexpr std::uint32_t k_meshlet_triangles = 124;
+
+struct passes {
+    enum type : unsigned {
+        NONE = 0,
+        VERTEX_CACHE = 0x1,
+        OVERDRAW = 0x2,
+        VERTEX_FETCH = 0x4,
+        ALL = VERTEX_CACHE | OVERDRAW | VERTEX_FETCH,
+        MESHLETS = 0x8          /* Not a reordering: also split into clusters, see build_meshlets() */
+    };
+};
+
+/**
+ * @brief Average cache miss ratio (misses per triangle, 0.5 at best and 3 at worst) and
+ * average transformed vertex ratio (misses per vertex, 1 at best) of a FIFO cache.
+ */
+struct cache_statistics {
+    float acmr = 0.0f;
+    float atvr = 0.0f;
+};
+
+/**
+ * @brief A FIFO post-transform cache simulated with timestamps: a vertex is a hit while fewer
+ * than cache_size misses happened since it was last loaded.
+ */
+class fifo_cache {
+public:
+    fifo_cache(std::size_t vertex_ct, std::uint32_t cache_size)
+        : m_time(vertex_ct, 0), m_now(cache_size + 1), m_size(cache_size) {}
+
+    bool contains(std::uint32_t vertex) const noexcept {
+        return m_now - m_time[vertex] <= m_size;
+    }
+
+    /**
+     * @brief Reference a vertex, returns whether it missed.
+     */
+    bool touch(std::uint32_t vertex) noexcept {
+        if (this->contains(vertex)) {
+            return false;
+        }
+        m_time[vertex] = m_now++;
+        return true;
+    }
+
+    void reset() noexcept {
+        m_now += m_size + 1;
+    }
+
+    std::uint32_t age(std::uint32_t vertex) const noexcept {
+        return m_now - m_time[vertex];
+    }
+
+private:
+    std::vector<std::uint32_t> m_time;
+    std::uint32_t m_now;
+    std::uint32_t m_size;
+};
+
+inline cache_statistics analyze_vertex_cache(std::span<std::uint32_t const> indices, std::size_t vertex_ct,
+                                             std::uint32_t cache_size = k_cache_size) {
+    if (indices.size() < 3 || vertex_ct == 0) {
+        return {};
+    }
+    auto cache = fifo_cache(vertex_ct, cache_size);
+    auto misses = std::size_t(0);
+    for (auto const index : indices) {
+        misses += cache.touch(index);
+    }
+    return { float(misses) / float(indices.size() / 3), float(misses) / float(vertex_ct) };
+}
+
+/**
+ * @brief Triangles sharing each vertex, as a compressed adjacency list.
+ */
+struct triangle_adjacency {
+    std::vector<std::uint32_t> offsets;
+    std::vector<std::uint32_t> triangles;
+
+    triangle_adjacency(std::span<std::uint32_t const> indices, std::size_t vertex_ct)
+        : offsets(vertex_ct + 1, 0), triangles(indices.size()) {
+
+        for (auto const index : indices) {
+            ++offsets[index + 1];
+        }
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        auto cursor = std::vector<std::uint32_t>(offsets.begin(), offsets.end() - 1);
+        for (auto i = std::size_t(0); i < indices.size(); ++i) {
+            triangles[cursor[indices[i]]++] = static_cast<std::uint32_t>(i / 3);
+        }
+    }
+
+    std::span<std::uint32_t const> of(std::uint32_t vertex) const noexcept {
+        return std::span(triangles).subspan(offsets[vertex], offsets[vertex + 1] - offsets[vertex]);
+    }
+};
+
+/**
+ * @brief Reorder the triangles in place for the post-transform vertex cache (Tipsify): fan
+ * around a vertex, then move on to the candidate vertex that will still be in the cache
+ * once its remaining triangles are emitted, backtracking through recently used vertices at
+ * dead ends. Linear time; the ACMR usually lands within 10% of the best known orders.
+ */
+inline void optimize_vertex_cache(std::span<std::uint32_t> indices, std::size_t vertex_ct,
+                                  std::uint32_t cache_size = k_cache_size) {
+    auto const triangle_ct = indices.size() / 3;
+    if (triangle_ct == 0) {
+        return;
+    }
+    auto const adjacency = triangle_adjacency(indices, vertex_ct);
+    auto live = std::vector<std::uint32_t>(vertex_ct);
+    for (auto v = std::size_t(0); v < vertex_ct; ++v) {
+        live[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+    }
+    auto cache = fifo_cache(vertex_ct, cache_size);
+    auto emitted = std::vector<bool>(triangle_ct, false);
+    auto dead_ends = std::vector<std::uint32_t>();
+    auto candidates = std::vector<std::uint32_t>();
+    auto result = std::vector<std::uint32_t>();
+    result.reserve(indices.size());
+    auto cursor = std::uint32_t(0);
+
+    auto const skip_dead_end = [&]() -> std::int64_t {
+        while (!dead_ends.empty()) {
+            auto const vertex = dead_ends.back();
+            dead_ends.pop_back();
+            if (live[vertex] > 0) {
+                return vertex;
+            }
+        }
+        for (; cursor < vertex_ct; ++cursor) {
+            if (live[cursor] > 0) {
+                return cursor;
+            }
+        }
+        return -1;
+    };
+
+    for (auto fan = skip_dead_end(); fan >= 0;) {
+        candidates.clear();
+        for (auto const triangle : adjacency.of(static_cast<std::uint32_t>(fan))) {
+            if (emitted[triangle]) {
+                continue;
+            }
+            emitted[triangle] = true;
+            for (auto k = 0; k < 3; ++k) {
+                auto const vertex = indices[triangle * 3 + k];
+                result.push_back(vertex);
+                dead_ends.push_back(vertex);
+                candidates.push_back(vertex);
+                --live[vertex];
+                cache.touch(vertex);
+            }
+        }
+        auto best = std::int64_t(-1);
+        auto best_priority = std::int64_t(-1);
+        for (auto const vertex : candidates) {
+            if (live[vertex] == 0) {
+                continue;
+            }
+            // Fanning the vertex pushes up to 2 misses per triangle; prefer the oldest vertex
+            // that survives that, any other one is worth 0.
+            auto priority = std::int64_t(0);
+            if (cache.age(vertex) + 2 * live[vertex] <= cache_size) {
+                priority = cache.age(vertex);
+            }
+            if (priority > best_priority) {
+                best = vertex;
+                best_priority = priority;
+            }
+        }
+        fan = best >= 0 ? best : skip_dead_end();
+    }
+    std::ranges::copy(result, indices.begin());
+}
+
+/**
+ * @brief Reorder clusters of triangles in place so that the outer ones facing away from the
+ * mesh center, which are likely to occlude the rest from any viewpoint, come first. Clusters
+ * are the runs the cache order already has, split further as long as that keeps each run
+ * below threshold times its ACMR, so the vertex cache order survives (call this after
+ * optimize_vertex_cache). Positions are the 3 first floats of every stride floats.
+ */
+inline void optimize_overdraw(std::span<std::uint32_t> indices, std::span<float const> vertices, std::size_t stride,
+                              float threshold = 1.05f, std::uint32_t cache_size = k_cache_size) {
+    auto const triangle_ct = indices.size() / 3;
+    auto const vertex_ct = vertices.size() / stride;
+    if (triangle_ct < 2 || stride < 3) {
+        return;
+    }
+    auto const position = [&](std::uint32_t vertex) {
+        return std::array<float, 3>{ vertices[vertex * stride], vertices[vertex * stride + 1], vertices[vertex * stride + 2] };
+    };
+    auto const misses_of = [&](fifo_cache& cache, std::size_t triangle) {
+        return cache.touch(indices[triangle * 3]) + cache.touch(indices[triangle * 3 + 1]) + cache.touch(indices[triangle * 3 + 2]);
+    };
+
+    // Hard boundaries: triangles that miss on every vertex, i.e. the cache order restarted.
+    auto hard = std::vector<std::size_t>();
+    auto cache = fifo_cache(vertex_ct, cache_size);
+    for (auto t = std::size_t(0); t < triangle_ct; ++t) {
+        if (misses_of(cache, t) == 3 || t == 0) {
+            hard.push_back(t);
+        }
+    }
+    hard.push_back(triangle_ct);
+
+    // Soft boundaries: cut a run as soon as its own ACMR is within the threshold of the whole one.
+    auto clusters = std::vector<std::size_t>();
+    for (auto h = std::size_t(0); h + 1 < hard.size(); ++h) {
+        auto const begin = hard[h];
+        auto const end = hard[h + 1];
+        cache.reset();
+        auto total = std::size_t(0);
+        for (auto t = begin; t < end; ++t) {
+            total += misses_of(cache, t);
+        }
+        auto const target = threshold * float(total) / float(end - begin);
+        clusters.push_back(begin);
+        cache.reset();
+        auto misses = std::size_t(0);
+        auto start = begin;
+        for (auto t = begin; t < end; ++t) {
+            misses += misses_of(cache, t);
+            if (t + 1 < end && float(misses) / float(t - start + 1) <= target) {
+                clusters.push_back(t + 1);
+                cache.reset();
+                misses = 0;
+                start = t + 1;
+            }
+        }
+    }
+    clusters.push_back(triangle_ct);
+
+    auto center = std::array<float, 3>{};
+    for (auto v = std::size_t(0); v < vertex_ct; ++v) {
+        auto const p = position(static_cast<std::uint32_t>(v));
+        for (auto k = 0; k < 3; ++k) {
+            center[k] += p[k] / float(vertex_ct);
+        }
+    }
+
+    // Sort key: distance of the cluster centroid along its (area weighted) normal.
+    auto keys = std::vector<float>(clusters.size() - 1);
+    for (auto c = std::size_t(0); c + 1 < clusters.size(); ++c) {
+        auto centroid = std::array<float, 3>{};
+        auto normal = std::array<float, 3>{};
+        auto area = 0.0f;
+        for (auto t = clusters[c]; t < clusters[c + 1]; ++t) {
+            auto const a = position(indices[t * 3]);
+            auto const b = position(indices[t * 3 + 1]);
+            auto const d = position(indices[t * 3 + 2]);
+            auto const u = std::array<float, 3>{ b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+            auto const w = std::array<float, 3>{ d[0] - a[0], d[1] - a[1], d[2] - a[2] };
+            auto const n = std::array<float, 3>{ u[1] * w[2] - u[2] * w[1], u[2] * w[0] - u[0] * w[2], u[0] * w[1] - u[1] * w[0] };
+            auto const weight = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            for (auto k = 0; k < 3; ++k) {
+                centroid[k] += (a[k] + b[k] + d[k]) / 3.0f * weight;
+                normal[k] += n[k];
+            }
+            area += weight;
+        }
+        auto const length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        if (area <= 0.0f || length <= 0.0f) {
+            continue;
+        }
+        for (auto k = 0; k < 3; ++k) {
+            keys[c] += (centroid[k] / area - center[k]) * normal[k] / length;
+        }
+    }
+
+    auto order = std::vector<std::size_t>(keys.size());
+    std::iota(order.begin(), order.end(), std::size_t(0));
+    std::ranges::stable_sort(order, [&](auto lhs, auto rhs) { return keys[lhs] > keys[rhs]; });
+
+    auto result = std::vector<std::uint32_t>();
+    result.reserve(indices.size());
+    for (auto const c : order) {
+        result.insert(result.end(), indices.begin() + clusters[c] * 3, indices.begin() + clusters[c + 1] * 3);
+    }
+    std::ranges::copy(result, indices.begin());
+}
+
+/**
+ * @brief Reorder the vertices in place in the order the indices first use them, and remap the
+ * indices, so that vertex fetch streams through memory. Unreferenced vertices are moved to
+ * the end; returns the count of referenced ones.
+ */
+inline std::size_t optimize_vertex_fetch(std::span<std::byte> vertices, std::size_t stride, std::span<std::uint32_t> indices) {
+    auto const vertex_ct = vertices.size() / stride;
+    auto constexpr k_unused = ~std::uint32_t(0);
+    auto remap = std::vector<std::uint32_t>(vertex_ct, k_unused);
+    auto next = std::uint32_t(0);
+    for (auto& index : indices) {
+        if (remap[index] == k_unused) {
+            remap[index] = next++;
+        }
+        index = remap[index];
+    }
+    auto const used = next;
+    for (auto& target : remap) {
+        if (target == k_unused) {
+            target = next++;
+        }
+    }
+    auto const source = std::vector<std::byte>(vertices.begin(), vertices.begin() + vertex_ct * stride);
+    for (auto v = std::size_t(0); v < vertex_ct; ++v) {
+        std::memcpy(vertices.data() + remap[v] * stride, source.data() + v * stride, stride);
+    }
+    return used;
+}
+
+template<typename Vertex>
+requires std::is_trivially_copyable_v<Vertex>
+std::size_t optimize_vertex_fetch(std::span<Vertex> vertices, std::span<std::uint32_t> indices) {
+    return optimize_vertex_fetch(std::as_writable_bytes(vertices), sizeof(Vertex), indices);
+}
+
+/**
+ * @brief A symmetric 4x4 error quadric (the upper triangle), weighted by the area of the
+ * planes summed into it so that error() is a mean squared distance.
+ */
+struct quadric {
+    std::array<double, 10> q = {};
+    double weight = 0.0;
+
+    static quadric of_plane(double a, double b, double c, double d, double w) noexcept {
+        return { { a * a * w, a * b * w, a * c * w, a * d * w, b * b * w, b * c * w, b * d * w, c * c * w, c * d * w, d * d * w }, w };
+    }
+
+    quadric& operator +=(quadric const& other) noexcept {
+        for (auto i = 0; i < 10; ++i) {
+            q[i] += other.q[i];
+        }
+        weight += other.weight;
+        return *this;
+    }
+
+    /**
+     * @brief Root mean squared distance of a point to the planes.
+     */
+    double error(double x, double y, double z) const noexcept {
+        auto const squared = q[0] * x * x + 2 * q[1] * x * y + 2 * q[2] * x * z + 2 * q[3] * x
+                           + q[4] * y * y + 2 * q[5] * y * z + 2 * q[6] * y
+                           + q[7] * z * z + 2 * q[8] * z + q[9];
+        return weight > 0.0 ? std::sqrt(std::max(squared, 0.0) / weight) : 0.0;
+    }
+};
+
+/**
+ * @brief Simplify a triangle list by quadric error edge collapses (Garland and Heckbert) onto
+ * existing vertices, so the result indexes the same vertex buffer. Border vertices (and so
+ * seams of split vertices) never move, and collapses that would flip a triangle are refused.
+ * Collapses run in passes of the cheapest independent ones until the index count reaches
+ * the target or the next collapse would exceed max_error (a distance in model units).
+ *
+ * @param error Receives the largest error introduced, e.g. to select levels of detail by.
+ */
+inline std::vector<std::uint32_t> simplify(std::span<std::uint32_t const> indices, std::span<float const> vertices, std::size_t stride,
+                                           std::size_t target_index_ct, float max_error = std::numeric_limits<float>::max(),
+                                           float* error = nullptr) {
+    auto const vertex_ct = vertices.size() / stride;
+    auto result = std::vector<std::uint32_t>(indices.begin(), indices.end() - indices.size() % 3);
+    auto const position = [&](std::uint32_t vertex) {
+        return std::array<double, 3>{ vertices[vertex * stride], vertices[vertex * stride + 1], vertices[vertex * stride + 2] };
+    };
+    auto const normal_of = [&](std::uint32_t a, std::uint32_t b, std::uint32_t c) {
+        auto const p = position(a), q = position(b), r = position(c);
+        auto const u = std::array<double, 3>{ q[0] - p[0], q[1] - p[1], q[2] - p[2] };
+        auto const v = std::array<double, 3>{ r[0] - p[0], r[1] - p[1], r[2] - p[2] };
+        return std::array<double, 3>{ u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0] };
+    };
+
+    auto quadrics = std::vector<quadric>(vertex_ct);
+    auto edges = std::unordered_map<std::uint64_t, int>();
+    for (auto t = std::size_t(0); t < result.size(); t += 3) {
+        auto const n = normal_of(result[t], result[t + 1], result[t + 2]);
+        auto const length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (length > 0.0) {
+            auto const p = position(result[t]);
+            auto const plane = quadric::of_plane(n[0] / length, n[1] / length, n[2] / length,
+                                                 -(n[0] * p[0] + n[1] * p[1] + n[2] * p[2]) / length, length * 0.5);
+            for (auto k = 0; k < 3; ++k) {
+                quadrics[result[t + k]] += plane;
+            }
+        }
+        for (auto k = 0; k < 3; ++k) {
+            auto const a = std::uint64_t(result[t + k]);
+            auto const b = std::uint64_t(result[t + (k + 1) % 3]);
+            ++edges[std::min(a, b) << 32 | std::max(a, b)];
+        }
+    }
+    auto locked = std::vector<bool>(vertex_ct, false);
+    for (auto const& [edge, count] : edges) {
+        if (count == 1) {
+            locked[edge >> 32] = true;
+            locked[edge & 0xFFFFFFFF] = true;
+        }
+    }
+
+    struct collapse {
+        std::uint32_t from;
+        std::uint32_t to;
+        float error;
+    };
+    auto largest = 0.0f;
+    auto candidates = std::vector<collapse>();
+    auto touched = std::vector<bool>(vertex_ct);
+    auto remap = std::vector<std::uint32_t>(vertex_ct);
+    while (result.size() > target_index_ct) {
+        candidates.clear();
+        for (auto t = std::size_t(0); t < result.size(); t += 3) {
+            for (auto k = 0; k < 3; ++k) {
+                auto const a = result[t + k];
+                auto const b = result[t + (k + 1) % 3];
+                for (auto const& [from, to] : { std::pair(a, b), std::pair(b, a) }) {
+                    if (locked[from]) {
+                        continue;
+                    }
+                    auto combined = quadrics[from];
+                    combined += quadrics[to];
+                    auto const p = position(to);
+                    candidates.push_back({ from, to, static_cast<float>(combined.error(p[0], p[1], p[2])) });
+                }
+            }
+        }
+        std::ranges::sort(candidates, {}, &collapse::error);
+
+        auto const adjacency = triangle_adjacency(result, vertex_ct);
+        std::fill(touched.begin(), touched.end(), false);
+        std::iota(remap.begin(), remap.end(), 0u);
+        auto budget = (result.size() - target_index_ct) / 3;
+        auto collapsed = std::size_t(0);
+        for (auto const& candidate : candidates) {
+            if (candidate.error > max_error || budget == 0) {
+                break;
+            }
+            if (touched[candidate.from] || touched[candidate.to]) {
+                continue;
+            }
+            auto flips = false;
+            for (auto const triangle : adjacency.of(candidate.from)) {
+                auto corners = std::array<std::uint32_t, 3>{ result[triangle * 3], result[triangle * 3 + 1], result[triangle * 3 + 2] };
+                if (std::ranges::find(corners, candidate.to) != corners.end()) {
+                    continue;               // Collapses into a degenerate triangle, removed.
+                }
+                auto const before = normal_of(corners[0], corners[1], corners[2]);
+                std::ranges::replace(corners, candidate.from, candidate.to);
+                auto const after = normal_of(corners[0], corners[1], corners[2]);
+                if (before[0] * after[0] + before[1] * after[1] + before[2] * after[2] <= 0.0) {
+                    flips = true;
+                    break;
+                }
+            }
+            if (flips) {
+                continue;
+            }
+            remap[candidate.from] = candidate.to;
+            quadrics[candidate.to] += quadrics[candidate.from];
+            for (auto const triangle : adjacency.of(candidate.from)) {
+                for (auto k = 0; k < 3; ++k) {
+                    touched[result[triangle * 3 + k]] = true;
+                }
+            }
+            largest = std::max(largest, candidate.error);
+            budget -= std::min<std::size_t>(budget, 2);     // An interior collapse removes two triangles.
+            ++collapsed;
+        }
+        if (collapsed == 0) {
+            break;
+        }
+
+        auto kept = std::size_t(0);
+        for (auto t = std::size_t(0); t < result.size(); t += 3) {
+            auto const a = remap[result[t]], b = remap[result[t + 1]], c = remap[result[t + 2]];
+            if (a != b && b != c && c != a) {
+                result[kept++] = a;
+                result[kept++] = b;
+                result[kept++] = c;
+            }
+        }
+        result.resize(kept);
+    }
+    if (error != nullptr) {
+        *error = largest;
+    }
+    return result;
+}
+
+/**
+ * @brief A cluster of consecutive triangles of an index list, with its bounding sphere and the
+ * cone of its normals: the cluster faces away from every point for which
+ * dot(normalize(cone_apex - point), cone_axis) >= cone_cutoff (never, if cone_cutoff is 1).
+ */
+struct meshlet {
+    std::uint32_t first_index;
+    std::uint32_t index_ct;
+    std::uint32_t vertex_ct;
+    std::array<float, 3> center;
+    float radius;
+    std::array<float, 3> cone_apex;
+    std::array<float, 3> cone_axis;
+    float cone_cutoff;
+};
+
+/**
+ * @brief Split a triangle list into meshlets of at most max_vertices distinct vertices and
+ * max_triangles triangles. Triangles are taken in order, so run optimize_vertex_cache() first
+ * for compact clusters; since every meshlet is a range of the index list, the clusters draw
+ * with plain glDrawElements-style ranges (e.g. one indirect command each).
+ */
+inline std::vector<meshlet> build_meshlets(std::span<std::uint32_t const> indices, std::span<float const> vertices, std::size_t stride,
+                                           std::uint32_t max_vertices = k_meshlet_vertices,
+                                           std::uint32_t max_triangles = k_meshlet_triangles) {
+    using vec3 = std::array<float, 3>;
+    auto const position = [&](std::uint32_t vertex) {
+        return vec3{ vertices[vertex * stride], vertices[vertex * stride + 1], vertices[vertex * stride + 2] };
+    };
+    auto const subtract = [](vec3 const& a, vec3 const& b) { return vec3{ a[0] - b[0], a[1] - b[1], a[2] - b[2] }; };
+    auto const dot = [](vec3 const& a, vec3 const& b) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; };
+    auto const normalized = [&](vec3 const& a) {
+        auto const length = std::sqrt(dot(a, a));
+        return length > 0.f ? vec3{ a[0] / length, a[1] / length, a[2] / length } : vec3{};
+    };
+
+    auto result = std::vector<meshlet>();
+    auto const finish = [&](std::size_t first, std::size_t last, std::uint32_t vertex_ct) {
+        auto low = position(indices[first]), high = low;
+        for (auto i = first; i < last; ++i) {
+            auto const p = position(indices[i]);
+            for (auto k = 0; k < 3; ++k) {
+                low[k] = std::min(low[k], p[k]);
+                high[k] = std::max(high[k], p[k]);
+            }
+        }
+        auto cluster = meshlet{ static_cast<std::uint32_t>(first), static_cast<std::uint32_t>(last - first), vertex_ct,
+                                { (low[0] + high[0]) * 0.5f, (low[1] + high[1]) * 0.5f, (low[2] + high[2]) * 0.5f }, 0.f, {}, {}, 1.f };
+        for (auto i = first; i < last; ++i) {
+            auto const offset = subtract(position(indices[i]), cluster.center);
+            cluster.radius = std::max(cluster.radius, std::sqrt(dot(offset, offset)));
+        }
+
+        auto planes = std::vector<std::pair<vec3, vec3>>();     // A corner and the unit normal of each triangle.
+        auto axis = vec3{};
+        for (auto i = first; i < last; i += 3) {
+            auto const p = position(indices[i]);
+            auto const u = subtract(position(indices[i + 1]), p), v = subtract(position(indices[i + 2]), p);
+            auto const normal = vec3{ u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0] };
+            for (auto k = 0; k < 3; ++k) {
+                axis[k] += normal[k];                   // Area weighted.
+            }
+            if (dot(normal, normal) > 0.f) {
+                planes.emplace_back(p, normalized(normal));
+            }
+        }
+        cluster.cone_axis = normalized(axis);
+        cluster.cone_apex = cluster.center;
+        auto spread = 1.f;                              // Smallest cosine between the axis and a normal.
+        for (auto const& [corner, normal] : planes) {
+            spread = std::min(spread, dot(normal, cluster.cone_axis));
+        }
+        if (!planes.empty() && spread > 0.1f) {         // Wider cones (e.g. curved patches) cull too rarely.
+            auto farthest = 0.f;                        // Move the apex so that the cone holds every triangle.
+            for (auto const& [corner, normal] : planes) {
+                farthest = std::max(farthest, dot(subtract(cluster.center, corner), normal) / dot(cluster.cone_axis, normal));
+            }
+            for (auto k = 0; k < 3; ++k) {
+                cluster.cone_apex[k] = cluster.center[k] - cluster.cone_axis[k] * farthest;
+            }
+            cluster.cone_cutoff = std::sqrt(1.f - spread * spread);
+        }
+        result.push_back(cluster);
+    };
+
+    auto const vertex_ct = vertices.size() / stride;
+    auto stamp = std::vector<std::size_t>(vertex_ct, std::size_t(-1));       // Meshlet a vertex was last counted in.
+    auto first = std::size_t(0);
+    auto used = std::uint32_t(0);
+    auto const triangle_end = indices.size() - indices.size() % 3;
+    auto const new_vertices = [&](std::size_t i) {
+        auto added = std::uint32_t(0);
+        for (auto k = std::size_t(0); k < 3; ++k) {
+            auto const repeated = std::find(indices.begin() + i, indices.begin() + i + k, indices[i + k]) != indices.begin() + i + k;
+            added += !repeated && stamp[indices[i + k]] != result.size();
+        }
+        return added;
+    };
+    for (auto i = std::size_t(0); i < triangle_end; i += 3) {
+        auto added = new_vertices(i);
+        if (used + added > max_vertices || (i - first) / 3 >= max_triangles) {
+            finish(first, i, used);
+            first = i;
+            used = 0;
+            added = new_vertices(i);
+        }
+        for (auto k = 0; k < 3; ++k) {
+            stamp[indices[i + k]] = result.size();
+        }
+        used += added;
+    }
+    if (first < triangle_end) {
+        finish(first, triangle_end, used);
+    }
+    return result;
+}
+
+/**
+ * @brief Run the passes in their intended order on a float vertex array of the given
+ * components per vertex (positions first), e.g. from an asset pipeline. Vertices the indices
+ * do not reference are dropped by VERTEX_FETCH.
+ */
+inline void optimize(std::vector<float>& vertices, std::size_t components, std::vector<std::uint32_t>& indices,
+                     unsigned selected = passes::ALL, std::uint32_t cache_size = k_cache_size) {
+    if (components == 0) {
+        throw std::runtime_error("Vertices must have at least one component");
+    }
+    auto const vertex_ct = vertices.size() / components;
+    if (std::ranges::any_of(indices, [&](auto index) { return index >= vertex_ct; })) {
+        throw std::runtime_error("Index out of the vertex range");
+    }
+    if (selected & passes::VERTEX_CACHE) {
+        optimize_vertex_cache(indices, vertex_ct, cache_size);
+    }
+    if (selected & passes::OVERDRAW) {
+        optimize_overdraw(indices, vertices, components, 1.05f, cache_size);
+    }
+    if (selected & passes::VERTEX_FETCH) {
+        auto const used = optimize_vertex_fetch(std::as_writable_bytes(std::span(vertices)), components * sizeof(float), indices);
+        vertices.resize(used * components);
+    }
+}
+
+} // namespace mesh_optimizer
+
+/**
+ * @brief A versioned binary mesh container that is used in place, e.g. memory-mapped with
+ * mapped_file: a header, then 16-byte aligned blocks of attribute descriptors, vertices,
+ * indices, levels of detail and meshlets, all little-endian and laid out exactly as the GPU
+ * (or mesh_optimizer) takes them, so loading is a validation and the uploads.
+ * Written by write() (see tools/mesh_convert.cpp), read by parse().
+ */
+namespace mesh_asset {
+
+constexpr std::uint32_t k_magic = 0x414D4C47;       // "GLMA"
+constexpr std::uint32_t k_version = 1;
+constexpr std::size_t k_alignment = 16;
+
+/**
+ * @brief A vertex attribute: `components` of a GL type enum (e.g. GL_FLOAT) `offset` bytes
+ * into the vertex, fed to `location`.
+ */
+struct attribute {
+    enum flag : std::uint32_t {
+        NONE = 0,
+        NORMALIZED = 0x1,
+        INTEGER = 0x2           /* Read as ivecN/uvecN, with no conversion */
+    };
+
+    std::uint32_t location;
+    std::uint32_t components;
+    std::uint32_t type;
+    std::uint32_t flags;
+    std::uint32_t offset;
+};
+
+/**
+ * @brief A level of detail: a range of the indices and its geometric error in model units.
+ */
+struct lod {
+    std::uint32_t first_index;
+    std::uint32_t index_ct;
+    float error;
+};
+
+struct header {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t stride;               /* Bytes per vertex */
+    std::uint32_t index_size;           /* 2 or 4 */
+    std::uint32_t attribute_ct;
+    std::uint32_t lod_ct;
+    std::uint32_t meshlet_ct;
+    std::uint32_t reserved;
+    std::uint64_t attribute_offset;     /* Byte offsets of the blocks from the start of the file */
+    std::uint64_t vertex_offset;
+    std::uint64_t vertex_bytes;
+    std::uint64_t index_offset;
+    std::uint64_t index_bytes;
+    std::uint64_t lod_offset;
+    std::uint64_t meshlet_offset;
+    float min[3];                       /* Model space bounds */
+    float max[3];
+};
+
+/**
+ * @brief Bytes of an attribute in the vertex, 0 for a type the format does not know.
+ */
+constexpr std::size_t size_of(attribute const& entry) noexcept {
+    switch (entry.type) {
+    case 0x1400: case 0x1401:                   return entry.components;        // GL_(UNSIGNED_)BYTE
+    case 0x1402: case 0x1403: case 0x140B:      return entry.components * 2;    // GL_(UNSIGNED_)SHORT, GL_HALF_FLOAT
+    case 0x1404: case 0x1405: case 0x1406:      return entry.components * 4;    // GL_(UNSIGNED_)INT, GL_FLOAT
+    case 0x140A:                                return entry.components * 8;    // GL_DOUBLE
+    case 0x8D9F: case 0x8368:                   return entry.components == 4 ? 4 : 0;  // GL_(UNSIGNED_)INT_2_10_10_10_REV
+    default:                                    return 0;
+    }
+}
+
+static_assert(sizeof(header) == 112 && sizeof(attribute) == 20 && sizeof(lod) == 12, "The layout of the format is fixed");
+static_assert(std::is_trivially_copyable_v<mesh_optimizer::meshlet> && sizeof(mesh_optimizer::meshlet) == 56,
+              "Meshlets are stored as they are in memory");
+
+/**
+ * @brief A parsed asset: views into the file's bytes, valid as long as they are.
+ */
+struct view {
+    header const* info = nullptr;
+    std::span<attribute const> attributes;
+    std::span<std::byte const> vertices;
+    std::span<std::byte const> indices;
+    std::span<lod const> lods;
+    std::span<mesh_optimizer::meshlet const> meshlets;
+};
+
+/**
+ * @brief Validate the header, the extent and alignment of every block, the attributes against
+ * the stride and the indices against the vertex count, and point into the blocks. The bytes
+ * must be aligned to k_alignment, as mapped pages are.
+ */
+inline view parse(std::span<std::byte const> bytes) {
+    if (bytes.size() < sizeof(header) || reinterpret_cast<std::uintptr_t>(bytes.data()) % k_alignment != 0) {
+        throw std::runtime_error("Not a mesh asset: too small or misaligned");
+    }
+    auto const* const info = reinterpret_cast<header const*>(bytes.data());
+    if (info->magic != k_magic) {
+        throw std::runtime_error("Not a mesh asset: bad magic");
+    }
+    if (info->version != k_version) {
+        throw std::runtime_error("Unsupported mesh asset version " + std::to_string(info->version));
+    }
+    if ((info->index_size != 2 && info->index_size != 4) || info->stride == 0) {
+        throw std::runtime_error("Corrupt mesh asset: bad index size or stride");
+    }
+    auto const block = [&](std::uint64_t offset, std::uint64_t size) {
+        if (offset % k_alignment != 0 || offset > bytes.size() || size > bytes.size() - offset) {
+            throw std::runtime_error("Corrupt mesh asset: block out of the file");
+        }
+        return bytes.subspan(static_cast<std::size_t>(offset), static_cast<std::size_t>(size));
+    };
+    auto result = view();
+    result.info = info;
+    result.attributes = { reinterpret_cast<attribute const*>(block(info->attribute_offset, info->attribute_ct * sizeof(attribute)).data()),
+                          info->attribute_ct };
+    result.vertices = block(info->vertex_offset, info->vertex_bytes);
+    result.indices = block(info->index_offset, info->index_bytes);
+    result.lods = { reinterpret_cast<lod const*>(block(info->lod_offset, info->lod_ct * sizeof(lod)).data()), info->lod_ct };
+    result.meshlets = { reinterpret_cast<mesh_optimizer::meshlet const*>(block(info->meshlet_offset, info->meshlet_ct * sizeof(mesh_optimizer::meshlet)).data()),
+                        info->meshlet_ct };
+    if (result.vertices.size() % info->stride != 0 || result.indices.size() % info->index_size != 0) {
+        throw std::runtime_error("Corrupt mesh asset: partial vertex or index");
+    }
+    auto const index_ct = result.indices.size() / info->index_size;
+    for (auto const& level : result.lods) {
+        if (level.first_index > index_ct || level.index_ct > index_ct - level.first_index) {
+            throw std::runtime_error("Corrupt mesh asset: level of detail out of the indices");
+        }
+    }
+    for (auto const& cluster : result.meshlets) {
+        if (cluster.first_index > index_ct || cluster.index_ct > index_ct - cluster.first_index) {
+            throw std::runtime_error("Corrupt mesh asset: meshlet out of the indices");
+        }
+    }
+    for (auto const& entry : result.attributes) {
+        auto const size = size_of(entry);
+        if (entry.components == 0 || entry.components > 4 || size == 0 || entry.offset > info->stride || size > info->stride - entry.offset) {
+            throw std::runtime_error("Corrupt mesh asset: attribute out of the vertex");
+        }
+    }
+    auto const vertex_ct = result.vertices.size() / info->stride;
+    auto const in_range = [index_ct, vertex_ct](auto const* indices) {
+        return std::all_of(indices, indices + index_ct, [vertex_ct](auto index) { return index < vertex_ct; });
+    };
+    auto const* const indices = result.indices.data();
+    if (!(info->index_size == 2 ? in_range(reinterpret_cast<std::uint16_t const*>(indices)) : in_range(reinterpret_cast<std::uint32_t const*>(indices)))) {
+        throw std::runtime_error("Corrupt mesh asset: index out of the vertices");
+    }
+    return result;
+}
+
+/**
+ * @brief Everything write() stores. The indices are narrowed to 16 bits whenever they fit;
+ * with no levels of detail, one covering all indices is written.
+ */
+struct source {
+    std::uint32_t stride = 0;
+    std::vector<attribute> attributes;
+    std::span<std::byte const> vertices;
+    std::span<std::uint32_t const> indices;
+    std::vector<lod> lods;
+    std::vector<mesh_optimizer::meshlet> meshlets;
+    std::array<float, 3> min = {};
+    std::array<float, 3> max = {};
+};
+
+inline void write(std::ostream& out, source const& mesh) {
+    auto const narrow = !mesh.indices.empty() && std::ranges::max(mesh.indices) <= 0xFFFF;
+    auto const all = std::vector<lod>{ { 0, static_cast<std::uint32_t>(mesh.indices.size()), 0.f } };
+    auto const& lods = mesh.lods.empty() ? all : mesh.lods;
+
+    auto info = header();
+    info.magic = k_magic;
+    info.version = k_version;
+    info.stride = mesh.stride;
+    info.index_size = narrow ? 2u : 4u;
+    info.attribute_ct = static_cast<std::uint32_t>(mesh.attributes.size());
+    info.lod_ct = static_cast<std::uint32_t>(lods.size());
+    info.meshlet_ct = static_cast<std::uint32_t>(mesh.meshlets.size());
+    auto end = std::uint64_t(sizeof(header));
+    auto const place = [&end](std::uint64_t& offset, std::uint64_t size) {
+        offset = (end + k_alignment - 1) / k_alignment * k_alignment;
+        end = offset + size;
+    };
+    place(info.attribute_offset, mesh.attributes.size() * sizeof(attribute));
+    place(info.vertex_offset, info.vertex_bytes = mesh.vertices.size());
+    place(info.index_offset, info.index_bytes = mesh.indices.size() * info.index_size);
+    place(info.lod_offset, lods.size() * sizeof(lod));
+    place(info.meshlet_offset, mesh.meshlets.size() * sizeof(mesh_optimizer::meshlet));
+    std::ranges::copy(mesh.min, info.min);
+    std::ranges::copy(mesh.max, info.max);
+
+    auto written = std::uint64_t(0);
+    auto const put = [&](std::uint64_t offset, void const* data, std::size_t size) {
+        static constexpr char k_padding[k_alignment] = {};
+        out.write(k_padding, static_cast<std::streamsize>(offset - written));
+        out.write(static_cast<char const*>(data), static_cast<std::streamsize>(size));
+        written = offset + size;
+    };
+    put(0, &info, sizeof(info));
+    put(info.attribute_offset, mesh.attributes.data(), mesh.attributes.size() * sizeof(attribute));
+    put(info.vertex_offset, mesh.vertices.data(), mesh.vertices.size());
+    if (narrow) {
+        auto const indices = std::vector<std::uint16_t>(mesh.indices.begin(), mesh.indices.end());
+        put(info.index_offset, indices.data(), indices.size() * sizeof(std::uint16_t));
+    }
+    else {
+        put(info.index_offset, mesh.indices.data(), mesh.indices.size_bytes());
+    }
+    put(info.lod_offset, lods.data(), lods.size() * sizeof(lod));
+    put(info.meshlet_offset, mesh.meshlets.data(), mesh.meshlets.size() * sizeof(mesh_optimizer::meshlet));
+    if (!out) {
+        throw std::runtime_error("Could not write the mesh asset");
+    }
+}
+
+} // namespace mesh_asset
+
+/**
+ * @brief Compact vertex formats for meshes of float vertices: positions as 16-bit unorms in
+ * the mesh's box, normals and tangents octahedral-encoded in two 16-bit snorms and texture
+ * coordinates as half floats. The GPU unpacks all of them in the attribute fetch; what is
+ * left to the vertex shader is mapping positions back to the box (see gl::mesh's position
+ * transform) and gl::k_octahedral_source for directions. A position, normal and uv vertex
+ * goes from 32 to 16 bytes.
+ */
+namespace vertex_quantization {
+
+constexpr std::uint32_t k_gl_short = 0x1402;           // GL enums, without pulling in a GL loader.
+constexpr std::uint32_t k_gl_unsigned_short = 0x1403;
+constexpr std::uint32_t k_gl_half_float = 0x140B;
+constexpr std::size_t k_none = std::numeric_limits<std::size_t>::max();
+
+/**
+ * @brief Float offsets of the optional channels in a source vertex, the position being the
+ * first 3 floats. A tangent is a vec4 whose w is the handedness of the bitangent (±1).
+ */
+struct channels {
+    std::size_t normal = k_none;
+    std::size_t tangent = k_none;
+    std::size_t uv = k_none;
+};
+
+/**
+ * @brief The packed vertices: `stride` bytes each, in the order position, normal, tangent, uv
+ * (the ones present), at locations 0, 1, 3 and 2 like tools/mesh_convert.cpp puts them. The
+ * 4th position component holds the tangent handedness, 0 for -1 and 1 for +1.
+ */
+struct result {
+    std::vector<std::byte> vertices;
+    std::uint32_t stride = 0;
+    std::vector<mesh_asset::attribute> attributes;
+};
+
+/**
+ * @brief Map a unit vector onto the octahedron and unfold it into a square of [-1, 1]^2.
+ */
+inline std::array<std::int16_t, 2> octahedral(float x, float y, float z) noexcept {
+    auto const norm = std::abs(x) + std::abs(y) + std::abs(z);
+    auto u = norm > 0.f ? x / norm : 0.f;
+    auto v = norm > 0.f ? y / norm : 0.f;
+    if (z < 0.f) {
+        auto const folded_u = (1.f - std::abs(v)) * (u < 0.f ? -1.f : 1.f);
+        v = (1.f - std::abs(u)) * (v < 0.f ? -1.f : 1.f);
+        u = folded_u;
+    }
+    auto const snorm = [](float value) {
+        return static_cast<std::int16_t>(std::lround(std::clamp(value, -1.f, 1.f) * 32767.f));
+    };
+    return { snorm(u), snorm(v) };
+}
+
+/**
+ * @brief IEEE half float bits, rounded to nearest; tiny values flush to zero, large ones to
+ * infinity.
+ */
+inline std::uint16_t half_bits(float value) noexcept {
+    auto const bits = std::bit_cast<std::uint32_t>(value);
+    auto const sign = static_cast<std::uint16_t>(bits >> 16 & 0x8000);
+    auto const exponent = static_cast<std::int32_t>(bits >> 23 & 0xFF) - 127 + 15;
+    if ((bits & 0x7FFFFFFF) > 0x7F800000) {
+        return sign | 0x7E00;                       // NaN
+    }
+    if (exponent <= 0) {
+        return sign;
+    }
+    auto const rounded = (static_cast<std::uint32_t>(exponent) << 10 | (bits >> 13 & 0x3FF)) + (bits >> 12 & 1);
+    return rounded >= 0x7C00 ? sign | 0x7C00 : static_cast<std::uint16_t>(sign | rounded);
+}
+
+/**
+ * @brief Pack float vertices of `components` floats, positions quantized in [min, max] (the
+ * bounds of the mesh, which the asset header stores anyway).
+ */
+inline result quantize(std::span<float const> vertices, std::size_t components, channels const& source,
+                       std::array<float, 3> const& min, std::array<float, 3> const& max) {
+    using flag = mesh_asset::attribute;
+    auto packed = result();
+    auto const add = [&packed](std::uint32_t location, std::uint32_t count, std::uint32_t type, std::uint32_t size) {
+        packed.attributes.push_back({ location, count, type, flag::NORMALIZED, packed.stride });
+        packed.stride += size;
+    };
+    add(0, 4, k_gl_unsigned_short, 8);
+    if (source.normal != k_none) {
+        add(1, 2, k_gl_short, 4);
+    }
+    if (source.tangent != k_none) {
+        add(3, 2, k_gl_short, 4);
+    }
+    if (source.uv != k_none) {
+        add(2, 2, k_gl_half_float, 4);
+        packed.attributes.back().flags = flag::NONE;
+    }
+
+    auto const vertex_ct = vertices.size() / components;
+    packed.vertices.resize(vertex_ct * packed.stride);
+    for (auto v = std::size_t(0); v < vertex_ct; ++v) {
+        auto const* const in = vertices.data() + v * components;
+        auto* out = packed.vertices.data() + v * packed.stride;
+        auto const put = [&out](auto const& values) {
+            std::memcpy(out, values.data(), sizeof(values));
+            out += sizeof(values);
+        };
+        auto position = std::array<std::uint16_t, 4>();
+        for (auto k = 0; k < 3; ++k) {
+            auto const extent = max[k] - min[k];
+            auto const unit = extent > 0.f ? (in[k] - min[k]) / extent : 0.f;
+            position[k] = static_cast<std::uint16_t>(std::lround(std::clamp(unit, 0.f, 1.f) * 65535.f));
+        }
+        position[3] = source.tangent != k_none && in[source.tangent + 3] < 0.f ? 0 : 0xFFFF;
+        put(position);
+        if (source.normal != k_none) {
+            put(octahedral(in[source.normal], in[source.normal + 1], in[source.normal + 2]));
+        }
+        if (source.tangent != k_none) {
+            put(octahedral(in[source.tangent], in[source.tangent + 1], in[source.tangent + 2]));
+        }
+        if (source.uv != k_none) {
+            put(std::array<std::uint16_t, 2>{ half_bits(in[source.uv]), half_bits(in[source.uv + 1]) });
+        }
+    }
+    return packed;
+}
+
+} // namespace vertex_quantization
+
+/**
+ * @brief A small JSON reader for asset descriptions (e.g. glTF): the whole text is parsed into
+ * a tree of values at once. Lookups of absent members give a null value instead of throwing,
+ * so optional fields read as `doc["a"]["b"].number(1.0)`.
+ */
+namespace json {
+
+class value {
+public:
+    using array = std::vector<value>;
+    using object = std::vector<std::pair<std::string, value>>;      // In document order.
+
+    value() = default;
+
+    explicit value(std::variant<std::nullptr_t, bool, double, std::string, array, object> data)
+        : m_data(std::move(data)) {}
+
+    bool is_null() const noexcept {
+        return std::holds_alternative<std::nullptr_t>(m_data);
+    }
+
+    bool is_number() const noexcept {
+        return std::holds_alternative<double>(m_data);
+    }
+
+    bool is_string() const noexcept {
+        return std::holds_alternative<std::string>(m_data);
+    }
+
+    bool is_array() const noexcept {
+        return std::holds_alternative<array>(m_data);
+    }
+
+    bool is_object() const noexcept {
+        return std::holds_alternative<object>(m_data);
+    }
+
+    double number(double fallback = 0.0) const noexcept {
+        auto const* const result = std::get_if<double>(&m_data);
+        return result != nullptr ? *result : fallback;
+    }
+
+    /**
+     * @brief The number as an index or count; `fallback` if absent, negative or not integral.
+     */
+    std::size_t index(std::size_t fallback = std::numeric_limits<std::size_t>::max()) const noexcept {
+        auto const* const result = std::get_if<double>(&m_data);
+        return result != nullptr && *result >= 0.0 && *result == std::floor(*result) ? static_cast<std::size_t>(*result) : fallback;
+    }
+
+    bool boolean(bool fallback = false) const noexcept {
+        auto const* const result = std::get_if<bool>(&m_data);
+        return result != nullptr ? *result : fallback;
+    }
+
+    std::string_view string(std::string_view fallback = {}) const noexcept {
+        auto const* const result = std::get_if<std::string>(&m_data);
+        return result != nullptr ? std::string_view(*result) : fallback;
+    }
+
+    /**
+     * @brief The elements of an array, none for any other value.
+     */
+    std::span<value const> elements() const noexcept {
+        auto const* const result = std::get_if<array>(&m_data);
+        return result != nullptr ? std::span<value const>(*result) : std::span<value const>();
+    }
+
+    /**
+     * @brief The members of an object, none for any other value.
+     */
+    std::span<std::pair<std::string, value> const> members() const noexcept {
+        auto const* const result = std::get_if<object>(&m_data);
+        return result != nullptr ? std::span<std::pair<std::string, value> const>(*result) : std::span<std::pair<std::string, value> const>();
+    }
+
+    std::size_t size() const noexcept {
+        return this->is_array() ? this->elements().size() : this->members().size();
+    }
+
+    bool contains(std::string_view key) const noexcept {
+        return std::ranges::any_of(this->members(), [key](auto const& member) { return member.first == key; });
+    }
+
+    value const& operator [](std::string_view key) const noexcept {
+        for (auto const& [name, member] : this->members()) {
+            if (name == key) {
+                return member;
+            }
+        }
+        return null();
+    }
+
+    value const& operator [](std::size_t i) const noexcept {
+        auto const items = this->elements();
+        return i < items.size() ? items[i] : null();
+    }
+
+    static value const& null() noexcept {
+        static auto const k_null = value();
+        return k_null;
+    }
+
+private:
+    std::variant<std::nullptr_t, bool, double, std::string, array, object> m_data = nullptr;
+};
+
+namespace detail {
+
+class parser {
+public:
+    explicit parser(std::string_view text)
+        : m_text(text) {}
+
+    value document() {
+        auto result = this->any(0);
+        this->skip_space();
+        if (m_position != m_text.size()) {
+            this->fail("trailing characters");
+        }
+        return result;
+    }
+
+private:
+    static constexpr auto k_max_depth = 256;
+
+    [[noreturn]] void fail(char const* what) const {
+        throw std::runtime_error("Invalid JSON at offset " + std::to_string(m_position) + ": " + what);
+    }
+
+    void skip_space() noexcept {
+        while (m_position < m_text.size() && (m_text[m_position] == ' ' || m_text[m_position] == '\t' ||
+                                              m_text[m_position] == '\n' || m_text[m_position] == '\r')) {
+            ++m_position;
+        }
+    }
+
+    bool take(char expected) {
+        this->skip_space();
+        if (m_position < m_text.size() && m_text[m_position] == expected) {
+            ++m_position;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char expected) {
+        if (!this->take(expected)) {
+            this->fail("unexpected character");
+        }
+    }
+
+    bool keyword(std::string_view word) {
+        if (m_text.substr(m_position, word.size()) == word) {
+            m_position += word.size();
+            return true;
+        }
+        return false;
+    }
+
+    value any(int depth) {
+        if (depth > k_max_depth) {
+            this->fail("nested too deep");
+        }
+        this->skip_space();
+        if (m_position >= m_text.size()) {
+            this->fail("unexpected end");
+        }
+        switch (m_text[m_position]) {
+        case '{': {
+            ++m_position;
+            auto result = value::object();
+            if (!this->take('}')) {
+                do {
+                    this->skip_space();
+                    auto key = this->string();
+                    this->expect(':');
+                    result.emplace_back(std::move(key), this->any(depth + 1));
+                } while (this->take(','));
+                this->expect('}');
+            }
+            return value(std::move(result));
+        }
+        case '[': {
+            ++m_position;
+            auto result = value::array();
+            if (!this->take(']')) {
+                do {
+                    result.push_back(this->any(depth + 1));
+                } while (this->take(','));
+                this->expect(']');
+            }
+            return value(std::move(result));
+        }
+        case '"':
+            return value(this->string());
+        default:
+            break;
+        }
+        if (this->keyword("true")) {
+            return value(true);
+        }
+        if (this->keyword("false")) {
+            return value(false);
+        }
+        if (this->keyword("null")) {
+            return value();
+        }
+        auto number = 0.0;
+        auto const* const first = m_text.data() + m_position;
+        auto const [end, error] = std::from_chars(first, m_text.data() + m_text.size(), number);
+        if (error != std::errc() || end == first) {
+            this->fail("expected a value");
+        }
+        m_position += static_cast<std::size_t>(end - first);
+        return value(number);
+    }
+
+    std::uint32_t hex4() {
+        if (m_text.size() - m_position < 4) {
+            this->fail("truncated escape");
+        }
+        auto result = std::uint32_t(0);
+        auto const [end, error] = std::from_chars(m_text.data() + m_position, m_text.data() + m_position + 4, result, 16);
+        if (error != std::errc() || end != m_text.data() + m_position + 4) {
+            this->fail("bad escape");
+        }
+        m_position += 4;
+        return result;
+    }
+
+    std::string string() {
+        if (m_position >= m_text.size() || m_text[m_position] != '"') {
+            this->fail("expected a string");
+        }
+        ++m_position;
+        auto result = std::string();
+        while (true) {
+            if (m_position >= m_text.size()) {
+                this->fail("unterminated string");
+            }
+            auto const c = m_text[m_position++];
+            if (c == '"') {
+                return result;
+            }
+            if (c != '\\') {
+                result += c;
+                continue;
+            }
+            if (m_position >= m_text.size()) {
+                this->fail("unterminated string");
+            }
+            switch (auto const escape = m_text[m_position++]) {
+            case 'b': result += '\b'; break;
+            case 'f': result += '\f'; break;
+            case 'n': result += '\n'; break;
+            case 'r': result += '\r'; break;
+            case 't': result += '\t'; break;
+            case 'u': {
+                auto code = this->hex4();
+                if (code >= 0xD800 && code < 0xDC00 && this->keyword("\\u")) {
+                    code = 0x10000 + ((code - 0xD800) << 10) + (this->hex4() - 0xDC00);
+                }
+                if (code < 0x80) {
+                    result += static_cast<char>(code);
+                }
+                else if (code < 0x800) {
+                    result += static_cast<char>(0xC0 | code >> 6);
+                    result += static_cast<char>(0x80 | (code & 0x3F));
+                }
+                else if (code < 0x10000) {
+                    result += static_cast<char>(0xE0 | code >> 12);
+                    result += static_cast<char>(0x80 | (code >> 6 & 0x3F));
+                    result += static_cast<char>(0x80 | (code & 0x3F));
+                }
+                else {
+                    result += static_cast<char>(0xF0 | code >> 18);
+                    result += static_cast<char>(0x80 | (code >> 12 & 0x3F));
+                    result += static_cast<char>(0x80 | (code >> 6 & 0x3F));
+                    result += static_cast<char>(0x80 | (code & 0x3F));
+                }
+                break;
+            }
+            default:
+                result += escape;       // '"', '\\' and '/'.
+                break;
+            }
+        }
+    }
+
+    std::string_view m_text;
+    std::size_t m_position = 0;
+};
+
+} // namespace detail
+
+/**
+ * @brief Parse a whole document. Throws std::runtime_error with the offset of the first error.
+ */
+inline value parse(std::string_view text) {
+    return detail::parser(text).document();
+}
+
+} // namespace json
+
+/**
+ * @brief Decoders of the meshoptimizer compressed buffer formats, as glTF files store them
+ * with EXT_meshopt_compression: vertex streams (mode ATTRIBUTES), triangle lists (TRIANGLES)
+ * and other index sequences (INDICES), and the filters applied to vertex streams after
+ * decoding. Follows the format specification of the extension; all of them throw
+ * std::runtime_error on malformed input rather than reading out of the data.
+ */
+namespace meshopt {
+
+namespace detail {
+
+inline std::uint32_t vbyte(std::span<std::byte const> data, std::size_t& position) {
+    auto result = std::uint32_t(0);
+    for (auto shift = 0; shift < 35; shift += 7) {
+        if (position >= data.size()) {
+            throw std::runtime_error("Truncated meshopt data");
+        }
+        auto const group = std::to_integer<std::uint32_t>(data[position++]);
+        result |= (group & 0x7F) << shift;
+        if (group < 0x80) {
+            break;
+        }
+    }
+    return result;
+}
+
+inline void put_index(std::span<std::byte> out, std::size_t index_size, std::size_t i, std::uint32_t value) {
+    if (index_size == 2) {
+        auto const narrow = static_cast<std::uint16_t>(value);
+        std::memcpy(out.data() + i * 2, &narrow, 2);
+    }
+    else {
+        std::memcpy(out.data() + i * 4, &value, 4);
+    }
+}
+
+/**
+ * @brief One byte of every vertex of a block: groups of 16 deltas of 0, 2, 4 or 8 bits, where
+ * the largest 2 and 4 bit value means the byte follows the group.
+ */
+inline void decode_bytes(std::span<std::byte const> data, std::size_t& position, std::uint8_t* out, std::size_t count) {
+    constexpr auto k_group_size = std::size_t(16);
+    constexpr auto k_group_decode_limit = std::size_t(24);
+    auto const header_size = (count / k_group_size + 3) / 4;
+    if (data.size() - position < header_size) {
+        throw std::runtime_error("Truncated meshopt vertex data");
+    }
+    auto const* const header = reinterpret_cast<std::uint8_t const*>(data.data() + position);
+    position += header_size;
+    for (auto i = std::size_t(0); i < count; i += k_group_size) {
+        if (data.size() - position < k_group_decode_limit) {
+            throw std::runtime_error("Truncated meshopt vertex data");
+        }
+        auto const group = i / k_group_size;
+        auto const bits_log2 = (header[group / 4] >> (group % 4 * 2)) & 3;
+        auto const* const in = reinterpret_cast<std::uint8_t const*>(data.data() + position);
+        if (bits_log2 == 0) {
+            std::memset(out + i, 0, k_group_size);
+        }
+        else if (bits_log2 == 3) {
+            std::memcpy(out + i, in, k_group_size);
+            position += k_group_size;
+        }
+        else {
+            auto const bits = bits_log2 == 1 ? 2u : 4u;
+            auto const sentinel = (1u << bits) - 1;
+            auto const packed = k_group_size * bits / 8;
+            auto extra = packed;
+            for (auto k = std::size_t(0); k < k_group_size; ++k) {
+                auto const code = (in[k * bits / 8] >> (8 - bits - k * bits % 8)) & sentinel;
+                out[i + k] = code == sentinel ? in[extra++] : static_cast<std::uint8_t>(code);
+            }
+            position += extra;
+        }
+    }
+}
+
+} // namespace detail
+
+/**
+ * @brief Decode `count` vertices of `stride` bytes (a multiple of 4, at most 256).
+ */
+inline void decode_vertices(std::span<std::byte> out, std::size_t count, std::size_t stride, std::span<std::byte const> data) {
+    if (stride == 0 || stride > 256 || stride % 4 != 0 || out.size() < count * stride) {
+        throw std::runtime_error("Bad meshopt vertex stride");
+    }
+    auto const tail_size = std::max<std::size_t>(stride, 32);
+    if (data.size() < 1 + tail_size || std::to_integer<std::uint8_t>(data[0]) != 0xA0) {
+        throw std::runtime_error("Unsupported meshopt vertex data");
+    }
+    auto last = std::array<std::uint8_t, 256>();
+    std::memcpy(last.data(), data.data() + data.size() - stride, stride);
+    auto const stream = data.first(data.size() - tail_size);
+    auto const block_size = std::min<std::size_t>(8192 / stride & ~std::size_t(15), 256);
+    auto bytes = std::array<std::uint8_t, 256>();
+    auto position = std::size_t(1);
+    for (auto first = std::size_t(0); first < count; first += block_size) {
+        auto const block = std::min(block_size, count - first);
+        auto* const vertices = reinterpret_cast<std::uint8_t*>(out.data() + first * stride);
+        for (auto k = std::size_t(0); k < stride; ++k) {
+            detail::decode_bytes(data, position, bytes.data(), (block + 15) & ~std::size_t(15));
+            auto previous = last[k];
+            for (auto i = std::size_t(0); i < block; ++i) {
+                auto const delta = static_cast<std::uint8_t>((0u - (bytes[i] & 1u)) ^ (bytes[i] >> 1));
+                vertices[i * stride + k] = previous = static_cast<std::uint8_t>(previous + delta);
+            }
+            last[k] = previous;
+        }
+    }
+    if (position != stream.size()) {
+        throw std::runtime_error("Corrupt meshopt vertex data");
+    }
+}
+
+/**
+ * @brief Decode a triangle list of `count` indices of `index_size` (2 or 4) bytes: triangles
+ * are coded against a FIFO of recent edges and one of recent vertices.
+ */
+inline void decode_triangles(std::span<std::byte> out, std::size_t count, std::size_t index_size, std::span<std::byte const> data) {
+    if (count % 3 != 0 || (index_size != 2 && index_size != 4) || out.size() < count * index_size) {
+        throw std::runtime_error("Bad meshopt triangle data");
+    }
+    if (data.size() < 1 + count / 3 + 16 || (std::to_integer<std::uint8_t>(data[0]) & 0xF0) != 0xE0 ||
+        (std::to_integer<std::uint8_t>(data[0]) & 0x0F) > 1) {
+        throw std::runtime_error("Unsupported meshopt triangle data");
+    }
+    auto const version = std::to_integer<std::uint32_t>(data[0]) & 0x0F;
+    auto edges = std::array<std::array<std::uint32_t, 2>, 16>();
+    auto vertices = std::array<std::uint32_t, 16>();
+    edges.fill({ ~0u, ~0u });
+    vertices.fill(~0u);
+    auto edge_offset = std::size_t(0);
+    auto vertex_offset = std::size_t(0);
+    auto const push_edge = [&](std::uint32_t a, std::uint32_t b) {
+        edges[edge_offset] = { a, b };
+        edge_offset = (edge_offset + 1) & 15;
+    };
+    auto const push_vertex = [&](std::uint32_t v, bool advance = true) {
+        vertices[vertex_offset] = v;
+        vertex_offset = (vertex_offset + advance) & 15;
+    };
+    auto const codes = data.subspan(1, count / 3);
+    auto const safe_end = data.size() - 16;
+    auto const aux_table = data.subspan(safe_end);
+    auto position = 1 + count / 3;
+    auto next = std::uint32_t(0);
+    auto last = std::uint32_t(0);
+    auto const fec_max = version >= 1 ? 13u : 15u;
+    auto const free_index = [&]() {
+        auto const v = detail::vbyte(data.first(safe_end), position);
+        return last += (v >> 1) ^ (0u - (v & 1));
+    };
+    for (auto i = std::size_t(0); i < count; i += 3) {
+        if (position > safe_end) {
+            throw std::runtime_error("Truncated meshopt triangle data");
+        }
+        auto const code = std::to_integer<std::uint32_t>(codes[i / 3]);
+        if (code < 0xF0) {
+            auto const [a, b] = edges[(edge_offset - 1 - (code >> 4)) & 15];
+            auto const fec = code & 15;
+            auto c = std::uint32_t(0);
+            if (fec < fec_max) {
+                c = fec == 0 ? next++ : vertices[(vertex_offset - 1 - fec) & 15];
+                push_vertex(c, fec == 0);
+            }
+            else {
+                c = last = fec != 15 ? last + (fec - (fec ^ 3)) : free_index();     // 13 and 14 are -1 and +1.
+                push_vertex(c);
+            }
+            detail::put_index(out, index_size, i, a);
+            detail::put_index(out, index_size, i + 1, b);
+            detail::put_index(out, index_size, i + 2, c);
+            push_edge(c, b);
+            push_edge(a, c);
+            continue;
+        }
+        auto aux = std::uint32_t(0);
+        auto fea = std::uint32_t(0);
+        if (code < 0xFE) {
+            aux = std::to_integer<std::uint32_t>(aux_table[code & 15]);
+        }
+        else {
+            if (position >= safe_end) {
+                throw std::runtime_error("Truncated meshopt triangle data");
+            }
+            aux = std::to_integer<std::uint32_t>(data[position++]);
+            fea = code == 0xFE ? 0 : 15;
+            if (aux == 0) {
+                next = 0;
+            }
+        }
+        auto const feb = aux >> 4;
+        auto const fec = aux & 15;
+        auto a = fea == 0 ? next++ : 0u;
+        auto b = feb == 0 ? next++ : vertices[(vertex_offset - feb) & 15];
+        auto c = fec == 0 ? next++ : vertices[(vertex_offset - fec) & 15];
+        if (code >= 0xFE) {
+            if (fea == 15) {
+                a = free_index();
+            }
+            if (feb == 15) {
+                b = free_index();
+            }
+            if (fec == 15) {
+                c = free_index();
+            }
+        }
+        detail::put_index(out, index_size, i, a);
+        detail::put_index(out, index_size, i + 1, b);
+        detail::put_index(out, index_size, i + 2, c);
+        push_vertex(a);
+        push_vertex(b, feb == 0 || (code >= 0xFE && feb == 15));
+        push_vertex(c, fec == 0 || (code >= 0xFE && fec == 15));
+        push_edge(b, a);
+        push_edge(c, b);
+        push_edge(a, c);
+    }
+    if (position != safe_end) {
+        throw std::runtime_error("Corrupt meshopt triangle data");
+    }
+}
+
+/**
+ * @brief Decode `count` indices of any other primitive: deltas to one of two baselines.
+ */
+inline void decode_index_sequence(std::span<std::byte> out, std::size_t count, std::size_t index_size, std::span<std::byte const> data) {
+    if ((index_size != 2 && index_size != 4) || out.size() < count * index_size) {
+        throw std::runtime_error("Bad meshopt index data");
+    }
+    if (data.size() < 1 + count + 4 || (std::to_integer<std::uint8_t>(data[0]) & 0xF0) != 0xD0 ||
+        (std::to_integer<std::uint8_t>(data[0]) & 0x0F) > 1) {
+        throw std::runtime_error("Unsupported meshopt index data");
+    }
+    auto const stream = data.first(data.size() - 4);
+    auto last = std::array<std::uint32_t, 2>{};
+    auto position = std::size_t(1);
+    for (auto i = std::size_t(0); i < count; ++i) {
+        auto v = detail::vbyte(stream, position);
+        auto const baseline = v & 1;
+        v >>= 1;
+        last[baseline] += (v >> 1) ^ (0u - (v & 1));
+        detail::put_index(out, index_size, i, last[baseline]);
+    }
+    if (position != stream.size()) {
+        throw std::runtime_error("Corrupt meshopt index data");
+    }
+}
+
+namespace detail {
+
+template<typename T>
+void octahedral_filter(std::span<std::byte> data, std::size_t count) {
+    constexpr auto k_max = float((1 << (sizeof(T) * 8 - 1)) - 1);
+    for (auto i = std::size_t(0); i < count; ++i) {
+        auto v = std::array<T, 4>();
+        std::memcpy(v.data(), data.data() + i * sizeof(v), sizeof(v));
+        auto x = float(v[0]);
+        auto y = float(v[1]);
+        auto const z = float(v[2]) - std::abs(x) - std::abs(y);     // The 3rd component encodes 1.
+        auto const t = std::min(z, 0.f);
+        x += x >= 0.f ? t : -t;
+        y += y >= 0.f ? t : -t;
+        auto const scale = k_max / std::sqrt(x * x + y * y + z * z);
+        v[0] = static_cast<T>(std::lround(x * scale));
+        v[1] = static_cast<T>(std::lround(y * scale));
+        v[2] = static_cast<T>(std::lround(z * scale));
+        std::memcpy(data.data() + i * sizeof(v), v.data(), sizeof(v));
+    }
+}
+
+} // namespace detail
+
+/**
+ * @brief The filters of EXT_meshopt_compression, undone over `count` decoded elements.
+ */
+struct filter {
+    enum type : std::uint32_t { NONE, OCTAHEDRAL, QUATERNION, EXPONENTIAL };
+};
+
+inline void unfilter(filter::type kind, std::span<std::byte> data, std::size_t count, std::size_t stride) {
+    switch (kind) {
+    case filter::OCTAHEDRAL:
+        if (stride == 4) {
+            detail::octahedral_filter<std::int8_t>(data, count);
+        }
+        else if (stride == 8) {
+            detail::octahedral_filter<std::int16_t>(data, count);
+        }
+        else {
+            throw std::runtime_error("Bad stride for the octahedral filter");
+        }
+        break;
+    case filter::QUATERNION:
+        if (stride != 8) {
+            throw std::runtime_error("Bad stride for the quaternion filter");
+        }
+        for (auto i = std::size_t(0); i < count; ++i) {
+            auto v = std::array<std::int16_t, 4>();
+            std::memcpy(v.data(), data.data() + i * sizeof(v), sizeof(v));
+            auto const scale = 1.f / std::sqrt(2.f) / float(v[3] | 3);    // The low bits of w pick the largest component.
+            auto const x = float(v[0]) * scale;
+            auto const y = float(v[1]) * scale;
+            auto const z = float(v[2]) * scale;
+            auto const w = std::sqrt(std::max(1.f - x * x - y * y - z * z, 0.f));
+            auto const largest = static_cast<std::size_t>(v[3] & 3);
+            auto result = std::array<std::int16_t, 4>();
+            result[(largest + 1) & 3] = static_cast<std::int16_t>(std::lround(x * 32767.f));
+            result[(largest + 2) & 3] = static_cast<std::int16_t>(std::lround(y * 32767.f));
+            result[(largest + 3) & 3] = static_cast<std::int16_t>(std::lround(z * 32767.f));
+            result[largest] = static_cast<std::int16_t>(std::lround(w * 32767.f));
+            std::memcpy(data.data() + i * sizeof(result), result.data(), sizeof(result));
+        }
+        break;
+    case filter::EXPONENTIAL:
+        if (stride % 4 != 0) {
+            throw std::runtime_error("Bad stride for the exponential filter");
+        }
+        for (auto i = std::size_t(0); i < count * stride / 4; ++i) {
+            auto bits = std::uint32_t(0);
+            std::memcpy(&bits, data.data() + i * 4, 4);
+            auto const mantissa = static_cast<std::int32_t>(bits << 8) >> 8;
+            auto const exponent = static_cast<std::int32_t>(bits) >> 24;
+            auto const value = std::ldexp(static_cast<float>(mantissa), exponent);
+            std::memcpy(data.data() + i * 4, &value, 4);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+} // namespace meshopt
+
+/**
+ * @brief An importer of glTF 2.0 scenes (.gltf with its buffers, or .glb): document::open()
+ * maps the files and parses the JSON, then every primitive decodes on its own into one
+ * interleaved vertex stream described by mesh_asset attributes, so gl::mesh takes it as it
+ * takes a mesh asset. The accessors of a primitive decode in parallel on a job_system, and
+ * bufferViews compressed with EXT_meshopt_compression are decompressed once, by whichever
+ * accessor needs them first. KHR_draco_mesh_compression needs a Draco decoder, which this
+ * library does not ship (see draco_decoder).
+ * @code
+ *      auto const scene = gltool::gltf::document::open("city.glb");
+ *      auto const primitives = scene->decode_all(jobs);       // One primitive per job.
+ * @endcode
+ */
+namespace gltf {
+
+constexpr std::uint32_t k_glb_magic = 0x46546C67;       // "glTF"
+constexpr std::uint32_t k_chunk_json = 0x4E4F534A;      // "JSON"
+constexpr std::uint32_t k_chunk_bin = 0x004E4942;       // "BIN\0"
+constexpr std::uint32_t k_no_material = std::numeric_limits<std::uint32_t>::max();
+
+/**
+ * @brief A decoded primitive: vertices interleaved at `stride` bytes, every attribute at a
+ * 4-byte aligned offset and fed to a fixed location: POSITION 0, NORMAL 1, TEXCOORD_0 2,
+ * TANGENT 3, COLOR_0 4, JOINTS_0 5, WEIGHTS_0 6 and TEXCOORD_1 7. Attribute formats are the
+ * accessors' (e.g. normalized 16-bit texture coordinates stay 16-bit).
+ */
+struct primitive {
+    std::string name;                   /* Of the mesh, with the index of the primitive */
+    std::size_t mesh = 0;
+    std::uint32_t material = k_no_material;
+    std::uint32_t stride = 0;
+    std::vector<mesh_asset::attribute> attributes;
+    std::vector<std::byte> vertices;
+    std::vector<std::uint32_t> indices;
+    std::array<float, 3> min = {};
+    std::array<float, 3> max = {};
+
+    /**
+     * @brief The primitive as a parsed mesh asset with no level of detail, valid as long as
+     * the primitive is and not moved.
+     */
+    mesh_asset::view view() {
+        m_header = mesh_asset::header();
+        m_header.magic = mesh_asset::k_magic;
+        m_header.version = mesh_asset::k_version;
+        m_header.stride = stride;
+        m_header.index_size = sizeof(std::uint32_t);
+        m_header.attribute_ct = static_cast<std::uint32_t>(attributes.size());
+        std::ranges::copy(min, m_header.min);
+        std::ranges::copy(max, m_header.max);
+        auto result = mesh_asset::view();
+        result.info = &m_header;
+        result.attributes = attributes;
+        result.vertices = vertices;
+        result.indices = std::as_bytes(std::span(indices));
+        return result;
+    }
+
+private:
+    mesh_asset::header m_header = {};
+};
+
+/**
+ * @brief A use of a mesh by a node of the default scene, with the world transform (column-major).
+ */
+struct instance {
+    std::size_t mesh = 0;
+    std::array<float, 16> transform = {};
+};
+
+/**
+ * @brief Decodes a primitive compressed with KHR_draco_mesh_compression: `data` is the
+ * bufferView of the extension, `extension` its JSON (with the Draco attribute ids); fill the
+ * vertices, attributes, stride and indices of `out`, e.g. with the Draco decoder library.
+ */
+using draco_decoder = std::function<void (std::span<std::byte const> data, json::value const& extension, primitive& out)>;
+
+class document {
+public:
+    /**
+     * @brief Map a .glb or .gltf file and the buffers it refers to (files relative to it, or
+     * base64 data URIs), and parse the JSON. Nothing is decoded yet.
+     */
+    static std::shared_ptr<document> open(std::filesystem::path const& path) {
+        auto result = std::shared_ptr<document>(new document());
+        auto& file = *result->m_files.emplace_back(std::make_unique<mapped_file>(path.string().c_str()));
+        auto const bytes = std::as_bytes(std::span(file.data(), file.size()));
+        auto binary = std::span<std::byte const>();
+        auto text = file.view();
+        if (bytes.size() >= 12 && read<std::uint32_t>(bytes, 0) == k_glb_magic) {
+            if (read<std::uint32_t>(bytes, 4) != 2) {
+                throw std::runtime_error("Unsupported glTF binary version in " + path.string());
+            }
+            text = {};
+            for (auto offset = std::size_t(12); offset + 8 <= bytes.size();) {
+                auto const length = read<std::uint32_t>(bytes, offset);
+                auto const type = read<std::uint32_t>(bytes, offset + 4);
+                if (length > bytes.size() - offset - 8) {
+                    throw std::runtime_error("Truncated glTF binary chunk in " + path.string());
+                }
+                auto const chunk = bytes.subspan(offset + 8, length);
+                if (type == k_chunk_json) {
+                    text = { reinterpret_cast<char const*>(chunk.data()), chunk.size() };
+                }
+                else if (type == k_chunk_bin && binary.empty()) {
+                    binary = chunk;
+                }
+                offset += 8 + (length + 3) / 4 * 4;
+            }
+        }
+        result->m_json = json::parse(text);
+        if (auto const version = result->m_json["asset"]["version"].string(); !version.starts_with("2.")) {
+            throw std::runtime_error("Unsupported glTF version " + std::string(version) + " in " + path.string());
+        }
+        for (auto const& buffer : result->m_json["buffers"].elements()) {
+            auto const uri = buffer["uri"].string();
+            if (buffer["extensions"]["EXT_meshopt_compression"]["fallback"].boolean()) {
+                result->m_buffers.emplace_back();          // Only read through compressed bufferViews.
+                continue;
+            }
+            if (uri.empty()) {
+                result->m_buffers.push_back(binary);
+            }
+            else if (uri.starts_with("data:")) {
+                auto const& decoded = result->m_embedded.emplace_back(base64(uri.substr(uri.find(',') + 1)));
+                result->m_buffers.push_back(decoded);       // Moving the vectors later keeps their storage.
+            }
+            else {
+                auto const& data = *result->m_files.emplace_back(
+                    std::make_unique<mapped_file>((path.parent_path() / std::filesystem::path(std::string(uri))).string().c_str()));
+                result->m_buffers.push_back(std::as_bytes(std::span(data.data(), data.size())));
+            }
+            if (result->m_buffers.back().size() < buffer["byteLength"].index(0)) {
+                throw std::runtime_error("glTF buffer smaller than its byteLength in " + path.string());
+            }
+        }
+        auto const views = result->m_json["bufferViews"].size();
+        result->m_decoded = std::vector<std::vector<std::byte>>(views);
+        result->m_decode_once = std::make_unique<std::once_flag[]>(views);
+
+        auto const meshes = result->m_json["meshes"].elements();
+        for (auto m = std::size_t(0); m < meshes.size(); ++m) {
+            auto const name = meshes[m]["name"].string().empty() ? "mesh" + std::to_string(m) : std::string(meshes[m]["name"].string());
+            for (auto p = std::size_t(0); p < meshes[m]["primitives"].size(); ++p) {
+                result->m_primitives.push_back({ m, p, name + "_" + std::to_string(p) });
+            }
+        }
+        result->collect_instances();
+        return result;
+    }
+
+    document(document const&) = delete;
+
+    document& operator =(document const&) = delete;
+
+    std::size_t primitive_count() const noexcept {
+        return m_primitives.size();
+    }
+
+    std::string const& primitive_name(std::size_t index) const {
+        return m_primitives.at(index).name;
+    }
+
+    std::span<instance const> instances() const noexcept {
+        return m_instances;
+    }
+
+    json::value const& get_json() const noexcept {
+        return m_json;
+    }
+
+    /**
+     * @brief Decode primitive `index` (0 to primitive_count()); with `jobs`, its accessors
+     * in parallel. Safe to call from several threads at once.
+     */
+    primitive decode(std::size_t index, job_system* jobs = nullptr, draco_decoder const& draco = {}) const {
+        auto const& reference = m_primitives.at(index);
+        auto const& source = m_json["meshes"][reference.mesh]["primitives"][reference.index];
+        auto result = primitive();
+        result.name = reference.name;
+        result.mesh = reference.mesh;
+        result.material = static_cast<std::uint32_t>(source["material"].index(k_no_material));
+        if (source["mode"].index(4) != 4) {
+            throw std::runtime_error("Only triangle lists are supported, " + result.name + " has mode " +
+                                     std::to_string(source["mode"].index(4)));
+        }
+        if (auto const& compressed = source["extensions"]["KHR_draco_mesh_compression"]; !compressed.is_null()) {
+            if (!draco) {
+                throw std::runtime_error(result.name + " is compressed with Draco and no draco_decoder was given");
+            }
+            draco(this->buffer_view(compressed["bufferView"].index()), compressed, result);
+            this->compute_bounds(result);
+            return result;
+        }
+
+        struct column {
+            std::size_t accessor;
+            std::uint32_t location;
+            std::uint32_t offset;
+            std::uint32_t size;
+        };
+        static constexpr auto k_locations = std::array<std::pair<std::string_view, std::uint32_t>, 8>{ {
+            { "POSITION", 0 }, { "NORMAL", 1 }, { "TEXCOORD_0", 2 }, { "TANGENT", 3 },
+            { "COLOR_0", 4 }, { "JOINTS_0", 5 }, { "WEIGHTS_0", 6 }, { "TEXCOORD_1", 7 } } };
+        auto columns = std::vector<column>();
+        auto vertex_ct = std::numeric_limits<std::size_t>::max();
+        for (auto const& [semantic, location] : k_locations) {
+            auto const id = source["attributes"][semantic].index();
+            if (id == std::numeric_limits<std::size_t>::max()) {
+                continue;
+            }
+            auto const& info = this->accessor(id);
+            auto const size = static_cast<std::uint32_t>(component_count(info["type"].string()) * component_size(info["componentType"].index()));
+            auto const integer = semantic == "JOINTS_0";
+            auto const normalized = info["normalized"].boolean();
+            result.attributes.push_back({ location, component_count(info["type"].string()), static_cast<std::uint32_t>(info["componentType"].index()),
+                                          integer ? mesh_asset::attribute::INTEGER : normalized ? mesh_asset::attribute::NORMALIZED : mesh_asset::attribute::NONE,
+                                          result.stride });
+            columns.push_back({ id, location, result.stride, size });
+            result.stride += (size + 3) / 4 * 4;
+            vertex_ct = std::min(vertex_ct, info["count"].index(0));
+        }
+        if (columns.empty() || columns.front().location != 0) {
+            throw std::runtime_error(result.name + " has no positions");
+        }
+        result.vertices.resize(vertex_ct * result.stride);
+        auto const indices = source["indices"].index();
+        if (indices != std::numeric_limits<std::size_t>::max()) {
+            result.indices.resize(this->accessor(indices)["count"].index(0));
+        }
+        else {
+            result.indices.resize(vertex_ct);
+            std::iota(result.indices.begin(), result.indices.end(), 0u);
+        }
+
+        // One task per attribute and one for the indices, each writing its own bytes.
+        auto const task = [&](std::size_t first, std::size_t last) {
+            for (auto t = first; t < last; ++t) {
+                if (t == columns.size()) {
+                    this->read_indices(indices, result.indices);
+                    continue;
+                }
+                auto const& item = columns[t];
+                this->read_accessor(item.accessor, vertex_ct, [&](std::size_t v, std::byte const* element) {
+                    std::memcpy(result.vertices.data() + v * result.stride + item.offset, element, item.size);
+                });
+            }
+        };
+        auto const task_ct = columns.size() + (indices != std::numeric_limits<std::size_t>::max());
+        if (jobs != nullptr) {
+            jobs->parallel_for(0, task_ct, task, 1, job_system::priority::BACKGROUND);
+        }
+        else {
+            task(0, task_ct);
+        }
+        if (std::ranges::any_of(result.indices, [vertex_ct](std::uint32_t i) { return i >= vertex_ct; })) {
+            throw std::runtime_error(result.name + " has indices past its vertices");
+        }
+
+        auto const& position = this->accessor(columns.front().accessor);
+        if (position["min"].size() == 3 && position["max"].size() == 3) {
+            for (auto k = std::size_t(0); k < 3; ++k) {
+                result.min[k] = static_cast<float>(position["min"][k].number());
+                result.max[k] = static_cast<float>(position["max"][k].number());
+            }
+        }
+        else {
+            this->compute_bounds(result);
+        }
+        return result;
+    }
+
+    /**
+     * @brief Decode every primitive, one job each (whose accessors are jobs in turn).
+     */
+    std::vector<primitive> decode_all(job_system& jobs, draco_decoder const& draco = {}) const {
+        auto result = std::vector<primitive>(m_primitives.size());
+        jobs.parallel_for(0, result.size(), [&](std::size_t first, std::size_t last) {
+            for (auto i = first; i < last; ++i) {
+                result[i] = this->decode(i, &jobs, draco);
+            }
+        }, 1, job_system::priority::BACKGROUND);
+        return result;
+    }
+
+private:
+    struct primitive_reference {
+        std::size_t mesh;
+        std::size_t index;
+        std::string name;
+    };
+
+    document() = default;
+
+    template<typename T>
+    static T read(std::span<std::byte const> bytes, std::size_t offset) {
+        auto result = T();
+        std::memcpy(&result, bytes.data() + offset, sizeof(T));
+        return result;
+    }
+
+    static std::vector<std::byte> base64(std::string_view text) {
+        auto result = std::vector<std::byte>();
+        result.reserve(text.size() / 4 * 3);
+        auto bits = std::uint32_t(0);
+        auto bit_ct = 0;
+        for (auto const c : text) {
+            auto value = std::uint32_t(0);
+            if (c >= 'A' && c <= 'Z') value = static_cast<std::uint32_t>(c - 'A');
+            else if (c >= 'a' && c <= 'z') value = static_cast<std::uint32_t>(c - 'a' + 26);
+            else if (c >= '0' && c <= '9') value = static_cast<std::uint32_t>(c - '0' + 52);
+            else if (c == '+' || c == '-') value = 62;
+            else if (c == '/' || c == '_') value = 63;
+            else if (c == '=') break;
+            else throw std::runtime_error("Invalid base64 data in a glTF data URI");
+            bits = bits << 6 | value;
+            bit_ct += 6;
+            if (bit_ct >= 8) {
+                bit_ct -= 8;
+                result.push_back(static_cast<std::byte>(bits >> bit_ct));
+            }
+        }
+        return result;
+    }
+
+    static std::uint32_t component_count(std::string_view type) {
+        if (type == "SCALAR") return 1;
+        if (type == "VEC2") return 2;
+        if (type == "VEC3") return 3;
+        if (type == "VEC4" || type == "MAT2") return 4;
+        if (type == "MAT3") return 9;
+        if (type == "MAT4") return 16;
+        throw std::runtime_error("Unknown glTF accessor type " + std::string(type));
+    }
+
+    static std::size_t component_size(std::size_t type) {
+        switch (type) {
+        case 5120: case 5121: return 1;             // (UNSIGNED_)BYTE
+        case 5122: case 5123: return 2;             // (UNSIGNED_)SHORT
+        case 5125: case 5126: return 4;             // UNSIGNED_INT, FLOAT
+        default: throw std::runtime_error("Unknown glTF component type " + std::to_string(type));
+        }
+    }
+
+    json::value const& accessor(std::size_t index) const {
+        auto const& result = m_json["accessors"][index];
+        if (result.is_null()) {
+            throw std::runtime_error("glTF accessor " + std::to_string(index) + " does not exist");
+        }
+        return result;
+    }
+
+    /**
+     * @brief The bytes of a bufferView, decompressed on first use if EXT_meshopt_compression.
+     */
+    std::span<std::byte const> buffer_view(std::size_t index) const {
+        auto const& view = m_json["bufferViews"][index];
+        if (view.is_null()) {
+            throw std::runtime_error("glTF bufferView " + std::to_string(index) + " does not exist");
+        }
+        auto const slice = [this](json::value const& range) {
+            auto const buffer = range["buffer"].index();
+            auto const offset = range["byteOffset"].index(0);
+            auto const length = range["byteLength"].index(0);
+            if (buffer >= m_buffers.size() || offset > m_buffers[buffer].size() || length > m_buffers[buffer].size() - offset) {
+                throw std::runtime_error("glTF bufferView out of its buffer");
+            }
+            return m_buffers[buffer].subspan(offset, length);
+        };
+        auto const& compressed = view["extensions"]["EXT_meshopt_compression"];
+        if (compressed.is_null()) {
+            return slice(view);
+        }
+        std::call_once(m_decode_once[index], [&] {
+            auto const count = compressed["count"].index(0);
+            auto const stride = compressed["byteStride"].index(0);
+            auto const mode = compressed["mode"].string();
+            auto const filter = compressed["filter"].string("NONE");
+            auto decoded = std::vector<std::byte>(count * stride);
+            if (mode == "ATTRIBUTES") {
+                meshopt::decode_vertices(decoded, count, stride, slice(compressed));
+                auto const kind = filter == "OCTAHEDRAL" ? meshopt::filter::OCTAHEDRAL : filter == "QUATERNION" ? meshopt::filter::QUATERNION :
+                                  filter == "EXPONENTIAL" ? meshopt::filter::EXPONENTIAL : meshopt::filter::NONE;
+                meshopt::unfilter(kind, decoded, count, stride);
+            }
+            else if (mode == "TRIANGLES") {
+                meshopt::decode_triangles(decoded, count, stride, slice(compressed));
+            }
+            else if (mode == "INDICES") {
+                meshopt::decode_index_sequence(decoded, count, stride, slice(compressed));
+            }
+            else {
+                throw std::runtime_error("Unknown EXT_meshopt_compression mode " + std::string(mode));
+            }
+            m_decoded[index] = std::move(decoded);
+        });
+        return m_decoded[index];
+    }
+
+    /**
+     * @brief Call `visit(i, bytes)` for the first `count` elements of an accessor, with its
+     * sparse substitutions applied; elements of an accessor without bufferView are zeros.
+     */
+    template<typename F>
+    void read_accessor(std::size_t index, std::size_t count, F&& visit) const {
+        auto const& info = this->accessor(index);
+        auto const element = component_count(info["type"].string()) * component_size(info["componentType"].index());
+        count = std::min(count, info["count"].index(0));
+        auto const zeros = std::vector<std::byte>(element);
+        if (auto const view = info["bufferView"].index(); view != std::numeric_limits<std::size_t>::max()) {
+            auto const bytes = this->buffer_view(view);
+            auto const stride = std::max<std::size_t>(m_json["bufferViews"][view]["byteStride"].index(0), element);
+            auto const offset = info["byteOffset"].index(0);
+            if (count > 0 && (offset > bytes.size() || (count - 1) * stride + element > bytes.size() - offset)) {
+                throw std::runtime_error("glTF accessor " + std::to_string(index) + " out of its bufferView");
+            }
+            for (auto i = std::size_t(0); i < count; ++i) {
+                visit(i, bytes.data() + offset + i * stride);
+            }
+        }
+        else {
+            for (auto i = std::size_t(0); i < count; ++i) {
+                visit(i, zeros.data());
+            }
+        }
+        if (auto const& sparse = info["sparse"]; !sparse.is_null()) {
+            auto const substitutes = sparse["count"].index(0);
+            auto targets = std::vector<std::uint32_t>(substitutes);
+            this->read_integers(sparse["indices"], substitutes, targets);
+            auto const values = this->buffer_view(sparse["values"]["bufferView"].index()).subspan(sparse["values"]["byteOffset"].index(0));
+            if (values.size() < substitutes * element) {
+                throw std::runtime_error("glTF sparse accessor out of its bufferView");
+            }
+            for (auto k = std::size_t(0); k < substitutes; ++k) {
+                if (targets[k] < count) {
+                    visit(targets[k], values.data() + k * element);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Unsigned integers of a bufferView and componentType, as sparse indices are given.
+     */
+    void read_integers(json::value const& source, std::size_t count, std::span<std::uint32_t> out) const {
+        auto const size = component_size(source["componentType"].index());
+        auto const bytes = this->buffer_view(source["bufferView"].index()).subspan(source["byteOffset"].index(0));
+        if (bytes.size() < count * size) {
+            throw std::runtime_error("glTF indices out of their bufferView");
+        }
+        for (auto i = std::size_t(0); i < count; ++i) {
+            out[i] = size == 1 ? std::to_integer<std::uint32_t>(bytes[i]) : size == 2 ? read<std::uint16_t>(bytes, i * 2) : read<std::uint32_t>(bytes, i * 4);
+        }
+    }
+
+    void read_indices(std::size_t index, std::span<std::uint32_t> out) const {
+        auto const size = component_size(this->accessor(index)["componentType"].index());
+        this->read_accessor(index, out.size(), [&](std::size_t i, std::byte const* element) {
+            out[i] = size == 1 ? std::to_integer<std::uint32_t>(*element) : size == 2 ? read<std::uint16_t>({ element, 2 }, 0)
+                                                                                      : read<std::uint32_t>({ element, 4 }, 0);
+        });
+    }
+
+    /**
+     * @brief Bounds of float positions, for primitives whose accessor does not give them.
+     */
+    static void compute_bounds(primitive& result) {
+        auto const position = std::ranges::find(result.attributes, 0u, &mesh_asset::attribute::location);
+        if (position == result.attributes.end() || position->type != 5126 || result.stride == 0) {
+            return;
+        }
+        result.min.fill(std::numeric_limits<float>::max());
+        result.max.fill(std::numeric_limits<float>::lowest());
+        for (auto v = std::size_t(0); v + position->offset + 12 <= result.vertices.size(); v += result.stride) {
+            auto p = std::array<float, 3>();
+            std::memcpy(p.data(), result.vertices.data() + v + position->offset, sizeof(p));
+            for (auto k = 0; k < 3; ++k) {
+                result.min[k] = std::min(result.min[k], p[k]);
+                result.max[k] = std::max(result.max[k], p[k]);
+            }
+        }
+    }
+
+    using matrix = std::array<float, 16>;
+
+    static matrix multiply(matrix const& a, matrix const& b) noexcept {
+        auto result = matrix();
+        for (auto c = 0; c < 4; ++c) {
+            for (auto r = 0; r < 4; ++r) {
+                for (auto k = 0; k < 4; ++k) {
+                    result[c * 4 + r] += a[k * 4 + r] * b[c * 4 + k];
+                }
+            }
+        }
+        return result;
+    }
+
+    static matrix local_transform(json::value const& node) {
+        auto result = matrix{ 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+        if (node["matrix"].size() == 16) {
+            for (auto i = std::size_t(0); i < 16; ++i) {
+                result[i] = static_cast<float>(node["matrix"][i].number());
+            }
+            return result;
+        }
+        auto const get = [&node](char const* key, std::size_t i, double fallback) {
+            return static_cast<float>(node[key][i].number(fallback));
+        };
+        auto const x = get("rotation", 0, 0.0), y = get("rotation", 1, 0.0), z = get("rotation", 2, 0.0), w = get("rotation", 3, 1.0);
+        auto const sx = get("scale", 0, 1.0), sy = get("scale", 1, 1.0), sz = get("scale", 2, 1.0);
+        result = { (1 - 2 * (y * y + z * z)) * sx, 2 * (x * y + z * w) * sx, 2 * (x * z - y * w) * sx, 0,
+                   2 * (x * y - z * w) * sy, (1 - 2 * (x * x + z * z)) * sy, 2 * (y * z + x * w) * sy, 0,
+                   2 * (x * z + y * w) * sz, 2 * (y * z - x * w) * sz, (1 - 2 * (x * x + y * y)) * sz, 0,
+                   get("translation", 0, 0.0), get("translation", 1, 0.0), get("translation", 2, 0.0), 1 };
+        return result;
+    }
+
+    /**
+     * @brief World transforms of the nodes with a mesh in the default scene (or the first).
+     */
+    void collect_instances() {
+        auto const& nodes = m_json["nodes"];
+        auto const& scene = m_json["scenes"][m_json["scene"].index(0)];
+        auto pending = std::vector<std::pair<std::size_t, matrix>>();
+        for (auto const& root : scene["nodes"].elements()) {
+            pending.push_back({ root.index(), matrix{ 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 } });
+        }
+        auto visited = std::vector<bool>(nodes.size());
+        while (!pending.empty()) {
+            auto const [index, parent] = pending.back();
+            pending.pop_back();
+            if (index >= nodes.size() || visited[index]) {
+                continue;           // A node is in one tree at most; ignore malformed graphs.
+            }
+            visited[index] = true;
+            auto const& node = nodes[index];
+            auto const world = multiply(parent, local_transform(node));
+            if (auto const mesh = node["mesh"].index(); mesh != std::numeric_limits<std::size_t>::max()) {
+                m_instances.push_back({ mesh, world });
+            }
+            for (auto const& child : node["children"].elements()) {
+                pending.push_back({ child.index(), world });
+            }
+        }
+    }
+
+    json::value m_json;
+    std::vector<std::unique_ptr<mapped_file>> m_files;
+    std::vector<std::vector<std::byte>> m_embedded;         /* Buffers of data URIs */
+    std::vector<std::span<std::byte const>> m_buffers;
+    mutable std::vector<std::vector<std::byte>> m_decoded;  /* Decompressed bufferViews */
+    mutable std::unique_ptr<std::once_flag[]> m_decode_once;
+    std::vector<primitive_reference> m_primitives;
+    std::vector<instance> m_instances;
+};
+
+} // namespace gltf
+
+/**
+ * @brief Fast readers of the text mesh formats of legacy assets, Wavefront OBJ and PLY (ASCII,
+ * or binary little-endian). The text is cut into chunks at line boundaries, which parse in
+ * parallel on a job_system (lines found 16 bytes at a time where SSE2 is available, numbers
+ * read with std::from_chars); a merge step then resolves the references and, for OBJ, welds
+ * the corners sharing a position, texture coordinate and normal through an open addressing
+ * table, so the result is indexed. Vertices are interleaved as positions, then normals and
+ * texture coordinates if every vertex has them, like tools/mesh_convert.cpp writes them.
+ * @code
+ *      auto const file = gltool::mapped_file("scan.ply", true);
+ *      auto const scan = gltool::text_mesh::parse_ply(file.view(), &jobs);
+ * @endcode
+ */
+namespace text_mesh {
+
+struct result {
+    std::vector<float> vertices;
+    std::vector<std::uint32_t> indices;
+    std::size_t components = 3;         /* Floats per vertex */
+    bool has_normals = false;
+    bool has_uvs = false;
+};
+
+namespace detail {
+
+inline char const* find_newline(char const* first, char const* last) noexcept {
+#if defined(M_HAS_SSE2)
+    auto const newline = _mm_set1_epi8('\n');
+    for (; last - first >= 16; first += 16) {
+        auto const mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(first)), newline));
+        if (mask != 0) {
+            return first + std::countr_zero(static_cast<unsigned>(mask));
+        }
+    }
+#endif
+    auto const* const found = static_cast<char const*>(std::memchr(first, '\n', static_cast<std::size_t>(last - first)));
+    return found != nullptr ? found : last;
+}
+
+inline std::size_t count_newlines(char const* first, char const* last) noexcept {
+    auto result = std::size_t(0);
+#if defined(M_HAS_SSE2)
+    auto const newline = _mm_set1_epi8('\n');
+    for (; last - first >= 16; first += 16) {
+        auto const mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(first)), newline));
+        result += static_cast<std::size_t>(std::popcount(static_cast<unsigned>(mask)));
+    }
+#endif
+    return result + static_cast<std::size_t>(std::count(first, last, '\n'));
+}
+
+/**
+ * @brief Split `text` into about `count` ranges, each ending after a newline (but the last).
+ */
+inline std::vector<std::string_view> chunks(std::string_view text, std::size_t count) {
+    constexpr auto k_min_chunk = std::size_t(1) << 20;
+    count = std::clamp<std::size_t>(text.size() / k_min_chunk, 1, std::max<std::size_t>(count, 1));
+    auto result = std::vector<std::string_view>();
+    auto const* first = text.data();
+    auto const* const end = text.data() + text.size();
+    for (auto i = std::size_t(1); i <= count && first < end; ++i) {
+        auto const* last = i == count ? end : std::max(first, text.data() + text.size() * i / count);
+        if (last < end) {
+            last = std::min(find_newline(last, end) + 1, end);
+        }
+        result.emplace_back(first, static_cast<std::size_t>(last - first));
+        first = last;
+    }
+    return result;
+}
+
+inline std::size_t chunk_count(job_system* jobs) noexcept {
+    return jobs != nullptr ? (jobs->worker_count() + 1) * 4 : 1;
+}
+
+template<typename F>
+void for_each_chunk(job_system* jobs, std::size_t count, F&& function) {
+    if (jobs != nullptr) {
+        jobs->parallel_for(0, count, [&function](std::size_t first, std::size_t last) {
+            for (auto i = first; i < last; ++i) {
+                function(i);
+            }
+        });
+        return;
+    }
+    for (auto i = std::size_t(0); i < count; ++i) {
+        function(i);
+    }
+}
+
+/**
+ * @brief Tokens of one line: numbers separated by blanks.
+ */
+struct cursor {
+    char const* position;
+    char const* end;
+
+    void skip_blank() noexcept {
+        while (position < end && (*position == ' ' || *position == '\t' || *position == '\r')) {
+            ++position;
+        }
+    }
+
+    bool done() noexcept {
+        this->skip_blank();
+        return position >= end;
+    }
+
+    template<typename T>
+    bool number(T& value) noexcept {
+        this->skip_blank();
+        if (position < end && *position == '+') {
+            ++position;             // std::from_chars takes no plus sign.
+        }
+        auto const [last, error] = std::from_chars(position, end, value);
+        if (error != std::errc()) {
+            return false;
+        }
+        position = last;
+        return true;
+    }
+
+    std::string_view word() noexcept {
+        this->skip_blank();
+        auto const* const first = position;
+        while (position < end && *position != ' ' && *position != '\t' && *position != '\r') {
+            ++position;
+        }
+        return { first, static_cast<std::size_t>(position - first) };
+    }
+};
+
+/**
+ * @brief Call `line(cursor)` for every line of `text`, without its newline.
+ */
+template<typename F>
+void for_each_line(std::string_view text, F&& line) {
+    auto const* first = text.data();
+    auto const* const end = text.data() + text.size();
+    while (first < end) {
+        auto const* const last = find_newline(first, end);
+        line(cursor{ first, last });
+        first = last + 1;
+    }
+}
+
+/**
+ * @brief Maps (position, uv, normal) references, 1-based with 0 for none, to welded vertices.
+ */
+class weld_table {
+public:
+    explicit weld_table(std::size_t capacity)
+        : m_slots(std::bit_ceil(std::max<std::size_t>(capacity * 2, 16))),
+          m_mask(m_slots.size() - 1) {}
+
+    /**
+     * @brief The vertex of a corner, and whether it was added.
+     */
+    std::pair<std::uint32_t, bool> insert(std::array<std::uint32_t, 3> const& key) {
+        auto hash = (std::uint64_t(key[0]) * 0x9E3779B97F4A7C15ull) ^ (std::uint64_t(key[1]) * 0xC2B2AE3D27D4EB4Full) ^
+                    (std::uint64_t(key[2]) * 0x165667B19E3779F9ull);
+        for (auto i = static_cast<std::size_t>(hash ^ hash >> 32) & m_mask;; i = (i + 1) & m_mask) {
+            auto& slot = m_slots[i];
+            if (slot.key[0] == 0) {
+                slot = { key, m_size };
+                return { m_size++, true };
+            }
+            if (slot.key == key) {
+                return { slot.vertex, false };
+            }
+        }
+    }
+
+private:
+    struct slot {
+        std::array<std::uint32_t, 3> key = {};      // Positions are never 0: empty slot.
+        std::uint32_t vertex = 0;
+    };
+
+    std::vector<slot> m_slots;
+    std::size_t m_mask;
+    std::uint32_t m_size = 0;
+};
+
+} // namespace detail
+
+/**
+ * @brief Parse the positions, normals, texture coordinates and faces of an OBJ text (other
+ * statements are skipped), triangulating polygons as fans and welding corners that share all
+ * their references. Throws std::runtime_error on malformed faces.
+ */
+inline result parse_obj(std::string_view text, job_system* jobs = nullptr) {
+    struct corner {
+        std::array<std::int64_t, 3> refs;   // Position, uv, normal; 0 if absent.
+        std::uint8_t relative;              // Bit k: refs[k] counts from the chunk's own start.
+    };
+    struct chunk {
+        std::vector<float> positions, uvs, normals;
+        std::vector<corner> corners;
+        std::vector<std::uint32_t> faces;   // Corner count of each face.
+    };
+    auto const ranges = detail::chunks(text, detail::chunk_count(jobs));
+    auto parsed = std::vector<chunk>(ranges.size());
+    detail::for_each_chunk(jobs, ranges.size(), [&](std::size_t c) {
+        auto& out = parsed[c];
+        detail::for_each_line(ranges[c], [&](detail::cursor line) {
+            line.skip_blank();
+            if (line.end - line.position < 2) {
+                return;
+            }
+            auto const* const tag = line.position;
+            auto const read = [&line](std::vector<float>& values, std::size_t count) {
+                for (auto k = std::size_t(0); k < count; ++k) {
+                    auto value = 0.f;
+                    line.number(value);         // Missing values read as 0, like most loaders do.
+                    values.push_back(value);
+                }
+            };
+            if (tag[0] == 'v' && (tag[1] == ' ' || tag[1] == '\t')) {
+                line.position += 2;
+                read(out.positions, 3);
+            }
+            else if (tag[0] == 'v' && tag[1] == 't') {
+                line.position += 2;
+                read(out.uvs, 2);
+            }
+            else if (tag[0] == 'v' && tag[1] == 'n') {
+                line.position += 2;
+                read(out.normals, 3);
+            }
+            else if (tag[0] == 'f' && (tag[1] == ' ' || tag[1] == '\t')) {
+                line.position += 2;
+                auto const counts = std::array<std::int64_t, 3>{ std::int64_t(out.positions.size() / 3), std::int64_t(out.uvs.size() / 2),
+                                                                 std::int64_t(out.normals.size() / 3) };
+                auto ct = std::uint32_t(0);
+                while (!line.done()) {
+                    auto item = corner{ {}, 0 };
+                    for (auto k = 0; k < 3; ++k) {
+                        if (k > 0) {
+                            if (line.position >= line.end || *line.position != '/') {
+                                break;
+                            }
+                            ++line.position;
+                            if (line.position < line.end && (*line.position == '/' || *line.position == ' ')) {
+                                continue;       // "p//n": no uv.
+                            }
+                        }
+                        if (!line.number(item.refs[k])) {
+                            throw std::runtime_error("Malformed OBJ face: " + std::string(tag, line.end));
+                        }
+                        if (item.refs[k] < 0) {
+                            item.refs[k] += counts[k] + 1;
+                            item.relative |= std::uint8_t(1u << k);
+                        }
+                    }
+                    out.corners.push_back(item);
+                    ++ct;
+                }
+                if (ct < 3) {
+                    throw std::runtime_error("OBJ face with fewer than 3 corners: " + std::string(tag, line.end));
+                }
+                out.faces.push_back(ct);
+            }
+        });
+    });
+
+    // Merge: the chunks' elements in order, and the references made absolute.
+    auto positions = std::vector<float>();
+    auto uvs = std::vector<float>();
+    auto normals = std::vector<float>();
+    auto corner_ct = std::size_t(0);
+    auto bases = std::vector<std::array<std::int64_t, 3>>(parsed.size());
+    for (auto c = std::size_t(0); c < parsed.size(); ++c) {
+        bases[c] = { std::int64_t(positions.size() / 3), std::int64_t(uvs.size() / 2), std::int64_t(normals.size() / 3) };
+        positions.insert(positions.end(), parsed[c].positions.begin(), parsed[c].positions.end());
+        uvs.insert(uvs.end(), parsed[c].uvs.begin(), parsed[c].uvs.end());
+        normals.insert(normals.end(), parsed[c].normals.begin(), parsed[c].normals.end());
+        corner_ct += parsed[c].corners.size();
+    }
+    auto const sizes = std::array<std::int64_t, 3>{ std::int64_t(positions.size() / 3), std::int64_t(uvs.size() / 2), std::int64_t(normals.size() / 3) };
+    auto mesh = result();
+    mesh.has_uvs = corner_ct > 0;
+    mesh.has_normals = corner_ct > 0;
+    for (auto c = std::size_t(0); c < parsed.size(); ++c) {
+        for (auto& item : parsed[c].corners) {
+            for (auto k = 0; k < 3; ++k) {
+                if (item.relative & (1u << k)) {
+                    item.refs[k] += bases[c][k];
+                }
+                if (item.refs[k] < 0 || item.refs[k] > sizes[k] || (k == 0 && item.refs[k] == 0)) {
+                    throw std::runtime_error("OBJ face index out of range");
+                }
+            }
+            mesh.has_uvs = mesh.has_uvs && item.refs[1] != 0;
+            mesh.has_normals = mesh.has_normals && item.refs[2] != 0;
+        }
+    }
+    mesh.components = 3 + (mesh.has_normals ? 3 : 0) + (mesh.has_uvs ? 2 : 0);
+
+    auto welded = detail::weld_table(corner_ct);
+    auto const vertex_of = [&](corner const& item) {
+        auto const key = std::array<std::uint32_t, 3>{ static_cast<std::uint32_t>(item.refs[0]),
+                                                       mesh.has_uvs ? static_cast<std::uint32_t>(item.refs[1]) : 0u,
+                                                       mesh.has_normals ? static_cast<std::uint32_t>(item.refs[2]) : 0u };
+        auto const [vertex, added] = welded.insert(key);
+        if (added) {
+            auto const* const p = positions.data() + (key[0] - 1) * 3;
+            mesh.vertices.insert(mesh.vertices.end(), p, p + 3);
+            if (mesh.has_normals) {
+                auto const* const n = normals.data() + (key[2] - 1) * 3;
+                mesh.vertices.insert(mesh.vertices.end(), n, n + 3);
+            }
+            if (mesh.has_uvs) {
+                auto const* const t = uvs.data() + (key[1] - 1) * 2;
+                mesh.vertices.insert(mesh.vertices.end(), t, t + 2);
+            }
+        }
+        return vertex;
+    };
+    mesh.vertices.reserve(corner_ct / 2 * mesh.components);
+    mesh.indices.reserve(corner_ct * 3);
+    for (auto const& part : parsed) {
+        auto first = std::size_t(0);
+        for (auto const ct : part.faces) {
+            auto const origin = vertex_of(part.corners[first]);
+            auto previous = vertex_of(part.corners[first + 1]);
+            for (auto k = std::size_t(2); k < ct; ++k) {
+                auto const next = vertex_of(part.corners[first + k]);
+                mesh.indices.insert(mesh.indices.end(), { origin, previous, next });
+                previous = next;
+            }
+            first += ct;
+        }
+    }
+    return mesh;
+}
+
+namespace detail {
+
+struct ply_property {
+    std::string name;
+    std::string_view type;
+    std::string_view count_type;        /* Of a list property; empty for scalars */
+};
+
+struct ply_element {
+    std::string name;
+    std::size_t count = 0;
+    std::vector<ply_property> properties;
+};
+
+inline std::size_t ply_size(std::string_view type) {
+    if (type == "char" || type == "uchar" || type == "int8" || type == "uint8") return 1;
+    if (type == "short" || type == "ushort" || type == "int16" || type == "uint16") return 2;
+    if (type == "int" || type == "uint" || type == "int32" || type == "uint32" || type == "float" || type == "float32") return 4;
+    if (type == "double" || type == "float64") return 8;
+    throw std::runtime_error("Unknown PLY property type " + std::string(type));
+}
+
+inline double ply_value(std::string_view type, char const* data) {
+    auto const get = [data]<typename T>(T) {
+        auto value = T();
+        std::memcpy(&value, data, sizeof(T));
+        return static_cast<double>(value);
+    };
+    if (type == "char" || type == "int8") return get(std::int8_t());
+    if (type == "uchar" || type == "uint8") return get(std::uint8_t());
+    if (type == "short" || type == "int16") return get(std::int16_t());
+    if (type == "ushort" || type == "uint16") return get(std::uint16_t());
+    if (type == "int" || type == "int32") return get(std::int32_t());
+    if (type == "uint" || type == "uint32") return get(std::uint32_t());
+    if (type == "float" || type == "float32") return get(float());
+    return get(double());
+}
+
+} // namespace detail
+
+/**
+ * @brief Parse a PLY text or binary little-endian file: the x, y, z (and nx, ny, nz, and u, v
+ * or s, t) of the vertex element, and the vertex_indices (or vertex_index) lists of the face
+ * element, as fans. Other elements and properties are skipped.
+ */
+inline result parse_ply(std::string_view text, job_system* jobs = nullptr) {
+    auto const header_end = text.find("end_header");
+    if (!text.starts_with("ply") || header_end == std::string_view::npos) {
+        throw std::runtime_error("Not a PLY file");
+    }
+    auto format = std::string_view();
+    auto elements = std::vector<detail::ply_element>();
+    detail::for_each_line(text.substr(0, header_end), [&](detail::cursor line) {
+        auto const keyword = line.word();
+        if (keyword == "format") {
+            format = line.word();
+        }
+        else if (keyword == "element") {
+            auto& element = elements.emplace_back();
+            element.name = line.word();
+            line.number(element.count);
+        }
+        else if (keyword == "property" && !elements.empty()) {
+            auto property = detail::ply_property();
+            property.type = line.word();
+            if (property.type == "list") {
+                property.count_type = line.word();
+                property.type = line.word();
+            }
+            property.name = line.word();
+            elements.back().properties.push_back(std::move(property));
+        }
+    });
+    auto const ascii = format == "ascii";
+    if (!ascii && format != "binary_little_endian") {
+        throw std::runtime_error("Unsupported PLY format " + std::string(format));
+    }
+    auto const* const header_last = detail::find_newline(text.data() + header_end, text.data() + text.size());
+    auto body = text.substr(std::min(text.size(), static_cast<std::size_t>(header_last - text.data()) + 1));
+
+    auto mesh = result();
+    auto vertex_ct = std::size_t(0);
+    for (auto const& element : elements) {
+        auto const find = [&element](std::initializer_list<std::string_view> names) {
+            for (auto const name : names) {
+                for (auto p = std::size_t(0); p < element.properties.size(); ++p) {
+                    if (element.properties[p].name == name && element.properties[p].count_type.empty()) {
+                        return p;
+                    }
+                }
+            }
+            return std::numeric_limits<std::size_t>::max();
+        };
+        auto const none = std::numeric_limits<std::size_t>::max();
+        if (element.count > body.size()) {
+            // Every row takes a byte at least: bounds what the header may have the parser allocate.
+            throw std::runtime_error("Truncated PLY element " + element.name);
+        }
+        auto const is_vertex = element.name == "vertex";
+        auto const is_face = element.name == "face";
+        auto columns = std::vector<std::size_t>();          // Properties to take, in output order.
+        if (is_vertex) {
+            columns = { find({ "x" }), find({ "y" }), find({ "z" }) };
+            if (std::ranges::find(columns, none) != columns.end()) {
+                throw std::runtime_error("PLY vertices without positions");
+            }
+            if (auto const nx = find({ "nx" }), ny = find({ "ny" }), nz = find({ "nz" }); nx != none && ny != none && nz != none) {
+                columns.insert(columns.end(), { nx, ny, nz });
+                mesh.has_normals = true;
+            }
+            if (auto const u = find({ "u", "s", "texture_u" }), v = find({ "v", "t", "texture_v" }); u != none && v != none) {
+                columns.insert(columns.end(), { u, v });
+                mesh.has_uvs = true;
+            }
+            mesh.components = columns.size();
+            mesh.vertices.resize(element.count * columns.size());
+            vertex_ct = element.count;
+        }
+        auto list = none;
+        if (is_face) {
+            for (auto p = std::size_t(0); p < element.properties.size(); ++p) {
+                if (!element.properties[p].count_type.empty() && (element.properties[p].name == "vertex_indices" || element.properties[p].name == "vertex_index")) {
+                    list = p;
+                }
+            }
+        }
+        // Which output value each property feeds, if any.
+        auto targets = std::vector<std::size_t>(element.properties.size(), none);
+        for (auto k = std::size_t(0); k < columns.size(); ++k) {
+            targets[columns[k]] = k;
+        }
+
+        if (ascii) {
+            // Lines of the element, then chunks of them with the index of their first line.
+            auto const* end = body.data();
+            for (auto n = std::size_t(0); n < element.count && end < body.data() + body.size(); ++n) {
+                end = detail::find_newline(end, body.data() + body.size()) + 1;
+            }
+            end = std::min(end, body.data() + body.size());
+            auto const block = body.substr(0, static_cast<std::size_t>(end - body.data()));
+            body.remove_prefix(block.size());
+            if (!is_vertex && !is_face) {
+                continue;
+            }
+            auto const ranges = detail::chunks(block, detail::chunk_count(jobs));
+            auto firsts = std::vector<std::size_t>(ranges.size() + 1);
+            detail::for_each_chunk(jobs, ranges.size(), [&](std::size_t c) {
+                firsts[c + 1] = detail::count_newlines(ranges[c].data(), ranges[c].data() + ranges[c].size());
+            });
+            std::partial_sum(firsts.begin(), firsts.end(), firsts.begin());
+            auto triangles = std::vector<std::vector<std::uint32_t>>(ranges.size());
+            detail::for_each_chunk(jobs, ranges.size(), [&](std::size_t c) {
+                auto row = firsts[c];
+                detail::for_each_line(ranges[c], [&](detail::cursor line) {
+                    if (row >= element.count) {
+                        return;
+                    }
+                    for (auto p = std::size_t(0); p < element.properties.size(); ++p) {
+                        if (!element.properties[p].count_type.empty()) {
+                            auto ct = std::size_t(0);
+                            line.number(ct);
+                            if (ct > static_cast<std::size_t>(line.end - line.position)) {
+                                throw std::runtime_error("Truncated PLY element " + element.name);
+                            }
+                            auto corners = std::vector<std::uint32_t>(ct);
+                            for (auto& index : corners) {
+                                line.number(index);
+                            }
+                            for (auto k = std::size_t(2); p == list && k < ct; ++k) {
+                                triangles[c].insert(triangles[c].end(), { corners[0], corners[k - 1], corners[k] });
+                            }
+                            continue;
+                        }
+                        auto value = 0.0;
+                        line.number(value);
+                        if (targets[p] != none) {
+                            mesh.vertices[row * columns.size() + targets[p]] = static_cast<float>(value);
+                        }
+                    }
+                    ++row;
+                });
+            });
+            for (auto const& part : triangles) {
+                mesh.indices.insert(mesh.indices.end(), part.begin(), part.end());
+            }
+            continue;
+        }
+
+        // Binary: fixed size records parse in parallel, others one after the other.
+        auto const fixed = std::ranges::all_of(element.properties, [](auto const& p) { return p.count_type.empty(); });
+        if (fixed) {
+            auto offsets = std::vector<std::size_t>();
+            auto record = std::size_t(0);
+            for (auto const& property : element.properties) {
+                offsets.push_back(record);
+                record += detail::ply_size(property.type);
+            }
+            if (body.size() < element.count * record) {
+                throw std::runtime_error("Truncated PLY element " + element.name);
+            }
+            if (is_vertex) {
+                auto const chunk = std::max<std::size_t>(element.count / detail::chunk_count(jobs), 1);
+                detail::for_each_chunk(jobs, (element.count + chunk - 1) / chunk, [&](std::size_t c) {
+                    for (auto row = c * chunk; row < std::min(element.count, (c + 1) * chunk); ++row) {
+                        for (auto k = std::size_t(0); k < columns.size(); ++k) {
+                            auto const& property = element.properties[columns[k]];
+                            mesh.vertices[row * columns.size() + k] =
+                                static_cast<float>(detail::ply_value(property.type, body.data() + row * record + offsets[columns[k]]));
+                        }
+                    }
+                });
+            }
+            body.remove_prefix(element.count * record);
+            continue;
+        }
+        auto const* data = body.data();
+        auto const* const end = body.data() + body.size();
+        for (auto row = std::size_t(0); row < element.count; ++row) {
+            for (auto p = std::size_t(0); p < element.properties.size(); ++p) {
+                auto const& property = element.properties[p];
+                auto const size = detail::ply_size(property.type);
+                auto ct = std::size_t(1);
+                if (!property.count_type.empty()) {
+                    if (end - data < static_cast<std::ptrdiff_t>(detail::ply_size(property.count_type))) {
+                        throw std::runtime_error("Truncated PLY element " + element.name);
+                    }
+                    ct = static_cast<std::size_t>(detail::ply_value(property.count_type, data));
+                    data += detail::ply_size(property.count_type);
+                }
+                if (static_cast<std::size_t>(end - data) < ct * size) {
+                    throw std::runtime_error("Truncated PLY element " + element.name);
+                }
+                if (p == list) {
+                    auto const corner = [&](std::size_t k) -> std::uint32_t {
+                        return static_cast<std::uint32_t>(detail::ply_value(property.type, data + k * size));
+                    };
+                    for (auto k = std::size_t(2); k < ct; ++k) {
+                        mesh.indices.insert(mesh.indices.end(), { corner(0), corner(k - 1), corner(k) });
+                    }
+                }
+                else if (is_vertex && targets[p] != none) {
+                    mesh.vertices[row * columns.size() + targets[p]] = static_cast<float>(detail::ply_value(property.type, data));
+                }
+                data += ct * size;
+            }
+        }
+        body.remove_prefix(static_cast<std::size_t>(data - body.data()));
+    }
+    if (std::ranges::any_of(mesh.indices, [vertex_ct](std::uint32_t i) { return i >= vertex_ct; })) {
+        throw std::runtime_error("PLY face index out of range");
+    }
+    return mesh;
+}
+
+/**
+ * @brief Map a .obj or .ply file and parse it, see parse_obj() and parse_ply().
+ */
+inline result load(std::filesystem::path const& path, job_system* jobs = nullptr) {
+    auto const file = mapped_file(path.string().c_str(), true);
+    auto const extension = path.extension().string();
+    if (extension == ".ply" || extension == ".PLY") {
+        return parse_ply(file.view(), jobs);
+    }
+    return parse_obj(file.view(), jobs);
+}
+
+} // namespace text_mesh
+
+/**
+ * @brief GPU-ready texture containers: KTX2 and DDS files holding block-compressed (BCn, ETC2,
+ * ASTC) or plain pixels, read in place, e.g. from a mapped_file, so every level goes from the
+ * file's pages straight to glCompressedTexSubImage2D without any decode on the CPU. Formats are
+ * GL internal format enums, spelled as numbers since this header does not include GL.
+ * KTX2 files supercompressed by Basis Universal are recognized, and need a transcoder (see
+ * transcode_target()).
+ */
+namespace texture_container {
+
+/**
+ * @brief Extensions (or versions) that make a family of compressed formats usable.
+ */
+struct support {
+    bool s3tc = false;          /* BC1-BC3, EXT_texture_compression_s3tc */
+    bool rgtc = true;           /* BC4-BC5, core since 3.0 */
+    bool bptc = false;          /* BC6H-BC7, ARB_texture_compression_bptc or 4.2 */
+    bool etc2 = false;          /* ETC2/EAC, ARB_ES3_compatibility or 4.3 */
+    bool astc = false;          /* KHR_texture_compression_astc_ldr */
+};
+
+struct format_info {
+    enum family_type : std::uint32_t {
+        UNCOMPRESSED,
+        S3TC,
+        RGTC,
+        BPTC,
+        ETC2,
+        ASTC
+    };
+
+    std::uint32_t gl_format = 0;
+    family_type family = UNCOMPRESSED;
+    std::uint32_t block_width = 1;
+    std::uint32_t block_height = 1;
+    std::uint32_t block_size = 0;       /* Bytes per block (per pixel when uncompressed) */
+
+    bool compressed() const noexcept {
+        return family != UNCOMPRESSED;
+    }
+
+    bool supported_by(support const& caps) const noexcept {
+        switch (family) {
+        case S3TC: return caps.s3tc;
+        case RGTC: return caps.rgtc;
+        case BPTC: return caps.bptc;
+        case ETC2: return caps.etc2;
+        case ASTC: return caps.astc;
+        default:   return true;
+        }
+    }
+
+    /**
+     * @brief Bytes of a level of the given size: whole blocks, partial ones at the edges included.
+     */
+    std::size_t level_size(std::uint32_t width, std::uint32_t height) const noexcept {
+        return std::size_t((width + block_width - 1) / block_width) * ((height + block_height - 1) / block_height) * block_size;
+    }
+};
+
+/**
+ * @brief The formats that can be loaded, by GL internal format.
+ */
+inline constexpr std::array<format_info, 44> k_formats = {{
+    { 0x8058, format_info::UNCOMPRESSED, 1, 1, 4 },     // GL_RGBA8
+    { 0x8C43, format_info::UNCOMPRESSED, 1, 1, 4 },     // GL_SRGB8_ALPHA8
+    { 0x8229, format_info::UNCOMPRESSED, 1, 1, 1 },     // GL_R8
+    { 0x822B, format_info::UNCOMPRESSED, 1, 1, 2 },     // GL_RG8
+    { 0x881A, format_info::UNCOMPRESSED, 1, 1, 8 },     // GL_RGBA16F
+    { 0x8814, format_info::UNCOMPRESSED, 1, 1, 16 },    // GL_RGBA32F
+    { 0x83F0, format_info::S3TC, 4, 4, 8 },             // GL_COMPRESSED_RGB_S3TC_DXT1_EXT (BC1)
+    { 0x83F1, format_info::S3TC, 4, 4, 8 },             // GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+    { 0x83F2, format_info::S3TC, 4, 4, 16 },            // GL_COMPRESSED_RGBA_S3TC_DXT3_EXT (BC2)
+    { 0x83F3, format_info::S3TC, 4, 4, 16 },            // GL_COMPRESSED_RGBA_S3TC_DXT5_EXT (BC3)
+    { 0x8C4C, format_info::S3TC, 4, 4, 8 },             // GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+    { 0x8C4D, format_info::S3TC, 4, 4, 8 },             // GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT
+    { 0x8C4E, format_info::S3TC, 4, 4, 16 },            // GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT
+    { 0x8C4F, format_info::S3TC, 4, 4, 16 },            // GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+    { 0x8DBB, format_info::RGTC, 4, 4, 8 },             // GL_COMPRESSED_RED_RGTC1 (BC4)
+    { 0x8DBC, format_info::RGTC, 4, 4, 8 },             // GL_COMPRESSED_SIGNED_RED_RGTC1
+    { 0x8DBD, format_info::RGTC, 4, 4, 16 },            // GL_COMPRESSED_RG_RGTC2 (BC5)
+    { 0x8DBE, format_info::RGTC, 4, 4, 16 },            // GL_COMPRESSED_SIGNED_RG_RGTC2
+    { 0x8E8C, format_info::BPTC, 4, 4, 16 },            // GL_COMPRESSED_RGBA_BPTC_UNORM (BC7)
+    { 0x8E8D, format_info::BPTC, 4, 4, 16 },            // GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM
+    { 0x8E8E, format_info::BPTC, 4, 4, 16 },            // GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT (BC6H)
+    { 0x8E8F, format_info::BPTC, 4, 4, 16 },            // GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT
+    { 0x9274, format_info::ETC2, 4, 4, 8 },             // GL_COMPRESSED_RGB8_ETC2
+    { 0x9275, format_info::ETC2, 4, 4, 8 },             // GL_COMPRESSED_SRGB8_ETC2
+    { 0x9276, format_info::ETC2, 4, 4, 8 },             // GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2
+    { 0x9277, format_info::ETC2, 4, 4, 8 },             // GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2
+    { 0x9278, format_info::ETC2, 4, 4, 16 },            // GL_COMPRESSED_RGBA8_ETC2_EAC
+    { 0x9279, format_info::ETC2, 4, 4, 16 },            // GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC
+    { 0x9270, format_info::ETC2, 4, 4, 8 },             // GL_COMPRESSED_R11_EAC
+    { 0x9271, format_info::ETC2, 4, 4, 8 },             // GL_COMPRESSED_SIGNED_R11_EAC
+    { 0x9272, format_info::ETC2, 4, 4, 16 },            // GL_COMPRESSED_RG11_EAC
+    { 0x9273, format_info::ETC2, 4, 4, 16 },            // GL_COMPRESSED_SIGNED_RG11_EAC
+    { 0x93B0, format_info::ASTC, 4, 4, 16 },            // GL_COMPRESSED_RGBA_ASTC_4x4_KHR
+    { 0x93D0, format_info::ASTC, 4, 4, 16 },            // GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR
+    { 0x93B2, format_info::ASTC, 5, 5, 16 },            // GL_COMPRESSED_RGBA_ASTC_5x5_KHR
+    { 0x93D2, format_info::ASTC, 5, 5, 16 },
+    { 0x93B4, format_info::ASTC, 6, 6, 16 },            // GL_COMPRESSED_RGBA_ASTC_6x6_KHR
+    { 0x93D4, format_info::ASTC, 6, 6, 16 },
+    { 0x93B7, format_info::ASTC, 8, 8, 16 },            // GL_COMPRESSED_RGBA_ASTC_8x8_KHR
+    { 0x93D7, format_info::ASTC, 8, 8, 16 },
+    { 0x93BB, format_info::ASTC, 10, 10, 16 },          // GL_COMPRESSED_RGBA_ASTC_10x10_KHR
+    { 0x93DB, format_info::ASTC, 10, 10, 16 },
+    { 0x93BD, format_info::ASTC, 12, 12, 16 },          // GL_COMPRESSED_RGBA_ASTC_12x12_KHR
+    { 0x93DD, format_info::ASTC, 12, 12, 16 }
+}};
+
+/**
+ * @brief The layout of a GL internal format, or nullptr if it is not one of k_formats.
+ */
+inline format_info const* info_of(std::uint32_t gl_format) noexcept {
+    auto const it = std::ranges::find(k_formats, gl_format, &format_info::gl_format);
+    return it == k_formats.end() ? nullptr : &*it;
+}
+
+/**
+ * @brief A parsed container: views into the file's bytes, valid as long as they are.
+ */
+struct image {
+    enum basis_type : std::uint32_t {
+        NONE,
+        ETC1S,          /* BasisLZ supercompression */
+        UASTC
+    };
+
+    std::uint32_t gl_format = 0;            /* 0 when the levels must be transcoded first */
+    std::uint32_t width = 0;
+    std::uint32_t height = 0;
+    bool srgb = false;
+    bool generate_mipmaps = false;          /* Only the base level is stored; build the rest */
+    basis_type basis = NONE;
+    std::vector<std::span<std::byte const>> levels;     /* Level 0 (the largest) first */
+    std::span<std::byte const> global;                  /* Supercompression data shared by the levels */
+};
+
+/**
+ * @brief Turns a level of a Basis Universal image into the given GL format, e.g. with the
+ * basisu transcoder, which this library does not ship.
+ */
+using transcoder = std::function<std::vector<std::byte>(image const&, std::size_t level, std::uint32_t gl_format)>;
+
+/**
+ * @brief The best format to transcode a Basis Universal image to on this GPU: ASTC or BC7 keep
+ * the most of UASTC, ETC2 is a lossless target for ETC1S, and plain RGBA8 always works.
+ */
+inline std::uint32_t transcode_target(image const& source, support const& caps) noexcept {
+    if (source.basis == image::ETC1S && caps.etc2) {
+        return source.srgb ? 0x9279 : 0x9278;
+    }
+    if (caps.astc) {
+        return source.srgb ? 0x93D0 : 0x93B0;
+    }
+    if (caps.bptc) {
+        return source.srgb ? 0x8E8D : 0x8E8C;
+    }
+    if (caps.etc2) {
+        return source.srgb ? 0x9279 : 0x9278;
+    }
+    if (caps.s3tc) {
+        return source.srgb ? 0x8C4F : 0x83F3;
+    }
+    return source.srgb ? 0x8C43 : 0x8058;
+}
+
+namespace detail {
+
+template<typename T>
+T read(std::span<std::byte const> bytes, std::size_t offset) {
+    if (offset > bytes.size() || sizeof(T) > bytes.size() - offset) {
+        throw std::runtime_error("Corrupt texture: truncated");
+    }
+    auto result = T();
+    std::memcpy(&result, bytes.data() + offset, sizeof(T));
+    return result;
+}
+
+inline std::uint32_t gl_of_vulkan(std::uint32_t format) noexcept {
+    // VkFormat values 131-184 are the BC, ETC2/EAC and ASTC formats, in that order.
+    static constexpr std::pair<std::uint32_t, std::uint32_t> k_table[] = {
+        { 37, 0x8058 }, { 43, 0x8C43 }, { 9, 0x8229 }, { 16, 0x822B }, { 97, 0x881A }, { 109, 0x8814 },
+        { 131, 0x83F0 }, { 132, 0x8C4C }, { 133, 0x83F1 }, { 134, 0x8C4D }, { 135, 0x83F2 }, { 136, 0x8C4E },
+        { 137, 0x83F3 }, { 138, 0x8C4F }, { 139, 0x8DBB }, { 140, 0x8DBC }, { 141, 0x8DBD }, { 142, 0x8DBE },
+        { 143, 0x8E8F }, { 144, 0x8E8E }, { 145, 0x8E8C }, { 146, 0x8E8D },
+        { 147, 0x9274 }, { 148, 0x9275 }, { 149, 0x9276 }, { 150, 0x9277 }, { 151, 0x9278 }, { 152, 0x9279 },
+        { 153, 0x9270 }, { 154, 0x9271 }, { 155, 0x9272 }, { 156, 0x9273 },
+        { 157, 0x93B0 }, { 158, 0x93D0 }, { 161, 0x93B2 }, { 162, 0x93D2 }, { 165, 0x93B4 }, { 166, 0x93D4 },
+        { 171, 0x93B7 }, { 172, 0x93D7 }, { 179, 0x93BB }, { 180, 0x93DB }, { 183, 0x93BD }, { 184, 0x93DD }
+    };
+    auto const it = std::ranges::find(k_table, format, &std::pair<std::uint32_t, std::uint32_t>::first);
+    return it == std::end(k_table) ? 0 : it->second;
+}
+
+inline std::uint32_t gl_of_dxgi(std::uint32_t format) noexcept {
+    static constexpr std::pair<std::uint32_t, std::uint32_t> k_table[] = {
+        { 28, 0x8058 }, { 29, 0x8C43 }, { 61, 0x8229 }, { 49, 0x822B }, { 10, 0x881A }, { 2, 0x8814 },
+        { 71, 0x83F1 }, { 72, 0x8C4D }, { 74, 0x83F2 }, { 75, 0x8C4E }, { 77, 0x83F3 }, { 78, 0x8C4F },
+        { 80, 0x8DBB }, { 81, 0x8DBC }, { 83, 0x8DBD }, { 84, 0x8DBE },
+        { 95, 0x8E8F }, { 96, 0x8E8E }, { 98, 0x8E8C }, { 99, 0x8E8D }
+    };
+    auto const it = std::ranges::find(k_table, format, &std::pair<std::uint32_t, std::uint32_t>::first);
+    return it == std::end(k_table) ? 0 : it->second;
+}
+
+inline bool is_srgb(std::uint32_t gl_format) noexcept {
+    return gl_format == 0x8C43 || (gl_format >= 0x8C4C && gl_format <= 0x8C4F) || gl_format == 0x8E8D
+        || gl_format == 0x9275 || gl_format == 0x9277 || gl_format == 0x9279 || (gl_format >= 0x93D0 && gl_format <= 0x93DD);
+}
+
+inline image parse_ktx2(std::span<std::byte const> bytes) {
+    static constexpr std::uint32_t k_basis_lz = 1;
+    static constexpr std::uint8_t k_model_uastc = 166;
+    static constexpr std::uint8_t k_transfer_srgb = 2;
+
+    auto const vk_format = read<std::uint32_t>(bytes, 12);
+    auto result = image();
+    result.width = read<std::uint32_t>(bytes, 20);
+    result.height = std::max(read<std::uint32_t>(bytes, 24), 1u);
+    if (read<std::uint32_t>(bytes, 28) > 1 || read<std::uint32_t>(bytes, 32) > 1 || read<std::uint32_t>(bytes, 36) > 1) {
+        throw std::runtime_error("Unsupported KTX2 texture: only 2D textures load");
+    }
+    auto const level_ct = read<std::uint32_t>(bytes, 40);
+    auto const scheme = read<std::uint32_t>(bytes, 44);
+    auto const dfd = read<std::uint32_t>(bytes, 48);
+    auto const model = read<std::uint8_t>(bytes, dfd + 12);
+    result.srgb = read<std::uint8_t>(bytes, dfd + 14) == k_transfer_srgb;
+    result.generate_mipmaps = level_ct == 0;
+
+    if (scheme == k_basis_lz) {
+        result.basis = image::ETC1S;
+        auto const offset = read<std::uint64_t>(bytes, 64);
+        auto const size = read<std::uint64_t>(bytes, 72);
+        if (offset > bytes.size() || size > bytes.size() - offset) {
+            throw std::runtime_error("Corrupt KTX2 texture: supercompression data out of the file");
+        }
+        result.global = bytes.subspan(static_cast<std::size_t>(offset), static_cast<std::size_t>(size));
+    }
+    else if (vk_format == 0 && model == k_model_uastc) {
+        result.basis = image::UASTC;
+    }
+    else if (scheme != 0) {
+        throw std::runtime_error("Unsupported KTX2 texture: supercompression scheme " + std::to_string(scheme));
+    }
+    else {
+        result.gl_format = gl_of_vulkan(vk_format);
+        if (result.gl_format == 0) {
+            throw std::runtime_error("Unsupported KTX2 texture: VkFormat " + std::to_string(vk_format));
+        }
+        result.srgb = is_srgb(result.gl_format);
+    }
+
+    auto const* const info = info_of(result.gl_format);
+    for (auto level = 0u; level < std::max(level_ct, 1u); ++level) {
+        auto const offset = read<std::uint64_t>(bytes, 80 + level * 24);
+        auto const size = read<std::uint64_t>(bytes, 80 + level * 24 + 8);
+        if (offset > bytes.size() || size > bytes.size() - offset) {
+            throw std::runtime_error("Corrupt KTX2 texture: level out of the file");
+        }
+        if (info != nullptr && size < info->level_size(std::max(result.width >> level, 1u), std::max(result.height >> level, 1u))) {
+            throw std::runtime_error("Corrupt KTX2 texture: level too small");
+        }
+        result.levels.push_back(bytes.subspan(static_cast<std::size_t>(offset), static_cast<std::size_t>(size)));
+    }
+    return result;
+}
+
+inline image parse_dds(std::span<std::byte const> bytes) {
+    static constexpr std::uint32_t k_fourcc = 0x4;
+    static constexpr std::uint32_t k_rgb = 0x40;
+    static constexpr std::uint32_t k_cubemap = 0x200;
+    auto const fourcc = [](char const (&code)[5]) {
+        return std::uint32_t(code[0]) | std::uint32_t(code[1]) << 8 | std::uint32_t(code[2]) << 16 | std::uint32_t(code[3]) << 24;
+    };
+
+    auto result = image();
+    result.height = read<std::uint32_t>(bytes, 12);
+    result.width = read<std::uint32_t>(bytes, 16);
+    auto const level_ct = std::max(read<std::uint32_t>(bytes, 28), 1u);
+    auto const flags = read<std::uint32_t>(bytes, 80);
+    auto const code = read<std::uint32_t>(bytes, 84);
+    if ((read<std::uint32_t>(bytes, 112) & k_cubemap) != 0 || read<std::uint32_t>(bytes, 24) > 1) {
+        throw std::runtime_error("Unsupported DDS texture: only 2D textures load");
+    }
+    auto data = std::size_t(128);
+    if ((flags & k_fourcc) != 0 && code == fourcc("DX10")) {
+        result.gl_format = gl_of_dxgi(read<std::uint32_t>(bytes, 128));
+        if (read<std::uint32_t>(bytes, 140) > 1) {
+            throw std::runtime_error("Unsupported DDS texture: only 2D textures load");
+        }
+        data = 148;
+    }
+    else if ((flags & k_fourcc) != 0) {
+        result.gl_format = code == fourcc("DXT1") ? 0x83F1
+                         : code == fourcc("DXT3") ? 0x83F2
+                         : code == fourcc("DXT5") ? 0x83F3
+                         : code == fourcc("ATI1") || code == fourcc("BC4U") ? 0x8DBB
+                         : code == fourcc("ATI2") || code == fourcc("BC5U") ? 0x8DBD : 0;
+    }
+    else if ((flags & k_rgb) != 0 && read<std::uint32_t>(bytes, 88) == 32 && read<std::uint32_t>(bytes, 92) == 0xFF
+             && read<std::uint32_t>(bytes, 96) == 0xFF00 && read<std::uint32_t>(bytes, 100) == 0xFF0000) {
+        result.gl_format = 0x8058;
+    }
+    auto const* const info = info_of(result.gl_format);
+    if (info == nullptr) {
+        throw std::runtime_error("Unsupported DDS texture: pixel format");
+    }
+    result.srgb = is_srgb(result.gl_format);
+
+    for (auto level = 0u; level < level_ct; ++level) {
+        auto const size = info->level_size(std::max(result.width >> level, 1u), std::max(result.height >> level, 1u));
+        if (data > bytes.size() || size > bytes.size() - data) {
+            throw std::runtime_error("Corrupt DDS texture: level out of the file");
+        }
+        result.levels.push_back(bytes.subspan(data, size));
+        data += size;
+    }
+    return result;
+}
+
+} // namespace detail
+
+/**
+ * @brief Recognize a KTX2 or DDS file by its identifier, validate it, and point into its levels.
+ */
+inline image parse(std::span<std::byte const> bytes) {
+    static constexpr unsigned char k_ktx2[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+    auto result = image();
+    if (bytes.size() >= 80 && std::memcmp(bytes.data(), k_ktx2, sizeof(k_ktx2)) == 0) {
+        result = detail::parse_ktx2(bytes);
+    }
+    else if (bytes.size() >= 128 && std::memcmp(bytes.data(), "DDS ", 4) == 0) {
+        result = detail::parse_dds(bytes);
+    }
+    else {
+        throw std::runtime_error("Not a texture container: expected KTX2 or DDS");
+    }
+    if (result.width == 0 || result.height == 0) {
+        throw std::runtime_error("Corrupt texture: empty");
+    }
+    return result;
+}
+
+} // namespace texture_container
+
+/**
+ * @brief Decoding of PNG, JPEG and the like on the job system, through a decoder this library
+ * does not ship (e.g. libjpeg-turbo, spng or wuffs, whose SIMD paths do the per-pixel work).
+ * The pixels come out as tightly packed 8-bit RGBA, the client layout of GL_RGBA8 and
+ * GL_SRGB8_ALPHA8, so they go to the GPU without another pass. Decoders that can start at
+ * any row (e.g. JPEG with restart markers, through jpeg_skip_scanlines()) decode bands of a
+ * large image in parallel; the others decode the whole image in one job.
+ * @code
+ *      auto const codec = gltool::image_decode::decoder{
+ *          .probe = [](auto file) { return read_jpeg_header(file); },       // A wrapper of libjpeg-turbo.
+ *          .decode_rows = [](auto file, auto first, auto count, auto rgba) { decode_jpeg_rows(file, first, count, rgba); }
+ *      };
+ *      auto header = gltool::image_decode::header();
+ *      auto const pixels = gltool::image_decode::decode(jobs, codec, file, header);
+ * @endcode
+ */
+namespace image_decode {
+
+struct header {
+    std::uint32_t width = 0;
+    std::uint32_t height = 0;
+    bool banded = false;                    /* Rows can be decoded from any row on, in parallel */
+};
+
+/**
+ * @brief A decoder: `probe` reads the header of a file it takes (nullopt otherwise), and
+ * `decode_rows` writes `row_ct` rows from `first_row` on into `rgba`, row_ct * width * 4
+ * bytes. It is called from several threads at once for a banded image.
+ */
+struct decoder {
+    std::function<std::optional<header>(std::span<std::byte const> file)> probe;
+    std::function<void (std::span<std::byte const> file, std::uint32_t first_row, std::uint32_t row_ct, std::span<std::byte> rgba)> decode_rows;
+};
+
+/**
+ * @brief Decode the whole image of `file`, whose header `codec` read, into `rgba`: bands of
+ * `band_rows` rows as jobs of their own when the image is banded.
+ */
+inline void decode(job_system& jobs, decoder const& codec, std::span<std::byte const> file, header const& image, std::span<std::byte> rgba,
+                   std::uint32_t band_rows = 256) {
+    auto const row_size = std::size_t(image.width) * 4;
+    if (rgba.size() < row_size * image.height) {
+        throw std::runtime_error("Image decode: the output is smaller than the image");
+    }
+    if (!image.banded || image.height <= band_rows) {
+        codec.decode_rows(file, 0, image.height, rgba.first(row_size * image.height));
+        return;
+    }
+    band_rows = std::max(band_rows, 1u);
+    auto const bands = (image.height + band_rows - 1) / band_rows;
+    jobs.parallel_for(0, bands, [&](std::size_t first, std::size_t last) {
+        for (auto band = first; band < last; ++band) {
+            auto const row = static_cast<std::uint32_t>(band) * band_rows;
+            auto const rows = std::min(band_rows, image.height - row);
+            codec.decode_rows(file, row, rows, rgba.subspan(row * row_size, rows * row_size));
+        }
+  }, 1, job_system::priority::BACKGROUND);
+}
+
+/**
+ * @brief Same as above into a new buffer; `image` receives the header.
+ */
+inline std::vector<std::byte> decode(job_system& jobs, decoder const& codec, std::span<std::byte const> file, header& image,
+                                     std::uint32_t band_rows = 256) {
+    if (!codec.probe || !codec.decode_rows) {
+        throw std::runtime_error("Image decode: no decoder");
+    }
+    auto const probed = codec.probe(file);
+    if (!probed || probed->width == 0 || probed->height == 0) {
+        throw std::runtime_error("Image decode: not an image the decoder takes");
+    }
+    image = *probed;
+    auto result = std::vector<std::byte>(std::size_t(image.width) * image.height * 4);
+    decode(jobs, codec, file, image, result, band_rows);
+    return result;
+}
+
+} // namespace image_decode
+
+/**
+ * @brief The tiled on-disk format of virtual textures: every mip level cut into square pages
+ * of `page_size` texels plus a `border` of neighbouring texels on each side (so a page filters
+ * on its own), stored one after the other so that a page is a single read from a mapped file.
+ * The last level always fits in one page. Pages are 8-bit RGBA, level 0 first and row-major in
+ * each level. Written by write(), read by parse().
+ */
+namespace tiled_texture {
+
+constexpr std::uint32_t k_magic = 0x54564C47;       // "GLVT"
+constexpr std::uint32_t k_version = 1;
+constexpr std::size_t k_alignment = 16;
+constexpr std::uint32_t k_texel_size = 4;
+
+struct header {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t width;                /* Of level 0, in texels */
+    std::uint32_t height;
+    std::uint32_t levels;
+    std::uint32_t page_size;            /* Texels of a page, without its borders */
+    std::uint32_t border;
+    std::uint32_t page_ct;              /* Of all levels */
+    std::uint64_t data_offset;          /* Byte offset of the first page */
+    std::uint64_t reserved;
+};
+
+static_assert(sizeof(header) == 48, "The layout of the format is fixed");
+
+/**
+ * @brief Pages across and down of a level.
+ */
+inline std::array<std::uint32_t, 2> page_grid(header const& info, std::uint32_t level) noexcept {
+    auto const width = std::max(info.width >> level, 1u);
+    auto const height = std::max(info.height >> level, 1u);
+    return { (width + info.page_size - 1) / info.page_size, (height + info.page_size - 1) / info.page_size };
+}
+
+/**
+ * @brief Bytes of a page with its borders.
+ */
+inline std::size_t page_bytes(header const& info) noexcept {
+    auto const side = std::size_t(info.page_size + 2 * info.border);
+    return side * side * k_texel_size;
+}
+
+/**
+ * @brief A parsed file: views into its bytes, valid as long as they are.
+ */
+struct view {
+    header const* info = nullptr;
+    std::vector<std::uint32_t> first_page;          /* Index of the first page of each level */
+    std::span<std::byte const> bytes;
+
+    std::span<std::byte const> page(std::uint32_t level, std::uint32_t x, std::uint32_t y) const {
+        auto const [across, down] = page_grid(*info, level);
+        if (level >= info->levels || x >= across || y >= down) {
+            throw std::out_of_range("Page outside of the virtual texture");
+        }
+        auto const size = page_bytes(*info);
+        auto const index = first_page[level] + y * across + x;
+        return bytes.subspan(static_cast<std::size_t>(info->data_offset) + index * size, size);
+    }
+};
+
+inline view parse(std::span<std::byte const> bytes) {
+    if (bytes.size() < sizeof(header) || reinterpret_cast<std::uintptr_t>(bytes.data()) % k_alignment != 0) {
+        throw std::runtime_error("Not a tiled texture: too small or misaligned");
+    }
+    auto const* const info = reinterpret_cast<header const*>(bytes.data());
+    if (info->magic != k_magic) {
+        throw std::runtime_error("Not a tiled texture: bad magic");
+    }
+    if (info->version != k_version) {
+        throw std::runtime_error("Unsupported tiled texture version " + std::to_string(info->version));
+    }
+    if (info->width == 0 || info->height == 0 || info->page_size == 0 || info->levels == 0 || info->levels > 16) {
+        throw std::runtime_error("Corrupt tiled texture: bad size");
+    }
+    auto result = view();
+    result.info = info;
+    result.bytes = bytes;
+    auto pages = std::uint64_t(0);
+    for (auto level = 0u; level < info->levels; ++level) {
+        result.first_page.push_back(static_cast<std::uint32_t>(pages));
+        auto const [across, down] = page_grid(*info, level);
+        pages += std::uint64_t(across) * down;
+    }
+    if (pages != info->page_ct || page_grid(*info, info->levels - 1) != std::array<std::uint32_t, 2>{ 1, 1 }) {
+        throw std::runtime_error("Corrupt tiled texture: bad page count");
+    }
+    if (info->data_offset > bytes.size() || pages * page_bytes(*info) > bytes.size() - info->data_offset) {
+        throw std::runtime_error("Corrupt tiled texture: pages out of the file");
+    }
+    return result;
+}
+
+/**
+ * @brief Write RGBA8 texels (level 0, tightly packed) as a tiled texture. Lower levels are
+ * box filtered down until one fits in a page; borders repeat the edge texels of the level.
+ */
+inline void write(std::ostream& out, std::span<std::byte const> texels, std::uint32_t width, std::uint32_t height,
+                  std::uint32_t page_size = 128, std::uint32_t border = 4) {
+    if (width == 0 || height == 0 || page_size == 0 || texels.size() < std::size_t(width) * height * k_texel_size) {
+        throw std::runtime_error("Not enough texels for the tiled texture");
+    }
+    auto info = header();
+    info.magic = k_magic;
+    info.version = k_version;
+    info.width = width;
+    info.height = height;
+    info.page_size = page_size;
+    info.border = border;
+    info.levels = 1;
+    while (std::max(width >> (info.levels - 1), 1u) > page_size || std::max(height >> (info.levels - 1), 1u) > page_size) {
+        ++info.levels;
+    }
+    info.page_ct = 0;
+    for (auto level = 0u; level < info.levels; ++level) {
+        auto const [across, down] = page_grid(info, level);
+        info.page_ct += across * down;
+    }
+    info.data_offset = (sizeof(header) + k_alignment - 1) / k_alignment * k_alignment;
+    out.write(reinterpret_cast<char const*>(&info), sizeof(info));
+    out.write(std::array<char, k_alignment>{}.data(), static_cast<std::streamsize>(info.data_offset - sizeof(info)));
+
+    auto image = std::vector<std::byte>(texels.begin(), texels.begin() + std::ptrdiff_t(width) * height * k_texel_size);
+    auto w = width;
+    auto h = height;
+    auto const side = page_size + 2 * border;
+    auto page = std::vector<std::byte>(page_bytes(info));
+    for (auto level = 0u; level < info.levels; ++level) {
+        auto const [across, down] = page_grid(info, level);
+        for (auto py = 0u; py < down; ++py) {
+            for (auto px = 0u; px < across; ++px) {
+                for (auto y = 0u; y < side; ++y) {
+                    auto const from_y = std::clamp<std::int64_t>(std::int64_t(py * page_size + y) - border, 0, h - 1);
+                    for (auto x = 0u; x < side; ++x) {
+                        auto const from_x = std::clamp<std::int64_t>(std::int64_t(px * page_size + x) - border, 0, w - 1);
+                        std::memcpy(page.data() + (y * side + x) * k_texel_size, image.data() + (from_y * w + from_x) * k_texel_size, k_texel_size);
+                    }
+                }
+                out.write(reinterpret_cast<char const*>(page.data()), static_cast<std::streamsize>(page.size()));
+            }
+        }
+        // Box filter the next level; odd edges reuse their last texel.
+        auto const next_w = std::max(w / 2, 1u);
+        auto const next_h = std::max(h / 2, 1u);
+        auto next = std::vector<std::byte>(std::size_t(next_w) * next_h * k_texel_size);
+        for (auto y = 0u; y < next_h; ++y) {
+            for (auto x = 0u; x < next_w; ++x) {
+                for (auto c = 0u; c < k_texel_size; ++c) {
+                    auto sum = 0u;
+                    for (auto k = 0u; k < 4; ++k) {
+                        auto const sx = std::min(x * 2 + (k & 1), w - 1);
+                        auto const sy = std::min(y * 2 + (k >> 1), h - 1);
+                        sum += std::to_integer<unsigned>(image[(sy * w + sx) * k_texel_size + c]);
+                    }
+                    next[(y * next_w + x) * k_texel_size + c] = std::byte((sum + 2) / 4);
+                }
+            }
+        }
+        image = std::move(next);
+        w = next_w;
+        h = next_h;
+    }
+    if (!out) {
+        throw std::runtime_error("Could not write the tiled texture");
+    }
+}
+
+} // namespace tiled_texture
+
+/**
+ * @brief The chunked on-disk format of point clouds too large for memory: an octree over the
+ * points where every node holds a subsample of what lies in its cube (one point per cell of a
+ * grid, at most `max_node_points`) and passes the rest on to its children, so a node adds
+ * detail to its ancestors and drawing a node never needs its children. Nodes are stored
+ * breadth first, with consecutive children, and the points of each node are one aligned chunk
+ * that is read from a mapped file as it is. Built by build(), written by write(), read by
+ * parse(). Positions are floats relative to a double precision origin, which keeps geographic
+ * coordinates exact to the millimeter.
+ */
+namespace point_cloud {
+
+constexpr std::uint32_t k_magic = 0x43504C47;       // "GLPC"
+constexpr std::uint32_t k_version = 1;
+constexpr std::size_t k_alignment = 16;
+
+struct point {
+    float position[3];                  /* Relative to the origin of the cloud */
+    std::uint8_t color[4];              /* RGBA */
+};
+
+struct node {
+    float min[3];                       /* Bounds of the cube of the node, not only of its points */
+    float max[3];
+    float spacing;                      /* Distance between neighbouring points of the node */
+    std::uint32_t first_child;          /* Children are consecutive; 0 for a leaf (0 is the root) */
+    std::uint32_t child_ct;
+    std::uint32_t point_ct;
+    std::uint64_t point_offset;         /* Byte offset of the points from the start of the file */
+};
+
+struct header {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t node_ct;
+    std::uint32_t max_node_points;
+    std::uint64_t point_ct;
+    std::uint64_t node_offset;          /* Byte offset of the nodes from the start of the file */
+    double origin[3];
+    std::uint64_t reserved;
+};
+
+static_assert(sizeof(header) == 64 && sizeof(node) == 48 && sizeof(point) == 16, "The layout of the format is fixed");
+
+/**
+ * @brief A parsed file: views into its bytes, valid as long as they are.
+ */
+struct view {
+    header const* info = nullptr;
+    std::span<node const> nodes;
+    std::span<std::byte const> bytes;
+
+    std::span<point const> points(std::uint32_t index) const {
+        auto const& entry = nodes[index];
+        return { reinterpret_cast<point const*>(bytes.data() + entry.point_offset), entry.point_ct };
+    }
+};
+
+inline view parse(std::span<std::byte const> bytes) {
+    if (bytes.size() < sizeof(header) || reinterpret_cast<std::uintptr_t>(bytes.data()) % k_alignment != 0) {
+        throw std::runtime_error("Not a point cloud: too small or misaligned");
+    }
+    auto const* const info = reinterpret_cast<header const*>(bytes.data());
+    if (info->magic != k_magic) {
+        throw std::runtime_error("Not a point cloud: bad magic");
+    }
+    if (info->version != k_version) {
+        throw std::runtime_error("Unsupported point cloud version " + std::to_string(info->version));
+    }
+    if (info->node_ct == 0 || info->node_offset % k_alignment != 0 || info->node_offset > bytes.size() ||
+        std::uint64_t(info->node_ct) * sizeof(node) > bytes.size() - info->node_offset) {
+        throw std::runtime_error("Corrupt point cloud: nodes out of the file");
+    }
+    auto result = view();
+    result.info = info;
+    result.bytes = bytes;
+    result.nodes = { reinterpret_cast<node const*>(bytes.data() + info->node_offset), info->node_ct };
+    auto points = std::uint64_t(0);
+    for (auto i = std::uint32_t(0); i < info->node_ct; ++i) {
+        auto const& entry = result.nodes[i];
+        if (entry.point_offset % k_alignment != 0 || entry.point_offset > bytes.size() ||
+            std::uint64_t(entry.point_ct) * sizeof(point) > bytes.size() - entry.point_offset) {
+            throw std::runtime_error("Corrupt point cloud: points of node " + std::to_string(i) + " out of the file");
+        }
+        if (entry.child_ct > 8 || (entry.child_ct > 0 && (entry.first_child <= i || entry.first_child > info->node_ct - entry.child_ct))) {
+            throw std::runtime_error("Corrupt point cloud: bad children of node " + std::to_string(i));
+        }
+        points += entry.point_ct;
+    }
+    if (points != info->point_ct) {
+        throw std::runtime_error("Corrupt point cloud: bad point count");
+    }
+    return result;
+}
+
+/**
+ * @brief An octree as build() makes it: the points in the order of the nodes, and each node's
+ * point_offset in bytes from the first point (write() places them in the file).
+ */
+struct tree {
+    std::vector<node> nodes;
+    std::vector<point> points;
+    std::uint32_t max_node_points = 0;
+};
+
+/**
+ * @brief Sort points into an octree. A node with more than `max_node_points` keeps the first
+ * point in each cell of a `grid` cubed grid over its cube (thinned evenly if those are still
+ * too many) and splits the others among its octants. The spacing of a node is that of its
+ * points on a surface, which is what scans are.
+ */
+inline tree build(std::span<point const> points, std::uint32_t max_node_points = 20000, std::uint32_t grid = 128) {
+    constexpr auto k_max_depth = 24;
+    if (points.empty() || max_node_points == 0 || grid == 0) {
+        throw std::runtime_error("A point cloud needs points, and nodes need room for some");
+    }
+    auto low = std::array<float, 3>{ points[0].position[0], points[0].position[1], points[0].position[2] };
+    auto high = low;
+    for (auto const& p : points) {
+        for (auto k = 0; k < 3; ++k) {
+            low[k] = std::min(low[k], p.position[k]);
+            high[k] = std::max(high[k], p.position[k]);
+        }
+    }
+    auto side = std::max({ high[0] - low[0], high[1] - low[1], high[2] - low[2], 1e-6f });
+    side = std::nextafter(side, std::numeric_limits<float>::max());     // Keep the farthest point inside.
+
+    struct work {
+        std::uint32_t node;
+        std::vector<std::uint32_t> members;
+        int depth;
+    };
+    auto result = tree();
+    result.max_node_points = max_node_points;
+    result.points.reserve(points.size());
+    result.nodes.push_back({ { low[0], low[1], low[2] }, { low[0] + side, low[1] + side, low[2] + side }, 0.f, 0, 0, 0, 0 });
+    auto queue = std::deque<work>();
+    queue.push_back({ 0, std::vector<std::uint32_t>(points.size()), 0 });
+    std::iota(queue.back().members.begin(), queue.back().members.end(), 0u);
+
+    auto occupied = std::unordered_set<std::uint64_t>();
+    while (!queue.empty()) {
+        auto item = std::move(queue.front());
+        queue.pop_front();
+        auto const& cube = result.nodes[item.node];
+        auto const origin = std::array<float, 3>{ cube.min[0], cube.min[1], cube.min[2] };
+        auto const extent = cube.max[0] - cube.min[0];
+        auto kept = std::vector<std::uint32_t>();
+        auto rest = std::vector<std::uint32_t>();
+        auto stride = std::size_t(1);
+        if (item.members.size() <= max_node_points || item.depth >= k_max_depth) {
+            kept = std::move(item.members);
+        }
+        else {
+            occupied.clear();
+            occupied.reserve(std::min<std::size_t>(item.members.size(), std::size_t(grid) * grid * 4));
+            for (auto const i : item.members) {
+                auto key = std::uint64_t(0);
+                for (auto k = 0; k < 3; ++k) {
+                    auto const cell = static_cast<std::uint64_t>(std::clamp((points[i].position[k] - origin[k]) / extent * static_cast<float>(grid),
+                                                                            0.f, static_cast<float>(grid - 1)));
+                    key = key * grid + cell;
+                }
+                (occupied.insert(key).second ? kept : rest).push_back(i);
+            }
+            if (kept.size() > max_node_points) {
+                stride = (kept.size() + max_node_points - 1) / max_node_points;
+                auto thinned = std::vector<std::uint32_t>();
+                for (auto k = std::size_t(0); k < kept.size(); ++k) {
+                    (k % stride == 0 ? thinned : rest).push_back(kept[k]);
+                }
+                kept = std::move(thinned);
+            }
+        }
+        auto& entry = result.nodes[item.node];
+        entry.point_offset = result.points.size() * sizeof(point);
+        entry.point_ct = static_cast<std::uint32_t>(kept.size());
+        entry.spacing = rest.empty() ? extent / std::sqrt(static_cast<float>(std::max<std::size_t>(kept.size(), 1)))
+                                     : extent / static_cast<float>(grid) * std::sqrt(static_cast<float>(stride));
+        for (auto const i : kept) {
+            result.points.push_back(points[i]);
+        }
+        if (rest.empty()) {
+            continue;
+        }
+        auto octants = std::array<std::vector<std::uint32_t>, 8>();
+        auto const half = extent * 0.5f;
+        for (auto const i : rest) {
+            auto octant = 0;
+            for (auto k = 0; k < 3; ++k) {
+                octant |= (points[i].position[k] >= origin[k] + half ? 1 : 0) << k;
+            }
+            octants[octant].push_back(i);
+        }
+        auto const first = static_cast<std::uint32_t>(result.nodes.size());
+        auto children = std::uint32_t(0);
+        for (auto octant = 0; octant < 8; ++octant) {
+            if (octants[octant].empty()) {
+                continue;
+            }
+            auto child = node();
+            for (auto k = 0; k < 3; ++k) {
+                child.min[k] = origin[k] + (octant >> k & 1 ? half : 0.f);
+                child.max[k] = child.min[k] + half;
+            }
+            result.nodes.push_back(child);
+            queue.push_back({ first + children++, std::move(octants[octant]), item.depth + 1 });
+        }
+        result.nodes[item.node].first_child = first;
+        result.nodes[item.node].child_ct = children;
+    }
+    return result;
+}
+
+inline void write(std::ostream& out, tree const& cloud, std::array<double, 3> const& origin) {
+    auto info = header();
+    info.magic = k_magic;
+    info.version = k_version;
+    info.node_ct = static_cast<std::uint32_t>(cloud.nodes.size());
+    info.max_node_points = cloud.max_node_points;
+    info.point_ct = cloud.points.size();
+    info.node_offset = (sizeof(header) + k_alignment - 1) / k_alignment * k_alignment;
+    std::ranges::copy(origin, info.origin);
+    auto const data_offset = (info.node_offset + cloud.nodes.size() * sizeof(node) + k_alignment - 1) / k_alignment * k_alignment;
+    auto nodes = cloud.nodes;
+    for (auto& entry : nodes) {
+        entry.point_offset += data_offset;
+    }
+    static constexpr char k_padding[k_alignment] = {};
+    out.write(reinterpret_cast<char const*>(&info), sizeof(info));
+    out.write(k_padding, static_cast<std::streamsize>(info.node_offset - sizeof(info)));
+    out.write(reinterpret_cast<char const*>(nodes.data()), static_cast<std::streamsize>(nodes.size() * sizeof(node)));
+    out.write(k_padding, static_cast<std::streamsize>(data_offset - info.node_offset - nodes.size() * sizeof(node)));
+    out.write(reinterpret_cast<char const*>(cloud.points.data()), static_cast<std::streamsize>(cloud.points.size() * sizeof(point)));
+    if (!out) {
+        throw std::runtime_error("Could not write the point cloud");
+    }
+}
+
+} // namespace point_cloud
+
+/**
+ * @brief Packs rectangles into a fixed-size bin with the skyline bottom-left heuristic: the
+ * top edge of what is packed is kept as a list of horizontal segments, and each rectangle goes
+ * where its top ends lowest (ties: where it wastes the narrowest segment). Fast, and close to
+ * maxrects for the similar sizes of sprite and decal sheets, best inserted tallest first.
+ */
+class skyline_packer {
+public:
+    struct rect {
+        std::uint32_t x = 0;
+        std::uint32_t y = 0;
+        std::uint32_t width = 0;
+        std::uint32_t height = 0;
+    };
+
+    /**
+     * @param padding Free pixels kept around every rectangle, e.g. to stop filtering bleeding
+     * between neighbours.
+     */
+    skyline_packer(std::uint32_t width, std::uint32_t height, std::uint32_t padding = 0)
+        : m_width(width),
+          m_height(height),
+          m_padding(padding),
+          m_skyline{ { 0, 0, width } } {}
+
+    /**
+     * @brief Place a rectangle, or return nothing if it does not fit anymore.
+     */
+    std::optional<rect> insert(std::uint32_t width, std::uint32_t height) {
+        auto const w = width + 2 * m_padding;
+        auto const h = height + 2 * m_padding;
+        auto best = m_skyline.size();
+        auto best_y = std::numeric_limits<std::uint32_t>::max();
+        auto best_waste = std::numeric_limits<std::uint32_t>::max();
+        for (auto i = std::size_t(0); i < m_skyline.size(); ++i) {
+            auto const y = this->fit(i, w, h);
+            if (!y) {
+                continue;
+            }
+            if (*y + h < best_y || (*y + h == best_y && m_skyline[i].width < best_waste)) {
+                best = i;
+                best_y = *y + h;
+                best_waste = m_skyline[i].width;
+            }
+        }
+        if (best == m_skyline.size()) {
+            return std::nullopt;
+        }
+        auto const x = m_skyline[best].x;
+        this->place(best, w, best_y);
+        m_used += std::uint64_t(width) * height;
+        return rect{ x + m_padding, best_y - h + m_padding, width, height };
+    }
+
+    /**
+     * @brief Fraction of the bin covered by rectangles (without their padding).
+     */
+    double occupancy() const noexcept {
+        return double(m_used) / (double(m_width) * double(m_height));
+    }
+
+    void reset() {
+        m_skyline = { { 0, 0, m_width } };
+        m_used = 0;
+    }
+
+private:
+    struct segment {
+        std::uint32_t x;
+        std::uint32_t y;
+        std::uint32_t width;
+    };
+
+    /**
+     * @brief The lowest y where a rectangle fits with its left edge on segment i.
+     */
+    std::optional<std::uint32_t> fit(std::size_t i, std::uint32_t width, std::uint32_t height) const {
+        if (m_skyline[i].x + width > m_width) {
+            return std::nullopt;
+        }
+        auto y = std::uint32_t(0);
+        auto left = width;
+        for (auto j = i; left > 0; ++j) {
+            y = std::max(y, m_skyline[j].y);
+            if (y + height > m_height) {
+                return std::nullopt;
+            }
+            left -= std::min(left, m_skyline[j].width);
+        }
+        return y;
+    }
+
+    void place(std::size_t i, std::uint32_t width, std::uint32_t top) {
+        auto const x = m_skyline[i].x;
+        m_skyline.insert(m_skyline.begin() + static_cast<std::ptrdiff_t>(i), { x, top, width });
+        // Cut the segments now under the rectangle.
+        for (auto j = i + 1; j < m_skyline.size();) {
+            auto& next = m_skyline[j];
+            if (next.x >= x + width) {
+                break;
+            }
+            auto const overlap = std::min(next.width, x + width - next.x);
+            next.x += overlap;
+            next.width -= overlap;
+            if (next.width == 0) {
+                m_skyline.erase(m_skyline.begin() + static_cast<std::ptrdiff_t>(j));
+            }
+            else {
+                break;
+            }
+        }
+        // Merge neighbours at the same height.
+        for (auto j = std::size_t(0); j + 1 < m_skyline.size();) {
+            if (m_skyline[j].y == m_skyline[j + 1].y) {
+                m_skyline[j].width += m_skyline[j + 1].width;
+                m_skyline.erase(m_skyline.begin() + static_cast<std::ptrdiff_t>(j + 1));
+            }
+            else {
+                ++j;
+            }
+        }
+    }
+
+    std::uint32_t        m_width;
+    std::uint32_t        m_height;
+    std::uint32_t        m_padding;
+    std::vector<segment> m_skyline;
+    std::uint64_t        m_used = 0;
+};
+
+/**
+ * @brief Allocates square power-of-two tiles of a square bin, and takes them back: the buddy
+ * scheme in two dimensions, a free tile splits into four quadrants on demand and four free
+ * quadrants merge again. Tiles never move, so what is rendered into one stays valid until it
+ * is released, e.g. the shadow maps of a shadow atlas.
+ */
+class quadtree_allocator {
+public:
+    struct tile {
+        std::uint32_t x = 0;
+        std::uint32_t y = 0;
+        std::uint32_t size = 0;
+    };
+
+    /**
+     * @param size Side of the bin, rounded down to a power of two.
+     * @param min_size Smallest tile handed out, rounded up to a power of two.
+     */
+    quadtree_allocator(std::uint32_t size, std::uint32_t min_size)
+        : m_size(std::bit_floor(std::max(size, 1u))),
+          m_min_size(std::min(std::bit_ceil(std::max(min_size, 1u)), m_size)),
+          m_free(static_cast<std::size_t>(std::countr_zero(m_size) - std::countr_zero(m_min_size)) + 1) {
+        m_free[0].insert(key_of(0, 0));
+    }
+
+    /**
+     * @brief A free tile of at least `size` (rounded up to a power of two, at least the
+     * minimum), or nothing if none is left that large.
+     */
+    std::optional<tile> allocate(std::uint32_t size) {
+        size = std::max(std::bit_ceil(std::max(size, 1u)), m_min_size);
+        if (size > m_size) {
+            return std::nullopt;
+        }
+        auto const level = this->level_of(size);
+        auto from = level;
+        while (m_free[from].empty()) {
+            if (from == 0) {
+                return std::nullopt;
+            }
+            --from;
+        }
+        auto key = *m_free[from].begin();
+        m_free[from].erase(m_free[from].begin());
+        // Split down to the level: the first quadrant goes on, the other three are free.
+        for (; from < level; ++from) {
+            auto const half = (m_size >> from) / 2;
+            auto const x = static_cast<std::uint32_t>(key >> 32);
+            auto const y = static_cast<std::uint32_t>(key);
+            m_free[from + 1].insert(key_of(x + half, y));
+            m_free[from + 1].insert(key_of(x, y + half));
+            m_free[from + 1].insert(key_of(x + half, y + half));
+        }
+        m_used += std::uint64_t(size) * size;
+        return tile{ static_cast<std::uint32_t>(key >> 32), static_cast<std::uint32_t>(key), size };
+    }
+
+    /**
+     * @brief Give back a tile of allocate(), merging it with its free siblings.
+     */
+    void release(tile const& freed) {
+        auto level = this->level_of(freed.size);
+        auto x = freed.x;
+        auto y = freed.y;
+        m_used -= std::uint64_t(freed.size) * freed.size;
+        while (level > 0) {
+            auto const parent = (m_size >> level) * 2;
+            auto const px = x / parent * parent;
+            auto const py = y / parent * parent;
+            auto const half = parent / 2;
+            auto const siblings = std::array{ key_of(px, py), key_of(px + half, py), key_of(px, py + half), key_of(px + half, py + half) };
+            auto const self = key_of(x, y);
+            if (!std::ranges::all_of(siblings, [&](std::uint64_t k) { return k == self || m_free[level].contains(k); })) {
+                break;
+            }
+            for (auto const k : siblings) {
+                m_free[level].erase(k);
+            }
+            x = px;
+            y = py;
+            --level;
+        }
+        m_free[level].insert(key_of(x, y));
+    }
+
+    void reset() {
+        for (auto& level : m_free) {
+            level.clear();
+        }
+        m_free[0].insert(key_of(0, 0));
+        m_used = 0;
+    }
+
+    /**
+     * @brief Fraction of the bin in allocated tiles.
+     */
+    double occupancy() const noexcept {
+        return double(m_used) / (double(m_size) * double(m_size));
+    }
+
+    std::uint32_t get_size() const noexcept {
+        return m_size;
+    }
+
+    std::uint32_t get_min_size() const noexcept {
+        return m_min_size;
+    }
+
+private:
+    static std::uint64_t key_of(std::uint32_t x, std::uint32_t y) noexcept {
+        return (std::uint64_t(x) << 32) | y;
+    }
+
+    std::size_t level_of(std::uint32_t size) const noexcept {
+        return static_cast<std::size_t>(std::countr_zero(m_size) - std::countr_zero(size));
+    }
+
+    std::uint32_t                                   m_size;
+    std::uint32_t                                   m_min_size;
+    std::vector<std::unordered_set<std::uint64_t>> m_free;        // Free tiles per level, the whole bin first.
+    std::uint64_t                                   m_used = 0;
+};
+
+
+/**
+ * @brief Signed distance fields of 8-bit coverage masks, e.g. of glyphs, for shapes that stay
+ * sharp at any scale: sampled with bilinear filtering, 0.5 is the edge.
+ */
+namespace distance_field {
+
+namespace detail {
+
+/**
+ * @brief One dimension of the exact squared Euclidean distance transform of Felzenszwalb and
+ * Huttenlocher: the lower envelope of the parabolas rooted at each sample.
+ */
+inline void transform_1d(std::span<float> f, std::vector<std::size_t>& v, std::vector<float>& z, std::vector<float>& d) {
+    auto const n = f.size();
+    constexpr auto k_infinity = std::numeric_limits<float>::infinity();
+    v.assign(n, 0);
+    z.assign(n + 1, 0.f);
+    d.resize(n);
+    auto k = std::size_t(0);
+    z[0] = -k_infinity;
+    z[1] = k_infinity;
+    auto const intersection = [&](std::size_t q, std::size_t p) {
+        return ((f[q] + float(q * q)) - (f[p] + float(p * p))) / (2.f * float(q) - 2.f * float(p));
+    };
+    for (auto q = std::size_t(1); q < n; ++q) {
+        if (f[q] == k_infinity) {
+            continue;
+        }
+        if (f[v[k]] == k_infinity) {
+            v[k] = q;                   // Nothing rooted yet: q starts the envelope.
+            continue;
+        }
+        auto s = intersection(q, v[k]);
+        while (k > 0 && s <= z[k]) {
+            --k;
+            s = intersection(q, v[k]);
+        }
+        ++k;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = k_infinity;
+    }
+    k = 0;
+    for (auto q = std::size_t(0); q < n; ++q) {
+        while (z[k + 1] < float(q)) {
+            ++k;
+        }
+        auto const offset = float(q) - float(v[k]);
+        d[q] = f[v[k]] == k_infinity ? k_infinity : offset * offset + f[v[k]];
+    }
+    std::ranges::copy(d, f.begin());
+}
+
+/**
+ * @brief Squared distances to the nearest pixel whose coverage is (or is not) at least half.
+ */
+inline std::vector<float> squared_distances(std::span<std::uint8_t const> coverage, std::uint32_t width, std::uint32_t height, bool to_inside) {
+    auto grid = std::vector<float>(coverage.size());
+    for (auto i = std::size_t(0); i < coverage.size(); ++i) {
+        grid[i] = (coverage[i] >= 128) == to_inside ? 0.f : std::numeric_limits<float>::infinity();
+    }
+    auto v = std::vector<std::size_t>();
+    auto z = std::vector<float>();
+    auto d = std::vector<float>();
+    for (auto y = std::size_t(0); y < height; ++y) {
+        transform_1d(std::span(grid).subspan(y * width, width), v, z, d);
+    }
+    auto column = std::vector<float>(height);
+    for (auto x = std::size_t(0); x < width; ++x) {
+        for (auto y = std::size_t(0); y < height; ++y) {
+            column[y] = grid[y * width + x];
+        }
+        transform_1d(column, v, z, d);
+        for (auto y = std::size_t(0); y < height; ++y) {
+            grid[y * width + x] = column[y];
+        }
+    }
+    return grid;
+}
+
+} // namespace detail
+
+/**
+ * @brief The distance field of a coverage mask, grown by `spread` pixels on each side so the
+ * field can fade out: (width + 2 spread) x (height + 2 spread) bytes, rows in the same order.
+ * A byte is 0.5 on the edge and moves by 0.5 over `spread` pixels, up inside.
+ */
+inline std::vector<std::uint8_t> generate(std::span<std::uint8_t const> coverage, std::uint32_t width, std::uint32_t height, std::uint32_t spread) {
+    if (coverage.size() < std::size_t(width) * height) {
+        throw std::runtime_error("Coverage mask smaller than its size");
+    }
+    auto const padded_width = width + 2 * spread;
+    auto const padded_height = height + 2 * spread;
+    auto padded = std::vector<std::uint8_t>(std::size_t(padded_width) * padded_height, 0);
+    for (auto y = std::size_t(0); y < height; ++y) {
+        std::copy_n(coverage.data() + y * width, width, padded.data() + (y + spread) * padded_width + spread);
+    }
+    auto const to_inside = detail::squared_distances(padded, padded_width, padded_height, true);
+    auto const to_outside = detail::squared_distances(padded, padded_width, padded_height, false);
+    auto result = std::vector<std::uint8_t>(padded.size());
+    auto const scale = 0.5f / float(std::max(spread, 1u));
+    for (auto i = std::size_t(0); i < padded.size(); ++i) {
+        // Distances between pixel centers, less half a pixel: the edge runs between the pixels.
+        auto const distance = padded[i] >= 128 ? 0.5f - std::sqrt(to_outside[i]) : std::sqrt(to_inside[i]) - 0.5f;
+        auto const value = std::isfinite(distance) ? std::clamp(0.5f - distance * scale, 0.f, 1.f) : 0.f;
+        result[i] = static_cast<std::uint8_t>(std::lround(value * 255.f));
+    }
+    return result;
+}
+
+} // namespace distance_field
+
+/**
+ * @brief Decode the UTF-8 code point at `position` and move past it. Malformed sequences give
+ * U+FFFD, one byte at a time.
+ */
+inline char32_t decode_utf8(std::string_view text, std::size_t& position) noexcept {
+    auto const lead = static_cast<unsigned char>(text[position++]);
+    if (lead < 0x80) {
+        return lead;
+    }
+    auto const length = lead >= 0xF0 ? 3 : lead >= 0xE0 ? 2 : lead >= 0xC0 ? 1 : 0;
+    if (length == 0 || position + length > text.size() || lead >= 0xF8) {
+        return U'�';
+    }
+    auto code = char32_t(lead & (0x3F >> length));
+    for (auto i = 0; i < length; ++i) {
+        auto const next = static_cast<unsigned char>(text[position + i]);
+        if ((next & 0xC0) != 0x80) {
+            return U'�';
+        }
+        code = code << 6 | (next & 0x3F);
+    }
+    position += length;
+    return code;
+}
+
+
+/**
+ * @brief Hash for string-keyed containers that accepts std::string_view (and string literals)
+ * as well, so that lookups never build a std::string; pair it with std::equal_to<>.
+ */
+struct string_hash {
+    using is_transparent = void;
+
+    std::size_t operator ()(std::string_view text) const noexcept {
+        return std::hash<std::string_view>()(text);
+    }
+};
+
+/**
+ * @brief Interned strings: each distinct string is stored once and stands for a small ID,
+ * given in order from 0. Strings are never released, so views of them stay valid for the
+ * whole program. Thread safe; lookups of known strings only take a shared lock.
+ * @code
+ *      auto const id = gltool::string_pool::instance().intern("crate");
+ *      assert(gltool::string_pool::instance().view(id) == "crate");
+ * @endcode
+ */
+class string_pool {
+public:
+    static constexpr std::uint32_t k_none = std::numeric_limits<std::uint32_t>::max();
+
+    static string_pool& instance() {
+        static auto pool = string_pool();
+        return pool;
+    }
+
+    /**
+     * @brief The ID of a string, added to the pool if it's new.
+     */
+    std::uint32_t intern(std::string_view text) {
+        if (auto const id = this->find(text); id != k_none) {
+            return id;
+        }
+        auto lock = std::unique_lock(m_mutex);
+        auto const [it, added] = m_ids.try_emplace(std::string(text), static_cast<std::uint32_t>(m_strings.size()));
+        if (added) {
+            m_strings.push_back(it->first);
+        }
+        return it->second;
+    }
+
+    /**
+     * @brief The ID of a string, or k_none if it was never interned; never allocates.
+     */
+    std::uint32_t find(std::string_view text) const {
+        auto lock = std::shared_lock(m_mutex);
+        auto const it = m_ids.find(text);
+        return it == m_ids.end() ? k_none : it->second;
+    }
+
+    std::string_view view(std::uint32_t id) const {
+        auto lock = std::shared_lock(m_mutex);
+        return m_strings.at(id);
+    }
+
+    std::size_t size() const {
+        auto lock = std::shared_lock(m_mutex);
+        return m_strings.size();
+    }
+
+private:
+    string_pool() = default;
+
+    mutable std::shared_mutex m_mutex;
+    std::unordered_map<std::string, std::uint32_t, string_hash, std::equal_to<>> m_ids;
+    std::deque<std::string_view> m_strings;         // Views of the keys: nodes of the map are stable.
 };
 
 } // namespace gl::detail
\ No newline at end of file
@@ -0,0 +1,394 @@
+/**
+ * @file benchmark.cpp
+ * @brief Benchmarks of the hot paths of the library: mesh::render() as the meshes and their
+ * triangles grow, resource manager emplace and lookups, shader uniforms, logger throughput
+ * with and without color and in asynchronous mode, read_file() on a large file, OBJ parsing
+ * on one and on all cores, and camera updates. The GL ones run in a headless window and are skipped when no context can be made.
+ * Each benchmark is timed in batches grown until one takes a tenth of the minimum time, then
+ * repeated; the median is reported. Results go to the terminal and, with --json, to a file in
+ * the format of Google Benchmark, so its compare.py can diff two runs.
+ *
+ * Usage: benchmark [--filter <substring>] [--json <file>] [--min-time <seconds>] [--file-size <MiB>]
+ *
+ * Licensed under the MIT License. See LICENSE file in the project root for full license information.
+ */
+
+#include "../include/application.hpp"
+
+#include <iomanip>
+
+namespace {
+
+constexpr auto k_repetitions = 5;
+
+struct options {
+    std::string filter;
+    char const* json = nullptr;
+    double min_time = 0.5;
+    std::size_t file_size = 256;            // MiB
+};
+
+struct result {
+    std::string name;
+    std::uint64_t iterations = 0;
+    double ns_per_item = 0.0;
+    double items_per_second = 0.0;
+};
+
+/**
+ * @brief Runs a batch `n` times per sample; a batch processes `items` items (draws, calls,
+ * bytes, ...), which the rates are reported in.
+ */
+class harness {
+public:
+    explicit harness(options const& settings)
+        : m_settings(settings) {}
+
+    template<typename Batch>
+    void run(std::string const& name, std::uint64_t items, Batch&& batch) {
+        if (!m_settings.filter.empty() && name.find(m_settings.filter) == std::string::npos) {
+            return;
+        }
+        auto const target = m_settings.min_time / k_repetitions;
+        auto n = std::uint64_t(1);
+        auto seconds = timed(batch, n);
+        while (seconds < target && n < (std::uint64_t(1) << 40)) {
+            n = seconds <= 0.0 ? n * 10 : std::max(n + 1, static_cast<std::uint64_t>(static_cast<double>(n) * target / seconds * 1.2));
+            seconds = timed(batch, n);
+        }
+        auto samples = std::array<double, k_repetitions>();
+        for (auto& sample : samples) {
+            sample = timed(batch, n);
+        }
+        std::ranges::sort(samples);
+        auto const median = samples[k_repetitions / 2];
+        auto const total = static_cast<double>(n) * static_cast<double>(items);
+        auto const& entry = m_results.emplace_back(result{ name, n, median * 1e9 / total, total / median });
+        std::cout << std::left << std::setw(44) << entry.name << std::right << std::setw(14) << std::fixed << std::setprecision(2)
+                  << entry.ns_per_item << " ns" << std::setw(16) << std::setprecision(0) << entry.items_per_second << " /s"
+                  << std::setw(12) << entry.iterations << std::endl;
+    }
+
+    void write_json(std::ostream& out) const {
+        out << "{\n  \"context\": {\n    \"executable\": \"benchmark\",\n    \"num_cpus\": " << std::thread::hardware_concurrency()
+            << ",\n    \"library_build_type\": \"" << (gl::constants::k_debug_draw ? "debug" : "release") << "\"\n  },\n  \"benchmarks\": [";
+        for (auto i = std::size_t(0); i < m_results.size(); ++i) {
+            auto const& entry = m_results[i];
+            out << (i == 0 ? "\n" : ",\n") << "    { \"name\": \"" << entry.name << "\", \"run_type\": \"iteration\", \"iterations\": "
+                << entry.iterations << std::setprecision(3) << std::fixed << ", \"real_time\": " << entry.ns_per_item
+                << ", \"cpu_time\": " << entry.ns_per_item << ", \"time_unit\": \"ns\", \"items_per_second\": " << entry.items_per_second << " }";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+private:
+    template<typename Batch>
+    static double timed(Batch& batch, std::uint64_t n) {
+        auto const start = std::chrono::steady_clock::now();
+        batch(n);
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    options const& m_settings;
+    std::vector<result> m_results;
+};
+
+/**
+ * @brief Keep the optimizer from dropping a computation whose result is unused.
+ */
+template<typename T>
+void keep(T const& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+std::pair<std::vector<gl::f32>, std::vector<gl::u32>> grid(std::uint32_t n) {
+    auto vertices = std::vector<gl::f32>();
+    auto indices = std::vector<gl::u32>();
+    for (auto y = 0u; y <= n; ++y) {
+        for (auto x = 0u; x <= n; ++x) {
+            vertices.insert(vertices.end(), { gl::f32(x) / gl::f32(n) - 0.5f, gl::f32(y) / gl::f32(n) - 0.5f, 0.f });
+        }
+    }
+    for (auto y = 0u; y < n; ++y) {
+        for (auto x = 0u; x < n; ++x) {
+            auto const i = y * (n + 1) + x;
+            indices.insert(indices.end(), { i, i + 1, i + n + 1, i + 1, i + n + 2, i + n + 1 });
+        }
+    }
+    return { std::move(vertices), std::move(indices) };
+}
+
+constexpr char const* k_vertex_source = R"(#version 330 core
+layout(location = 0) in vec3 position;
+uniform mat4 model;
+void main() {
+    gl_Position = model * vec4(position, 1.0);
+}
+)";
+
+constexpr char const* k_fragment_source = R"(#version 330 core
+out vec4 color;
+void main() {
+    color = vec4(1.0);
+}
+)";
+
+void gl_benchmarks(harness& bench) {
+    auto win = gl::window(gl::aux::window_specification{ .title = "benchmark", .width = 256, .height = 256,
+                                                         .traits = gl::aux::window_specification::HEADLESS });
+    gl::states::glew_initialize();
+
+    auto program = gl::shader::from_sources(k_vertex_source, k_fragment_source);
+    program.bind();
+    auto const model = program.get_uniform<glm::mat4>("model");
+    auto const transform = glm::scale(glm::mat4(1.f), glm::vec3(0.01f));
+    model.set(transform);
+
+    for (auto const count : { 1u, 16u, 256u, 4096u }) {
+        auto [vertices, indices] = grid(1);
+        auto meshes = std::vector<gl::mesh>();
+        meshes.reserve(count);
+        for (auto i = 0u; i < count; ++i) {
+            meshes.emplace_back(std::span<gl::f32 const>(vertices), std::span<gl::u32 const>(indices));
+        }
+        bench.run("mesh::render/meshes:" + std::to_string(count), count, [&](std::uint64_t n) {
+            for (auto k = std::uint64_t(0); k < n; ++k) {
+                for (auto& item : meshes) {
+                    item.render();
+                }
+            }
+            gl::finish();
+        });
+    }
+    for (auto const resolution : { 1u, 32u, 256u }) {
+        auto [vertices, indices] = grid(resolution);
+        auto item = gl::mesh(std::span<gl::f32 const>(vertices), std::span<gl::u32 const>(indices));
+        bench.run("mesh::render/triangles:" + std::to_string(indices.size() / 3), 1, [&](std::uint64_t n) {
+            for (auto k = std::uint64_t(0); k < n; ++k) {
+                item.render();
+            }
+            gl::finish();
+        });
+    }
+
+    bench.run("shader::set_uniform/by_name", 1, [&](std::uint64_t n) {
+        for (auto k = std::uint64_t(0); k < n; ++k) {
+            program.set_uniform("model", glm::value_ptr(transform));
+        }
+    });
+    bench.run("shader::set_uniform/handle", 1, [&](std::uint64_t n) {
+        for (auto k = std::uint64_t(0); k < n; ++k) {
+            model.set(transform);
+        }
+    });
+
+    gl::states::resource_initialize();
+    auto& buffers = gl::states::g_resource_manager->buffers;
+    auto created = std::vector<gl::resource_handle<gl::buffer>>();
+    bench.run("resource_manager::proxy/emplace_buffer", 1, [&](std::uint64_t n) {
+        for (auto k = std::uint64_t(0); k < n; ++k) {
+            auto name = "bench-" + std::to_string(k);
+            created.push_back(buffers.emplace(name));
+        }
+        for (auto const handle : created) {
+            buffers.remove(handle);
+        }
+        created.clear();
+    });
+}
+
+void resource_benchmarks(harness& bench) {
+    gl::states::resource_initialize();
+    auto& cameras = gl::states::g_resource_manager->cameras;
+    auto const make = [&](std::string name) {
+        return cameras.emplace(name, glm::vec3(0.f), glm::vec3(0.f, 1.f, 0.f), -90.f, 0.f, 2.5f, 0.1f);
+    };
+    auto created = std::vector<gl::resource_handle<gl::camera>>();
+    bench.run("resource_manager::proxy/emplace_camera", 1, [&](std::uint64_t n) {
+        for (auto k = std::uint64_t(0); k < n; ++k) {
+            created.push_back(make("bench-" + std::to_string(k)));
+        }
+        for (auto const handle : created) {
+            cameras.remove(handle);
+        }
+        created.clear();
+    });
+    for (auto const count : { 16u, 1024u, 65536u }) {
+        auto names = std::vector<std::string>();
+        auto handles = std::vector<gl::resource_handle<gl::camera>>();
+        for (auto i = 0u; i < count; ++i) {
+            handles.push_back(make("camera-" + std::to_string(i)));
+            names.push_back(cameras.name_of(handles.back()));
+        }
+        bench.run("resource_manager::proxy/lookup_name:" + std::to_string(count), count, [&](std::uint64_t n) {
+            for (auto k = std::uint64_t(0); k < n; ++k) {
+                for (auto const& name : names) {
+                    keep(&cameras[std::string_view(name)]);
+                }
+            }
+        });
+        bench.run("resource_manager::proxy/lookup_handle:" + std::to_string(count), count, [&](std::uint64_t n) {
+            for (auto k = std::uint64_t(0); k < n; ++k) {
+                for (auto const handle : handles) {
+                    keep(&cameras[handle]);
+                }
+            }
+        });
+        for (auto const handle : handles) {
+            cameras.remove(handle);
+        }
+    }
+}
+
+void logger_benchmarks(harness& bench) {
+    auto sink = std::ostringstream();
+    auto const drain = [&] {
+        sink.str(std::string());
+        sink.clear();
+    };
+    auto plain = gltool::logger(sink);
+    bench.run("logger/plain", 1, [&](std::uint64_t n) {
+        for (auto k = std::uint64_t(0); k < n; ++k) {
+            plain() << "Frame " << k << " drew " << 1234 << " meshes in " << 1.25 << " ms" << std::endl;
+        }
+        drain();
+    });
+    bench.run("logger/colored", 1, [&](std::uint64_t n) {
+        for (auto k = std::uint64_t(0); k < n; ++k) {
+            plain() << gltool::colors::k_red("Frame ") << k << " drew " << 1234 << " meshes in " << 1.25 << " ms" << std::endl;
+        }
+        drain();
+    });
+    auto async = gltool::logger(sink);
+    async.set_async();
+    bench.run("logger/async", 1, [&](std::uint64_t n) {
+        for (auto k = std::uint64_t(0); k < n; ++k) {
+            async() << "Frame " << k << " drew " << 1234 << " meshes in " << 1.25 << " ms" << std::endl;
+        }
+        async.flush();
+        drain();
+    });
+}
+
+void file_benchmarks(harness& bench, std::size_t mebibytes) {
+    auto const path = std::filesystem::temp_directory_path() / "gltool-benchmark.bin";
+    {
+        auto out = std::ofstream(path, std::ios::binary);
+        auto const block = std::string(std::size_t(1) << 20, 'x');
+        for (auto i = std::size_t(0); i < mebibytes; ++i) {
+            out.write(block.data(), static_cast<std::streamsize>(block.size()));
+        }
+    }
+    bench.run("read_file/MiB:" + std::to_string(mebibytes), mebibytes << 20, [&](std::uint64_t n) {
+        for (auto k = std::uint64_t(0); k < n; ++k) {
+            keep(gltool::read_file(path.string().c_str()).size());
+        }
+    });
+    std::filesystem::remove(path);
+
+    // A grid of quads with positions, texture coordinates and one shared normal.
+    auto obj = std::string("vn 0 0 1\n");
+    auto const side = 512;
+    for (auto y = 0; y <= side; ++y) {
+        for (auto x = 0; x <= side; ++x) {
+            obj += "v " + std::to_string(float(x) / side) + " " + std::to_string(float(y) / side) + " 0.0\n";
+            obj += "vt " + std::to_string(float(x) / side) + " " + std::to_string(float(y) / side) + "\n";
+        }
+    }
+    for (auto y = 0; y < side; ++y) {
+        for (auto x = 0; x < side; ++x) {
+            auto const i = std::to_string(y * (side + 1) + x + 1), j = std::to_string(y * (side + 1) + x + 2);
+            auto const k = std::to_string((y + 1) * (side + 1) + x + 2), l = std::to_string((y + 1) * (side + 1) + x + 1);
+            obj += "f " + i + "/" + i + "/1 " + j + "/" + j + "/1 " + k + "/" + k + "/1 " + l + "/" + l + "/1\n";
+        }
+    }
+    bench.run("text_mesh::parse_obj/serial", obj.size(), [&](std::uint64_t n) {
+        for (auto k = std::uint64_t(0); k < n; ++k) {
+            keep(gltool::text_mesh::parse_obj(obj).indices.size());
+        }
+    });
+    auto jobs = gltool::job_system();
+    bench.run("text_mesh::parse_obj/parallel", obj.size(), [&](std::uint64_t n) {
+        for (auto k = std::uint64_t(0); k < n; ++k) {
+            keep(gltool::text_mesh::parse_obj(obj, &jobs).indices.size());
+        }
+    });
+}
+
+void camera_benchmarks(harness& bench) {
+    auto view = gl::camera(glm::vec3(0.f, 0.f, 3.f), glm::vec3(0.f, 1.f, 0.f), -90.f, 0.f, 2.5f, 0.1f);
+    view.set_perspective(45.f, 16.f / 9.f, 0.1f, 100.f);
+    auto keys = std::array<bool, GLFW_KEY_LAST + 1>{};
+    keys[gl::constants::k_front_key] = true;
+    bench.run("camera/update", 1, [&](std::uint64_t n) {
+        for (auto k = std::uint64_t(0); k < n; ++k) {
+            view.update();
+            keep(view.get_view_matrix());
+        }
+    });
+    bench.run("camera/move_and_turn", 1, [&](std::uint64_t n) {
+        for (auto k = std::uint64_t(0); k < n; ++k) {
+            view.on_key_pressed(keys, 0.016f);
+            view.on_mouse_moved(k % 2 == 0 ? 1.f : -1.f, 0.5f);
+            keep(view.get_view_projection_matrix());
+        }
+    });
+}
+
+options parse_options(int argc, char** argv) {
+    auto result = options();
+    for (auto i = 1; i < argc; ++i) {
+        auto const arg = std::string_view(argv[i]);
+        if (arg == "--filter" && i + 1 < argc) {
+            result.filter = argv[++i];
+        }
+        else if (arg == "--json" && i + 1 < argc) {
+            result.json = argv[++i];
+        }
+        else if (arg == "--min-time" && i + 1 < argc) {
+            result.min_time = std::stod(argv[++i]);
+        }
+        else if (arg == "--file-size" && i + 1 < argc) {
+            result.file_size = std::max<std::size_t>(1, std::stoul(argv[++i]));
+        }
+        else {
+            throw std::runtime_error("Usage: benchmark [--filter <substring>] [--json <file>] [--min-time <seconds>] [--file-size <MiB>]");
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        auto const settings = parse_options(argc, argv);
+        auto bench = harness(settings);
+        gl::LOG.set_level(gltool::log_tag::WARNING);
+        std::cout << std::left << std::setw(44) << "benchmark" << std::right << std::setw(17) << "time/item" << std::setw(18)
+                  << "items/s" << std::setw(12) << "iterations" << std::endl;
+        try {
+            gl_benchmarks(bench);
+        }
+        catch (...) {
+            std::cerr << "No headless GL context: skipped the GL benchmarks" << std::endl;
+        }
+        resource_benchmarks(bench);
+        logger_benchmarks(bench);
+        file_benchmarks(bench, settings.file_size);
+        camera_benchmarks(bench);
+
+        if (settings.json != nullptr) {
+            auto out = std::ofstream(settings.json);
+            if (!out.is_open()) {
+                throw std::runtime_error("Could not open file: " + std::string(settings.json));
+            }
+            bench.write_json(out);
+        }
+    }
+    catch (std::exception const& error) {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,28 @@
+/**
+ * @file log_decode.cpp
+ * @brief Offline decoder for the binary log format of gltool::logger (see gltool::binlog).
+ * Prints the decoded, colored log to the standard output.
+ *
+ * Usage: log_decode <binary-log-file>
+ *
+ * Licensed under the MIT License. See LICENSE file in the project root for full license information.
+ */
+
+#include "../include/log.hpp"
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <binary-log-file>" << std::endl;
+        return 1;
+    }
+    auto in = std::ifstream(argv[1], std::ios::binary);
+    if (!in.is_open()) {
+        std::cerr << gltool::colors::k_red("Could not open file: " + std::string(argv[1])) << std::endl;
+        return 1;
+    }
+    if (!gltool::binlog::decode(in, std::cout)) {
+        std::cerr << gltool::colors::k_red("Not a binary log, or the log is truncated.") << std::endl;
+        return 2;
+    }
+    return 0;
+}
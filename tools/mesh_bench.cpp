@@ -0,0 +1,105 @@
+/**
+ * @file mesh_bench.cpp
+ * @brief Benchmark of gltool::mesh_optimizer on generated meshes (a grid and a UV sphere) with
+ * their triangles shuffled, as meshes exported without care usually are. Prints the ACMR and
+ * ATVR of a FIFO cache before and after each pass, and the time the passes took.
+ *
+ * Usage: mesh_bench [resolution] [cache-size]
+ *
+ * Licensed under the MIT License. See LICENSE file in the project root for full license information.
+ */
+
+#include "../include/utility.hpp"
+
+#include <iomanip>
+#include <numbers>
+#include <random>
+
+namespace {
+
+struct test_mesh {
+    std::string name;
+    std::vector<float> vertices;
+    std::vector<std::uint32_t> indices;
+};
+
+test_mesh grid(std::uint32_t n) {
+    auto result = test_mesh{ "grid", {}, {} };
+    for (auto y = 0u; y <= n; ++y) {
+        for (auto x = 0u; x <= n; ++x) {
+            result.vertices.insert(result.vertices.end(), { float(x) / float(n), float(y) / float(n), 0.0f });
+        }
+    }
+    for (auto y = 0u; y < n; ++y) {
+        for (auto x = 0u; x < n; ++x) {
+            auto const i = y * (n + 1) + x;
+            result.indices.insert(result.indices.end(), { i, i + 1, i + n + 1, i + 1, i + n + 2, i + n + 1 });
+        }
+    }
+    return result;
+}
+
+test_mesh sphere(std::uint32_t n) {
+    auto result = test_mesh{ "sphere", {}, {} };
+    for (auto y = 0u; y <= n; ++y) {
+        auto const theta = std::numbers::pi_v<float> * float(y) / float(n);
+        for (auto x = 0u; x <= 2 * n; ++x) {
+            auto const phi = std::numbers::pi_v<float> * float(x) / float(n);
+            result.vertices.insert(result.vertices.end(),
+                { std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi) });
+        }
+    }
+    for (auto y = 0u; y < n; ++y) {
+        for (auto x = 0u; x < 2 * n; ++x) {
+            auto const i = y * (2 * n + 1) + x;
+            result.indices.insert(result.indices.end(), { i, i + 2 * n + 1, i + 1, i + 1, i + 2 * n + 1, i + 2 * n + 2 });
+        }
+    }
+    return result;
+}
+
+void shuffle_triangles(std::vector<std::uint32_t>& indices) {
+    auto triangles = std::vector<std::array<std::uint32_t, 3>>(indices.size() / 3);
+    std::memcpy(triangles.data(), indices.data(), indices.size() * sizeof(std::uint32_t));
+    std::ranges::shuffle(triangles, std::mt19937(42));
+    std::memcpy(indices.data(), triangles.data(), indices.size() * sizeof(std::uint32_t));
+}
+
+void report(char const* step, test_mesh const& mesh, std::uint32_t cache_size, double ms) {
+    auto const stats = gltool::mesh_optimizer::analyze_vertex_cache(mesh.indices, mesh.vertices.size() / 3, cache_size);
+    std::cout << "  " << std::left << std::setw(14) << step << std::right << std::fixed << std::setprecision(3)
+              << "ACMR " << stats.acmr << "  ATVR " << stats.atvr;
+    if (ms >= 0.0) {
+        std::cout << "  (" << std::setprecision(2) << ms << " ms)";
+    }
+    std::cout << std::endl;
+}
+
+template<typename F>
+double timed(F&& f) {
+    auto const start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    namespace opt = gltool::mesh_optimizer;
+    auto const resolution = argc > 1 ? std::uint32_t(std::stoul(argv[1])) : 256u;
+    auto const cache_size = argc > 2 ? std::uint32_t(std::stoul(argv[2])) : opt::k_cache_size;
+
+    for (auto mesh : { grid(resolution), sphere(resolution) }) {
+        shuffle_triangles(mesh.indices);
+        auto const vertex_ct = mesh.vertices.size() / 3;
+        std::cout << mesh.name << ": " << vertex_ct << " vertices, " << mesh.indices.size() / 3 << " triangles, cache of "
+                  << cache_size << std::endl;
+        report("shuffled", mesh, cache_size, -1.0);
+        report("vertex cache", mesh, cache_size, timed([&] { opt::optimize_vertex_cache(mesh.indices, vertex_ct, cache_size); }));
+        report("overdraw", mesh, cache_size, timed([&] { opt::optimize_overdraw(mesh.indices, mesh.vertices, 3, 1.05f, cache_size); }));
+        report("vertex fetch", mesh, cache_size, timed([&] {
+            opt::optimize_vertex_fetch(std::as_writable_bytes(std::span(mesh.vertices)), 3 * sizeof(float), mesh.indices);
+        }));
+    }
+    return 0;
+}
@@ -0,0 +1,141 @@
+/**
+ * @file mesh_convert.cpp
+ * @brief Offline converter from Wavefront OBJ or PLY to the binary mesh asset format of
+ * gltool::mesh_asset, loaded at run time by gl::mesh::from_file() without any parsing.
+ * The input is read by gltool::text_mesh on all cores. Positions, normals and texture
+ * coordinates (the ones the file has) are interleaved as floats at locations 0, 1 and 2;
+ * polygons are triangulated as fans. The mesh is optimized
+ * with gltool::mesh_optimizer, and levels of detail and meshlets are built on request. With
+ * --quantize the vertices are packed by gltool::vertex_quantization instead (16-bit positions
+ * in the bounds, octahedral normals, half float texture coordinates).
+ *
+ * Usage: mesh_convert <input.obj|input.ply> <output.mesh> [--lods <count>] [--meshlets] [--no-optimize] [--quantize]
+ *
+ * Licensed under the MIT License. See LICENSE file in the project root for full license information.
+ */
+
+#include "../include/utility.hpp"
+
+namespace {
+
+constexpr std::uint32_t k_gl_float = 0x1406;       // GL_FLOAT, without pulling in a GL loader.
+
+struct options {
+    char const* input = nullptr;
+    char const* output = nullptr;
+    std::uint32_t lod_ct = 1;
+    bool meshlets = false;
+    bool optimize = true;
+    bool quantize = false;
+};
+
+options parse_options(int argc, char** argv) {
+    auto result = options();
+    for (auto i = 1; i < argc; ++i) {
+        auto const arg = std::string_view(argv[i]);
+        if (arg == "--lods" && i + 1 < argc) {
+            result.lod_ct = std::max(1u, std::uint32_t(std::stoul(argv[++i])));
+        }
+        else if (arg == "--meshlets") {
+            result.meshlets = true;
+        }
+        else if (arg == "--no-optimize") {
+            result.optimize = false;
+        }
+        else if (arg == "--quantize") {
+            result.quantize = true;
+        }
+        else if (result.input == nullptr) {
+            result.input = argv[i];
+        }
+        else if (result.output == nullptr) {
+            result.output = argv[i];
+        }
+        else {
+            throw std::runtime_error("Unexpected argument: " + std::string(arg));
+        }
+    }
+    if (result.output == nullptr) {
+        throw std::runtime_error("Usage: mesh_convert <input.obj|input.ply> <output.mesh> [--lods <count>] [--meshlets] [--no-optimize] [--quantize]");
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    namespace opt = gltool::mesh_optimizer;
+    try {
+        auto const settings = parse_options(argc, argv);
+        auto jobs = gltool::job_system();
+        auto mesh = gltool::text_mesh::load(settings.input, &jobs);
+        auto const components = mesh.components;
+        if (settings.optimize) {
+            opt::optimize(mesh.vertices, components, mesh.indices);
+        }
+
+        auto asset = gltool::mesh_asset::source();
+        asset.stride = static_cast<std::uint32_t>(components * sizeof(float));
+        asset.attributes.push_back({ 0, 3, k_gl_float, gltool::mesh_asset::attribute::NONE, 0 });
+        if (mesh.has_normals) {
+            asset.attributes.push_back({ 1, 3, k_gl_float, gltool::mesh_asset::attribute::NONE, 3 * sizeof(float) });
+        }
+        if (mesh.has_uvs) {
+            asset.attributes.push_back({ 2, 2, k_gl_float, gltool::mesh_asset::attribute::NONE,
+                                         std::uint32_t((mesh.has_normals ? 6 : 3) * sizeof(float)) });
+        }
+
+        // Levels of detail go after the full index list, each half the triangles of the last.
+        auto indices = mesh.indices;
+        asset.lods.push_back({ 0, static_cast<std::uint32_t>(indices.size()), 0.f });
+        auto level = mesh.indices;
+        while (asset.lods.size() < settings.lod_ct) {
+            auto error = 0.f;
+            auto next = opt::simplify(level, mesh.vertices, components, level.size() / 6 * 3, std::numeric_limits<float>::max(), &error);
+            if (next.empty() || next.size() >= level.size()) {
+                break;
+            }
+            asset.lods.push_back({ static_cast<std::uint32_t>(indices.size()), static_cast<std::uint32_t>(next.size()),
+                                   std::max(asset.lods.back().error, error) });
+            indices.insert(indices.end(), next.begin(), next.end());
+            level = std::move(next);
+        }
+        if (settings.meshlets) {
+            asset.meshlets = opt::build_meshlets(mesh.indices, mesh.vertices, components);
+        }
+
+        asset.min = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+        asset.max = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+        for (auto v = std::size_t(0); v < mesh.vertices.size(); v += components) {
+            for (auto k = 0; k < 3; ++k) {
+                asset.min[k] = std::min(asset.min[k], mesh.vertices[v + k]);
+                asset.max[k] = std::max(asset.max[k], mesh.vertices[v + k]);
+            }
+        }
+        asset.vertices = std::as_bytes(std::span(mesh.vertices));
+        asset.indices = indices;
+        auto packed = gltool::vertex_quantization::result();
+        if (settings.quantize) {
+            auto channels = gltool::vertex_quantization::channels();
+            channels.normal = mesh.has_normals ? 3 : gltool::vertex_quantization::k_none;
+            channels.uv = mesh.has_uvs ? (mesh.has_normals ? 6 : 3) : gltool::vertex_quantization::k_none;
+            packed = gltool::vertex_quantization::quantize(mesh.vertices, components, channels, asset.min, asset.max);
+            asset.stride = packed.stride;
+            asset.attributes = packed.attributes;
+            asset.vertices = packed.vertices;
+        }
+
+        auto out = std::ofstream(settings.output, std::ios::binary);
+        if (!out.is_open()) {
+            throw std::runtime_error("Could not open file: " + std::string(settings.output));
+        }
+        gltool::mesh_asset::write(out, asset);
+        std::cout << settings.input << ": " << mesh.vertices.size() / components << " vertices, " << mesh.indices.size() / 3
+                  << " triangles, " << asset.lods.size() << " levels of detail, " << asset.meshlets.size() << " meshlets" << std::endl;
+    }
+    catch (std::exception const& error) {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
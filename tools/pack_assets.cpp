@@ -0,0 +1,107 @@
+/**
+ * @file pack_assets.cpp
+ * @brief Packs a directory of assets into one archive of the gltool::asset_archive format,
+ * mounted at run time with gltool::vfs::mount() so the files are read from a single mapping.
+ * Files are stored under their path relative to the directory; with --lz4 they are compressed
+ * wherever that saves space, except the formats read in place (meshes, textures) unless
+ * --lz4-all is given.
+ *
+ * Usage: pack_assets <directory> <output.pak> [--lz4] [--lz4-all]
+ *
+ * Licensed under the MIT License. See LICENSE file in the project root for full license information.
+ */
+
+#include "../include/utility.hpp"
+
+namespace {
+
+struct options {
+    char const* input = nullptr;
+    char const* output = nullptr;
+    bool compress = false;
+    bool compress_all = false;
+};
+
+/**
+ * @brief Whether a file is mapped and used where it lies (compressing it would cost a copy).
+ */
+bool read_in_place(std::filesystem::path const& path) {
+    auto const extension = path.extension().string();
+    return extension == ".mesh" || extension == ".ktx2" || extension == ".dds";
+}
+
+options parse_options(int argc, char** argv) {
+    auto result = options();
+    for (auto i = 1; i < argc; ++i) {
+        auto const arg = std::string_view(argv[i]);
+        if (arg == "--lz4") {
+            result.compress = true;
+        }
+        else if (arg == "--lz4-all") {
+            result.compress = result.compress_all = true;
+        }
+        else if (result.input == nullptr) {
+            result.input = argv[i];
+        }
+        else if (result.output == nullptr) {
+            result.output = argv[i];
+        }
+        else {
+            throw std::runtime_error("Unexpected argument: " + std::string(arg));
+        }
+    }
+    if (result.output == nullptr) {
+        throw std::runtime_error("Usage: pack_assets <directory> <output.pak> [--lz4] [--lz4-all]");
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        auto const settings = parse_options(argc, argv);
+        auto const root = std::filesystem::path(settings.input);
+        auto paths = std::vector<std::filesystem::path>();
+        for (auto const& item : std::filesystem::recursive_directory_iterator(root)) {
+            if (item.is_regular_file()) {
+                paths.push_back(item.path());
+            }
+        }
+        std::ranges::sort(paths);
+
+        auto files = std::vector<gltool::mapped_file>();
+        auto sources = std::vector<gltool::asset_archive::source>();
+        files.reserve(paths.size());
+        for (auto const& path : paths) {
+            auto const& file = files.emplace_back(path.string().c_str());
+            sources.push_back({ std::filesystem::relative(path, root).generic_string(),
+                                std::as_bytes(std::span(file.data(), file.size())),
+                                settings.compress && (settings.compress_all || !read_in_place(path)) });
+        }
+
+        auto out = std::ofstream(settings.output, std::ios::binary);
+        if (!out.is_open()) {
+            throw std::runtime_error("Could not open file: " + std::string(settings.output));
+        }
+        gltool::asset_archive::write(out, sources);
+        out.close();
+
+        auto const packed = gltool::asset_archive::archive::open(settings.output);
+        auto size = std::uint64_t(0);
+        auto stored = std::uint64_t(0);
+        auto compressed = std::size_t(0);
+        for (auto const& item : packed->entries()) {
+            size += item.size;
+            stored += item.stored_size;
+            compressed += item.compression != gltool::asset_archive::compression::NONE;
+        }
+        std::cout << settings.output << ": " << packed->entries().size() << " files (" << compressed << " compressed), "
+                  << size << " bytes stored in " << stored << std::endl;
+    }
+    catch (std::exception const& error) {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,142 @@
+/**
+ * @file point_convert.cpp
+ * @brief Offline builder of the point cloud octrees of gltool::point_cloud, streamed at run
+ * time by gl::point_cloud. The input is text with a point per line, "x y z" optionally
+ * followed by "r g b" in [0, 255] (the .xyz and .pts exports of scanning software; lines that
+ * do not start with three numbers, such as a point count, are skipped). The origin of the
+ * cloud is the corner of its bounds rounded down to whole units, so the float positions stay
+ * precise however far from zero the coordinates are. The points are held in memory while the
+ * octree is built, about 70 bytes each.
+ *
+ * Usage: point_convert <input.xyz> <output.pcloud> [--node-points <count>] [--grid <cells>]
+ *
+ * Licensed under the MIT License. See LICENSE file in the project root for full license information.
+ */
+
+#include "../include/utility.hpp"
+
+namespace {
+
+struct options {
+    char const* input = nullptr;
+    char const* output = nullptr;
+    std::uint32_t node_points = 20000;
+    std::uint32_t grid = 128;
+};
+
+options parse_options(int argc, char** argv) {
+    auto result = options();
+    for (auto i = 1; i < argc; ++i) {
+        auto const arg = std::string_view(argv[i]);
+        if (arg == "--node-points" && i + 1 < argc) {
+            result.node_points = std::max(1u, std::uint32_t(std::stoul(argv[++i])));
+        }
+        else if (arg == "--grid" && i + 1 < argc) {
+            result.grid = std::max(1u, std::uint32_t(std::stoul(argv[++i])));
+        }
+        else if (result.input == nullptr) {
+            result.input = argv[i];
+        }
+        else if (result.output == nullptr) {
+            result.output = argv[i];
+        }
+        else {
+            throw std::runtime_error("Unexpected argument: " + std::string(arg));
+        }
+    }
+    if (result.output == nullptr) {
+        throw std::runtime_error("Usage: point_convert <input.xyz> <output.pcloud> [--node-points <count>] [--grid <cells>]");
+    }
+    return result;
+}
+
+struct source_point {
+    std::array<double, 3> position;
+    std::array<std::uint8_t, 4> color;
+};
+
+/**
+ * @brief The numbers at the start of a line, up to `values.size()`; returns how many were read.
+ */
+std::size_t read_numbers(char const* first, char const* last, std::span<double> values) {
+    auto count = std::size_t(0);
+    while (count < values.size()) {
+        while (first != last && (*first == ' ' || *first == '\t' || *first == ',' || *first == ';')) {
+            ++first;
+        }
+        auto const [end, error] = std::from_chars(first, last, values[count]);
+        if (error != std::errc()) {
+            break;
+        }
+        first = end;
+        ++count;
+    }
+    return count;
+}
+
+std::vector<source_point> read_points(char const* path) {
+    auto const file = gltool::mapped_file(path);
+    auto const* cursor = file.data();
+    auto const* const end = file.data() + file.size();
+    auto result = std::vector<source_point>();
+    auto values = std::array<double, 6>();
+    while (cursor < end) {
+        auto const* const line_end = std::find(cursor, end, '\n');
+        auto const count = read_numbers(cursor, line_end, values);
+        if (count >= 3) {
+            auto point = source_point{ { values[0], values[1], values[2] }, { 255, 255, 255, 255 } };
+            if (count >= 6) {
+                for (auto k = 0; k < 3; ++k) {
+                    point.color[k] = static_cast<std::uint8_t>(std::clamp(values[3 + k], 0.0, 255.0));
+                }
+            }
+            result.push_back(point);
+        }
+        cursor = line_end + (line_end < end ? 1 : 0);
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    namespace pc = gltool::point_cloud;
+    try {
+        auto const settings = parse_options(argc, argv);
+        auto const source = read_points(settings.input);
+        if (source.empty()) {
+            throw std::runtime_error("No points in " + std::string(settings.input));
+        }
+        auto origin = source.front().position;
+        for (auto const& p : source) {
+            for (auto k = 0; k < 3; ++k) {
+                origin[k] = std::min(origin[k], p.position[k]);
+            }
+        }
+        for (auto& value : origin) {
+            value = std::floor(value);
+        }
+        auto points = std::vector<pc::point>(source.size());
+        for (auto i = std::size_t(0); i < source.size(); ++i) {
+            for (auto k = 0; k < 3; ++k) {
+                points[i].position[k] = static_cast<float>(source[i].position[k] - origin[k]);
+                points[i].color[k] = source[i].color[k];
+            }
+            points[i].color[3] = 255;
+        }
+
+        auto const octree = pc::build(points, settings.node_points, settings.grid);
+        auto out = std::ofstream(settings.output, std::ios::binary);
+        if (!out.is_open()) {
+            throw std::runtime_error("Could not open file: " + std::string(settings.output));
+        }
+        pc::write(out, octree, origin);
+        std::cout << settings.input << ": " << points.size() << " points in " << octree.nodes.size() << " nodes of at most "
+                  << settings.node_points << " points" << std::endl;
+    }
+    catch (std::exception const& error) {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
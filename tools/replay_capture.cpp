@@ -0,0 +1,904 @@
+/**
+ * @file replay_capture.cpp
+ * @brief Replays a recording of gl::call_capture (see window::capture_calls()) in a hidden
+ * window, without the application: all the frames but the last once, to make the objects and
+ * state, then the last frame in a loop, timing every call on the CPU and the frame on the GPU.
+ * Object names are mapped to the ones made here; the data each frame wrote to mapped memory
+ * is uploaded at the start of the frame it was written in. Reports the frame times and, with
+ * --calls, the time by call, the slowest first; with --json, both to a file, to compare
+ * drivers, or a change, on the very same workload.
+ *
+ * Usage: replay_capture <capture> [--loops <count>] [--size <width>x<height>] [--calls] [--json <file>]
+ *
+ * Licensed under the MIT License. See LICENSE file in the project root for full license information.
+ */
+
+#define M_GLFW_CONTEXT_MAJOR_VERSION 4
+#define M_GLFW_CONTEXT_MINOR_VERSION 5
+
+#include "../include/application.hpp"
+
+#include <chrono>
+#include <iomanip>
+
+namespace {
+
+using call = gl::call_capture::call;
+
+struct options {
+    char const* input = nullptr;
+    char const* json = nullptr;
+    gl::u32 loops = 100;
+    gl::i32 width = 1280;
+    gl::i32 height = 720;
+    bool calls = false;
+};
+
+struct record {
+    call::type                 id;
+    std::span<std::byte const> args;
+};
+
+/**
+ * @brief The arguments of a record, read in the order the wrapper wrote them.
+ */
+class reader {
+public:
+    explicit reader(std::span<std::byte const> args) noexcept
+        : m_args(args) {}
+
+    template<typename T>
+    T get() {
+        auto value = T();
+        std::memcpy(&value, this->take(sizeof(T)).data(), sizeof(T));
+        return value;
+    }
+
+    std::span<std::byte const> bytes() {
+        return this->take(this->get<std::uint32_t>());
+    }
+
+    /**
+     * @brief The elements of an array argument of a multi-bind, none for a null array.
+     */
+    template<typename T>
+    std::vector<T> values() {
+        auto const data = this->bytes();
+        auto result = std::vector<T>(data.size() / sizeof(T));
+        std::memcpy(result.data(), data.data(), result.size() * sizeof(T));
+        return result;
+    }
+
+    template<typename T>
+    T const* array() {
+        return reinterpret_cast<T const*>(this->bytes().data());
+    }
+
+    /**
+     * @brief An offset into a bound buffer, or the recorded client memory (null if none).
+     */
+    void const* pointer() {
+        if (this->get<std::uint8_t>() != 0) {
+            return reinterpret_cast<void const*>(static_cast<std::intptr_t>(this->get<std::int64_t>()));
+        }
+        auto const data = this->bytes();
+        return data.empty() ? nullptr : data.data();
+    }
+
+private:
+    std::span<std::byte const> take(std::size_t size) {
+        if (m_at + size > m_args.size()) {
+            throw std::runtime_error("Truncated capture record");
+        }
+        auto const result = m_args.subspan(m_at, size);
+        m_at += size;
+        return result;
+    }
+
+    std::span<std::byte const> m_args;
+    std::size_t                m_at = 0;
+};
+
+/**
+ * @brief The names of the recording mapped to those made by the replay, per kind of object.
+ */
+class name_map {
+public:
+    struct kind {
+        enum type : gl::u32 {
+            BUFFER, TEXTURE, VERTEX_ARRAY, FRAMEBUFFER, RENDERBUFFER, SAMPLER, PROGRAM, SHADER, PIPELINE, COUNT
+        };
+    };
+
+    /**
+     * @brief The replay's name, 0 for 0 and for names made before the recording started.
+     */
+    gl::u32 operator ()(kind::type type, gl::u32 recorded) const {
+        auto const found = m_names[type].find(recorded);
+        return found == m_names[type].end() ? 0 : found->second;
+    }
+
+    void add(kind::type type, gl::u32 recorded, gl::u32 replayed) {
+        m_names[type][recorded] = replayed;
+    }
+
+    void add(kind::type type, gl::s32 count, gl::u32 const* recorded, gl::u32 const* replayed) {
+        for (auto i = 0; i < count; ++i) {
+            this->add(type, recorded[i], replayed[i]);
+        }
+    }
+
+    /**
+     * @brief Map and forget names about to be deleted.
+     */
+    std::vector<gl::u32> remove(kind::type type, gl::s32 count, gl::u32 const* recorded) {
+        auto result = std::vector<gl::u32>(static_cast<std::size_t>(count));
+        for (auto i = 0; i < count; ++i) {
+            result[i] = (*this)(type, recorded[i]);
+            m_names[type].erase(recorded[i]);
+        }
+        return result;
+    }
+
+private:
+    std::array<std::unordered_map<gl::u32, gl::u32>, kind::COUNT> m_names;
+};
+
+using kind = name_map::kind;
+
+/**
+ * @brief Make objects as glGen* or glCreate* did, and map the recorded names to them.
+ */
+template<typename F>
+void make(name_map& names, kind::type type, reader& in, F&& generate) {
+    auto const count = in.get<gl::s32>();
+    auto const* recorded = in.array<gl::u32>();
+    auto made = std::vector<gl::u32>(static_cast<std::size_t>(count));
+    generate(count, made.data());
+    names.add(type, count, recorded, made.data());
+}
+
+template<typename F>
+void remove(name_map& names, kind::type type, reader& in, F&& destroy) {
+    auto const count = in.get<gl::s32>();
+    auto const replayed = names.remove(type, count, in.array<gl::u32>());
+    destroy(count, replayed.data());
+}
+
+/**
+ * @brief Issue one recorded call.
+ */
+void replay(record const& r, name_map& names) {
+    auto in = reader(r.args);
+    auto const u32 = [&] { return in.get<gl::u32>(); };
+    auto const i32 = [&] { return in.get<gl::i32>(); };
+    auto const s32 = [&] { return in.get<gl::s32>(); };
+    auto const e32 = [&] { return in.get<gl::e32>(); };
+    auto const f32 = [&] { return in.get<gl::f32>(); };
+    auto const i64 = [&] { return static_cast<std::intptr_t>(in.get<std::int64_t>()); };
+    auto const b8 = [&] { return in.get<gl::b8>(); };
+    auto const b32 = [&] { return in.get<gl::b32>(); };
+    auto const name = [&](kind::type type) { return names(type, in.get<gl::u32>()); };
+    auto const objects = [&](kind::type type) {
+        auto result = in.values<gl::u32>();
+        for (auto& object : result) {
+            object = names(type, object);
+        }
+        return result;
+    };
+    auto const data = [](auto const& values) { return values.empty() ? nullptr : values.data(); };
+
+    // Arguments are read into locals first: the order of evaluation of call arguments is unspecified.
+    switch (r.id) {
+    case call::ACTIVE_SHADER_PROGRAM: { auto const p = name(kind::PIPELINE); glActiveShaderProgram(p, name(kind::PROGRAM)); break; }
+    case call::ACTIVE_TEXTURE: glActiveTexture(e32()); break;
+    case call::ATTACH_SHADER: { auto const p = name(kind::PROGRAM); glAttachShader(p, name(kind::SHADER)); break; }
+    case call::BIND_BUFFER: { auto const t = e32(); glBindBuffer(t, name(kind::BUFFER)); break; }
+    case call::BIND_BUFFER_BASE: { auto const t = e32(); auto const i = u32(); glBindBufferBase(t, i, name(kind::BUFFER)); break; }
+    case call::BIND_BUFFER_RANGE: {
+        auto const t = e32(); auto const i = u32(); auto const b = name(kind::BUFFER); auto const o = i64();
+        glBindBufferRange(t, i, b, o, i64());
+        break;
+    }
+    case call::BIND_BUFFERS_BASE: {
+        auto const t = e32(); auto const first = u32(); auto const count = s32();
+        glBindBuffersBase(t, first, count, data(objects(kind::BUFFER)));
+        break;
+    }
+    case call::BIND_BUFFERS_RANGE: {
+        auto const t = e32(); auto const first = u32(); auto const count = s32(); auto const buffers = objects(kind::BUFFER);
+        auto const offsets = in.values<std::intptr_t>();
+        auto const sizes = in.values<std::intptr_t>();
+        glBindBuffersRange(t, first, count, data(buffers), data(offsets), data(sizes));
+        break;
+    }
+    case call::BIND_FRAMEBUFFER: { auto const t = e32(); glBindFramebuffer(t, name(kind::FRAMEBUFFER)); break; }
+    case call::BIND_IMAGE_TEXTURE: {
+        auto const unit = u32(); auto const t = name(kind::TEXTURE); auto const level = i32(); auto const layered = b8();
+        auto const layer = i32(); auto const access = e32();
+        glBindImageTexture(unit, t, level, layered, layer, access, e32());
+        break;
+    }
+    case call::BIND_PROGRAM_PIPELINE: glBindProgramPipeline(name(kind::PIPELINE)); break;
+    case call::BIND_RENDERBUFFER: { auto const t = e32(); glBindRenderbuffer(t, name(kind::RENDERBUFFER)); break; }
+    case call::BIND_SAMPLER: { auto const unit = u32(); glBindSampler(unit, name(kind::SAMPLER)); break; }
+    case call::BIND_SAMPLERS: { auto const first = u32(); auto const count = s32(); glBindSamplers(first, count, data(objects(kind::SAMPLER))); break; }
+    case call::BIND_TEXTURE: { auto const t = e32(); glBindTexture(t, name(kind::TEXTURE)); break; }
+    case call::BIND_TEXTURE_UNIT: { auto const unit = u32(); glBindTextureUnit(unit, name(kind::TEXTURE)); break; }
+    case call::BIND_TEXTURES: { auto const first = u32(); auto const count = s32(); glBindTextures(first, count, data(objects(kind::TEXTURE))); break; }
+    case call::BIND_VERTEX_ARRAY: glBindVertexArray(name(kind::VERTEX_ARRAY)); break;
+    case call::BIND_VERTEX_BUFFERS:
+    case call::VERTEX_ARRAY_VERTEX_BUFFERS: {
+        auto const named = r.id == call::VERTEX_ARRAY_VERTEX_BUFFERS;
+        auto const vao = named ? name(kind::VERTEX_ARRAY) : 0;
+        auto const first = u32(); auto const count = s32(); auto const buffers = objects(kind::BUFFER);
+        auto const offsets = in.values<std::intptr_t>();
+        auto const strides = in.values<gl::s32>();
+        if (named) {
+            glVertexArrayVertexBuffers(vao, first, count, data(buffers), data(offsets), data(strides));
+        }
+        else {
+            glBindVertexBuffers(first, count, data(buffers), data(offsets), data(strides));
+        }
+        break;
+    }
+    case call::BLEND_EQUATION_SEPARATE: { auto const rgb = e32(); glBlendEquationSeparate(rgb, e32()); break; }
+    case call::BLEND_FUNC: { auto const source = e32(); glBlendFunc(source, e32()); break; }
+    case call::BLEND_FUNC_I: { auto const buffer = u32(); auto const source = e32(); glBlendFunci(buffer, source, e32()); break; }
+    case call::BLEND_FUNC_SEPARATE: {
+        auto const source_rgb = e32(); auto const destination_rgb = e32(); auto const source_alpha = e32();
+        glBlendFuncSeparate(source_rgb, destination_rgb, source_alpha, e32());
+        break;
+    }
+    case call::BLIT_FRAMEBUFFER:
+    case call::BLIT_NAMED_FRAMEBUFFER: {
+        auto const named = r.id == call::BLIT_NAMED_FRAMEBUFFER;
+        auto const read = named ? name(kind::FRAMEBUFFER) : 0;
+        auto const draw = named ? name(kind::FRAMEBUFFER) : 0;
+        auto rect = std::array<gl::i32, 8>();
+        for (auto& value : rect) {
+            value = i32();
+        }
+        auto const mask = b32();
+        auto const filter = e32();
+        if (named) {
+            glBlitNamedFramebuffer(read, draw, rect[0], rect[1], rect[2], rect[3], rect[4], rect[5], rect[6], rect[7], mask, filter);
+        }
+        else {
+            glBlitFramebuffer(rect[0], rect[1], rect[2], rect[3], rect[4], rect[5], rect[6], rect[7], mask, filter);
+        }
+        break;
+    }
+    case call::BUFFER_DATA: { auto const t = e32(); auto const size = i64(); auto const* data = in.pointer(); glBufferData(t, size, data, e32()); break; }
+    case call::BUFFER_STORAGE: {
+        // Dynamic, so that the writes recorded through mappings can be uploaded.
+        auto const t = e32(); auto const size = i64(); auto const* data = in.pointer();
+        glBufferStorage(t, size, data, b32() | GL_DYNAMIC_STORAGE_BIT);
+        break;
+    }
+    case call::BUFFER_SUB_DATA: { auto const t = e32(); auto const offset = i64(); auto const size = i64(); glBufferSubData(t, offset, size, in.pointer()); break; }
+    case call::CLEAR: glClear(b32()); break;
+    case call::CLEAR_BUFFER_FI: { auto const b = e32(); auto const d = i32(); auto const depth = f32(); glClearBufferfi(b, d, depth, i32()); break; }
+    case call::CLEAR_BUFFER_FV: { auto const b = e32(); auto const d = i32(); glClearBufferfv(b, d, in.array<gl::f32>()); break; }
+    case call::CLEAR_BUFFER_SUB_DATA: {
+        auto const t = e32(); auto const internal = e32(); auto const offset = i64(); auto const size = i64(); auto const format = e32(); auto const type = e32();
+        glClearBufferSubData(t, internal, offset, size, format, type, in.pointer());
+        break;
+    }
+    case call::CLEAR_BUFFER_UIV: { auto const b = e32(); auto const d = i32(); glClearBufferuiv(b, d, in.array<gl::u32>()); break; }
+    case call::CLEAR_COLOR: { auto const r_ = f32(); auto const g = f32(); auto const b = f32(); glClearColor(r_, g, b, f32()); break; }
+    case call::CLEAR_DEPTH: glClearDepth(in.get<gl::f64>()); break;
+    case call::CLEAR_NAMED_BUFFER_SUB_DATA: {
+        auto const b = name(kind::BUFFER); auto const internal = e32(); auto const offset = i64(); auto const size = i64(); auto const format = e32(); auto const type = e32();
+        glClearNamedBufferSubData(b, internal, offset, size, format, type, in.pointer());
+        break;
+    }
+    case call::CLEAR_NAMED_FRAMEBUFFER_FI: {
+        auto const fb = name(kind::FRAMEBUFFER); auto const b = e32(); auto const d = i32(); auto const depth = f32();
+        glClearNamedFramebufferfi(fb, b, d, depth, i32());
+        break;
+    }
+    case call::CLEAR_NAMED_FRAMEBUFFER_FV: {
+        auto const fb = name(kind::FRAMEBUFFER); auto const b = e32(); auto const d = i32();
+        glClearNamedFramebufferfv(fb, b, d, in.array<gl::f32>());
+        break;
+    }
+    case call::CLEAR_NAMED_FRAMEBUFFER_UIV: {
+        auto const fb = name(kind::FRAMEBUFFER); auto const b = e32(); auto const d = i32();
+        glClearNamedFramebufferuiv(fb, b, d, in.array<gl::u32>());
+        break;
+    }
+    case call::CLIP_CONTROL: { auto const origin = e32(); glClipControl(origin, e32()); break; }
+    case call::COLOR_MASK: { auto const red = b8(); auto const green = b8(); auto const blue = b8(); glColorMask(red, green, blue, b8()); break; }
+    case call::COMPILE_SHADER: glCompileShader(name(kind::SHADER)); break;
+    case call::COMPRESSED_TEX_SUB_IMAGE_2D:
+    case call::COMPRESSED_TEXTURE_SUB_IMAGE_2D: {
+        auto const named = r.id == call::COMPRESSED_TEXTURE_SUB_IMAGE_2D;
+        auto const target = named ? name(kind::TEXTURE) : e32();
+        auto const level = i32(); auto const x = i32(); auto const y = i32(); auto const w = s32(); auto const h = s32();
+        auto const format = e32(); auto const size = s32(); auto const* data = in.pointer();
+        if (named) {
+            glCompressedTextureSubImage2D(target, level, x, y, w, h, format, size, data);
+        }
+        else {
+            glCompressedTexSubImage2D(target, level, x, y, w, h, format, size, data);
+        }
+        break;
+    }
+    case call::COPY_BUFFER_SUB_DATA: {
+        auto const read = e32(); auto const write = e32(); auto const ro = i64(); auto const wo = i64();
+        glCopyBufferSubData(read, write, ro, wo, i64());
+        break;
+    }
+    case call::COPY_IMAGE_SUB_DATA: {
+        auto const src = name(kind::TEXTURE); auto const src_target = e32(); auto const src_level = i32();
+        auto const sx = i32(); auto const sy = i32(); auto const sz = i32();
+        auto const dst = name(kind::TEXTURE); auto const dst_target = e32(); auto const dst_level = i32();
+        auto const dx = i32(); auto const dy = i32(); auto const dz = i32();
+        auto const w = s32(); auto const h = s32();
+        glCopyImageSubData(src, src_target, src_level, sx, sy, sz, dst, dst_target, dst_level, dx, dy, dz, w, h, s32());
+        break;
+    }
+    case call::COPY_NAMED_BUFFER_SUB_DATA: {
+        auto const read = name(kind::BUFFER); auto const write = name(kind::BUFFER); auto const ro = i64(); auto const wo = i64();
+        glCopyNamedBufferSubData(read, write, ro, wo, i64());
+        break;
+    }
+    case call::CREATE_BUFFERS: make(names, kind::BUFFER, in, [](gl::s32 n, gl::u32* made) { glCreateBuffers(n, made); }); break;
+    case call::CREATE_FRAMEBUFFERS: make(names, kind::FRAMEBUFFER, in, [](gl::s32 n, gl::u32* made) { glCreateFramebuffers(n, made); }); break;
+    case call::CREATE_PROGRAM: names.add(kind::PROGRAM, u32(), glCreateProgram()); break;
+    case call::CREATE_RENDERBUFFERS: make(names, kind::RENDERBUFFER, in, [](gl::s32 n, gl::u32* made) { glCreateRenderbuffers(n, made); }); break;
+    case call::CREATE_SAMPLERS: make(names, kind::SAMPLER, in, [](gl::s32 n, gl::u32* made) { glCreateSamplers(n, made); }); break;
+    case call::CREATE_SHADER: { auto const type = e32(); names.add(kind::SHADER, u32(), glCreateShader(type)); break; }
+    case call::CREATE_TEXTURES: {
+        auto const target = e32();
+        make(names, kind::TEXTURE, in, [&](gl::s32 n, gl::u32* made) { glCreateTextures(target, n, made); });
+        break;
+    }
+    case call::CREATE_VERTEX_ARRAYS: make(names, kind::VERTEX_ARRAY, in, [](gl::s32 n, gl::u32* made) { glCreateVertexArrays(n, made); }); break;
+    case call::CULL_FACE: glCullFace(e32()); break;
+    case call::DELETE_BUFFERS: remove(names, kind::BUFFER, in, [](gl::s32 n, gl::u32 const* names) { glDeleteBuffers(n, names); }); break;
+    case call::DELETE_FRAMEBUFFERS: remove(names, kind::FRAMEBUFFER, in, [](gl::s32 n, gl::u32 const* names) { glDeleteFramebuffers(n, names); }); break;
+    case call::DELETE_PROGRAM: { auto const recorded = u32(); glDeleteProgram(names.remove(kind::PROGRAM, 1, &recorded)[0]); break; }
+    case call::DELETE_PROGRAM_PIPELINES: remove(names, kind::PIPELINE, in, [](gl::s32 n, gl::u32 const* names) { glDeleteProgramPipelines(n, names); }); break;
+    case call::DELETE_RENDERBUFFERS: remove(names, kind::RENDERBUFFER, in, [](gl::s32 n, gl::u32 const* names) { glDeleteRenderbuffers(n, names); }); break;
+    case call::DELETE_SAMPLERS: remove(names, kind::SAMPLER, in, [](gl::s32 n, gl::u32 const* names) { glDeleteSamplers(n, names); }); break;
+    case call::DELETE_SHADER: { auto const recorded = u32(); glDeleteShader(names.remove(kind::SHADER, 1, &recorded)[0]); break; }
+    case call::DELETE_TEXTURES: remove(names, kind::TEXTURE, in, [](gl::s32 n, gl::u32 const* names) { glDeleteTextures(n, names); }); break;
+    case call::DELETE_VERTEX_ARRAYS: remove(names, kind::VERTEX_ARRAY, in, [](gl::s32 n, gl::u32 const* names) { glDeleteVertexArrays(n, names); }); break;
+    case call::DEPTH_FUNC: glDepthFunc(e32()); break;
+    case call::DEPTH_MASK: glDepthMask(b8()); break;
+    case call::DETACH_SHADER: { auto const p = name(kind::PROGRAM); glDetachShader(p, name(kind::SHADER)); break; }
+    case call::DISABLE: glDisable(e32()); break;
+    case call::DISPATCH_COMPUTE: { auto const x = u32(); auto const y = u32(); glDispatchCompute(x, y, u32()); break; }
+    case call::DISPATCH_COMPUTE_INDIRECT: glDispatchComputeIndirect(i64()); break;
+    case call::DRAW_ARRAYS: { auto const mode = e32(); auto const first = i32(); glDrawArrays(mode, first, s32()); break; }
+    case call::DRAW_ARRAYS_INDIRECT: { auto const mode = e32(); glDrawArraysIndirect(mode, in.pointer()); break; }
+    case call::DRAW_ARRAYS_INSTANCED: { auto const mode = e32(); auto const first = i32(); auto const count = s32(); glDrawArraysInstanced(mode, first, count, s32()); break; }
+    case call::DRAW_BUFFER: glDrawBuffer(e32()); break;
+    case call::DRAW_BUFFERS: { auto const count = s32(); glDrawBuffers(count, in.array<gl::e32>()); break; }
+    case call::DRAW_ELEMENTS:
+    case call::DRAW_ELEMENTS_BASE_VERTEX:
+    case call::DRAW_ELEMENTS_INSTANCED:
+    case call::DRAW_ELEMENTS_INSTANCED_BASE_VERTEX: {
+        auto const mode = e32(); auto const count = s32(); auto const type = e32(); auto const* indices = in.pointer();
+        auto const instanced = r.id == call::DRAW_ELEMENTS_INSTANCED || r.id == call::DRAW_ELEMENTS_INSTANCED_BASE_VERTEX;
+        auto const instances = instanced ? s32() : 1;
+        auto const base = r.id == call::DRAW_ELEMENTS_BASE_VERTEX || r.id == call::DRAW_ELEMENTS_INSTANCED_BASE_VERTEX ? i32() : 0;
+        glDrawElementsInstancedBaseVertex(mode, count, type, indices, instances, base);
+        break;
+    }
+    case call::DRAW_ELEMENTS_INSTANCED_BASE_VERTEX_BASE_INSTANCE: {
+        auto const mode = e32(); auto const count = s32(); auto const type = e32(); auto const* indices = in.pointer();
+        auto const instances = s32(); auto const base = i32();
+        glDrawElementsInstancedBaseVertexBaseInstance(mode, count, type, indices, instances, base, u32());
+        break;
+    }
+    case call::ENABLE: glEnable(e32()); break;
+    case call::ENABLE_VERTEX_ARRAY_ATTRIB: { auto const vao = name(kind::VERTEX_ARRAY); glEnableVertexArrayAttrib(vao, u32()); break; }
+    case call::ENABLE_VERTEX_ATTRIB_ARRAY: glEnableVertexAttribArray(u32()); break;
+    case call::FRAMEBUFFER_RENDERBUFFER: {
+        auto const t = e32(); auto const a = e32(); auto const rt = e32();
+        glFramebufferRenderbuffer(t, a, rt, name(kind::RENDERBUFFER));
+        break;
+    }
+    case call::FRAMEBUFFER_TEXTURE: { auto const t = e32(); auto const a = e32(); auto const tex = name(kind::TEXTURE); glFramebufferTexture(t, a, tex, i32()); break; }
+    case call::FRAMEBUFFER_TEXTURE_2D: {
+        auto const t = e32(); auto const a = e32(); auto const tt = e32(); auto const tex = name(kind::TEXTURE);
+        glFramebufferTexture2D(t, a, tt, tex, i32());
+        break;
+    }
+    case call::FRAMEBUFFER_TEXTURE_LAYER: {
+        auto const t = e32(); auto const a = e32(); auto const tex = name(kind::TEXTURE); auto const level = i32();
+        glFramebufferTextureLayer(t, a, tex, level, i32());
+        break;
+    }
+    case call::FRAMEBUFFER_TEXTURE_MULTIVIEW: {
+        auto const t = e32(); auto const a = e32(); auto const tex = name(kind::TEXTURE); auto const level = i32(); auto const base = i32();
+        glFramebufferTextureMultiviewOVR(t, a, tex, level, base, s32());
+        break;
+    }
+    case call::FRONT_FACE: glFrontFace(e32()); break;
+    case call::GEN_BUFFERS: make(names, kind::BUFFER, in, [](gl::s32 n, gl::u32* made) { glGenBuffers(n, made); }); break;
+    case call::GEN_FRAMEBUFFERS: make(names, kind::FRAMEBUFFER, in, [](gl::s32 n, gl::u32* made) { glGenFramebuffers(n, made); }); break;
+    case call::GEN_PROGRAM_PIPELINES: make(names, kind::PIPELINE, in, [](gl::s32 n, gl::u32* made) { glGenProgramPipelines(n, made); }); break;
+    case call::GEN_RENDERBUFFERS: make(names, kind::RENDERBUFFER, in, [](gl::s32 n, gl::u32* made) { glGenRenderbuffers(n, made); }); break;
+    case call::GEN_SAMPLERS: make(names, kind::SAMPLER, in, [](gl::s32 n, gl::u32* made) { glGenSamplers(n, made); }); break;
+    case call::GEN_TEXTURES: make(names, kind::TEXTURE, in, [](gl::s32 n, gl::u32* made) { glGenTextures(n, made); }); break;
+    case call::GEN_VERTEX_ARRAYS: make(names, kind::VERTEX_ARRAY, in, [](gl::s32 n, gl::u32* made) { glGenVertexArrays(n, made); }); break;
+    case call::GENERATE_MIPMAP: glGenerateMipmap(e32()); break;
+    case call::GENERATE_TEXTURE_MIPMAP: glGenerateTextureMipmap(name(kind::TEXTURE)); break;
+    case call::INVALIDATE_FRAMEBUFFER: { auto const t = e32(); auto const count = s32(); glInvalidateFramebuffer(t, count, in.array<gl::e32>()); break; }
+    case call::INVALIDATE_NAMED_FRAMEBUFFER_DATA: {
+        auto const fb = name(kind::FRAMEBUFFER); auto const count = s32();
+        glInvalidateNamedFramebufferData(fb, count, in.array<gl::e32>());
+        break;
+    }
+    case call::LINK_PROGRAM: glLinkProgram(name(kind::PROGRAM)); break;
+    case call::MEMORY_BARRIER: glMemoryBarrier(b32()); break;
+    case call::MULTI_DRAW_ARRAYS_INDIRECT: {
+        auto const mode = e32(); auto const* indirect = in.pointer(); auto const count = s32();
+        glMultiDrawArraysIndirect(mode, indirect, count, s32());
+        break;
+    }
+    case call::MULTI_DRAW_ELEMENTS_INDIRECT: {
+        auto const mode = e32(); auto const type = e32(); auto const* indirect = in.pointer(); auto const count = s32();
+        glMultiDrawElementsIndirect(mode, type, indirect, count, s32());
+        break;
+    }
+    case call::MULTI_DRAW_ELEMENTS_INDIRECT_COUNT: {
+        auto const mode = e32(); auto const type = e32(); auto const* indirect = in.pointer(); auto const count = i64();
+        auto const max_count = s32();
+        glMultiDrawElementsIndirectCount(mode, type, indirect, count, max_count, s32());
+        break;
+    }
+    case call::NAMED_BUFFER_DATA: {
+        auto const b = name(kind::BUFFER); auto const size = i64(); auto const* data = in.pointer();
+        glNamedBufferData(b, size, data, e32());
+        break;
+    }
+    case call::NAMED_BUFFER_STORAGE: {
+        auto const b = name(kind::BUFFER); auto const size = i64(); auto const* data = in.pointer();
+        glNamedBufferStorage(b, size, data, b32() | GL_DYNAMIC_STORAGE_BIT);
+        break;
+    }
+    case call::NAMED_BUFFER_SUB_DATA:
+    case call::MAPPED_WRITE: {
+        auto const b = name(kind::BUFFER); auto const offset = i64();
+        if (r.id == call::MAPPED_WRITE) {
+            auto const data = in.bytes();
+            if (!data.empty()) {
+                glNamedBufferSubData(b, offset, static_cast<std::intptr_t>(data.size()), data.data());
+            }
+        }
+        else {
+            auto const size = i64();
+            glNamedBufferSubData(b, offset, size, in.pointer());
+        }
+        break;
+    }
+    case call::NAMED_FRAMEBUFFER_DRAW_BUFFERS: {
+        auto const fb = name(kind::FRAMEBUFFER); auto const count = s32();
+        glNamedFramebufferDrawBuffers(fb, count, in.array<gl::e32>());
+        break;
+    }
+    case call::NAMED_FRAMEBUFFER_READ_BUFFER: { auto const fb = name(kind::FRAMEBUFFER); glNamedFramebufferReadBuffer(fb, e32()); break; }
+    case call::NAMED_FRAMEBUFFER_RENDERBUFFER: {
+        auto const fb = name(kind::FRAMEBUFFER); auto const a = e32(); auto const rt = e32();
+        glNamedFramebufferRenderbuffer(fb, a, rt, name(kind::RENDERBUFFER));
+        break;
+    }
+    case call::NAMED_FRAMEBUFFER_TEXTURE: {
+        auto const fb = name(kind::FRAMEBUFFER); auto const a = e32(); auto const tex = name(kind::TEXTURE);
+        glNamedFramebufferTexture(fb, a, tex, i32());
+        break;
+    }
+    case call::NAMED_FRAMEBUFFER_TEXTURE_LAYER: {
+        auto const fb = name(kind::FRAMEBUFFER); auto const a = e32(); auto const tex = name(kind::TEXTURE); auto const level = i32();
+        glNamedFramebufferTextureLayer(fb, a, tex, level, i32());
+        break;
+    }
+    case call::NAMED_RENDERBUFFER_STORAGE_MULTISAMPLE: {
+        auto const rb = name(kind::RENDERBUFFER); auto const samples = s32(); auto const format = e32(); auto const w = s32();
+        glNamedRenderbufferStorageMultisample(rb, samples, format, w, s32());
+        break;
+    }
+    case call::PATCH_PARAMETER: { auto const pname = e32(); glPatchParameteri(pname, i32()); break; }
+    case call::PIXEL_STORE_I: { auto const pname = e32(); glPixelStorei(pname, i32()); break; }
+    case call::POLYGON_MODE: { auto const face = e32(); glPolygonMode(face, e32()); break; }
+    case call::POLYGON_OFFSET: { auto const factor = f32(); glPolygonOffset(factor, f32()); break; }
+    case call::PROGRAM_BINARY: {
+        auto const p = name(kind::PROGRAM); auto const format = e32(); auto const binary = in.bytes();
+        glProgramBinary(p, format, binary.data(), static_cast<gl::s32>(binary.size()));
+        break;
+    }
+    case call::PROGRAM_PARAMETER: { auto const p = name(kind::PROGRAM); auto const pname = e32(); glProgramParameteri(p, pname, i32()); break; }
+    case call::PROGRAM_UNIFORM_1F: { auto const p = name(kind::PROGRAM); auto const location = i32(); glProgramUniform1f(p, location, f32()); break; }
+    case call::PROGRAM_UNIFORM_1I: { auto const p = name(kind::PROGRAM); auto const location = i32(); glProgramUniform1i(p, location, i32()); break; }
+    case call::PROGRAM_UNIFORM_1U: { auto const p = name(kind::PROGRAM); auto const location = i32(); glProgramUniform1ui(p, location, u32()); break; }
+    case call::PROGRAM_UNIFORM_2F: {
+        auto const p = name(kind::PROGRAM); auto const location = i32(); auto const count = s32();
+        glProgramUniform2fv(p, location, count, in.array<gl::f32>());
+        break;
+    }
+    case call::PROGRAM_UNIFORM_2I: {
+        auto const p = name(kind::PROGRAM); auto const location = i32(); auto const count = s32();
+        glProgramUniform2iv(p, location, count, in.array<gl::i32>());
+        break;
+    }
+    case call::PROGRAM_UNIFORM_3F: {
+        auto const p = name(kind::PROGRAM); auto const location = i32(); auto const count = s32();
+        glProgramUniform3fv(p, location, count, in.array<gl::f32>());
+        break;
+    }
+    case call::PROGRAM_UNIFORM_3I: {
+        auto const p = name(kind::PROGRAM); auto const location = i32(); auto const count = s32();
+        glProgramUniform3iv(p, location, count, in.array<gl::i32>());
+        break;
+    }
+    case call::PROGRAM_UNIFORM_4F: {
+        auto const p = name(kind::PROGRAM); auto const location = i32(); auto const count = s32();
+        glProgramUniform4fv(p, location, count, in.array<gl::f32>());
+        break;
+    }
+    case call::PROGRAM_UNIFORM_4I: {
+        auto const p = name(kind::PROGRAM); auto const location = i32(); auto const count = s32();
+        glProgramUniform4iv(p, location, count, in.array<gl::i32>());
+        break;
+    }
+    case call::PROGRAM_UNIFORM_MAT3F: {
+        auto const p = name(kind::PROGRAM); auto const location = i32(); auto const count = s32(); auto const transpose = b8();
+        glProgramUniformMatrix3fv(p, location, count, transpose, in.array<gl::f32>());
+        break;
+    }
+    case call::PROGRAM_UNIFORM_MAT4F: {
+        auto const p = name(kind::PROGRAM); auto const location = i32(); auto const count = s32(); auto const transpose = b8();
+        glProgramUniformMatrix4fv(p, location, count, transpose, in.array<gl::f32>());
+        break;
+    }
+    case call::READ_BUFFER: glReadBuffer(e32()); break;
+    case call::RENDERBUFFER_STORAGE_MULTISAMPLE: {
+        auto const t = e32(); auto const samples = s32(); auto const format = e32(); auto const w = s32();
+        glRenderbufferStorageMultisample(t, samples, format, w, s32());
+        break;
+    }
+    case call::SAMPLER_PARAMETER_F: { auto const s = name(kind::SAMPLER); auto const pname = e32(); glSamplerParameterf(s, pname, f32()); break; }
+    case call::SAMPLER_PARAMETER_I: { auto const s = name(kind::SAMPLER); auto const pname = e32(); glSamplerParameteri(s, pname, i32()); break; }
+    case call::SCISSOR_ARRAY: { auto const first = u32(); auto const count = s32(); glScissorArrayv(first, count, in.array<gl::i32>()); break; }
+    case call::SHADER_BINARY: {
+        auto const count = s32();
+        auto const* recorded = in.array<gl::u32>();
+        auto shaders = std::vector<gl::u32>(static_cast<std::size_t>(count));
+        for (auto i = 0; i < count; ++i) {
+            shaders[i] = names(kind::SHADER, recorded[i]);
+        }
+        auto const format = e32();
+        auto const binary = in.bytes();
+        glShaderBinary(count, shaders.data(), format, binary.data(), static_cast<gl::s32>(binary.size()));
+        break;
+    }
+    case call::SHADER_STORAGE_BLOCK_BINDING: {
+        auto const p = name(kind::PROGRAM); auto const index = u32();
+        glShaderStorageBlockBinding(p, index, u32());
+        break;
+    }
+    case call::SHADER_SOURCE: {
+        auto const shader = name(kind::SHADER);
+        auto const source = in.bytes();
+        auto const* text = reinterpret_cast<char const*>(source.data());
+        auto const length = static_cast<gl::i32>(source.size());
+        glShaderSource(shader, 1, &text, &length);
+        break;
+    }
+    case call::SPECIALIZE_SHADER: {
+        auto const shader = name(kind::SHADER);
+        auto const entry = in.bytes();
+        auto const entry_point = std::string(reinterpret_cast<char const*>(entry.data()), entry.size());
+        auto const count = u32();
+        auto const* indices = in.array<gl::u32>();
+        auto const* values = in.array<gl::u32>();
+        glSpecializeShader(shader, entry_point.c_str(), count, indices, values);
+        break;
+    }
+    case call::STENCIL_FUNC: { auto const func = e32(); auto const reference = i32(); glStencilFunc(func, reference, u32()); break; }
+    case call::STENCIL_MASK: glStencilMask(u32()); break;
+    case call::STENCIL_OP: { auto const stencil_fail = e32(); auto const depth_fail = e32(); glStencilOp(stencil_fail, depth_fail, e32()); break; }
+    case call::TEX_PARAMETER_I: { auto const t = e32(); auto const pname = e32(); glTexParameteri(t, pname, i32()); break; }
+    case call::TEX_STORAGE_2D:
+    case call::TEXTURE_STORAGE_2D: {
+        auto const named = r.id == call::TEXTURE_STORAGE_2D;
+        auto const target = named ? name(kind::TEXTURE) : e32();
+        auto const levels = s32(); auto const format = e32(); auto const w = s32(); auto const h = s32();
+        named ? glTextureStorage2D(target, levels, format, w, h) : glTexStorage2D(target, levels, format, w, h);
+        break;
+    }
+    case call::TEX_STORAGE_3D:
+    case call::TEXTURE_STORAGE_3D: {
+        auto const named = r.id == call::TEXTURE_STORAGE_3D;
+        auto const target = named ? name(kind::TEXTURE) : e32();
+        auto const levels = s32(); auto const format = e32(); auto const w = s32(); auto const h = s32(); auto const d = s32();
+        named ? glTextureStorage3D(target, levels, format, w, h, d) : glTexStorage3D(target, levels, format, w, h, d);
+        break;
+    }
+    case call::TEX_SUB_IMAGE_2D:
+    case call::TEXTURE_SUB_IMAGE_2D: {
+        auto const named = r.id == call::TEXTURE_SUB_IMAGE_2D;
+        auto const target = named ? name(kind::TEXTURE) : e32();
+        auto const level = i32(); auto const x = i32(); auto const y = i32(); auto const w = s32(); auto const h = s32();
+        auto const format = e32(); auto const type = e32(); auto const* pixels = in.pointer();
+        named ? glTextureSubImage2D(target, level, x, y, w, h, format, type, pixels) : glTexSubImage2D(target, level, x, y, w, h, format, type, pixels);
+        break;
+    }
+    case call::TEX_SUB_IMAGE_3D:
+    case call::TEXTURE_SUB_IMAGE_3D: {
+        auto const named = r.id == call::TEXTURE_SUB_IMAGE_3D;
+        auto const target = named ? name(kind::TEXTURE) : e32();
+        auto const level = i32(); auto const x = i32(); auto const y = i32(); auto const z = i32();
+        auto const w = s32(); auto const h = s32(); auto const d = s32();
+        auto const format = e32(); auto const type = e32(); auto const* pixels = in.pointer();
+        named ? glTextureSubImage3D(target, level, x, y, z, w, h, d, format, type, pixels)
+              : glTexSubImage3D(target, level, x, y, z, w, h, d, format, type, pixels);
+        break;
+    }
+    case call::UNIFORM_1F: { auto const location = i32(); glUniform1f(location, f32()); break; }
+    case call::UNIFORM_1I: { auto const location = i32(); glUniform1i(location, i32()); break; }
+    case call::UNIFORM_1U: { auto const location = i32(); glUniform1ui(location, u32()); break; }
+    case call::UNIFORM_2F: { auto const location = i32(); auto const count = s32(); glUniform2fv(location, count, in.array<gl::f32>()); break; }
+    case call::UNIFORM_2I: { auto const location = i32(); auto const count = s32(); glUniform2iv(location, count, in.array<gl::i32>()); break; }
+    case call::UNIFORM_3F: { auto const location = i32(); auto const count = s32(); glUniform3fv(location, count, in.array<gl::f32>()); break; }
+    case call::UNIFORM_3I: { auto const location = i32(); auto const count = s32(); glUniform3iv(location, count, in.array<gl::i32>()); break; }
+    case call::UNIFORM_4F: { auto const location = i32(); auto const count = s32(); glUniform4fv(location, count, in.array<gl::f32>()); break; }
+    case call::UNIFORM_4I: { auto const location = i32(); auto const count = s32(); glUniform4iv(location, count, in.array<gl::i32>()); break; }
+    case call::UNIFORM_BLOCK_BINDING: { auto const p = name(kind::PROGRAM); auto const index = u32(); glUniformBlockBinding(p, index, u32()); break; }
+    case call::UNIFORM_MAT3F: {
+        auto const location = i32(); auto const count = s32(); auto const transpose = b8();
+        glUniformMatrix3fv(location, count, transpose, in.array<gl::f32>());
+        break;
+    }
+    case call::UNIFORM_MAT4F: {
+        auto const location = i32(); auto const count = s32(); auto const transpose = b8();
+        glUniformMatrix4fv(location, count, transpose, in.array<gl::f32>());
+        break;
+    }
+    case call::USE_PROGRAM: glUseProgram(name(kind::PROGRAM)); break;
+    case call::USE_PROGRAM_STAGES: { auto const p = name(kind::PIPELINE); auto const stages = b32(); glUseProgramStages(p, stages, name(kind::PROGRAM)); break; }
+    case call::VERTEX_ARRAY_ATTRIB_BINDING: { auto const vao = name(kind::VERTEX_ARRAY); auto const index = u32(); glVertexArrayAttribBinding(vao, index, u32()); break; }
+    case call::VERTEX_ARRAY_ATTRIB_FORMAT: {
+        auto const vao = name(kind::VERTEX_ARRAY); auto const index = u32(); auto const size = i32(); auto const type = e32();
+        auto const normalized = b8();
+        glVertexArrayAttribFormat(vao, index, size, type, normalized, u32());
+        break;
+    }
+    case call::VERTEX_ARRAY_ATTRIB_I_FORMAT: {
+        auto const vao = name(kind::VERTEX_ARRAY); auto const index = u32(); auto const size = i32(); auto const type = e32();
+        glVertexArrayAttribIFormat(vao, index, size, type, u32());
+        break;
+    }
+    case call::VERTEX_ARRAY_BINDING_DIVISOR: { auto const vao = name(kind::VERTEX_ARRAY); auto const binding = u32(); glVertexArrayBindingDivisor(vao, binding, u32()); break; }
+    case call::VERTEX_ARRAY_ELEMENT_BUFFER: { auto const vao = name(kind::VERTEX_ARRAY); glVertexArrayElementBuffer(vao, name(kind::BUFFER)); break; }
+    case call::VERTEX_ARRAY_VERTEX_BUFFER: {
+        auto const vao = name(kind::VERTEX_ARRAY); auto const binding = u32(); auto const b = name(kind::BUFFER); auto const offset = i64();
+        glVertexArrayVertexBuffer(vao, binding, b, offset, s32());
+        break;
+    }
+    case call::VERTEX_ATTRIB: { auto const index = static_cast<gl::u32>(i32()); glVertexAttrib4fv(index, in.array<gl::f32>()); break; }
+    case call::VERTEX_ATTRIB_DIVISOR: { auto const index = u32(); glVertexAttribDivisor(index, u32()); break; }
+    case call::VERTEX_ATTRIB_I_POINTER: {
+        auto const index = static_cast<gl::u32>(i32()); auto const size = s32(); auto const type = e32(); auto const stride = s32();
+        glVertexAttribIPointer(index, size, type, stride, in.pointer());
+        break;
+    }
+    case call::VERTEX_ATTRIB_POINTER: {
+        auto const index = static_cast<gl::u32>(i32()); auto const size = s32(); auto const type = e32(); auto const normalized = b8();
+        auto const stride = s32();
+        glVertexAttribPointer(index, size, type, normalized, stride, in.pointer());
+        break;
+    }
+    case call::VIEWPORT: { auto const x = i32(); auto const y = i32(); auto const w = s32(); glViewport(x, y, w, s32()); break; }
+    case call::VIEWPORT_ARRAY: { auto const first = u32(); auto const count = s32(); glViewportArrayv(first, count, in.array<gl::f32>()); break; }
+    case call::FRAME:
+    case call::COUNT:
+        break;
+    }
+}
+
+/**
+ * @brief The records of a capture, one list per frame, the writes through mappings first
+ * (the CPU wrote them before the frame's draws read them; they are only recorded at its end).
+ */
+std::vector<std::vector<record>> read_frames(std::span<std::byte const> file) {
+    auto head = gl::call_capture::header();
+    if (file.size() < sizeof(head)) {
+        throw std::runtime_error("Not a capture: too short");
+    }
+    std::memcpy(&head, file.data(), sizeof(head));
+    if (head.magic != gl::call_capture::k_magic) {
+        throw std::runtime_error("Not a capture");
+    }
+    if (head.version != gl::call_capture::k_version) {
+        throw std::runtime_error("Unsupported capture version " + std::to_string(head.version));
+    }
+
+    auto frames = std::vector<std::vector<record>>(1);
+    auto writes = std::size_t(0);                   // Mapped writes at the front of the last frame.
+    for (auto at = sizeof(head); at < file.size();) {
+        if (at + gl::call_capture::k_record_size > file.size()) {
+            throw std::runtime_error("Truncated capture");
+        }
+        auto id = std::uint16_t(0);
+        auto size = std::uint32_t(0);
+        std::memcpy(&id, file.data() + at, sizeof(id));
+        std::memcpy(&size, file.data() + at + sizeof(id), sizeof(size));
+        at += gl::call_capture::k_record_size;
+        if (at + size > file.size() || id >= call::COUNT) {
+            throw std::runtime_error("Corrupt capture record at byte " + std::to_string(at));
+        }
+        auto const item = record{ static_cast<call::type>(id), file.subspan(at, size) };
+        at += size;
+        if (item.id == call::FRAME) {
+            frames.emplace_back();
+            writes = 0;
+        }
+        else if (item.id == call::MAPPED_WRITE) {
+            auto& frame = frames.back();
+            frame.insert(frame.begin() + static_cast<std::ptrdiff_t>(writes++), item);
+        }
+        else {
+            frames.back().push_back(item);
+        }
+    }
+    if (frames.back().empty()) {
+        frames.pop_back();
+    }
+    if (frames.empty()) {
+        throw std::runtime_error("The capture has no frames");
+    }
+    return frames;
+}
+
+options parse_options(int argc, char** argv) {
+    auto result = options();
+    for (auto i = 1; i < argc; ++i) {
+        auto const arg = std::string_view(argv[i]);
+        if (arg == "--calls") {
+            result.calls = true;
+        }
+        else if (arg == "--loops" && i + 1 < argc) {
+            result.loops = static_cast<gl::u32>(std::max(std::stoi(argv[++i]), 1));
+        }
+        else if (arg == "--size" && i + 1 < argc) {
+            auto const size = std::string(argv[++i]);
+            auto const x = size.find('x');
+            if (x == std::string::npos) {
+                throw std::runtime_error("Expected <width>x<height>: " + size);
+            }
+            result.width = std::stoi(size.substr(0, x));
+            result.height = std::stoi(size.substr(x + 1));
+        }
+        else if (arg == "--json" && i + 1 < argc) {
+            result.json = argv[++i];
+        }
+        else if (result.input == nullptr && !arg.starts_with("--")) {
+            result.input = argv[i];
+        }
+        else {
+            throw std::runtime_error("Unexpected argument: " + std::string(arg));
+        }
+    }
+    if (result.input == nullptr) {
+        throw std::runtime_error("Usage: replay_capture <capture> [--loops <count>] [--size <width>x<height>] [--calls] [--json <file>]");
+    }
+    return result;
+}
+
+struct call_time {
+    call::type    id;
+    std::uint64_t count = 0;
+    double        total = 0.0;      // Seconds.
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        using clock = std::chrono::steady_clock;
+        auto const settings = parse_options(argc, argv);
+        gl::LOG.set_level(gltool::log_tag::WARNING);
+
+        auto const file = gltool::mapped_file(settings.input);
+        auto const frames = read_frames(std::as_bytes(std::span(file.data(), file.size())));
+
+        auto win = gl::window(gl::aux::window_specification{ .title = "replay_capture", .width = settings.width,
+                                                             .height = settings.height, .traits = gl::aux::window_specification::HEADLESS });
+        gl::states::glew_initialize();
+        if (!GLEW_VERSION_4_5) {
+            throw std::runtime_error("Replaying needs OpenGL 4.5");
+        }
+
+        auto names = name_map();
+        for (auto i = std::size_t(0); i + 1 < frames.size(); ++i) {
+            for (auto const& item : frames[i]) {
+                replay(item, names);
+            }
+        }
+        glFinish();
+
+        auto const& looped = frames.back();
+        auto times = std::vector<call_time>(call::COUNT);
+        for (auto i = 0; i < call::COUNT; ++i) {
+            times[i].id = static_cast<call::type>(i);
+        }
+        auto frame_times = std::vector<double>();
+        auto gpu_times = std::vector<double>();
+        auto query = gl::u32(0);
+        glGenQueries(1, &query);
+        for (auto loop = gl::u32(0); loop < settings.loops; ++loop) {
+            auto const start = clock::now();
+            glBeginQuery(GL_TIME_ELAPSED, query);
+            for (auto const& item : looped) {
+                auto const before = clock::now();
+                replay(item, names);
+                auto& time = times[item.id];
+                time.total += std::chrono::duration<double>(clock::now() - before).count();
+                ++time.count;
+            }
+            glEndQuery(GL_TIME_ELAPSED);
+            glFinish();
+            frame_times.push_back(std::chrono::duration<double>(clock::now() - start).count());
+            auto elapsed = gl::u64(0);
+            glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+            gpu_times.push_back(static_cast<double>(elapsed) * 1e-9);
+        }
+        glDeleteQueries(1, &query);
+
+        std::ranges::sort(frame_times);
+        auto const mean = [](std::vector<double> const& values) {
+            return std::accumulate(values.begin(), values.end(), 0.0) / static_cast<double>(values.size());
+        };
+        std::erase_if(times, [](call_time const& t) { return t.count == 0; });
+        std::ranges::sort(times, std::greater<>(), &call_time::total);
+        auto const loops = static_cast<double>(settings.loops);
+
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << settings.input << ": " << frames.size() - 1 << " frames replayed once, the last (" << looped.size()
+                  << " calls) " << settings.loops << " times\n"
+                  << "frame: " << mean(frame_times) * 1e3 << " ms mean, " << frame_times.front() * 1e3 << " min, "
+                  << frame_times[frame_times.size() / 2] * 1e3 << " median, " << frame_times.back() * 1e3 << " max; GPU "
+                  << mean(gpu_times) * 1e3 << " ms mean" << std::endl;
+        if (settings.calls) {
+            std::cout << std::left << std::setw(40) << "call" << std::right << std::setw(14) << "calls/frame" << std::setw(14)
+                      << "us/call" << std::setw(14) << "us/frame" << '\n';
+            for (auto const& t : times) {
+                std::cout << std::left << std::setw(40) << gl::call_capture::name_of(t.id) << std::right << std::setw(14)
+                          << static_cast<double>(t.count) / loops << std::setw(14) << t.total / static_cast<double>(t.count) * 1e6
+                          << std::setw(14) << t.total / loops * 1e6 << '\n';
+            }
+            std::cout << std::flush;
+        }
+
+        if (settings.json != nullptr) {
+            auto out = std::ofstream(settings.json);
+            if (!out.is_open()) {
+                throw std::runtime_error("Could not open file: " + std::string(settings.json));
+            }
+            out << std::fixed << std::setprecision(6);
+            out << "{\n  \"capture\": \"" << settings.input << "\",\n  \"renderer\": \"" << gl::get_string(GL_RENDERER)
+                << "\",\n  \"setup_frames\": " << frames.size() - 1 << ",\n  \"loops\": " << settings.loops
+                << ",\n  \"frame_ms\": { \"mean\": " << mean(frame_times) * 1e3 << ", \"min\": " << frame_times.front() * 1e3
+                << ", \"p50\": " << frame_times[frame_times.size() / 2] * 1e3 << ", \"max\": " << frame_times.back() * 1e3
+                << " },\n  \"gpu_ms\": { \"mean\": " << mean(gpu_times) * 1e3 << " },\n  \"calls\": [";
+            for (auto i = std::size_t(0); i < times.size(); ++i) {
+                auto const& t = times[i];
+                out << (i == 0 ? "\n" : ",\n") << "    { \"name\": \"" << gl::call_capture::name_of(t.id) << "\", \"per_frame\": "
+                    << static_cast<double>(t.count) / loops << ", \"us_per_call\": " << t.total / static_cast<double>(t.count) * 1e6
+                    << " }";
+            }
+            out << (times.empty() ? "]" : "\n  ]") << "\n}\n";
+        }
+    }
+    catch (std::exception const& error) {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
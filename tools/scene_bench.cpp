@@ -0,0 +1,605 @@
+/**
+ * @file scene_bench.cpp
+ * @brief GPU benchmark of generated scenes: instanced cubes (one draw), unique meshes (a draw
+ * and a VAO each), many point lights through gl::clustered_lighting, and stacked fullscreen
+ * layers for overdraw. Each scene runs in a headless gl::application without vsync, waiting
+ * for the GPU every frame, while the camera orbits the scene once over the set duration, so
+ * every run sees the same views. Reports the distribution of the frame times, the counters of
+ * the frames and the GPU time and counts of the scopes of the window (see gl::gpu_profiler)
+ * per scene, as JSON, to compare drivers and hardware; the counts (vertex and fragment shader
+ * invocations, samples passed) tell vertex bound scenes from fill bound ones.
+ *
+ * Usage: scene_bench [--scene <name>] [--duration <seconds>] [--warmup <seconds>] [--size <width>x<height>] [--scale <factor>] [--json <file>]
+ *
+ * Licensed under the MIT License. See LICENSE file in the project root for full license information.
+ */
+
+#include "../include/application.hpp"
+
+#include <iomanip>
+#include <numbers>
+#include <random>
+
+namespace {
+
+struct options {
+    std::string scene;                  // Empty: all of them.
+    char const* json = nullptr;
+    double duration = 10.0;
+    double warmup = 1.0;
+    gl::i32 width = 1280;
+    gl::i32 height = 720;
+    double scale = 1.0;                 // Of the instance, mesh, light and layer counts.
+};
+
+/**
+ * @brief What a scene measured, once its run is over.
+ */
+struct report {
+    std::string name;
+    std::size_t count = 0;
+    std::vector<double> frame_times;            // Seconds, sorted.
+    gl::state_cache::stats counters;            // Summed over the measured frames.
+    std::vector<gl::gpu_profiler::scope_statistics> gpu_scopes;
+
+    double percentile(double pct) const noexcept {
+        if (frame_times.empty()) {
+            return 0.0;
+        }
+        auto const rank = static_cast<std::size_t>(std::ceil(pct / 100.0 * static_cast<double>(frame_times.size())));
+        return frame_times[std::clamp<std::size_t>(rank, 1, frame_times.size()) - 1];
+    }
+
+    double mean() const noexcept {
+        return frame_times.empty() ? 0.0 : std::accumulate(frame_times.begin(), frame_times.end(), 0.0) / static_cast<double>(frame_times.size());
+    }
+};
+
+/**
+ * @brief A generated scene: built when its run starts (with the context current), drawn once
+ * per frame from the camera of the path.
+ */
+class scene {
+public:
+    explicit scene(std::size_t count)
+        : m_count(count) {}
+
+    virtual ~scene() = default;
+
+    virtual char const* name() const noexcept = 0;
+
+    virtual void draw(gl::camera& eye, gl::aux::size viewport, double time) = 0;
+
+    std::size_t count() const noexcept {
+        return m_count;
+    }
+
+    /**
+     * @brief How far the camera orbits from the center, to see the whole scene.
+     */
+    virtual gl::f32 radius() const noexcept {
+        return 40.f;
+    }
+
+protected:
+    std::size_t m_count;
+};
+
+constexpr auto k_cube_vertices = std::array<gl::f32, 24>{
+    -0.5f, -0.5f, -0.5f,   0.5f, -0.5f, -0.5f,   0.5f,  0.5f, -0.5f,  -0.5f,  0.5f, -0.5f,
+    -0.5f, -0.5f,  0.5f,   0.5f, -0.5f,  0.5f,   0.5f,  0.5f,  0.5f,  -0.5f,  0.5f,  0.5f,
+};
+
+constexpr auto k_cube_indices = std::array<gl::u32, 36>{
+    0, 2, 1,  0, 3, 2,      // -z
+    4, 5, 6,  4, 6, 7,      // +z
+    0, 1, 5,  0, 5, 4,      // -y
+    3, 6, 2,  3, 7, 6,      // +y
+    0, 4, 7,  0, 7, 3,      // -x
+    1, 2, 6,  1, 6, 5,      // +x
+};
+
+/**
+ * @brief The transforms of `count` cubes on a square grid in the x-z plane, spaced 2 apart,
+ * turned and lifted at random (the same every run).
+ */
+std::vector<glm::mat4> cube_grid(std::size_t count) {
+    auto random = std::mt19937(42);
+    auto angle = std::uniform_real_distribution<gl::f32>(0.f, 2.f * std::numbers::pi_v<gl::f32>);
+    auto height = std::uniform_real_distribution<gl::f32>(0.f, 1.f);
+    auto const side = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+    auto const half = static_cast<gl::f32>(side);
+    auto result = std::vector<glm::mat4>();
+    result.reserve(count);
+    for (auto i = std::size_t(0); i < count; ++i) {
+        auto const position = glm::vec3(2.f * static_cast<gl::f32>(i % side) - half, height(random), 2.f * static_cast<gl::f32>(i / side) - half);
+        result.push_back(glm::rotate(glm::translate(glm::mat4(1.f), position), angle(random), glm::vec3(0.f, 1.f, 0.f)));
+    }
+    return result;
+}
+
+std::string instance_prelude(char const* version = "330") {
+    return std::string("#version ") + version + " core\n#define INSTANCE_LOCATION " + std::to_string(gl::constants::k_instance_location) + "\n";
+}
+
+constexpr char const* k_cube_vertex_source = R"(
+layout(location = 0) in vec3 position;
+#ifdef INSTANCE_LOCATION
+layout(location = INSTANCE_LOCATION) in mat4 instance;
+#else
+const mat4 instance = mat4(1.0);
+#endif
+uniform mat4 view;
+uniform mat4 view_projection;
+out vec3 v_view;
+void main() {
+    vec4 world = instance * vec4(position, 1.0);
+    v_view = (view * world).xyz;
+    gl_Position = view_projection * world;
+}
+)";
+
+// Flat shading from the derivatives of the view position: the meshes need no normals.
+constexpr char const* k_cube_fragment_source = R"(#version 330 core
+in vec3 v_view;
+out vec4 color;
+void main() {
+    vec3 normal = normalize(cross(dFdx(v_view), dFdy(v_view)));
+    color = vec4(0.5 + 0.5 * normal, 1.0);
+}
+)";
+
+constexpr char const* k_gbuffer_fragment_source = R"(
+in vec3 v_view;
+void main() {
+    write_gbuffer(vec3(0.8), 0.5, cross(dFdx(v_view), dFdy(v_view)), 32.0);
+}
+)";
+
+void set_camera(gl::shader& program, gl::camera const& eye) {
+    program.bind();
+    program.get_uniform<glm::mat4>("view").set(eye.get_view_matrix());
+    program.get_uniform<glm::mat4>("view_projection").set(eye.get_view_projection_matrix());
+}
+
+/**
+ * @brief One cube mesh drawn `count` times by a single instanced draw.
+ */
+class instanced_cubes : public scene {
+public:
+    explicit instanced_cubes(std::size_t count)
+        : scene(count),
+          m_cube(std::span<gl::f32 const>(k_cube_vertices), std::span<gl::u32 const>(k_cube_indices)),
+          m_program(gl::shader::from_sources((instance_prelude() + k_cube_vertex_source).c_str(), k_cube_fragment_source)) {
+
+        auto const transforms = cube_grid(count);
+        m_instances.upload(std::span<glm::mat4 const>(transforms));
+        m_cube.set_instances(m_instances);
+    }
+
+    char const* name() const noexcept override {
+        return "instanced_cubes";
+    }
+
+    gl::f32 radius() const noexcept override {
+        return std::sqrt(static_cast<gl::f32>(m_count)) * 1.5f + 5.f;
+    }
+
+    void draw(gl::camera& eye, gl::aux::size, double) override {
+        gl::enable(GL_DEPTH_TEST);
+        set_camera(m_program, eye);
+        m_cube.render_instanced(static_cast<gl::s32>(m_count));
+    }
+
+private:
+    gl::mesh m_cube;
+    gl::buffer m_instances;
+    gl::shader m_program;
+};
+
+/**
+ * @brief `count` distinct meshes, each with its own buffers and VAO, drawn one by one: the
+ * cost of the draws and of the binds between them.
+ */
+class unique_meshes : public scene {
+public:
+    explicit unique_meshes(std::size_t count)
+        : scene(count),
+          m_program(gl::shader::from_sources((std::string("#version 330 core\n") + k_cube_vertex_source).c_str(), k_cube_fragment_source)) {
+
+        auto vertices = std::vector<gl::f32>(k_cube_vertices.size());
+        m_meshes.reserve(count);
+        for (auto const& transform : cube_grid(count)) {
+            for (auto v = std::size_t(0); v < k_cube_vertices.size(); v += 3) {
+                auto const p = transform * glm::vec4(k_cube_vertices[v], k_cube_vertices[v + 1], k_cube_vertices[v + 2], 1.f);
+                vertices[v] = p.x;
+                vertices[v + 1] = p.y;
+                vertices[v + 2] = p.z;
+            }
+            m_meshes.emplace_back(std::span<gl::f32 const>(vertices), std::span<gl::u32 const>(k_cube_indices));
+        }
+    }
+
+    char const* name() const noexcept override {
+        return "unique_meshes";
+    }
+
+    gl::f32 radius() const noexcept override {
+        return std::sqrt(static_cast<gl::f32>(m_count)) * 1.5f + 5.f;
+    }
+
+    void draw(gl::camera& eye, gl::aux::size, double) override {
+        gl::enable(GL_DEPTH_TEST);
+        set_camera(m_program, eye);
+        for (auto& item : m_meshes) {
+            item.render();
+        }
+    }
+
+private:
+    std::vector<gl::mesh> m_meshes;
+    gl::shader m_program;
+};
+
+/**
+ * @brief `count` moving point lights over a field of instanced cubes, shaded deferred by
+ * clustered_lighting: the cost of the light culling and of the shading pass.
+ */
+class many_lights : public scene {
+public:
+    static constexpr auto k_cube_ct = std::size_t(1024);
+
+    explicit many_lights(std::size_t count)
+        : scene(count),
+          m_cubes(std::span<gl::f32 const>(k_cube_vertices), std::span<gl::u32 const>(k_cube_indices)),
+          m_program(gl::shader::from_sources((instance_prelude("450") + k_cube_vertex_source).c_str(),
+                                             (std::string("#version 450 core\n") + gl::clustered_lighting::gbuffer_declaration() + k_gbuffer_fragment_source).c_str())) {
+
+        auto const transforms = cube_grid(k_cube_ct);
+        m_instances.upload(std::span<glm::mat4 const>(transforms));
+        m_cubes.set_instances(m_instances);
+
+        auto random = std::mt19937(7);
+        auto spread = std::uniform_real_distribution<gl::f32>(-radius(), radius());
+        auto hue = std::uniform_real_distribution<gl::f32>(0.f, 1.f);
+        m_lights.resize(count);
+        for (auto& light : m_lights) {
+            light = { glm::vec3(spread(random), 1.f, spread(random)), 4.f, glm::vec3(hue(random), hue(random), hue(random)), 2.f };
+        }
+        m_moving = m_lights;
+        m_lighting.set_ambient(glm::vec3(0.05f));
+    }
+
+    char const* name() const noexcept override {
+        return "many_lights";
+    }
+
+    gl::f32 radius() const noexcept override {
+        return std::sqrt(static_cast<gl::f32>(k_cube_ct)) * 1.5f + 5.f;
+    }
+
+    void draw(gl::camera& eye, gl::aux::size viewport, double time) override {
+        for (auto i = std::size_t(0); i < m_lights.size(); ++i) {
+            auto const phase = static_cast<gl::f32>(time) + static_cast<gl::f32>(i);
+            m_moving[i].position = m_lights[i].position + glm::vec3(std::cos(phase), 0.5f * std::sin(2.f * phase), std::sin(phase));
+        }
+        m_lighting.resize(viewport.width, viewport.height);
+        m_lighting.set_lights(m_moving);
+        m_lighting.begin_geometry();
+        set_camera(m_program, eye);
+        m_cubes.render_instanced(static_cast<gl::s32>(k_cube_ct));
+        m_lighting.cull(eye);
+        m_lighting.shade(nullptr, viewport);
+    }
+
+private:
+    gl::clustered_lighting m_lighting;
+    gl::mesh m_cubes;
+    gl::buffer m_instances;
+    gl::shader m_program;
+    std::vector<gl::point_light> m_lights;          // Where they start.
+    std::vector<gl::point_light> m_moving;          // This frame's.
+};
+
+constexpr char const* k_layer_vertex_source = R"(#version 330 core
+flat out int v_layer;
+void main() {
+    // A triangle covering the screen per layer, from gl_VertexID alone.
+    vec2 corner = vec2((gl_VertexID % 3 == 1) ? 3.0 : -1.0, (gl_VertexID % 3 == 2) ? 3.0 : -1.0);
+    v_layer = gl_VertexID / 3;
+    gl_Position = vec4(corner, 0.0, 1.0);
+}
+)";
+
+constexpr char const* k_layer_fragment_source = R"(#version 330 core
+flat in int v_layer;
+out vec4 color;
+void main() {
+    float shade = fract(float(v_layer) * 0.618034);
+    color = vec4(shade, 1.0 - shade, 0.5, 0.05);
+}
+)";
+
+/**
+ * @brief `count` blended fullscreen layers with no depth test: every pixel is shaded and
+ * blended `count` times, the fill rate and the bandwidth of the target.
+ */
+class overdraw : public scene {
+public:
+    explicit overdraw(std::size_t count)
+        : scene(count),
+          m_program(gl::shader::from_sources(k_layer_vertex_source, k_layer_fragment_source)) {}
+
+    char const* name() const noexcept override {
+        return "overdraw";
+    }
+
+    void draw(gl::camera&, gl::aux::size, double) override {
+        gl::disable(GL_DEPTH_TEST);
+        gl::enable(GL_BLEND);
+        gl::blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        m_program.bind();
+        gl::bind_vao(m_array.get_object());
+        gl::draw_arrays(GL_TRIANGLES, 0, static_cast<gl::s32>(3 * m_count));
+        gl::disable(GL_BLEND);
+    }
+
+private:
+    gl::vertex_array m_array;           // Empty: the vertices come from gl_VertexID.
+    gl::shader m_program;
+};
+
+struct scene_entry {
+    char const* name;
+    std::size_t count;
+    std::function<std::unique_ptr<scene> (std::size_t)> create;
+};
+
+std::vector<scene_entry> scene_list() {
+    return {
+        { "instanced_cubes", 100000, [](std::size_t n) { return std::make_unique<instanced_cubes>(n); } },
+        { "unique_meshes", 4096, [](std::size_t n) { return std::make_unique<unique_meshes>(n); } },
+        { "many_lights", 1024, [](std::size_t n) { return std::make_unique<many_lights>(n); } },
+        { "overdraw", 64, [](std::size_t n) { return std::make_unique<overdraw>(n); } },
+    };
+}
+
+/**
+ * @brief Runs the selected scenes one after the other in the main window, each for the warmup
+ * and then the measured duration, and closes the window after the last one.
+ */
+class scene_benchmark : public gl::application {
+public:
+    explicit scene_benchmark(options const& settings)
+        : gl::application(gl::aux::window_specification{ .title = "scene_bench", .width = settings.width, .height = settings.height,
+                                                         .traits = gl::aux::window_specification::HEADLESS,
+                                                         .present = gl::aux::present_mode::IMMEDIATE }),
+          m_settings(settings),
+          m_camera(glm::vec3(0.f), glm::vec3(0.f, 1.f, 0.f), 0.f, 0.f, 0.f, 0.f) {
+
+        for (auto& entry : scene_list()) {
+            if (m_settings.scene.empty() || m_settings.scene == entry.name) {
+                m_pending.push_back(std::move(entry));
+            }
+        }
+        if (m_pending.empty()) {
+            throw std::runtime_error("Unknown scene: " + m_settings.scene);
+        }
+    }
+
+    void startup() override {
+        auto& win = this->get_current_window();
+        win.set_latency_mode(gl::window::latency_mode::MINIMAL);     // Frame times include the GPU's.
+        win.set_gpu_profiling(true);
+        win.get_gpu_profiler()->set_counters(gl::gpu_profiler::counters::ALL);
+        m_renderer = gl::get_string(GL_RENDERER);
+        m_vendor = gl::get_string(GL_VENDOR);
+        m_version = gl::get_string(GL_VERSION);
+        this->next_scene(win);
+    }
+
+    void logic(gl::window& win, double delta_time) {
+        if (m_scene == nullptr) {
+            return;
+        }
+        // The first frame of a scene also timed its creation.
+        auto const fresh = std::exchange(m_fresh, false);
+        auto const measuring = !fresh && m_elapsed >= m_settings.warmup;
+        if (measuring) {
+            m_current.frame_times.push_back(delta_time);
+            m_current.counters += win.get_state_stats();        // The last frame's.
+        }
+        m_elapsed += fresh ? 0.0 : delta_time;
+        if (!measuring && m_elapsed >= m_settings.warmup) {
+            win.get_gpu_profiler()->reset_statistics();
+        }
+        if (m_elapsed >= m_settings.warmup + m_settings.duration) {
+            this->finish_scene(win);
+            this->next_scene(win);
+            return;
+        }
+
+        // One orbit over the measured duration, at the same views whatever the frame rate.
+        auto const t = std::clamp((m_elapsed - m_settings.warmup) / m_settings.duration, 0.0, 1.0);
+        auto const angle = static_cast<gl::f32>(2.0 * std::numbers::pi * t);
+        auto const distance = m_scene->radius();
+        auto const position = glm::vec3(distance * std::cos(angle), 0.4f * distance, distance * std::sin(angle));
+        auto const front = glm::normalize(-position);
+        m_camera.set_position(position);
+        m_camera.set_orientation(glm::degrees(std::atan2(front.z, front.x)), glm::degrees(std::asin(front.y)));
+        auto const size = win.get_size();
+        m_camera.set_perspective(45.f, static_cast<gl::f32>(size.width) / static_cast<gl::f32>(std::max(size.height, 1)), 0.1f, 4.f * distance);
+    }
+
+    void render(gl::window& win, double) {
+        if (m_scene == nullptr) {
+            return;
+        }
+        GPU_SCOPE(*win.get_gpu_profiler(), m_scene->name());
+        m_scene->draw(m_camera, win.get_size(), m_elapsed);
+    }
+
+    std::vector<report> const& get_reports() const noexcept {
+        return m_reports;
+    }
+
+    std::string json() const {
+        auto const quoted = [](std::string_view text) {
+            auto result = std::string("\"");
+            for (auto const c : text) {
+                if (c == '"' || c == '\\') {
+                    result += '\\';
+                }
+                result += c;
+            }
+            return result + '"';
+        };
+        using counters = gl::gpu_profiler::counters;
+        auto out = std::ostringstream();
+        out << std::fixed << std::setprecision(4);
+        out << "{\n  \"context\": {\n    \"renderer\": " << quoted(m_renderer) << ",\n    \"vendor\": " << quoted(m_vendor)
+            << ",\n    \"version\": " << quoted(m_version) << ",\n    \"width\": " << m_settings.width << ",\n    \"height\": "
+            << m_settings.height << ",\n    \"duration\": " << m_settings.duration << ",\n    \"warmup\": " << m_settings.warmup
+            << "\n  },\n  \"scenes\": [";
+        for (auto i = std::size_t(0); i < m_reports.size(); ++i) {
+            auto const& r = m_reports[i];
+            auto const frames = std::max<double>(1.0, static_cast<double>(r.frame_times.size()));
+            out << (i == 0 ? "\n" : ",\n") << "    {\n      \"name\": " << quoted(r.name) << ",\n      \"count\": " << r.count
+                << ",\n      \"frames\": " << r.frame_times.size() << ",\n      \"frame_time_ms\": { \"mean\": " << r.mean() * 1e3
+                << ", \"min\": " << r.percentile(0.0) * 1e3 << ", \"p50\": " << r.percentile(50.0) * 1e3 << ", \"p90\": "
+                << r.percentile(90.0) * 1e3 << ", \"p99\": " << r.percentile(99.0) * 1e3 << ", \"max\": " << r.percentile(100.0) * 1e3
+                << " },\n      \"per_frame\": { \"draw_calls\": " << static_cast<double>(r.counters.draw_calls) / frames
+                << ", \"triangles\": " << static_cast<double>(r.counters.triangles) / frames << ", \"instances\": "
+                << static_cast<double>(r.counters.instances) / frames << ", \"bytes_uploaded\": "
+                << static_cast<double>(r.counters.bytes_uploaded) / frames << " },\n      \"gpu_scopes_ms\": [";
+            for (auto k = std::size_t(0); k < r.gpu_scopes.size(); ++k) {
+                auto const& s = r.gpu_scopes[k];
+                out << (k == 0 ? "\n" : ",\n") << "        { \"name\": " << quoted(s.name) << ", \"depth\": " << s.depth
+                    << ", \"mean\": " << s.average() << ", \"min\": " << (s.count > 0 ? s.min : 0.0) << ", \"max\": " << s.max
+                    << ", \"frames\": " << s.count << ", \"per_frame\": { \"vertices\": " << s.average(counters::VERTICES)
+                    << ", \"vertex_invocations\": " << s.average(counters::VERTEX_INVOCATIONS) << ", \"clipping_input\": "
+                    << s.average(counters::CLIPPING_INPUT) << ", \"clipping_output\": " << s.average(counters::CLIPPING_OUTPUT)
+                    << ", \"fragment_invocations\": " << s.average(counters::FRAGMENT_INVOCATIONS) << ", \"samples_passed\": "
+                    << s.average(counters::SAMPLES_PASSED) << " } }";
+            }
+            out << (r.gpu_scopes.empty() ? "]" : "\n      ]") << "\n    }";
+        }
+        out << "\n  ]\n}\n";
+        return out.str();
+    }
+
+private:
+    void next_scene(gl::window& win) {
+        m_scene.reset();
+        if (m_pending.empty()) {
+            win.close();
+            return;
+        }
+        auto const entry = std::move(m_pending.front());
+        m_pending.erase(m_pending.begin());
+        auto const count = std::max<std::size_t>(1, static_cast<std::size_t>(static_cast<double>(entry.count) * m_settings.scale));
+        try {
+            m_scene = entry.create(count);
+        }
+        catch (...) {
+            std::cerr << "Skipped " << entry.name << ": it could not be created with this context" << std::endl;
+            this->next_scene(win);
+            return;
+        }
+        m_current = report{ entry.name, count, {}, {}, {} };
+        m_elapsed = 0.0;
+        m_fresh = true;
+    }
+
+    void finish_scene(gl::window& win) {
+        std::ranges::sort(m_current.frame_times);
+        auto const statistics = win.get_gpu_profiler()->get_statistics();
+        m_current.gpu_scopes.assign(statistics.begin(), statistics.end());
+        std::erase_if(m_current.gpu_scopes, [](auto const& s) { return s.count == 0; });
+        auto const& r = m_reports.emplace_back(std::move(m_current));
+        std::cout << std::left << std::setw(18) << r.name << std::right << std::setw(8) << r.count << std::fixed << std::setprecision(2)
+                  << "  mean " << r.mean() * 1e3 << " ms  p50 " << r.percentile(50.0) * 1e3 << "  p99 " << r.percentile(99.0) * 1e3
+                  << "  (" << r.frame_times.size() << " frames)" << std::endl;
+    }
+
+    options const& m_settings;
+    gl::camera m_camera;
+    std::vector<scene_entry> m_pending;
+    std::unique_ptr<scene> m_scene;
+    report m_current;
+    std::vector<report> m_reports;
+    double m_elapsed = 0.0;                 // Since the current scene started.
+    bool m_fresh = false;                   // The current scene was created by the last frame.
+    std::string m_renderer;
+    std::string m_vendor;
+    std::string m_version;
+};
+
+options parse_options(int argc, char** argv) {
+    auto result = options();
+    for (auto i = 1; i < argc; ++i) {
+        auto const arg = std::string_view(argv[i]);
+        if (arg == "--scene" && i + 1 < argc) {
+            result.scene = argv[++i];
+        }
+        else if (arg == "--duration" && i + 1 < argc) {
+            result.duration = std::max(0.1, std::stod(argv[++i]));
+        }
+        else if (arg == "--warmup" && i + 1 < argc) {
+            result.warmup = std::max(0.0, std::stod(argv[++i]));
+        }
+        else if (arg == "--size" && i + 1 < argc) {
+            auto const size = std::string(argv[++i]);
+            auto const x = size.find('x');
+            if (x == std::string::npos) {
+                throw std::runtime_error("Expected <width>x<height>: " + size);
+            }
+            result.width = std::stoi(size.substr(0, x));
+            result.height = std::stoi(size.substr(x + 1));
+        }
+        else if (arg == "--scale" && i + 1 < argc) {
+            result.scale = std::stod(argv[++i]);
+        }
+        else if (arg == "--json" && i + 1 < argc) {
+            result.json = argv[++i];
+        }
+        else {
+            throw std::runtime_error("Usage: scene_bench [--scene <name>] [--duration <seconds>] [--warmup <seconds>] "
+                                     "[--size <width>x<height>] [--scale <factor>] [--json <file>]");
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        auto const settings = parse_options(argc, argv);
+        gl::LOG.set_level(gltool::log_tag::WARNING);
+        auto app = scene_benchmark(settings);
+        app.run([&app](gl::window& win, double dt) { app.logic(win, dt); },
+                [&app](gl::window& win, double dt) { app.render(win, dt); });
+
+        auto const result = app.json();
+        if (settings.json != nullptr) {
+            auto out = std::ofstream(settings.json);
+            if (!out.is_open()) {
+                throw std::runtime_error("Could not open file: " + std::string(settings.json));
+            }
+            out << result;
+        }
+        else {
+            std::cout << result;
+        }
+    }
+    catch (std::exception const& error) {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+    catch (...) {
+        std::cerr << "Could not create a headless OpenGL context" << std::endl;
+        return 1;
+    }
+    return 0;
+}